@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pet_state.h"
+#include <iostream>
 #include <vector>
 #include <string>
 
@@ -12,8 +13,9 @@ public:
     /**
      * @brief Constructor
      * @param petState Reference to the pet state
+     * @param out Stream achievements are written to
      */
-    explicit AchievementManager(PetState& petState) noexcept;
+    explicit AchievementManager(PetState& petState, std::ostream& out = std::cout) noexcept;
 
     /**
      * @brief Display unlocked achievements
@@ -36,4 +38,7 @@ public:
 private:
     // Reference to the pet state
     PetState& m_petState;
+
+    // Stream achievements are written to
+    std::ostream& m_out;
 };
@@ -6,9 +6,8 @@
 #include <vector>
 #include <bitset>
 #include <optional>
-#include <fstream>
-#include <set>
 #include <string>
+#include "state_file_format.h"
 
 /**
  * @brief Enumeration of all possible achievements in the game
@@ -119,7 +118,19 @@ public:
      * @brief Set the unlocked achievements from a binary representation
      * @param bits uint64_t representing unlocked achievements
      */
-    void setUnlockedBits(uint64_t bits) noexcept { m_unlockedAchievements = std::bitset<64>(bits); }
+    void setUnlockedBits(uint64_t bits) noexcept { m_unlockedAchievements = std::bitset<64>(bits); m_dirty = true; }
+    
+    /**
+     * @brief Get the newly unlocked achievements as uint64_t
+     * @return uint64_t representing newly unlocked achievements
+     */
+    uint64_t getNewlyUnlockedBits() const noexcept { return m_newlyUnlockedAchievements.to_ullong(); }
+    
+    /**
+     * @brief Set the newly unlocked achievements from a binary representation
+     * @param bits uint64_t representing newly unlocked achievements
+     */
+    void setNewlyUnlockedBits(uint64_t bits) noexcept { m_newlyUnlockedAchievements = std::bitset<64>(bits); m_dirty = true; }
     
     /**
      * @brief Track progress for achievements that require multiple steps
@@ -147,7 +158,9 @@ public:
      * @param type The achievement type
      * @return The total required progress
      */
-    static uint32_t getRequiredProgress(AchievementType type) noexcept;
+    static constexpr uint32_t getRequiredProgress(AchievementType type) noexcept {
+        return type == AchievementType::Count ? 0 : ACHIEVEMENT_REQUIRED_PROGRESS[static_cast<size_t>(type)];
+    }
     
     /**
      * @brief Reset achievement system to default state
@@ -157,10 +170,21 @@ public:
         m_unlockedAchievements.reset();
         m_newlyUnlockedAchievements.reset();
         m_progress.fill(0);
-        m_usedCommands.clear();
-        m_progress.fill(0);
+        m_usedCommandsMask = 0;
+        m_dirty = true;
     }
     
+    /**
+     * @brief Check if anything changed since the last clearDirty()
+     * @return True if achievement state was modified
+     */
+    bool isDirty() const noexcept { return m_dirty; }
+    
+    /**
+     * @brief Mark the current achievement state as persisted
+     */
+    void clearDirty() const noexcept { m_dirty = false; }
+    
     /**
      * @brief Track a unique command for the Explorer achievement
      * @param command The command string to track
@@ -168,21 +192,48 @@ public:
     void trackUniqueCommand(const std::string& command) noexcept;
     
     /**
-     * @brief Save achievement data to a file stream
-     * @param file The output file stream
-     * @return true if saved successfully, false otherwise
+     * @brief Get the commands used so far for the Explorer achievement
+     * @return Bitmask with one bit per entry of the Explorer command list
      */
-    bool save(std::ofstream& file) const noexcept;
+    uint32_t getUsedCommandsMask() const noexcept { return m_usedCommandsMask; }
     
     /**
-     * @brief Load achievement data from a file stream
-     * @param file The input file stream
+     * @brief Get an Explorer command by its index in the used commands mask
+     * @param index Bit index in the used commands mask
+     * @return The command name, or an empty string_view if out of range
+     */
+    static std::string_view getExplorerCommand(size_t index) noexcept {
+        return index < EXPLORER_COMMANDS.size() ? EXPLORER_COMMANDS[index] : std::string_view{};
+    }
+    
+    /**
+     * @brief Write achievement data into a state file section
+     * @param section The section to fill
+     */
+    void writeSection(StateFileFormat::AchievementSection& section) const noexcept;
+    
+    /**
+     * @brief Read achievement data from a state file section
+     * @param section The decoded section
+     */
+    void readSection(const StateFileFormat::AchievementSection& section) noexcept;
+    
+    /**
+     * @brief Load achievement data from a legacy (version 2-4) file
+     * @param reader Reader positioned at the achievement data
      * @param version The version of the file
      * @return true if loaded successfully, false otherwise
      */
-    bool load(std::ifstream& file, uint8_t version = 4) noexcept;
+    bool load(BinarySchema::Reader& reader, uint8_t version = 4) noexcept;
     
 private:
+    /**
+     * @brief Find the Explorer command list index of a command
+     * @param command The command string
+     * @return Index into EXPLORER_COMMANDS, or std::nullopt if not tracked
+     */
+    static std::optional<size_t> findExplorerCommand(std::string_view command) noexcept;
+    
     // Bitset to store unlocked achievements (64 bits allows for future expansion)
     std::bitset<64> m_unlockedAchievements;
     
@@ -192,8 +243,16 @@ private:
     // Progress tracking for achievements that require multiple steps
     std::array<uint32_t, static_cast<size_t>(AchievementType::Count)> m_progress;
     
-    // Set to track used commands for the Explorer achievement
-    std::set<std::string> m_usedCommands;
+    // Bitmask of used commands for the Explorer achievement (bit per EXPLORER_COMMANDS entry)
+    uint32_t m_usedCommandsMask;
+    
+    // Set by every modification, cleared once the state is persisted
+    mutable bool m_dirty = false;
+    
+    // Only basic commands from the help menu are considered for the Explorer achievement
+    static constexpr std::array<std::string_view, 7> EXPLORER_COMMANDS = {
+        "status", "feed", "play", "evolve", "achievements", "help", "clear"
+    };
     
     // Static array of achievement names
     static constexpr std::array<std::string_view, static_cast<size_t>(AchievementType::Count)> ACHIEVEMENT_NAMES = {
@@ -239,4 +298,7 @@ private:
         30,  // Survivor
         1  // Eternal
     };
+    
+    static_assert(static_cast<size_t>(AchievementType::Count) <= StateFileFormat::MAX_ACHIEVEMENTS,
+                  "Achievement progress must fit in the state file header");
 };
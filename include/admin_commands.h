@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+
+/**
+ * @brief Handles maintenance commands that operate on state files directly
+ * 
+ * These commands run before any pet is loaded and never touch the
+ * current user's pet unless it is inside the directory they are given.
+ */
+class AdminCommands {
+public:
+    /**
+     * @brief Constructor
+     */
+    AdminCommands() noexcept;
+    
+    /**
+     * @brief Check whether a command is an admin command
+     * @param command The command name
+     * @return True if the command is handled by AdminCommands
+     */
+    bool isAdminCommand(std::string_view command) const noexcept;
+    
+    /**
+     * @brief Run an admin command
+     * @param args Command line arguments, starting with the command name
+     * @return Process exit code
+     */
+    int run(const std::vector<std::string_view>& args) const noexcept;
+    
+private:
+    /**
+     * @brief Upgrade all state files below a directory to the current format
+     * @param args Arguments following the command name
+     * @return Process exit code
+     */
+    static int runMigrate(const std::vector<std::string_view>& args);
+    
+    /**
+     * @brief Verify the checksums of all state files below a directory
+     * @param args Arguments following the command name
+     * @return Process exit code, non-zero if any file is corrupt
+     */
+    static int runFsck(const std::vector<std::string_view>& args);
+    
+    /**
+     * @brief Move idle pets below a directory into compressed archives
+     * @param args Arguments following the command name
+     * @return Process exit code
+     */
+    static int runArchive(const std::vector<std::string_view>& args);
+    
+    /**
+     * @brief Measure how the tick engine scales with the number of threads
+     * @param args Arguments following the command name
+     * @return Process exit code
+     */
+    static int runTickBench(const std::vector<std::string_view>& args);
+    
+    /**
+     * @brief Count, list or project the pets below a directory or in a store that match a predicate
+     * @param args Arguments following the command name
+     * @return Process exit code
+     */
+    static int runQuery(const std::vector<std::string_view>& args);
+    
+    /**
+     * @brief Show the pets of a store with the most XP, the oldest pets, or the rank of one pet
+     * @param args Arguments following the command name
+     * @return Process exit code
+     */
+    static int runLeaderboard(const std::vector<std::string_view>& args);
+    
+    /**
+     * @brief Keep pets loaded and serve commands over a Unix domain socket
+     * @param args Arguments following the command name
+     * @return Process exit code
+     */
+    static int runDaemon(const std::vector<std::string_view>& args);
+    
+    /**
+     * @brief Measure daemon throughput and latency over the socket and shared memory as more requests are pipelined
+     * @param args Arguments following the command name
+     * @return Process exit code
+     */
+    static int runDaemonBench(const std::vector<std::string_view>& args);
+    
+    // Type of admin command handler function
+    using AdminHandler = std::function<int(const std::vector<std::string_view>&)>;
+    
+    // Map of command names to their handlers
+    std::unordered_map<std::string_view, AdminHandler> m_handlers;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <limits>
+
+/**
+ * @brief Allocator returning memory aligned to a fixed boundary
+ *
+ * Used for columns processed with SIMD loads, so every column starts
+ * on a cache line and vector loads never straddle one at the start.
+ *
+ * @tparam T Element type
+ * @tparam Alignment Alignment in bytes, a power of two
+ */
+template <typename T, size_t Alignment>
+class AlignedAllocator {
+public:
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must satisfy the element type");
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* pointer, size_t) noexcept {
+        ::operator delete(pointer, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <span>
+#include <filesystem>
+#include <vector>
+
+/**
+ * @brief Controls when saves are forced to disk with fsync
+ *
+ * AtomicFileWriter::write() always syncs a file's data before renaming it
+ * into place, so no policy can leave a truncated file. The policy decides
+ * when the renames themselves (the directory) and appended bytes are synced.
+ */
+struct DurabilityPolicy {
+    /**
+     * @brief Durability modes
+     */
+    enum class Mode : uint8_t {
+        Always,     // Persist every save before returning
+        Batched,    // Persist saves every N saves or every T milliseconds, whichever comes first
+        Never       // Leave persisting renames and appends to the operating system
+    };
+
+    Mode mode = Mode::Always;
+
+    // Batched mode: fsync at least every this many saves
+    uint32_t maxUnsyncedSaves = 1;
+
+    // Batched mode: fsync at least this often
+    std::chrono::milliseconds maxUnsyncedTime{0};
+
+    /**
+     * @brief Policy that syncs every save
+     */
+    static constexpr DurabilityPolicy always() noexcept {
+        return { Mode::Always, 1, std::chrono::milliseconds{0} };
+    }
+
+    /**
+     * @brief Policy that syncs every N saves or T milliseconds
+     * @param saves Maximum number of saves between syncs
+     * @param interval Maximum time between syncs
+     */
+    static constexpr DurabilityPolicy batched(uint32_t saves, std::chrono::milliseconds interval) noexcept {
+        return { Mode::Batched, saves, interval };
+    }
+
+    /**
+     * @brief Policy that never syncs explicitly
+     */
+    static constexpr DurabilityPolicy never() noexcept {
+        return { Mode::Never, 0, std::chrono::milliseconds{0} };
+    }
+};
+
+/**
+ * @brief Replaces files atomically via a temporary file and rename
+ *
+ * A reader (or a crash, or a power loss) only ever sees the old or the new
+ * file contents, never a truncated file. Whether the new contents survive
+ * a power loss depends on the configured DurabilityPolicy. Temporary files
+ * are unique per write, so writers in the same process never share one.
+ */
+class AtomicFileWriter {
+public:
+    /**
+     * @brief Constructor
+     * @param policy The durability policy to use
+     */
+    explicit AtomicFileWriter(DurabilityPolicy policy = DurabilityPolicy::always()) noexcept;
+
+    /**
+     * @brief Destructor, syncs any pending unsynced save
+     */
+    ~AtomicFileWriter();
+
+    AtomicFileWriter(const AtomicFileWriter& other) noexcept;
+    AtomicFileWriter& operator=(const AtomicFileWriter& other) noexcept;
+
+    /**
+     * @brief Set the durability policy
+     * @param policy The new policy
+     */
+    void setPolicy(const DurabilityPolicy& policy) noexcept { m_policy = policy; }
+
+    /**
+     * @brief Get the durability policy
+     * @return The current policy
+     */
+    const DurabilityPolicy& getPolicy() const noexcept { return m_policy; }
+
+    /**
+     * @brief Atomically replace a file with the given contents
+     * @param path Destination path
+     * @param data File contents
+     * @return True if the file was replaced, false otherwise
+     */
+    bool write(const std::filesystem::path& path, std::span<const std::byte> data) noexcept;
+
+    /**
+     * @brief Append to an existing file, syncing it as the policy requires
+     *
+     * Unlike write() this is not atomic: an interrupted append may leave a
+     * partial tail, which the file format must be able to detect.
+     *
+     * @param path Path of an existing file
+     * @param data Bytes to append
+     * @return True if all bytes were appended, false otherwise
+     */
+    bool append(const std::filesystem::path& path, std::span<const std::byte> data) noexcept;
+
+    /**
+     * @brief Persist every save made since the last sync: appended files and renamed directory entries
+     *
+     * The batched policy checks its interval only when a save is made, so
+     * callers that stop saving should flush; the destructor does so too.
+     *
+     * @return True if nothing was pending or every sync succeeded
+     */
+    bool flush() noexcept;
+
+    /**
+     * @brief Get the number of saves not yet forced to disk
+     * @return Number of unsynced saves
+     */
+    uint32_t getUnsyncedSaves() const noexcept { return m_unsyncedSaves; }
+
+private:
+    /**
+     * @brief Decide whether the save being written now should be synced
+     * @return True if the policy requires a sync
+     */
+    bool shouldSync() const noexcept;
+
+    /**
+     * @brief Account for a finished save; a synced one also syncs everything pending
+     * @param path What the save left to sync: the appended file, or the directory of a renamed one
+     * @param isDirectory True if path is a directory
+     * @param synced True if the save was forced to disk
+     */
+    void recordSave(const std::filesystem::path& path, bool isDirectory, bool synced) noexcept;
+
+    /**
+     * @brief Sync the contents of a file
+     * @param path Path of the file to sync
+     * @return True if successful
+     */
+    static bool syncFile(const std::filesystem::path& path) noexcept;
+
+    /**
+     * @brief Sync a directory, persisting renames into it
+     * @param directory Path of the directory, empty for the current one
+     * @return True if successful
+     */
+    static bool syncDirectory(const std::filesystem::path& directory) noexcept;
+
+    // Current durability policy
+    DurabilityPolicy m_policy;
+
+    // Saves written since the last sync
+    uint32_t m_unsyncedSaves = 0;
+
+    // Time of the last sync
+    std::chrono::steady_clock::time_point m_lastSync;
+
+    // Files appended to without a sync, each listed once
+    std::vector<std::filesystem::path> m_pendingFiles;
+
+    // Directories with renames not yet synced, each listed once
+    std::vector<std::filesystem::path> m_pendingDirectories;
+};
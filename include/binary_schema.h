@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <bit>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief Compile-time binary schemas and bounds-checked little-endian readers
+ *
+ * A schema is a constexpr list of field descriptors over a plain record struct.
+ * The same descriptors drive both the encoder and the decoder, so a field is
+ * declared once: its position, size and the version that introduced it.
+ * All scalars are stored little-endian regardless of the host byte order.
+ */
+namespace BinarySchema {
+
+    /**
+     * @brief Types that can be stored as fixed-size scalars
+     */
+    template <typename T>
+    concept Scalar = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+    /**
+     * @brief Unsigned integer with the same size as a scalar type
+     */
+    template <size_t Size> struct UnsignedOfSize;
+    template <> struct UnsignedOfSize<1> { using type = uint8_t; };
+    template <> struct UnsignedOfSize<2> { using type = uint16_t; };
+    template <> struct UnsignedOfSize<4> { using type = uint32_t; };
+    template <> struct UnsignedOfSize<8> { using type = uint64_t; };
+
+    /**
+     * @brief Store a scalar in little-endian byte order
+     * @param out Destination, at least sizeof(T) bytes
+     * @param value The value to store
+     */
+    template <Scalar T>
+    constexpr void storeLE(std::byte* out, T value) noexcept {
+        using Bits = typename UnsignedOfSize<sizeof(T)>::type;
+        Bits bits;
+        if constexpr (std::is_enum_v<T>) {
+            bits = static_cast<Bits>(static_cast<std::underlying_type_t<T>>(value));
+        } else {
+            bits = std::bit_cast<Bits>(value);
+        }
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            out[i] = static_cast<std::byte>(bits >> (8 * i));
+        }
+    }
+
+    /**
+     * @brief Load a scalar stored in little-endian byte order
+     * @param in Source, at least sizeof(T) bytes
+     * @return The decoded value
+     */
+    template <Scalar T>
+    constexpr T loadLE(const std::byte* in) noexcept {
+        using Bits = typename UnsignedOfSize<sizeof(T)>::type;
+        Bits bits = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            bits |= static_cast<Bits>(static_cast<Bits>(in[i]) << (8 * i));
+        }
+        if constexpr (std::is_enum_v<T>) {
+            return static_cast<T>(static_cast<std::underlying_type_t<T>>(bits));
+        } else {
+            return std::bit_cast<T>(bits);
+        }
+    }
+
+    /**
+     * @brief Descriptor of one record field
+     * @tparam Record The record struct
+     * @tparam T Member type: a scalar or a fixed-size array of scalars
+     */
+    template <typename Record, typename T>
+    struct Field {
+        using ElementType = std::remove_all_extents_t<T>;
+        static_assert(Scalar<ElementType>, "Schema fields must be scalars or arrays of scalars");
+
+        // Number of scalars in the field
+        static constexpr size_t COUNT = std::is_array_v<T> ? std::extent_v<T> : 1;
+
+        // Encoded size of the field in bytes
+        static constexpr size_t SIZE = sizeof(ElementType) * COUNT;
+
+        std::string_view name;
+        T Record::* member;
+        uint8_t sinceVersion;
+
+        constexpr bool presentIn(uint8_t version) const noexcept { return version >= sinceVersion; }
+
+        void encode(const Record& record, std::byte* out) const noexcept {
+            if constexpr (std::is_array_v<T>) {
+                for (size_t i = 0; i < COUNT; ++i) {
+                    storeLE(out + i * sizeof(ElementType), (record.*member)[i]);
+                }
+            } else {
+                storeLE(out, record.*member);
+            }
+        }
+
+        void decode(Record& record, const std::byte* in) const noexcept {
+            if constexpr (std::is_array_v<T>) {
+                for (size_t i = 0; i < COUNT; ++i) {
+                    (record.*member)[i] = loadLE<ElementType>(in + i * sizeof(ElementType));
+                }
+            } else {
+                record.*member = loadLE<T>(in);
+            }
+        }
+    };
+
+    /**
+     * @brief Create a field descriptor
+     * @param name Field name, for diagnostics
+     * @param member Pointer to the record member
+     * @param sinceVersion First format version containing the field
+     */
+    template <typename Record, typename T>
+    constexpr Field<Record, T> field(std::string_view name, T Record::* member, uint8_t sinceVersion = 0) noexcept {
+        return { name, member, sinceVersion };
+    }
+
+    /**
+     * @brief Ordered list of fields making up a record's encoding
+     *
+     * Fields are packed in declaration order without padding. Fields newer
+     * than the version being read are left value-initialized by decode().
+     */
+    template <typename Record, typename... Fields>
+    class Schema {
+    public:
+        constexpr explicit Schema(Fields... fields) noexcept : m_fields(fields...) {}
+
+        /**
+         * @brief Get the encoded size of a record
+         * @param version Format version
+         * @return Size in bytes of all fields present in the version
+         */
+        constexpr size_t encodedSize(uint8_t version) const noexcept {
+            return std::apply([version](const auto&... f) {
+                return ((f.presentIn(version) ? f.SIZE : size_t{0}) + ... + size_t{0});
+            }, m_fields);
+        }
+
+        /**
+         * @brief Get the offset of a field in the encoding
+         * @param name Field name
+         * @param version Format version
+         * @return Offset in bytes, or encodedSize(version) if the field is not present
+         */
+        constexpr size_t offsetOf(std::string_view name, uint8_t version) const noexcept {
+            size_t offset = 0;
+            bool found = false;
+            std::apply([&](const auto&... f) {
+                auto visitField = [&](const auto& fieldDescriptor) {
+                    if (found || !fieldDescriptor.presentIn(version)) {
+                        return;
+                    }
+                    if (fieldDescriptor.name == name) {
+                        found = true;
+                    } else {
+                        offset += fieldDescriptor.SIZE;
+                    }
+                };
+                (visitField(f), ...);
+            }, m_fields);
+            return offset;
+        }
+
+        /**
+         * @brief Encode a record
+         * @param record The record to encode
+         * @param version Format version to write
+         * @param out Destination of at least encodedSize(version) bytes
+         * @return True if out was large enough
+         */
+        bool encode(const Record& record, uint8_t version, std::span<std::byte> out) const noexcept {
+            if (out.size() < encodedSize(version)) {
+                return false;
+            }
+
+            std::byte* pos = out.data();
+            std::apply([&](const auto&... f) {
+                auto encodeField = [&](const auto& fieldDescriptor) {
+                    if (fieldDescriptor.presentIn(version)) {
+                        fieldDescriptor.encode(record, pos);
+                        pos += fieldDescriptor.SIZE;
+                    }
+                };
+                (encodeField(f), ...);
+            }, m_fields);
+            return true;
+        }
+
+        /**
+         * @brief Decode a record
+         * @param in Source bytes
+         * @param version Format version of the source
+         * @param record Output record; fields absent from the version are value-initialized
+         * @return True if in held all fields of the version
+         */
+        bool decode(std::span<const std::byte> in, uint8_t version, Record& record) const noexcept {
+            if (in.size() < encodedSize(version)) {
+                return false;
+            }
+
+            record = Record{};
+            const std::byte* pos = in.data();
+            std::apply([&](const auto&... f) {
+                auto decodeField = [&](const auto& fieldDescriptor) {
+                    if (fieldDescriptor.presentIn(version)) {
+                        fieldDescriptor.decode(record, pos);
+                        pos += fieldDescriptor.SIZE;
+                    }
+                };
+                (decodeField(f), ...);
+            }, m_fields);
+            return true;
+        }
+
+    private:
+        std::tuple<Fields...> m_fields;
+    };
+
+    /**
+     * @brief Create a schema from field descriptors
+     */
+    template <typename Record, typename... Ts>
+    constexpr Schema<Record, Field<Record, Ts>...> makeSchema(Field<Record, Ts>... fields) noexcept {
+        return Schema<Record, Field<Record, Ts>...>(fields...);
+    }
+
+    /**
+     * @brief Sequential bounds-checked reader over a byte span
+     *
+     * Every read fails once the data is exhausted; the failure is sticky,
+     * so a sequence of reads can be checked once at the end with ok().
+     */
+    class Reader {
+    public:
+        explicit Reader(std::span<const std::byte> bytes) noexcept : m_bytes(bytes) {}
+
+        /**
+         * @brief Read a little-endian scalar
+         * @param value Output value, left unchanged on failure
+         * @return True if enough bytes were available
+         */
+        template <Scalar T>
+        bool read(T& value) noexcept {
+            if (!m_ok || remaining() < sizeof(T)) {
+                m_ok = false;
+                return false;
+            }
+            value = loadLE<T>(m_bytes.data() + m_pos);
+            m_pos += sizeof(T);
+            return true;
+        }
+
+        /**
+         * @brief Read raw bytes
+         * @param size Number of bytes
+         * @return The bytes, or an empty span on failure
+         */
+        std::span<const std::byte> readBytes(size_t size) noexcept {
+            if (!m_ok || remaining() < size) {
+                m_ok = false;
+                return {};
+            }
+            auto bytes = m_bytes.subspan(m_pos, size);
+            m_pos += size;
+            return bytes;
+        }
+
+        /**
+         * @brief Get the number of unread bytes
+         */
+        size_t remaining() const noexcept { return m_bytes.size() - m_pos; }
+
+        /**
+         * @brief Get the current read position
+         */
+        size_t position() const noexcept { return m_pos; }
+
+        /**
+         * @brief Check that no read has failed so far
+         */
+        bool ok() const noexcept { return m_ok; }
+
+    private:
+        std::span<const std::byte> m_bytes;
+        size_t m_pos = 0;
+        bool m_ok = true;
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <iostream>
 #include <string>
 #include <vector>
 #include <string_view>
@@ -37,8 +38,21 @@ public:
     virtual void showHelp() const noexcept = 0;
 
 protected:
-    // Type of command handler function
-    using CommandHandler = std::function<void(GameLogic&)>;
+    /**
+     * @brief Constructor
+     * @param out Stream command output is written to
+     * @param err Stream errors are written to
+     */
+    explicit CommandHandlerBase(std::ostream& out = std::cout, std::ostream& err = std::cerr) noexcept
+        : m_out(out)
+        , m_err(err) {}
+
+    // Streams command output and errors are written to
+    std::ostream& m_out;
+    std::ostream& m_err;
+
+    // Type of command handler function, called with the arguments following the command name
+    using CommandHandler = std::function<void(GameLogic&, const std::vector<std::string_view>&)>;
     
     // Map of command names to their handlers
     std::unordered_map<std::string_view, CommandHandler> m_commandHandlers;
@@ -20,8 +20,10 @@ class CommandParser : public CommandHandlerBase {
 public:
     /**
      * @brief Constructor
+     * @param out Stream command output is written to
+     * @param err Stream errors are written to
      */
-    CommandParser() noexcept;
+    explicit CommandParser(std::ostream& out = std::cout, std::ostream& err = std::cerr) noexcept;
     
     /**
      * @brief Process command line arguments
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+/**
+ * @brief CRC32C (Castagnoli) checksums
+ *
+ * Uses the SSE4.2 crc32 instruction when the CPU supports it and a
+ * table-driven implementation otherwise; both produce identical results.
+ */
+namespace Crc32c {
+
+    /**
+     * @brief Compute or extend a CRC32C checksum
+     * @param bytes Data to checksum
+     * @param crc Checksum of the preceding data, 0 to start a new checksum
+     * @return Checksum of the preceding data followed by bytes
+     */
+    uint32_t compute(std::span<const std::byte> bytes, uint32_t crc = 0) noexcept;
+
+    /**
+     * @brief Compute a CRC32C checksum with the portable implementation
+     * @param bytes Data to checksum
+     * @param crc Checksum of the preceding data, 0 to start a new checksum
+     * @return Checksum of the preceding data followed by bytes
+     */
+    uint32_t computePortable(std::span<const std::byte> bytes, uint32_t crc = 0) noexcept;
+
+    /**
+     * @brief Check whether compute() uses the SSE4.2 instruction
+     * @return True if hardware acceleration is in use
+     */
+    bool isHardwareAccelerated() noexcept;
+}
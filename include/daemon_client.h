@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+#include "daemon_protocol.h"
+
+class SharedChannel;
+
+/**
+ * @brief Forwards pet commands to a running `pet daemon`
+ *
+ * Only commands that need no terminal input are forwarded. When no daemon
+ * is listening, or PET_NO_DAEMON is set, forward() returns nothing and the
+ * caller runs the command itself.
+ */
+class DaemonClient {
+public:
+    /**
+     * @brief Check whether a command can run in the daemon
+     * @param command The command name
+     * @return True for status, feed, play, evolve and achievements
+     */
+    static bool isForwardable(std::string_view command) noexcept;
+
+    /**
+     * @brief Run a command in the daemon and copy its output to this process
+     * @param args Command line arguments
+     * @return The command's exit code, or std::nullopt if the caller should run it directly
+     */
+    static std::optional<int> forward(const std::vector<std::string_view>& args) noexcept;
+};
+
+/**
+ * @brief Client of the daemon's binary protocol with request pipelining
+ *
+ * sendCommand() only queues a request and returns its sequence number;
+ * requests go out on flush() or when a result is awaited, so any number
+ * can be in flight. Results arrive in request order with the same
+ * sequence numbers. While sending, the connection also reads results so
+ * that neither side blocks on a full socket buffer.
+ *
+ * With Transport::SharedMemory the requests and results travel through a
+ * SharedChannel instead of the socket: sendCommand() encodes the request
+ * straight into the request ring, and receive() decodes the result and
+ * its text where the daemon wrote them. No system call is made while both
+ * sides are busy.
+ *
+ * @code
+ * DaemonConnection connection;
+ * auto petId = connection.connect(DaemonProtocol::getSocketPath()) ? connection.openPet(path) : std::nullopt;
+ * for (int i = 0; i < 100; ++i) {
+ *     connection.sendCommand(*petId, DaemonProtocol::CommandId::Feed);
+ * }
+ * DaemonProtocol::CommandResult result;
+ * while (connection.getPendingCount() > 0 && connection.receive(result)) {
+ *     // result.sequence, result.xp, ...
+ * }
+ * @endcode
+ */
+class DaemonConnection {
+public:
+    /**
+     * @brief How requests reach the daemon
+     */
+    enum class Transport {
+        Socket,         // Over the Unix domain socket
+        SharedMemory    // Through shared memory rings; the socket only tells each side the other exited
+    };
+
+    /**
+     * @brief Constructor, not connected
+     */
+    DaemonConnection() noexcept;
+
+    /**
+     * @brief Destructor, closes the connection
+     */
+    ~DaemonConnection();
+
+    DaemonConnection(const DaemonConnection&) = delete;
+    DaemonConnection& operator=(const DaemonConnection&) = delete;
+
+    /**
+     * @brief Connect to a daemon
+     * @param socketPath Socket the daemon listens on
+     * @param transport How to send requests
+     * @return True if connected; false also if the daemon or platform cannot share memory
+     */
+    bool connect(const std::filesystem::path& socketPath, Transport transport = Transport::Socket) noexcept;
+
+    /**
+     * @brief Close the connection, dropping unsent requests and unread results
+     */
+    void close() noexcept;
+
+    /**
+     * @brief Check whether the connection is open
+     */
+    bool isConnected() const noexcept {
+        return m_fd >= 0;
+    }
+
+    /**
+     * @brief Get a pet ID for a state file, waiting for the answer
+     *
+     * Results of earlier commands must all have been received.
+     * @param statePath The state file; a relative path is resolved in this process
+     * @return The pet ID, or std::nullopt if the daemon could not load the pet
+     */
+    std::optional<uint32_t> openPet(const std::filesystem::path& statePath);
+
+    /**
+     * @brief Queue a command
+     * @param petId Pet ID from openPet()
+     * @param command The command
+     * @param count Repetitions for feed and play
+     * @param flags DaemonProtocol::COMMAND_* flags
+     * @return The sequence number its result will carry
+     */
+    uint32_t sendCommand(uint32_t petId, DaemonProtocol::CommandId command, uint32_t count = 1, uint8_t flags = 0);
+
+    /**
+     * @brief Send every queued request
+     * @return False if the connection failed
+     */
+    bool flush() noexcept;
+
+    /**
+     * @brief Wait for the next command result, sending queued requests first
+     * @param result Output result
+     * @param text Output text if the command had COMMAND_WANT_TEXT, valid until the next call on this connection; may be nullptr
+     * @return False if the connection failed or no command is pending
+     */
+    bool receive(DaemonProtocol::CommandResult& result, std::string_view* text = nullptr);
+
+    /**
+     * @brief Get the number of commands sent whose results have not been received
+     */
+    size_t getPendingCount() const noexcept {
+        return m_pendingCount;
+    }
+
+private:
+    /**
+     * @brief Wait until the socket is ready, then send queued bytes and read available ones
+     * @param waitForInput True to wait for input even when nothing is queued
+     * @return False if the connection failed or the daemon hung up
+     */
+    bool exchange(bool waitForInput) noexcept;
+
+    /**
+     * @brief Wait for the next message of a type
+     * @param type The expected message type
+     * @param payload Output payload, valid until the next call
+     * @return False if the connection failed or another type arrived
+     */
+    bool receiveMessage(DaemonProtocol::MessageType type, std::span<const std::byte>& payload);
+
+    /**
+     * @brief Wait for the next message in the response ring and keep it there until the next call
+     */
+    bool receiveSharedMessage(DaemonProtocol::MessageType type, std::span<const std::byte>& payload) noexcept;
+
+    /**
+     * @brief Reserve a request record in the request ring, moving results aside while it is full
+     * @return The record, or an empty span if the daemon went away
+     */
+    std::span<std::byte> reserveSharedRequest(size_t size);
+
+    /**
+     * @brief Release the response record held since the last receive
+     */
+    void releaseSharedResponse() noexcept;
+
+    /**
+     * @brief Check that the daemon has not closed the socket
+     */
+    bool isDaemonAlive() const noexcept;
+
+    int m_fd = -1;
+    uint32_t m_nextSequence = 0;
+    size_t m_pendingCount = 0;
+
+    // Queued requests; bytes before m_outputPos are sent
+    std::vector<std::byte> m_output;
+    size_t m_outputPos = 0;
+
+    // Received bytes; bytes before m_inputPos are parsed. With shared memory, results moved out of a full ring
+    std::vector<std::byte> m_input;
+    size_t m_inputPos = 0;
+
+    // Shared memory transport, if attached
+    std::unique_ptr<SharedChannel> m_channel;
+    bool m_holdingResponse = false;
+};
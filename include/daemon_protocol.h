@@ -0,0 +1,278 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+
+/**
+ * @brief Messages between clients and the resident daemon
+ *
+ * Every message is a 4-byte little-endian payload length, a MessageType
+ * byte and the payload. A connection stays open for any number of
+ * messages, and a client may send many before reading any response.
+ *
+ * Two kinds of requests share a connection:
+ * - Request runs a command line and returns its text: Stdout and Stderr
+ *   messages, then Exit or RunLocally. `pet` uses this to forward commands.
+ * - OpenPet and Command are fixed binary records for automation. OpenPet
+ *   maps a state file to a pet ID once; each Command then names a pet ID
+ *   and a CommandId and gets a CommandResult with the pet's stats. Both
+ *   carry a sequence number that the response echoes.
+ *
+ * Responses come back in request order.
+ *
+ * A local client may move its binary requests off the socket: it sends
+ * AttachSharedMemory with the descriptor of a SharedChannel, and after
+ * SharedMemoryAttached every OpenPet and Command goes through the channel's
+ * request ring and every response through its response ring, one message
+ * per ring record. The socket stays open so each side sees the other exit.
+ */
+namespace DaemonProtocol {
+
+    /**
+     * @brief Message types
+     */
+    enum class MessageType : uint8_t {
+        Request = 1,        // Client: run a command line; payload from encodeRequest()
+        Stdout = 2,         // Daemon: output for standard output
+        Stderr = 3,         // Daemon: output for standard error
+        Exit = 4,           // Daemon: the command finished; payload is the 4-byte exit code
+        RunLocally = 5,     // Daemon: the command needs the terminal; run it without the daemon
+        OpenPet = 6,        // Client: sequence number, then the state file path
+        PetOpened = 7,      // Daemon: OpenPetResult
+        Command = 8,        // Client: CommandRequest
+        CommandResult = 9,  // Daemon: CommandResult, then the text output if COMMAND_WANT_TEXT was set
+        AttachSharedMemory = 10,    // Client: no payload; a SharedChannel descriptor comes with it
+        SharedMemoryAttached = 11   // Daemon: 1-byte Status
+    };
+
+    /**
+     * @brief Commands of a Command message, one per CommandHandlerBase handler that needs no terminal
+     */
+    enum class CommandId : uint8_t {
+        Status = 1,
+        Feed = 2,
+        Play = 3,
+        Evolve = 4,
+        Achievements = 5
+    };
+
+    /**
+     * @brief Outcome of an OpenPet or Command request
+     */
+    enum class Status : uint8_t {
+        Ok = 0,
+        UnknownPet = 1,         // No pet with that ID was opened
+        UnknownCommand = 2,     // Not a CommandId
+        InvalidArgument = 3,    // Count out of range
+        LoadFailed = 4,         // The state file could not be loaded
+        Unavailable = 5         // The daemon cannot take another shared memory client
+    };
+
+    // Command flag: append the command's text output to the CommandResult
+    constexpr uint8_t COMMAND_WANT_TEXT = 0x01;
+
+    /**
+     * @brief Payload of a Command message
+     */
+    struct CommandRequest {
+        uint32_t sequence;
+        uint32_t petId;
+        CommandId command;
+        uint8_t flags;          // COMMAND_* flags
+        uint16_t reserved16;    // Written as zero
+        uint32_t count;         // Repetitions for feed and play; ignored by other commands
+    };
+
+    /**
+     * @brief Payload of a CommandResult message
+     */
+    struct CommandResult {
+        uint32_t sequence;
+        Status status;
+        uint8_t evolutionLevel;
+        uint8_t evolved;        // 1 if the command changed the evolution level
+        uint8_t reserved8;      // Written as zero
+        uint32_t xp;
+        float hunger;
+        float happiness;
+        float energy;
+    };
+
+    /**
+     * @brief Payload of a PetOpened message
+     */
+    struct OpenPetResult {
+        uint32_t sequence;
+        Status status;
+        uint32_t petId;
+    };
+
+    /**
+     * @brief Outcome of parseMessage()
+     */
+    enum class ParseResult {
+        Complete,       // A whole message is at the front of the buffer
+        Incomplete,     // More bytes are needed
+        Invalid         // The length exceeds GameConfig::Daemon::MAX_MESSAGE_SIZE
+    };
+
+    // Length and type
+    constexpr size_t HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+
+    // Size of a whole Command message
+    constexpr size_t COMMAND_MESSAGE_SIZE = HEADER_SIZE + 16;
+
+    // Size of a whole CommandResult message without text
+    constexpr size_t COMMAND_RESULT_MESSAGE_SIZE = HEADER_SIZE + 24;
+
+    /**
+     * @brief Get the socket path of the daemon
+     * @return $PET_DAEMON_SOCKET if set, otherwise the default path for the user
+     */
+    std::filesystem::path getSocketPath();
+
+    /**
+     * @brief Get the CommandHandlerBase handler name of a command
+     * @param command The command
+     * @return The name, or std::nullopt if command is not a CommandId
+     */
+    std::optional<std::string_view> getCommandName(CommandId command) noexcept;
+
+    /**
+     * @brief Send a message
+     * @param fd Connected blocking socket
+     * @param type Message type
+     * @param payload Message payload
+     * @return True if the whole message was sent
+     */
+    bool sendMessage(int fd, MessageType type, std::span<const std::byte> payload) noexcept;
+
+    /**
+     * @brief Receive a message
+     * @param fd Connected blocking socket
+     * @param type Output message type
+     * @param payload Output payload, resized to the payload length
+     * @return True if a whole message of at most GameConfig::Daemon::MAX_MESSAGE_SIZE bytes was received
+     */
+    bool receiveMessage(int fd, MessageType& type, std::vector<std::byte>& payload) noexcept;
+
+    /**
+     * @brief Find the first message in buffered input
+     * @param buffer Received bytes
+     * @param type Output message type
+     * @param payload Output payload, a view into buffer
+     * @return Complete if a message was found; it spans HEADER_SIZE + payload.size() bytes
+     */
+    ParseResult parseMessage(std::span<const std::byte> buffer, MessageType& type, std::span<const std::byte>& payload) noexcept;
+
+    /**
+     * @brief Append a message to an output buffer
+     * @param buffer Output buffer
+     * @param type Message type
+     * @param payload Message payload
+     */
+    void appendMessage(std::vector<std::byte>& buffer, MessageType type, std::span<const std::byte> payload);
+
+    /**
+     * @brief Encode a Request payload
+     * @param statePath State file of the pet the command is for
+     * @param args Command line arguments
+     * @return The payload
+     */
+    std::vector<std::byte> encodeRequest(const std::filesystem::path& statePath, const std::vector<std::string_view>& args);
+
+    /**
+     * @brief Decode a Request payload
+     * @param payload The payload
+     * @param statePath Output state file path
+     * @param args Output command line arguments
+     * @return True if the payload is well formed
+     */
+    bool decodeRequest(std::span<const std::byte> payload, std::string& statePath, std::vector<std::string>& args);
+
+    /**
+     * @brief Append an OpenPet message
+     * @param buffer Output buffer
+     * @param sequence Sequence number
+     * @param statePath State file of the pet
+     */
+    void appendOpenPet(std::vector<std::byte>& buffer, uint32_t sequence, const std::filesystem::path& statePath);
+
+    /**
+     * @brief Decode an OpenPet payload
+     * @param payload The payload
+     * @param sequence Output sequence number
+     * @param statePath Output state file path
+     * @return True if the payload is well formed
+     */
+    bool decodeOpenPet(std::span<const std::byte> payload, uint32_t& sequence, std::string& statePath);
+
+    /**
+     * @brief Append a PetOpened message
+     */
+    void appendPetOpened(std::vector<std::byte>& buffer, const OpenPetResult& result);
+
+    /**
+     * @brief Decode a PetOpened payload
+     * @return True if the payload is well formed
+     */
+    bool decodePetOpened(std::span<const std::byte> payload, OpenPetResult& result) noexcept;
+
+    /**
+     * @brief Append a Command message
+     */
+    void appendCommand(std::vector<std::byte>& buffer, const CommandRequest& request);
+
+    /**
+     * @brief Write a Command message in place
+     * @param out Destination of COMMAND_MESSAGE_SIZE bytes
+     * @param request The request
+     */
+    void writeCommand(std::span<std::byte> out, const CommandRequest& request) noexcept;
+
+    /**
+     * @brief Decode a Command payload
+     * @return True if the payload is well formed
+     */
+    bool decodeCommand(std::span<const std::byte> payload, CommandRequest& request) noexcept;
+
+    /**
+     * @brief Append a CommandResult message
+     * @param buffer Output buffer
+     * @param result The result
+     * @param text Text output to append, empty unless COMMAND_WANT_TEXT was set
+     */
+    void appendCommandResult(std::vector<std::byte>& buffer, const CommandResult& result, std::string_view text);
+
+    /**
+     * @brief Write the header and result of a CommandResult message in place
+     * @param out Destination; its first COMMAND_RESULT_MESSAGE_SIZE bytes are written and the text must follow them already
+     * @param result The result
+     * @param textSize Size of the text
+     */
+    void writeCommandResult(std::span<std::byte> out, const CommandResult& result, size_t textSize) noexcept;
+
+    /**
+     * @brief Decode a CommandResult payload
+     * @param payload The payload
+     * @param result Output result
+     * @param text Output text that followed the result, a view into payload
+     * @return True if the payload is well formed
+     */
+    bool decodeCommandResult(std::span<const std::byte> payload, CommandResult& result, std::string_view& text) noexcept;
+
+    /**
+     * @brief Send an empty message with a file descriptor attached
+     * @param fd Connected Unix domain socket
+     * @param type Message type
+     * @param descriptor The descriptor to pass; the receiver gets its own copy
+     * @return True if the message was sent
+     */
+    bool sendDescriptor(int fd, MessageType type, int descriptor) noexcept;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pet_state.h"
+#include <iostream>
 #include <string_view>
 
 /**
@@ -11,8 +12,9 @@ public:
     /**
      * @brief Constructor
      * @param petState Reference to the pet state
+     * @param out Stream the display is written to
      */
-    explicit DisplayManager(PetState& petState) noexcept;
+    explicit DisplayManager(PetState& petState, std::ostream& out = std::cout) noexcept;
 
     /**
      * @brief Display a message about the pet's state change
@@ -40,4 +42,7 @@ public:
 private:
     // Reference to the pet state
     PetState& m_petState;
+
+    // Stream the display is written to
+    std::ostream& m_out;
 };
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Epoch-based reclamation for objects that readers reach through atomic pointers
+ *
+ * Writers replace an object by exchanging the pointer to it, then retire
+ * the old object instead of deleting it. Readers hold a ReadGuard while
+ * they use what they loaded. Entering and leaving a guard are a load and
+ * two stores to the reader's own cache line: readers never wait, never
+ * take a lock and never write to memory another reader writes.
+ *
+ * Every guard records the global epoch it started in. A writer frees a
+ * retired object once every guard that started before it was retired has
+ * ended, which it checks by advancing the epoch and scanning the readers'
+ * slots. Each reader thread registers once and holds its Reader for as
+ * long as it reads.
+ */
+class EpochReclaimer {
+public:
+    /**
+     * @brief A registered reader thread; unregisters when destroyed
+     */
+    class Reader {
+    public:
+        Reader() noexcept = default;
+        Reader(Reader&& other) noexcept
+            : m_reclaimer(std::exchange(other.m_reclaimer, nullptr))
+            , m_slot(other.m_slot) {}
+        Reader& operator=(Reader&&) = delete;
+        ~Reader();
+
+        /**
+         * @brief Check whether registration succeeded
+         */
+        bool isValid() const noexcept { return m_reclaimer != nullptr; }
+
+    private:
+        friend class EpochReclaimer;
+        Reader(EpochReclaimer* reclaimer, size_t slot) noexcept
+            : m_reclaimer(reclaimer), m_slot(slot) {}
+
+        EpochReclaimer* m_reclaimer = nullptr;
+        size_t m_slot = 0;
+    };
+
+    /**
+     * @brief Read-side critical section: objects loaded while it exists are not freed
+     *
+     * Guards of one reader must not nest.
+     */
+    class ReadGuard {
+    public:
+        /**
+         * @brief Constructor
+         * @param reader A valid reader of the calling thread
+         */
+        explicit ReadGuard(const Reader& reader) noexcept;
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        std::atomic<uint64_t>& m_epoch;
+    };
+
+    /**
+     * @brief Objects retired by one writer thread and not yet freed
+     *
+     * Each writer keeps its own list, so writers do not contend either.
+     * Destroying the list frees everything in it; by then no reader may
+     * hold any of it.
+     */
+    class RetireList {
+    public:
+        explicit RetireList(EpochReclaimer& reclaimer) noexcept
+            : m_reclaimer(reclaimer) {}
+
+        RetireList(const RetireList&) = delete;
+        RetireList& operator=(const RetireList&) = delete;
+
+        /**
+         * @brief Free an object once no reader can hold it
+         *
+         * Call after the object was unpublished; frees whatever is safe
+         * to free once enough objects are waiting.
+         *
+         * @param object The object, or nullptr
+         */
+        template <typename T>
+        void retire(std::unique_ptr<T> object) {
+            if (object) {
+                add(std::shared_ptr<const void>(std::move(object)));
+            }
+        }
+
+        /**
+         * @brief Free every retired object that no reader can hold any more
+         */
+        void reclaim() noexcept;
+
+        /**
+         * @brief Get the number of objects waiting to be freed
+         */
+        size_t size() const noexcept { return m_objects.size(); }
+
+    private:
+        void add(std::shared_ptr<const void> object);
+
+        EpochReclaimer& m_reclaimer;
+        // Objects with the epoch they were retired in
+        std::vector<std::pair<uint64_t, std::shared_ptr<const void>>> m_objects;
+    };
+
+    /**
+     * @brief Constructor
+     * @param maxReaders Number of reader threads that may be registered at once
+     */
+    explicit EpochReclaimer(size_t maxReaders);
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    /**
+     * @brief Register the calling thread as a reader
+     * @return The reader, invalid if maxReaders are registered already
+     */
+    Reader registerReader() noexcept;
+
+private:
+    /**
+     * @brief One reader's epoch, 0 outside a guard; padded so readers do not share cache lines
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{ 0 };
+        std::atomic<bool> used{ false };
+    };
+
+    /**
+     * @brief Get the oldest epoch a guard started in, or UINT64_MAX if no guard is open
+     */
+    uint64_t getOldestActiveEpoch() const noexcept;
+
+    // Starts at 1 so that 0 marks an idle slot
+    std::atomic<uint64_t> m_epoch{ 1 };
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_slotCount;
+};
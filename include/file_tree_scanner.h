@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <functional>
+#include <filesystem>
+
+/**
+ * @brief Walks a directory tree and processes its files on a thread pool
+ *
+ * The tree is listed on the calling thread while workers process files in
+ * batches. Symlinks are not followed, so a file is never processed twice
+ * and bulk rewrites cannot replace a link with a regular file.
+ */
+class FileTreeScanner {
+public:
+    // Called on a worker thread for every regular file
+    using FileVisitor = std::function<void(const std::filesystem::path&)>;
+
+    // Called with a path and a reason for every error; must be thread-safe
+    using ErrorHandler = std::function<void(const std::filesystem::path&, std::string)>;
+
+    /**
+     * @brief Constructor
+     * @param threadCount Number of worker threads; 0 uses the hardware concurrency
+     */
+    explicit FileTreeScanner(size_t threadCount = 0) noexcept;
+
+    /**
+     * @brief Visit every regular file below a directory
+     * @param root Directory to scan recursively, or a single file
+     * @param visit Callback for each file; exceptions are reported to onError
+     * @param onError Callback for files or directories that could not be processed
+     * @return Number of files visited
+     */
+    size_t scan(const std::filesystem::path& root, const FileVisitor& visit, const ErrorHandler& onError) const noexcept;
+
+    /**
+     * @brief Check whether a file is a by-product of saving rather than a state file
+     * @param path Path of the file
+     * @return True for journals, pet archives and their lock files, and temporary files of interrupted saves
+     */
+    static bool isAuxiliaryFile(const std::filesystem::path& path);
+
+private:
+    // Number of worker threads
+    size_t m_threadCount;
+};
@@ -60,6 +60,61 @@ namespace GameConfig {
         constexpr double SIGNIFICANT_TIME_THRESHOLD = 2.0;
     }
 
+    /**
+     * @brief Persistence constants
+     */
+    namespace Persistence {
+        // Batched durability: fsync at least every this many saves
+        constexpr uint32_t BATCHED_SYNC_EVERY_N_SAVES = 32;
+        
+        // Batched durability: fsync at least this often (milliseconds)
+        constexpr uint32_t BATCHED_SYNC_INTERVAL_MS = 1000;
+        
+        // Fold the interaction journal into a new snapshot once it grows past this size (bytes)
+        constexpr uint64_t JOURNAL_COMPACTION_THRESHOLD = 16 * 1024;
+        
+        // Default idle time after which `pet archive` moves a pet to the cold archive (days)
+        constexpr uint32_t ARCHIVE_IDLE_DAYS = 14;
+        
+        // Pets `pet leaderboard` lists when no ranking is requested
+        constexpr size_t LEADERBOARD_DEFAULT_SIZE = 10;
+    }
+
+    /**
+     * @brief Resident daemon constants
+     */
+    namespace Daemon {
+        // Socket file name in $XDG_RUNTIME_DIR; without it the socket is /tmp/pet-<uid>.sock
+        constexpr const char* SOCKET_FILE_NAME = "pet.sock";
+        
+        // Largest request or response message (bytes)
+        constexpr uint32_t MAX_MESSAGE_SIZE = 1024 * 1024;
+        
+        // Stop reading requests from a connection while this many response bytes are unsent
+        constexpr uint32_t MAX_PENDING_OUTPUT = 4 * 1024 * 1024;
+        
+        // Requests of one connection queued on the shards; reading from it pauses beyond this
+        constexpr uint32_t MAX_QUEUED_REQUESTS = 1024;
+        
+        // Pets kept loaded, split evenly between the shards; a shard unloads its least recently used pet beyond its share
+        constexpr uint32_t MAX_RESIDENT_PETS = 4096;
+        
+        // Capacity of each shared-memory ring between a client and the daemon (bytes, a power of two)
+        constexpr uint32_t SHARED_RING_CAPACITY = 1024 * 1024;
+        
+        // Text output of a command sent over shared memory is cut at this size (bytes)
+        constexpr uint32_t SHARED_TEXT_LIMIT = 64 * 1024;
+        
+        // Rounds a side spins on an empty or full ring before it sleeps on a futex
+        constexpr uint32_t SHARED_RING_SPIN_COUNT = 2000;
+        
+        // Clients served over shared memory at once, each by its own daemon thread
+        constexpr uint32_t MAX_SHARED_CHANNELS = 64;
+        
+        // Pet IDs with snapshots for read-only commands; pets beyond always run on their shard
+        constexpr uint32_t MAX_SNAPSHOT_PETS = 1024 * 1024;
+    }
+
     /**
      * @brief Stat change rates per hour based on preset
      */
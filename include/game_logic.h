@@ -5,6 +5,7 @@
 #include "achievement_manager.h"
 #include "interaction_manager.h"
 #include "time_manager.h"
+#include <iostream>
 #include <memory>
 #include <string_view>
 #include <optional>
@@ -22,8 +23,9 @@ public:
     /**
      * @brief Constructor
      * @param petState Reference to the pet state
+     * @param out Stream the game is written to
      */
-    explicit GameLogic(PetState& petState) noexcept;
+    explicit GameLogic(PetState& petState, std::ostream& out = std::cout) noexcept;
 
     /**
      * @brief Destructor
@@ -44,13 +46,15 @@ public:
 
     /**
      * @brief Feed the pet
+     * @param times Number of feedings, applied at once with one summary
      */
-    void feedPet() noexcept;
+    void feedPet(uint32_t times = 1) noexcept;
 
     /**
      * @brief Play with the pet
+     * @param times Number of plays, applied at once with one summary
      */
-    void playWithPet() noexcept;
+    void playWithPet(uint32_t times = 1) noexcept;
 
     /**
      * @brief Show evolution progress
@@ -102,6 +106,9 @@ private:
     // Reference to the pet state
     PetState& m_petState;
 
+    // Stream the game is written to
+    std::ostream& m_out;
+
     // Unique pointers to managers
     std::unique_ptr<DisplayManager> m_displayManager;
     std::unique_ptr<AchievementManager> m_achievementManager;
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <filesystem>
+
+class AtomicFileWriter;
+
+/**
+ * @brief Types of records stored in the interaction journal
+ */
+enum class JournalRecordType : uint8_t {
+    Feed = 1,               // Pet was fed; field: time (see encodeTime())
+    Play = 2,               // Pet was played with; field: time
+    TimeEffects = 3,        // Time effects were applied; field: time
+    AchievementUnlock = 4,  // Achievement unlocked outside of derived rules; field: AchievementType
+    CommandUsed = 5,        // Command tracked for the Explorer achievement; field: command index
+    FeedBatch = 6,          // Pet was fed several times; field: time, count: number of feedings
+    PlayBatch = 7           // Pet was played with several times; field: time, count: number of plays
+};
+
+// Largest count of a batch record
+constexpr uint64_t MAX_BATCH_COUNT = (uint64_t{1} << 24) - 1;
+
+/**
+ * @brief Append-only log of small interaction records
+ *
+ * File layout: a 16-byte header (magic "PETJRNL2", little-endian sequence
+ * number of the first record) followed by records of the form
+ * [varint length][type][varint field][varint count]. The count is omitted
+ * when it is 1. Times are nanoseconds since the epoch, so replay sees the
+ * same instants the live interactions used.
+ * Every record has an implicit sequence number; snapshots store the sequence
+ * of the first record they do not include, so replay can skip the rest.
+ * A partially written record at the end of the file is ignored.
+ *
+ * Journals written before "PETJRNL2" ("PETJRNL1") hold whole seconds and
+ * pack batch counts into the field. They are converted when read, and
+ * rewritten in the current format by the next append.
+ */
+class InteractionJournal {
+public:
+    /**
+     * @brief A decoded journal record
+     */
+    struct Record {
+        JournalRecordType type;
+        uint64_t value;
+        uint64_t count = 1;     // Interactions in a batch record
+    };
+
+    /**
+     * @brief Constructor
+     */
+    InteractionJournal() noexcept = default;
+
+    /**
+     * @brief Destructor, waits for a running compaction
+     */
+    ~InteractionJournal();
+
+    InteractionJournal(const InteractionJournal&) = delete;
+    InteractionJournal& operator=(const InteractionJournal&) = delete;
+
+    /**
+     * @brief Set the journal file path
+     * @param path Path to the journal file
+     */
+    void setPath(const std::filesystem::path& path) noexcept;
+
+    /**
+     * @brief Get the journal file path
+     * @return Journal file path
+     */
+    const std::filesystem::path& getPath() const noexcept { return m_path; }
+
+    /**
+     * @brief Replay records starting at a sequence number
+     * @param fromSequence First sequence number to apply
+     * @param apply Callback invoked for each record, in order
+     * @return Sequence number following the last record in the journal,
+     *         or fromSequence if there is nothing to replay
+     */
+    uint64_t replay(uint64_t fromSequence, const std::function<void(const Record&)>& apply) noexcept;
+
+    /**
+     * @brief Append encoded records with a single write
+     * @param records Records encoded with encodeRecord()
+     * @param count Number of records in the buffer
+     * @param firstSequence Sequence number of the first record
+     * @param writer Writer whose durability policy decides when the journal is synced
+     * @return True if appended successfully
+     */
+    bool append(std::span<const std::byte> records, uint32_t count, uint64_t firstSequence,
+                AtomicFileWriter& writer) noexcept;
+
+    /**
+     * @brief Get the size of the journal file
+     * @return Size in bytes of the valid part of the journal
+     */
+    uint64_t size() const noexcept;
+
+    /**
+     * @brief Remove the journal after its records were folded into a snapshot
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Fold the journal into a snapshot on a background thread
+     *
+     * Writes the snapshot atomically, then drops all records below the
+     * snapshot's sequence number from the journal. The snapshot is older
+     * than any later save, so callers must waitForCompaction() before
+     * writing the state file themselves.
+     *
+     * @param snapshotPath Path of the state file
+     * @param snapshot Encoded state including all records below sequence
+     * @param sequence First sequence number not included in the snapshot
+     */
+    void compactAsync(const std::filesystem::path& snapshotPath, std::vector<std::byte> snapshot, uint64_t sequence) noexcept;
+
+    /**
+     * @brief Wait for a running compaction to finish
+     */
+    void waitForCompaction() noexcept;
+
+    /**
+     * @brief Encode a record and append it to a buffer
+     * @param buffer Output buffer
+     * @param record The record to encode
+     */
+    static void encodeRecord(std::vector<std::byte>& buffer, const Record& record);
+
+    /**
+     * @brief Convert a time to the field of a time record
+     * @param time The time
+     * @return Nanoseconds since the epoch
+     */
+    static uint64_t encodeTime(std::chrono::system_clock::time_point time) noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Convert the field of a time record back to a time
+     * @param value Nanoseconds since the epoch
+     * @return The time
+     */
+    static std::chrono::system_clock::time_point decodeTime(uint64_t value) noexcept {
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(static_cast<int64_t>(value))));
+    }
+
+private:
+    /**
+     * @brief Drop records below a sequence number by rewriting the journal
+     * @param sequence First sequence number to keep
+     */
+    void truncateBefore(uint64_t sequence) noexcept;
+
+    // Journal file path
+    std::filesystem::path m_path;
+
+    // Sequence number following the last valid record, valid after replay/append
+    uint64_t m_endSequence = 0;
+
+    // Size of the valid part of the file, valid after replay/append
+    uint64_t m_validSize = 0;
+
+    // Whether m_endSequence and m_validSize reflect the file
+    bool m_scanned = false;
+
+    // Whether the file is a "PETJRNL1" journal, valid after replay/append
+    bool m_legacyFormat = false;
+
+    // Serializes file access between appends and the compactor
+    mutable std::mutex m_mutex;
+
+    // Background compaction thread
+    std::thread m_compactor;
+};
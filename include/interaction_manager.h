@@ -14,18 +14,22 @@ public:
      * @param petState Reference to the pet state
      * @param displayManager Reference to the display manager
      * @param achievementManager Reference to the achievement manager
+     * @param out Stream the results of interactions are written to
      */
-    InteractionManager(PetState& petState, DisplayManager& displayManager, AchievementManager& achievementManager) noexcept;
+    InteractionManager(PetState& petState, DisplayManager& displayManager, AchievementManager& achievementManager,
+                       std::ostream& out = std::cout) noexcept;
 
     /**
      * @brief Feed the pet
+     * @param times Number of feedings, applied at once with one summary
      */
-    void feedPet() noexcept;
+    void feedPet(uint32_t times = 1) noexcept;
 
     /**
      * @brief Play with the pet
+     * @param times Number of plays, applied at once with one summary
      */
-    void playWithPet() noexcept;
+    void playWithPet(uint32_t times = 1) noexcept;
 
     /**
      * @brief Show the current status of the pet
@@ -45,6 +49,20 @@ public:
     bool createNewPet(bool force = false) noexcept;
 
 private:
+    /**
+     * @brief Show what a batch of interactions added up to
+     * @param action Past tense of the interaction, such as "fed"
+     * @param times Number of interactions; nothing is shown for one
+     * @param xpBefore XP before the interactions
+     */
+    void showBatchSummary(std::string_view action, uint32_t times, uint32_t xpBefore) const noexcept;
+    
+    /**
+     * @brief Announce an evolution, possibly across several levels
+     * @param levelBefore Evolution level before the interaction
+     */
+    void showEvolution(EvolutionLevel levelBefore) const noexcept;
+    
     // Reference to the pet state
     PetState& m_petState;
     
@@ -53,4 +71,7 @@ private:
     
     // Reference to the achievement manager
     AchievementManager& m_achievementManager;
+
+    // Stream the results of interactions are written to
+    std::ostream& m_out;
 };
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+#include "order_statistic_tree.h"
+
+/**
+ * @brief Rankings of pets by XP and by age
+ *
+ * Each ranking is an OrderStatisticTree, so updating a pet, reading the
+ * top K and finding the rank of a pet all take O(log n) (plus K).
+ * Ties are broken by pet ID, lowest first.
+ *
+ * File layout:
+ * - Magic "PETLDRB1"
+ * - LeaderboardHeader
+ * - entryCount entries in XP order: pet ID (u64), XP (u32), birth date (i64 seconds)
+ * - entryCount u32 indices into those entries, in age order
+ *
+ * Both rankings are stored already sorted, so loading builds them in
+ * linear time instead of inserting every pet.
+ */
+class Leaderboard {
+public:
+    /**
+     * @brief Header following the magic bytes
+     */
+    struct LeaderboardHeader {
+        uint32_t entryCount;        // Number of pets
+        uint32_t checksum;          // CRC32C of everything following the header
+        uint32_t reserved32;        // Written as zero
+    };
+
+    /**
+     * @brief The values of one pet the rankings depend on
+     */
+    struct Entry {
+        uint64_t petId;
+        uint32_t xp;
+        int64_t birthSeconds;       // Birth date in seconds since the epoch
+    };
+
+    /**
+     * @brief Get the number of ranked pets
+     */
+    size_t size() const noexcept { return m_entries.size(); }
+
+    /**
+     * @brief Check if a pet is ranked
+     * @param petId The pet ID
+     */
+    bool contains(uint64_t petId) const noexcept { return m_entries.count(petId) != 0; }
+
+    /**
+     * @brief Add a pet or replace its values
+     * @param entry The pet's values
+     */
+    void update(const Entry& entry);
+
+    /**
+     * @brief Remove a pet
+     * @param petId The pet ID
+     * @return True if the pet was ranked
+     */
+    bool remove(uint64_t petId) noexcept;
+
+    /**
+     * @brief Remove every pet
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Get the pets with the most XP
+     * @param count Maximum number of pets
+     * @param offset Number of pets to skip first
+     * @return Pets from highest to lowest XP
+     */
+    std::vector<Entry> getTopXP(size_t count, size_t offset = 0) const;
+
+    /**
+     * @brief Get the oldest pets
+     * @param count Maximum number of pets
+     * @param offset Number of pets to skip first
+     * @return Pets from oldest to youngest
+     */
+    std::vector<Entry> getOldest(size_t count, size_t offset = 0) const;
+
+    /**
+     * @brief Get a pet's position by XP
+     * @param petId The pet ID
+     * @return One-based rank, or std::nullopt if the pet is not ranked
+     */
+    std::optional<size_t> getXPRank(uint64_t petId) const noexcept;
+
+    /**
+     * @brief Get a pet's position by age
+     * @param petId The pet ID
+     * @return One-based rank, or std::nullopt if the pet is not ranked
+     */
+    std::optional<size_t> getAgeRank(uint64_t petId) const noexcept;
+
+    /**
+     * @brief Load the rankings from a file, replacing the current ones
+     * @param path Path to the leaderboard file
+     * @return True if loaded successfully; on failure the leaderboard is empty
+     */
+    bool load(const std::filesystem::path& path) noexcept;
+
+    /**
+     * @brief Atomically write the rankings to a file
+     * @param path Path to the leaderboard file
+     * @return True if saved successfully
+     */
+    bool save(const std::filesystem::path& path) const noexcept;
+
+private:
+    // Highest XP first
+    static OrderStatisticTree::Key xpKey(const Entry& entry) noexcept {
+        return { static_cast<uint64_t>(UINT32_MAX - entry.xp), entry.petId };
+    }
+
+    // Earliest birth date first; flipping the sign bit orders signed seconds as unsigned
+    static OrderStatisticTree::Key ageKey(const Entry& entry) noexcept {
+        return { static_cast<uint64_t>(entry.birthSeconds) ^ (uint64_t{1} << 63), entry.petId };
+    }
+
+    std::vector<Entry> lookup(const std::vector<OrderStatisticTree::Key>& keys) const;
+
+    // Pet ID to the values the pet is ranked by
+    std::unordered_map<uint64_t, Entry> m_entries;
+
+    OrderStatisticTree m_byXP;
+    OrderStatisticTree m_byAge;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <filesystem>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Owns the mapping for its lifetime so callers can parse
+ * the file contents in place without copying them into a buffer.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map the given file into memory
+     * @param path Path to the file to map
+     */
+    explicit MappedFile(const std::filesystem::path& path) noexcept;
+
+    /**
+     * @brief Destructor, unmaps the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Check if the file was mapped successfully
+     * @return True if the mapping is valid, false otherwise
+     */
+    bool isOpen() const noexcept { return m_isOpen; }
+
+    /**
+     * @brief Get the mapped file contents
+     * @return Span over the mapped bytes (empty for empty files)
+     */
+    std::span<const std::byte> data() const noexcept {
+        return { m_data, m_size };
+    }
+
+private:
+    // Start of the mapping (nullptr for empty files)
+    const std::byte* m_data = nullptr;
+
+    // Size of the mapping in bytes
+    size_t m_size = 0;
+
+    // Whether the file was opened successfully
+    bool m_isOpen = false;
+
+#ifdef _WIN32
+    // Windows file mapping object handle
+    void* m_mappingHandle = nullptr;
+#endif
+};
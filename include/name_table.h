@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief Interned pet names, referenced by 32-bit IDs
+ *
+ * Many pets share a name, so compact records store an ID instead of a
+ * string. Each distinct name is stored once; IDs are assigned in order of
+ * first use and never change.
+ */
+class NameTable {
+public:
+    // ID of the empty name, always present
+    static constexpr uint32_t EMPTY_NAME_ID = 0;
+
+    /**
+     * @brief Constructor
+     */
+    NameTable();
+
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    /**
+     * @brief Get the ID of a name, adding the name if it is new
+     * @param name The name
+     * @return ID of the name
+     */
+    uint32_t intern(std::string_view name);
+
+    /**
+     * @brief Get the ID of a name without adding it
+     * @param name The name
+     * @param id Output ID
+     * @return True if the name is in the table
+     */
+    bool find(std::string_view name, uint32_t& id) const noexcept;
+
+    /**
+     * @brief Get a name by ID
+     * @param id Name ID
+     * @return The name, or an empty string_view for unknown IDs
+     */
+    std::string_view get(uint32_t id) const noexcept {
+        return id < m_names.size() ? std::string_view(m_names[id]) : std::string_view{};
+    }
+
+    /**
+     * @brief Get the number of distinct names
+     * @return Name count, including the empty name
+     */
+    size_t size() const noexcept { return m_names.size(); }
+
+private:
+    // Names indexed by ID; a deque so interned strings never move
+    std::deque<std::string> m_names;
+
+    // Views into m_names
+    std::unordered_map<std::string_view, uint32_t> m_ids;
+};
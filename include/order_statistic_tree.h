@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <compare>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Ordered set of keys with rank and select queries in O(log n)
+ *
+ * A treap whose nodes also count the size of their subtree. Node
+ * priorities are a hash of the key, so the shape of the tree depends only
+ * on the set of keys: a sorted list of keys can be turned back into the
+ * same tree in linear time. Nodes live in one vector and link by index.
+ */
+class OrderStatisticTree {
+public:
+    /**
+     * @brief Key ordered by score, then by ID
+     */
+    struct Key {
+        uint64_t score;
+        uint64_t id;
+
+        friend constexpr auto operator<=>(const Key&, const Key&) = default;
+    };
+
+    /**
+     * @brief Get the number of keys
+     */
+    size_t size() const noexcept { return m_root == NIL ? 0 : m_nodes[m_root].size; }
+
+    /**
+     * @brief Check if the set is empty
+     */
+    bool empty() const noexcept { return m_root == NIL; }
+
+    /**
+     * @brief Remove every key
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Add a key that is not in the set yet
+     * @param key The key
+     */
+    void insert(const Key& key);
+
+    /**
+     * @brief Remove a key
+     * @param key The key
+     * @return True if the key was in the set
+     */
+    bool erase(const Key& key) noexcept;
+
+    /**
+     * @brief Count the keys less than a key
+     * @param key The key, which need not be in the set
+     * @return Zero-based position the key has or would have
+     */
+    size_t rank(const Key& key) const noexcept;
+
+    /**
+     * @brief Get the key at a position
+     * @param position Zero-based position
+     * @return The key, or std::nullopt if position is not less than size()
+     */
+    std::optional<Key> select(size_t position) const noexcept;
+
+    /**
+     * @brief Get consecutive keys in order
+     * @param first Position of the first key
+     * @param count Maximum number of keys
+     * @return Up to count keys starting at first
+     */
+    std::vector<Key> range(size_t first, size_t count) const;
+
+    /**
+     * @brief Replace the contents with sorted keys in linear time
+     * @param keys Keys in strictly increasing order
+     * @return True if successful, false (leaving the set empty) if keys are not strictly increasing
+     */
+    bool assign(std::span<const Key> keys);
+
+    /**
+     * @brief Call a function for every key in order
+     * @param visit Called with each key
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        std::vector<uint32_t> stack;
+        for (uint32_t node = m_root; node != NIL || !stack.empty();) {
+            if (node != NIL) {
+                stack.push_back(node);
+                node = m_nodes[node].left;
+            } else {
+                node = stack.back();
+                stack.pop_back();
+                visit(m_nodes[node].key);
+                node = m_nodes[node].right;
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        Key key;
+        uint64_t priority;
+        uint32_t left;
+        uint32_t right;
+        uint32_t size;
+    };
+
+    static uint64_t priorityOf(const Key& key) noexcept;
+
+    uint32_t sizeOf(uint32_t node) const noexcept { return node == NIL ? 0 : m_nodes[node].size; }
+    void updateSize(uint32_t node) noexcept {
+        m_nodes[node].size = 1 + sizeOf(m_nodes[node].left) + sizeOf(m_nodes[node].right);
+    }
+
+    uint32_t allocate(const Key& key);
+
+    /**
+     * @brief Insert an allocated node into a subtree, returning the new subtree root
+     */
+    uint32_t insertInto(uint32_t node, uint32_t newNode) noexcept;
+
+    /**
+     * @brief Split a subtree into the keys less than key and the rest
+     */
+    std::pair<uint32_t, uint32_t> split(uint32_t node, const Key& key) noexcept;
+
+    /**
+     * @brief Join two subtrees whose keys are all less in the first
+     */
+    uint32_t merge(uint32_t left, uint32_t right) noexcept;
+
+    bool eraseFrom(uint32_t& node, const Key& key) noexcept;
+
+    uint32_t computeSizes(uint32_t node) noexcept;
+
+    std::vector<Node> m_nodes;
+
+    // Indices of unused nodes
+    std::vector<uint32_t> m_free;
+
+    uint32_t m_root = NIL;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <map>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+/**
+ * @brief Compressed archive of idle pets, one per directory
+ *
+ * File layout:
+ * - ArchiveHeader
+ * - Shared dictionary (dictionarySize bytes)
+ * - entryCount entries: EntryHeader, the state file name, then the
+ *   raw-deflate compressed state image
+ *
+ * State images are tiny and nearly identical, so each one is compressed
+ * on its own against a dictionary trained from sample images and shared
+ * by the whole archive. A single pet can then be extracted without
+ * decompressing the others.
+ */
+class PetArchive {
+public:
+    // Name of the archive file inside a directory of state files
+    static constexpr const char* FILE_NAME = ".pet_archive";
+
+    // Name of the file locked while an archive is read, modified and committed
+    static constexpr const char* LOCK_FILE_NAME = ".pet_archive.lock";
+
+    // Largest dictionary zlib can use (its window size)
+    static constexpr size_t MAX_DICTIONARY_SIZE = 32 * 1024;
+
+    // Most archived pets used as dictionary samples
+    static constexpr size_t MAX_DICTIONARY_SAMPLES = 16;
+
+    // Keep the dictionary small relative to the archive: one sample per this many pets
+    static constexpr size_t PETS_PER_DICTIONARY_SAMPLE = 8;
+
+    /**
+     * @brief Header at the start of the archive file
+     */
+    struct ArchiveHeader {
+        uint32_t dictionarySize;        // Bytes of shared dictionary following the header
+        uint32_t dictionaryChecksum;    // CRC32C of the dictionary
+        uint32_t entryCount;            // Number of entries following the dictionary
+        uint32_t reserved32;            // Written as zero
+    };
+
+    /**
+     * @brief Header of every archived pet
+     */
+    struct EntryHeader {
+        uint16_t nameLength;            // Length of the state file name that follows
+        uint16_t reserved16;            // Written as zero
+        uint32_t rawSize;               // Size of the decompressed state image
+        uint32_t compressedSize;        // Size of the compressed data that follows the name
+        uint32_t checksum;              // CRC32C of the decompressed state image
+    };
+
+    /**
+     * @brief Exclusive lock on the archive of a directory, held until destroyed
+     *
+     * Every change rewrites the whole archive from the copy that was
+     * opened, so whoever opens an archive to change it holds this lock
+     * from open() until commit(). Commits replace the archive file, so
+     * the lock is taken on a separate file that is never removed.
+     */
+    class Lock {
+    public:
+        /**
+         * @brief Constructor, blocks until the lock is taken
+         * @param archivePath Path of the archive file
+         */
+        explicit Lock(const std::filesystem::path& archivePath) noexcept;
+
+        /**
+         * @brief Destructor, releases the lock
+         */
+        ~Lock();
+
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+
+        /**
+         * @brief Check whether the lock was taken
+         * @return False if the lock file could not be opened or locked
+         */
+        bool isLocked() const noexcept { return m_locked; }
+
+    private:
+#ifdef _WIN32
+        void* m_handle = nullptr;
+#else
+        int m_fd = -1;
+#endif
+        bool m_locked = false;
+    };
+
+    /**
+     * @brief Constructor
+     */
+    PetArchive() noexcept = default;
+
+    PetArchive(const PetArchive&) = delete;
+    PetArchive& operator=(const PetArchive&) = delete;
+
+    /**
+     * @brief Get the archive that holds a state file once it is archived
+     * @param statePath Path of the state file
+     * @return Path of the archive in the same directory
+     */
+    static std::filesystem::path archivePathFor(const std::filesystem::path& statePath);
+
+    /**
+     * @brief Open an archive file; a missing file opens an empty archive
+     * @param path Path to the archive file
+     * @return True if the archive is missing or valid, false if it is unreadable
+     */
+    bool open(const std::filesystem::path& path) noexcept;
+
+    /**
+     * @brief Check if a pet is archived
+     * @param name State file name
+     * @return True if an entry exists
+     */
+    bool contains(const std::string& name) const noexcept { return m_entries.count(name) != 0; }
+
+    /**
+     * @brief Get the number of archived pets
+     * @return Number of entries
+     */
+    size_t size() const noexcept { return m_entries.size(); }
+
+    /**
+     * @brief Get the size of the shared dictionary
+     * @return Dictionary size in bytes
+     */
+    size_t getDictionarySize() const noexcept { return m_dictionary.size(); }
+
+    /**
+     * @brief Train the shared dictionary from the archived pets
+     *
+     * Picks representative images from the archive as the new dictionary
+     * and recompresses every entry against it.
+     *
+     * @return True if successful; the archive is unchanged otherwise
+     */
+    bool trainDictionary() noexcept;
+
+    /**
+     * @brief Extract an archived state image
+     * @param name State file name
+     * @param image Output buffer, resized to the image size
+     * @return True if the entry exists and decompressed intact
+     */
+    bool get(const std::string& name, std::vector<std::byte>& image) const noexcept;
+
+    /**
+     * @brief Insert or replace an archived state image
+     * @param name State file name
+     * @param image The state image
+     * @return True if compressed successfully
+     */
+    bool put(const std::string& name, std::span<const std::byte> image) noexcept;
+
+    /**
+     * @brief Remove an archived pet
+     * @param name State file name
+     * @return True if the entry existed
+     */
+    bool erase(const std::string& name) noexcept;
+
+    /**
+     * @brief Atomically write the archive back to its file
+     *
+     * An archive without entries removes the file instead.
+     *
+     * @return True if successful
+     */
+    bool commit() const noexcept;
+
+private:
+    /**
+     * @brief An archived pet, kept compressed in memory
+     */
+    struct Entry {
+        uint32_t rawSize;
+        uint32_t checksum;
+        std::vector<std::byte> compressed;
+    };
+
+    // Archive file path
+    std::filesystem::path m_path;
+
+    // Shared compression dictionary
+    std::vector<std::byte> m_dictionary;
+
+    // State file name to entry, ordered so commits are deterministic
+    std::map<std::string, Entry> m_entries;
+};
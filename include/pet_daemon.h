@@ -0,0 +1,454 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include "command_parser.h"
+#include "daemon_protocol.h"
+#include "epoch_reclaimer.h"
+#include "pet_snapshot.h"
+#include "shard_runtime.h"
+
+class PetState;
+class GameLogic;
+class SharedChannel;
+
+/**
+ * @brief Resident server that keeps pets loaded and runs their commands
+ *
+ * `pet daemon` listens on a Unix domain socket (DaemonProtocol::getSocketPath()).
+ * The first command for a pet loads it and builds its GameLogic; later
+ * commands reuse both, so a command costs a socket round trip instead of a
+ * process start, a load and a save. Commands still commit through the usual
+ * transaction, so the state file and journal on disk stay current.
+ *
+ * One thread serves every connection with poll(). Connections are
+ * non-blocking and persistent: the daemon runs every complete request it
+ * has buffered and sends the responses together, so a client that
+ * pipelines requests pays for one round trip per batch. It stops reading
+ * from a client whose unsent responses exceed
+ * GameConfig::Daemon::MAX_PENDING_OUTPUT.
+ *
+ * A client that attaches a SharedChannel gets a thread of its own that
+ * takes requests from the channel's ring and writes results into the
+ * other ring in place: command output is rendered straight into shared
+ * memory.
+ *
+ * Pets are partitioned by pet ID across the shards of a ShardRuntime.
+ * Each shard owns its pets, its parser and its output buffers, and runs
+ * their commands one after another, so commands on pets of different
+ * shards run in parallel without locks. The poll() thread and the shared
+ * memory threads only decode requests, post them to the pet's shard and
+ * deliver the responses in request order. A shard's pets and parser write
+ * to the shard's own output streams, so shards share no stream state;
+ * only diagnostics of the persistence layer go to the daemon's std::cerr.
+ *
+ * After every command a shard publishes an immutable PetSnapshot of the
+ * pet. Binary status, evolve and achievements requests that want no text
+ * and would not change the pet are answered from the snapshot by the
+ * thread that decoded them, without waiting for the shard; old snapshots
+ * are freed through an EpochReclaimer once no reader can hold them.
+ *
+ * Before each command the daemon compares the size and modification time
+ * of the state file and its journal with the values after its own last
+ * commit, and reloads the pet if another process changed them.
+ */
+class PetDaemon {
+public:
+    /**
+     * @brief Constructor
+     * @param socketPath Path of the socket to listen on
+     * @param shardCount Number of shards running commands; 0 uses the hardware concurrency
+     * @param pinThreads Pin each shard thread to its own CPU
+     */
+    explicit PetDaemon(std::filesystem::path socketPath, size_t shardCount = 0, bool pinThreads = false) noexcept;
+
+    /**
+     * @brief Destructor, closes the socket and unloads every pet
+     */
+    ~PetDaemon();
+
+    PetDaemon(const PetDaemon&) = delete;
+    PetDaemon& operator=(const PetDaemon&) = delete;
+
+    /**
+     * @brief Start listening, serve commands until SIGINT or SIGTERM, then stop
+     * @return Process exit code
+     */
+    int run() noexcept;
+
+    /**
+     * @brief Create, bind and listen on the socket
+     * @return True if clients can connect
+     */
+    bool start() noexcept;
+
+    /**
+     * @brief Serve commands until stop() is called
+     *
+     * Requires a successful start(). Closes every connection and removes
+     * the socket before returning.
+     */
+    void serve() noexcept;
+
+    /**
+     * @brief Ask serve() to return
+     *
+     * Safe to call from another thread or a signal handler.
+     */
+    void stop() noexcept;
+
+    /**
+     * @brief Get the number of commands run so far, by the shards or from snapshots
+     */
+    uint64_t getCommandCount() const noexcept;
+
+    /**
+     * @brief Get the number of commands answered from snapshots without waiting for a shard
+     */
+    uint64_t getSnapshotReadCount() const noexcept;
+
+private:
+    /**
+     * @brief Sizes and modification times of a pet's files
+     */
+    struct FileStamp {
+        std::filesystem::file_time_type stateTime;
+        std::filesystem::file_time_type journalTime;
+        uintmax_t stateSize = 0;
+        uintmax_t journalSize = 0;
+
+        bool operator==(const FileStamp&) const = default;
+    };
+
+    /**
+     * @brief A loaded pet
+     */
+    struct ResidentPet {
+        // Declared first so the game logic that refers to it is destroyed first
+        std::unique_ptr<PetState> petState;
+        std::shared_ptr<GameLogic> gameLogic;
+        FileStamp stamp;
+        uint64_t lastUsed = 0;
+    };
+
+    /**
+     * @brief What readers see of a pet between the shard's commands
+     */
+    struct ResidentSnapshot {
+        PetSnapshot pet;
+        // Stamp of the pet's files the snapshot matches
+        FileStamp stamp;
+        std::string statePath;
+    };
+
+    /**
+     * @brief Published snapshots of a block of consecutive pet IDs
+     */
+    struct SnapshotChunk {
+        static constexpr size_t SIZE = 1024;
+        std::atomic<const ResidentSnapshot*> snapshots[SIZE] = {};
+    };
+
+    /**
+     * @brief A thread that answers requests from snapshots
+     */
+    struct SnapshotReader {
+        EpochReclaimer::Reader slot;
+        // Requests answered from snapshots
+        std::atomic<uint64_t> reads{ 0 };
+    };
+
+    /**
+     * @brief The pets of one shard and what running their commands needs
+     *
+     * Only touched by tasks on its shard.
+     */
+    struct Shard {
+        explicit Shard(EpochReclaimer& reclaimer) noexcept
+            : retired(reclaimer) {}
+
+        // Output of the command being run, reused between commands
+        std::stringbuf outText;
+        std::stringbuf errText;
+        // The shard's own streams: its pets and parser write to them, so shards share no stream state
+        std::ostream out{ &outText };
+        std::ostream err{ &errText };
+        CommandParser parser{ out, err };
+        // State files of the pet IDs routed to this shard
+        std::unordered_map<uint32_t, std::string> petPaths;
+        std::unordered_map<uint32_t, ResidentPet> pets;
+        // Commands run, also the clock for least-recently-used eviction
+        std::atomic<uint64_t> commandCount{ 0 };
+        // Snapshots this shard replaced that readers may still hold
+        EpochReclaimer::RetireList retired;
+    };
+
+    /**
+     * @brief A response that a shard is still producing
+     */
+    struct PendingResponse {
+        std::vector<std::byte> bytes;
+        // The pet whose shard produces it
+        std::optional<uint32_t> petId;
+        // The request failed and the connection must be closed
+        bool failed = false;
+        std::atomic<bool> done{ false };
+    };
+
+    /**
+     * @brief A client's shared memory channel and the thread serving it
+     */
+    struct SharedSession {
+        std::unique_ptr<SharedChannel> channel;
+        std::thread worker;
+
+        /**
+         * @brief Destructor, closes the channel and waits for the thread
+         */
+        ~SharedSession();
+    };
+
+    /**
+     * @brief A client connection
+     */
+    struct Connection {
+        int fd = -1;
+        // Descriptors passed by the client and not yet used
+        std::vector<int> receivedFds;
+        // Set once the client attached shared memory
+        std::unique_ptr<SharedSession> shared;
+        // Received bytes not yet run
+        std::vector<std::byte> input;
+        // Responses not yet produced, in request order
+        std::deque<std::shared_ptr<PendingResponse>> pending;
+        // Number of pending responses per pet; a pet with some is not read from its snapshot
+        std::unordered_map<uint32_t, uint32_t> pendingByPet;
+        // Responses; bytes before outputPos are sent
+        std::vector<std::byte> output;
+        size_t outputPos = 0;
+        // The client shut down its side
+        bool peerClosed = false;
+
+        size_t getPendingOutput() const noexcept {
+            return output.size() - outputPos;
+        }
+    };
+
+    /**
+     * @brief Read the stamp of a pet's files
+     */
+    static FileStamp readStamp(const std::filesystem::path& statePath) noexcept;
+
+    /**
+     * @brief Accept every pending connection
+     */
+    void acceptConnections() noexcept;
+
+    /**
+     * @brief Close a connection, its unused descriptors and its shared memory channel
+     */
+    static void closeConnection(Connection& connection) noexcept;
+
+    /**
+     * @brief Read what a client sent, run complete requests and send responses
+     * @param connection The connection
+     * @param readable True if poll() reported input or a hang-up
+     * @return False if the connection should be closed
+     */
+    bool serviceConnection(Connection& connection, bool readable) noexcept;
+
+    /**
+     * @brief Run buffered requests until none is complete or the output limit is reached
+     * @param connection The connection
+     * @return False if the client sent a malformed message
+     */
+    bool runRequests(Connection& connection);
+
+    /**
+     * @brief Move the leading finished responses to the output
+     * @return False if one of them failed
+     */
+    static bool collectResponses(Connection& connection);
+
+    /**
+     * @brief Mark a response finished and wake the poll() thread to send it; runs on a shard
+     */
+    void completeResponse(PendingResponse& response) noexcept;
+
+    /**
+     * @brief Send as much pending output as the socket accepts
+     * @param connection The connection
+     * @return False if the connection failed
+     */
+    static bool sendOutput(Connection& connection) noexcept;
+
+    /**
+     * @brief Post a request to the shard of its pet, queueing its response on the connection
+     * @return False if the payload is malformed
+     */
+    bool dispatchRequest(Connection& connection, DaemonProtocol::MessageType type, std::span<const std::byte> payload);
+
+    /**
+     * @brief Run a task on the shard of a pet that produces a response, then complete the response
+     */
+    void postResponse(uint32_t petId, std::shared_ptr<PendingResponse> response,
+                      std::function<void(Shard&, std::vector<std::byte>&)> task);
+
+    /**
+     * @brief Get the pet ID of a state file, assigning the next one if it has none
+     * @param statePath Canonical path of the state file
+     */
+    uint32_t getPetId(const std::string& statePath);
+
+    /**
+     * @brief Get the shard that owns a pet
+     */
+    Shard& getShard(uint32_t petId) noexcept {
+        return *m_shards[m_runtime->getShardFor(petId)];
+    }
+
+    /**
+     * @brief Publish a new snapshot of a pet, or none, and retire the old one; runs on the pet's shard
+     * @param shard The pet's shard
+     * @param petId The pet's ID
+     * @param pet The pet, or nullptr once it is unloaded
+     * @param statePath Its state file
+     */
+    void publishSnapshot(Shard& shard, uint32_t petId, const ResidentPet* pet, const std::string& statePath);
+
+    /**
+     * @brief Answer a read-only binary command from the pet's snapshot
+     * @param reader The calling thread's reader
+     * @param request The request
+     * @param result Receives the result
+     * @return False if the command must run on the shard: it changes the pet, wants text, or no current snapshot exists
+     */
+    bool readSnapshot(SnapshotReader& reader, const DaemonProtocol::CommandRequest& request,
+                      DaemonProtocol::CommandResult& result) noexcept;
+
+    /**
+     * @brief Register the calling thread to read snapshots
+     */
+    std::unique_ptr<SnapshotReader> addReader();
+
+    /**
+     * @brief Unregister a reader, keeping its read count
+     */
+    void removeReader(SnapshotReader& reader) noexcept;
+
+    /**
+     * @brief Run a task on the shard of a pet and wait for it
+     */
+    void callOnShard(uint32_t petId, const std::function<void(Shard&)>& task);
+
+    /**
+     * @brief Run a text Request and append its output, exit code or RunLocally; runs on the pet's shard
+     */
+    void handleRequest(Shard& shard, uint32_t petId, const std::string& statePath,
+                       const std::vector<std::string>& args, std::vector<std::byte>& output);
+
+    /**
+     * @brief Load a pet and append the PetOpened response; runs on the pet's shard
+     */
+    void handleOpenPet(Shard& shard, DaemonProtocol::OpenPetResult result, const std::string& statePath,
+                       std::vector<std::byte>& output);
+
+    /**
+     * @brief Run a binary Command and append its CommandResult; runs on the pet's shard
+     */
+    void handleCommand(Shard& shard, const DaemonProtocol::CommandRequest& request, std::vector<std::byte>& output);
+
+    /**
+     * @brief Attach the shared memory a client passed and start serving it
+     * @return False if the client passed no descriptor or is attached already
+     */
+    bool attachSharedMemory(Connection& connection);
+
+    /**
+     * @brief Serve a shared memory channel until either side closes it; runs on the session thread
+     */
+    void serveSharedChannel(SharedChannel& channel) noexcept;
+
+    /**
+     * @brief Run a binary command; runs on the pet's shard
+     * @param shard The pet's shard
+     * @param request The request
+     * @param text Receives the command's standard output if the request has COMMAND_WANT_TEXT
+     * @return The result
+     */
+    DaemonProtocol::CommandResult executeCommand(Shard& shard, const DaemonProtocol::CommandRequest& request,
+                                                 std::streambuf* text);
+
+    /**
+     * @brief Run a command line on a pet, writing to the shard's streams
+     * @param shard The pet's shard
+     * @param pet The pet
+     * @param petId Its ID, to publish its snapshot
+     * @param statePath Its state file
+     * @param args Command line arguments
+     * @param out Receives the command's output
+     * @return The exit code; errors are in the shard's errText
+     */
+    int32_t runCaptured(Shard& shard, ResidentPet& pet, uint32_t petId, const std::string& statePath,
+                        const std::vector<std::string_view>& args, std::streambuf* out);
+
+    /**
+     * @brief Get a loaded pet of a shard, loading it if needed
+     * @param shard The shard
+     * @param petId The pet's ID
+     * @param statePath Its state file
+     * @return The pet, or nullptr if it could not be loaded
+     */
+    ResidentPet* getResidentPet(Shard& shard, uint32_t petId, const std::string& statePath);
+
+    // Socket to listen on
+    std::filesystem::path m_socketPath;
+
+    // Listening socket, and the pipe that wakes poll() for stop()
+    int m_listenFd = -1;
+    int m_wakeFds[2] = { -1, -1 };
+    std::atomic<bool> m_stopRequested{ false };
+
+    // Set by shards when a response finished, so a burst of them writes to the wake pipe once
+    std::atomic<bool> m_responsesReady{ false };
+
+    // Open client connections
+    std::vector<Connection> m_connections;
+
+    // Frees replaced snapshots once no reader holds them; outlives the shards' retire lists
+    EpochReclaimer m_reclaimer;
+
+    // Published snapshot of each pet ID, in chunks allocated with the IDs
+    std::unique_ptr<std::atomic<SnapshotChunk*>[]> m_snapshotChunks;
+
+    // Readers of the snapshots, and the reads of readers that left
+    mutable std::mutex m_readerMutex;
+    std::vector<SnapshotReader*> m_readers;
+    uint64_t m_finishedReads = 0;
+
+    // Reader of the poll() thread while serve() runs
+    std::unique_ptr<SnapshotReader> m_pollReader;
+
+    // Shards and the runtime whose threads run them; created by start()
+    size_t m_shardCount;
+    bool m_pinThreads;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::unique_ptr<ShardRuntime> m_runtime;
+
+    // Pet IDs by state file; IDs stay valid while the daemon runs. Used by the poll() and shared memory threads
+    std::mutex m_petIdMutex;
+    std::unordered_map<std::string, uint32_t> m_petIds;
+};
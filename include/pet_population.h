@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <type_traits>
+#include "aligned_allocator.h"
+#include "game_config.h"
+#include "pet_state.h"
+#include "population_aggregates.h"
+#include "time_decay.h"
+
+class PetStore;
+
+/**
+ * @brief Columnar (structure-of-arrays) container for many pets
+ *
+ * Each field lives in its own contiguous, cache-line aligned array, so
+ * bulk operations such as decay or statistics stream through only the
+ * columns they need. Individual pets are accessed through lightweight
+ * views whose getters mirror those of PetState.
+ *
+ * The population holds the hot per-pet data only: achievement progress
+ * and preserved file sections stay with PetState and the state files.
+ * Unlocked achievements are kept as one bit mask per pet, so bulk ticks
+ * can unlock the ones that follow from stats and evolution.
+ *
+ * Per-level aggregates are maintained as pets are added and changed.
+ * Views and the bulk operations report their changes; code writing the
+ * columns directly has to report its own through getAggregates().
+ */
+class PetPopulation {
+public:
+    // Alignment of every column, one cache line
+    static constexpr size_t COLUMN_ALIGNMENT = 64;
+
+    // Contiguous aligned storage for one field of every pet
+    template <typename T>
+    using Column = std::vector<T, AlignedAllocator<T, COLUMN_ALIGNMENT>>;
+
+    /**
+     * @brief Proxy for one pet in the population
+     *
+     * Getters match PetState, including evaluating stat decay on read.
+     * Mutators are only available on views of a non-const population and
+     * follow PetState's capping rules, without achievement progress. They
+     * update the population's aggregates as they go.
+     *
+     * @tparam Population PetPopulation or const PetPopulation
+     */
+    template <typename Population>
+    class BasicPetView {
+    public:
+        BasicPetView(Population& population, size_t index) noexcept
+            : m_population(&population), m_index(index) {}
+
+        /**
+         * @brief Get the index of the pet in the population
+         */
+        size_t getIndex() const noexcept { return m_index; }
+
+        // Getters mirroring PetState
+        std::string_view getName() const noexcept { return m_population->m_names[m_index]; }
+
+        EvolutionLevel getEvolutionLevel() const noexcept {
+            return static_cast<EvolutionLevel>(m_population->m_evolutionLevels[m_index]);
+        }
+
+        uint32_t getXP() const noexcept { return m_population->m_xp[m_index]; }
+
+        uint32_t getXPForNextLevel() const noexcept {
+            return GameConfig::getEvolutionXPRequirement(m_population->m_evolutionLevels[m_index]);
+        }
+
+        float getMaxStatValue() const noexcept {
+            return GameConfig::getMaxStatForEvolutionLevel(m_population->m_evolutionLevels[m_index]);
+        }
+
+        TimeDecay::Stats getAnchorStats() const noexcept {
+            return {m_population->m_hunger[m_index], m_population->m_happiness[m_index], m_population->m_energy[m_index]};
+        }
+
+        TimeDecay::Stats getStatsAt(std::chrono::system_clock::time_point now) const noexcept {
+            if (m_population->m_lastInteractionSeconds[m_index] == 0) {
+                return getAnchorStats();
+            }
+            double hoursPassed = std::chrono::duration<double, std::ratio<3600, 1>>(now - getLastInteractionTime()).count();
+            if (hoursPassed < GameConfig::Time::MIN_TIME_THRESHOLD) {
+                return getAnchorStats();
+            }
+            return TimeDecay::applyHours(getAnchorStats(), getMaxStatValue(), hoursPassed);
+        }
+
+        float getHunger() const noexcept { return getStatsAt(std::chrono::system_clock::now()).hunger; }
+        float getHappiness() const noexcept { return getStatsAt(std::chrono::system_clock::now()).happiness; }
+        float getEnergy() const noexcept { return getStatsAt(std::chrono::system_clock::now()).energy; }
+
+        std::chrono::system_clock::time_point getLastInteractionTime() const noexcept {
+            return std::chrono::system_clock::time_point(std::chrono::seconds(m_population->m_lastInteractionSeconds[m_index]));
+        }
+
+        std::chrono::system_clock::time_point getBirthDate() const noexcept {
+            return std::chrono::system_clock::time_point(std::chrono::seconds(m_population->m_birthDateSeconds[m_index]));
+        }
+
+        uint64_t getUnlockedAchievementBits() const noexcept { return m_population->m_achievementBits[m_index]; }
+
+        bool isAchievementUnlocked(AchievementType type) const noexcept {
+            return (getUnlockedAchievementBits() >> static_cast<size_t>(type)) & 1;
+        }
+
+        // Mutators mirroring PetState
+        void setName(std::string_view name) noexcept requires (!std::is_const_v<Population>) {
+            m_population->m_names[m_index] = name;
+        }
+
+        /**
+         * @brief Add experience points, evolving through every level they cover like PetState::addXP()
+         *
+         * XP saturates at UINT32_MAX, and each evolution unlocks Evolution,
+         * plus Master or Eternal on reaching those levels.
+         *
+         * @param amount The amount of XP to add
+         * @return True if this caused an evolution, false otherwise
+         */
+        bool addXP(uint32_t amount) noexcept requires (!std::is_const_v<Population>) {
+            auto before = getSample();
+            auto& xp = m_population->m_xp[m_index];
+            auto& level = m_population->m_evolutionLevels[m_index];
+            xp = static_cast<uint32_t>(std::min<uint64_t>(uint64_t{xp} + amount, UINT32_MAX));
+
+            bool evolved = false;
+            while (level < static_cast<uint8_t>(EvolutionLevel::Ancient) && xp >= GameConfig::getEvolutionXPRequirement(level)) {
+                ++level;
+                evolved = true;
+                unlockAchievement(AchievementType::Evolution);
+                if (level == static_cast<uint8_t>(EvolutionLevel::Master)) {
+                    unlockAchievement(AchievementType::Master);
+                } else if (level == static_cast<uint8_t>(EvolutionLevel::Ancient)) {
+                    unlockAchievement(AchievementType::Eternal);
+                }
+            }
+            m_population->m_aggregates.update(before, getSample());
+            return evolved;
+        }
+
+        void increaseHunger(float amount) noexcept requires (!std::is_const_v<Population>) {
+            increase(m_population->m_hunger[m_index], amount);
+        }
+
+        void decreaseHunger(float amount) noexcept requires (!std::is_const_v<Population>) {
+            decrease(m_population->m_hunger[m_index], amount);
+        }
+
+        void increaseHappiness(float amount) noexcept requires (!std::is_const_v<Population>) {
+            increase(m_population->m_happiness[m_index], amount);
+        }
+
+        void decreaseHappiness(float amount) noexcept requires (!std::is_const_v<Population>) {
+            decrease(m_population->m_happiness[m_index], amount);
+        }
+
+        void increaseEnergy(float amount) noexcept requires (!std::is_const_v<Population>) {
+            increase(m_population->m_energy[m_index], amount);
+        }
+
+        void decreaseEnergy(float amount) noexcept requires (!std::is_const_v<Population>) {
+            decrease(m_population->m_energy[m_index], amount);
+        }
+
+        /**
+         * @brief Unlock an achievement
+         * @param type The achievement type to unlock
+         * @return True if the achievement was newly unlocked
+         */
+        bool unlockAchievement(AchievementType type) noexcept requires (!std::is_const_v<Population>) {
+            uint64_t bit = uint64_t{1} << static_cast<size_t>(type);
+            auto& bits = m_population->m_achievementBits[m_index];
+            if (bits & bit) {
+                return false;
+            }
+            bits |= bit;
+            return true;
+        }
+
+        void updateInteractionTime() noexcept requires (!std::is_const_v<Population>) {
+            m_population->m_lastInteractionSeconds[m_index] = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+         * @brief Get the values the population's aggregates hold for this pet
+         */
+        PopulationAggregates::PetSample getSample() const noexcept {
+            return m_population->sample(m_index);
+        }
+
+    private:
+        void increase(float& stat, float amount) const noexcept {
+            auto before = getSample();
+            stat += amount;
+            if (stat > getMaxStatValue()) {
+                stat = getMaxStatValue();
+            }
+            m_population->m_aggregates.update(before, getSample());
+        }
+
+        void decrease(float& stat, float amount) const noexcept {
+            auto before = getSample();
+            stat = (stat > amount) ? (stat - amount) : 0.0f;
+            m_population->m_aggregates.update(before, getSample());
+        }
+
+        Population* m_population;
+        size_t m_index;
+    };
+
+    using PetView = BasicPetView<PetPopulation>;
+    using ConstPetView = BasicPetView<const PetPopulation>;
+
+    /**
+     * @brief Constructor
+     */
+    PetPopulation() noexcept = default;
+
+    /**
+     * @brief Get the number of pets
+     * @return Number of pets
+     */
+    size_t size() const noexcept { return m_xp.size(); }
+
+    /**
+     * @brief Check if the population is empty
+     * @return True if there are no pets
+     */
+    bool empty() const noexcept { return m_xp.empty(); }
+
+    /**
+     * @brief Reserve space in every column
+     * @param count Number of pets to reserve space for
+     */
+    void reserve(size_t count);
+
+    /**
+     * @brief Remove all pets
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Add a new pet with initial stats, like PetState::initialize()
+     * @param name The pet's name
+     * @param now Birth and last interaction time
+     * @return Index of the new pet
+     */
+    size_t add(std::string_view name, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Add a copy of a pet's hot data
+     * @param petState The pet to copy
+     * @return Index of the new pet
+     */
+    size_t add(const PetState& petState);
+
+    /**
+     * @brief Append every pet of a store
+     * @param store The open pet store
+     * @return Number of pets that failed to load
+     */
+    size_t loadFromStore(PetStore& store);
+
+    /**
+     * @brief Apply time effects to every pet, like PetState::applyElapsedTime()
+     *
+     * Runs the vectorized TimeDecay kernel over the stat columns with one
+     * shared time; stats come out bit-identical to the per-pet path.
+     *
+     * @param now Current time
+     * @return Number of pets updated
+     */
+    size_t applyTimeEffectsBatch(std::chrono::system_clock::time_point now) noexcept;
+
+    /**
+     * @brief Apply time effects to the pets [begin, end) and record the change
+     *
+     * For bulk operations that split the population between threads: each
+     * range reports into its own delta, merged into getAggregates() once
+     * all ranges are done.
+     *
+     * @param begin First pet
+     * @param end One past the last pet
+     * @param nowSeconds Current time in seconds since the epoch
+     * @param delta Receives the change to the aggregates
+     * @return Number of pets updated
+     */
+    size_t applyTimeEffectsRange(size_t begin, size_t end, int64_t nowSeconds, PopulationAggregates& delta) noexcept;
+
+    /**
+     * @brief Get the per-level aggregates of the population
+     * @return Aggregates, up to date with every reported change
+     */
+    const PopulationAggregates& getAggregates() const noexcept { return m_aggregates; }
+
+    /**
+     * @brief Get the aggregates to report changes made through the columns
+     * @return Mutable aggregates
+     */
+    PopulationAggregates& getAggregates() noexcept { return m_aggregates; }
+
+    /**
+     * @brief Get the values the aggregates hold for a pet
+     * @param index Pet index, less than size()
+     */
+    PopulationAggregates::PetSample sample(size_t index) const noexcept {
+        return {m_evolutionLevels[index], m_xp[index], m_hunger[index], m_happiness[index], m_energy[index]};
+    }
+
+    /**
+     * @brief Get a view of a pet
+     * @param index Pet index, less than size()
+     */
+    PetView operator[](size_t index) noexcept { return PetView(*this, index); }
+
+    /**
+     * @brief Get a read-only view of a pet
+     * @param index Pet index, less than size()
+     */
+    ConstPetView operator[](size_t index) const noexcept { return ConstPetView(*this, index); }
+
+    // Column access for bulk operations
+    std::span<float> getHungerColumn() noexcept { return m_hunger; }
+    std::span<const float> getHungerColumn() const noexcept { return m_hunger; }
+    std::span<float> getHappinessColumn() noexcept { return m_happiness; }
+    std::span<const float> getHappinessColumn() const noexcept { return m_happiness; }
+    std::span<float> getEnergyColumn() noexcept { return m_energy; }
+    std::span<const float> getEnergyColumn() const noexcept { return m_energy; }
+    std::span<uint32_t> getXPColumn() noexcept { return m_xp; }
+    std::span<const uint32_t> getXPColumn() const noexcept { return m_xp; }
+    std::span<uint8_t> getEvolutionLevelColumn() noexcept { return m_evolutionLevels; }
+    std::span<const uint8_t> getEvolutionLevelColumn() const noexcept { return m_evolutionLevels; }
+    std::span<int64_t> getLastInteractionColumn() noexcept { return m_lastInteractionSeconds; }
+    std::span<const int64_t> getLastInteractionColumn() const noexcept { return m_lastInteractionSeconds; }
+    std::span<const int64_t> getBirthDateColumn() const noexcept { return m_birthDateSeconds; }
+    std::span<uint64_t> getAchievementColumn() noexcept { return m_achievementBits; }
+    std::span<const uint64_t> getAchievementColumn() const noexcept { return m_achievementBits; }
+
+private:
+    /**
+     * @brief Append one pet to every column
+     */
+    size_t append(std::string_view name, uint8_t evolutionLevel, uint32_t xp, float hunger, float happiness,
+                  float energy, int64_t lastInteractionSeconds, int64_t birthDateSeconds, uint64_t achievementBits);
+
+    // Stat columns, indexed by pet
+    Column<float> m_hunger;
+    Column<float> m_happiness;
+    Column<float> m_energy;
+
+    // Progression columns
+    Column<uint32_t> m_xp;
+    Column<uint8_t> m_evolutionLevels;
+
+    // Timestamps in seconds since the epoch, as in the state file
+    Column<int64_t> m_lastInteractionSeconds;
+    Column<int64_t> m_birthDateSeconds;
+
+    // Unlocked achievements, one bit per AchievementType
+    Column<uint64_t> m_achievementBits;
+
+    // Names are cold data, kept apart from the numeric columns
+    std::vector<std::string> m_names;
+
+    // Aggregates of the columns above
+    PopulationAggregates m_aggregates;
+};
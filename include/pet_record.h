@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <algorithm>
+#include <chrono>
+#include "achievement_system.h"
+#include "game_config.h"
+#include "pet_state.h"
+
+/**
+ * @brief Packed 32-byte form of a pet for keeping very many pets in memory
+ *
+ * A PetState owns a name string, an achievement system and file and journal
+ * bookkeeping; a record holds only what defines the pet:
+ * - stats in Q8.8 fixed point (1/256 steps up to 255.99)
+ * - timestamps as 32-bit minutes since the epoch
+ * - the evolution level in 4 bits
+ * - 16-bit achievement masks and bit-packed progress of locked achievements
+ * - the name as a NameTable ID
+ *
+ * Converting a record to a PetState and back gives the same record as long
+ * as its times are at most MAX_MINUTES.
+ * Converting a PetState rounds its stats to the nearest 1/256 and its
+ * timestamps down to the minute. Time effects on records use integer
+ * arithmetic only, so they give the same result on every platform.
+ */
+struct PetRecord {
+    // Fractional bits of the fixed-point stats
+    static constexpr unsigned STAT_FRACTION_BITS = 8;
+
+    // Fixed-point value of 1.0
+    static constexpr uint32_t STAT_ONE = uint32_t{1} << STAT_FRACTION_BITS;
+
+    // Shortest absence in minutes that applies time effects, as GameConfig::Time::MIN_TIME_THRESHOLD
+    static constexpr uint32_t MIN_ELAPSED_MINUTES =
+        static_cast<uint32_t>(GameConfig::Time::MIN_TIME_THRESHOLD * 60.0 + 0.5);
+
+    // Latest minute a system_clock time can hold; the year 2262 with a nanosecond clock
+    static constexpr uint32_t MAX_MINUTES = static_cast<uint32_t>(std::min<int64_t>(
+        std::chrono::duration_cast<std::chrono::minutes>(std::chrono::system_clock::duration::max()).count(), UINT32_MAX));
+
+    uint32_t xp;
+    uint32_t lastInteractionMinutes;        // Minutes since the epoch, 0 if never
+    uint32_t birthDateMinutes;              // Minutes since the epoch
+    uint32_t nameId;                        // ID in the NameTable the record was made with
+    uint32_t achievementProgress;           // Progress of locked achievements, see getProgress()
+    uint16_t hunger;                        // Q8.8
+    uint16_t happiness;                     // Q8.8
+    uint16_t energy;                        // Q8.8
+    uint16_t unlockedAchievements;          // Bit per AchievementType
+    uint16_t newlyUnlockedAchievements;     // Bit per AchievementType
+    uint8_t evolutionLevel : 4;             // EvolutionLevel
+    uint8_t reserved : 4;                   // Written as zero
+    uint8_t usedCommandsMask;               // Bit per Explorer command
+
+    /**
+     * @brief Convert a stat to fixed point, rounding to nearest and clamping to the range
+     */
+    static constexpr uint16_t toFixed(float value) noexcept {
+        if (!(value > 0.0f)) {
+            return 0;
+        }
+        float scaled = value * static_cast<float>(STAT_ONE) + 0.5f;
+        return scaled >= 65535.0f ? uint16_t{65535} : static_cast<uint16_t>(scaled);
+    }
+
+    /**
+     * @brief Convert a fixed-point stat to float; exact
+     */
+    static constexpr float fromFixed(uint16_t value) noexcept {
+        return static_cast<float>(value) / static_cast<float>(STAT_ONE);
+    }
+
+    /**
+     * @brief Convert a time to minutes since the epoch, rounding down and clamping to MAX_MINUTES
+     */
+    static uint32_t toMinutes(std::chrono::system_clock::time_point time) noexcept;
+
+    /**
+     * @brief Convert minutes since the epoch to a time, clamping to MAX_MINUTES
+     */
+    static std::chrono::system_clock::time_point fromMinutes(uint32_t minutes) noexcept {
+        return std::chrono::system_clock::time_point(std::chrono::minutes(std::min(minutes, MAX_MINUTES)));
+    }
+
+    /**
+     * @brief Get the number of progress bits stored for an achievement
+     *
+     * Locked progress is below the required amount, so it needs the bits of
+     * one less than it. Explorer progress is the number of bits set in
+     * usedCommandsMask and takes none.
+     */
+    static constexpr unsigned getProgressBits(AchievementType type) noexcept {
+        if (type == AchievementType::Explorer || type == AchievementType::Count) {
+            return 0;
+        }
+        return static_cast<unsigned>(std::bit_width(AchievementSystem::getRequiredProgress(type) - 1));
+    }
+
+    /**
+     * @brief Get the position of an achievement's progress in achievementProgress
+     */
+    static constexpr unsigned getProgressShift(AchievementType type) noexcept {
+        unsigned shift = 0;
+        for (size_t i = 0; i < static_cast<size_t>(type); ++i) {
+            shift += getProgressBits(static_cast<AchievementType>(i));
+        }
+        return shift;
+    }
+
+    /**
+     * @brief Get the progress of an achievement
+     * @param type The achievement type
+     * @return Required progress if unlocked, otherwise the stored progress
+     */
+    uint32_t getProgress(AchievementType type) const noexcept;
+
+    /**
+     * @brief Store the progress of a locked achievement
+     * @param type The achievement type
+     * @param progress Progress, clamped to one less than the required amount
+     */
+    void setProgress(AchievementType type, uint32_t progress) noexcept;
+
+    /**
+     * @brief Apply the time passed since the last interaction
+     *
+     * Fixed-point counterpart of PetState::applyElapsedTime(): hunger and
+     * happiness fall and energy rises at the GameConfig rates, clamped to
+     * zero and the evolution level's maximum. Records that never interacted
+     * or were touched less than MIN_ELAPSED_MINUTES ago are left as they are.
+     *
+     * @param nowMinutes Current time in minutes since the epoch
+     * @return True if the record changed
+     */
+    bool applyElapsedTime(uint32_t nowMinutes) noexcept;
+};
+
+static_assert(sizeof(PetRecord) == 32, "PetRecord must stay 32 bytes");
+static_assert(static_cast<size_t>(AchievementType::Count) <= 16, "Achievement masks must fit in 16 bits");
+static_assert(PetRecord::getProgressShift(AchievementType::Count) <= 32, "Achievement progress must fit in 32 bits");
+static_assert(GameConfig::getMaxStatForEvolutionLevel(static_cast<uint8_t>(EvolutionLevel::Ancient)) < 256.0f,
+              "Stats must fit in Q8.8");
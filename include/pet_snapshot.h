@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <string_view>
+#include "pet_state.h"
+#include "time_decay.h"
+
+/**
+ * @brief Immutable copy of what read-only commands report about a pet
+ *
+ * Made by the thread that owns the PetState and never changed after, so
+ * any number of threads may read it while the owner goes on mutating the
+ * pet. Getters match PetState, including evaluating stat decay on read.
+ */
+class PetSnapshot {
+public:
+    /**
+     * @brief Constructor
+     * @param petState The pet, outside a transaction
+     */
+    explicit PetSnapshot(const PetState& petState) noexcept;
+
+    EvolutionLevel getEvolutionLevel() const noexcept { return m_evolutionLevel; }
+
+    uint32_t getXP() const noexcept { return m_xp; }
+
+    float getMaxStatValue() const noexcept {
+        return GameConfig::getMaxStatForEvolutionLevel(static_cast<uint8_t>(m_evolutionLevel));
+    }
+
+    TimeDecay::Stats getAnchorStats() const noexcept { return m_anchorStats; }
+
+    TimeDecay::Stats getStatsAt(std::chrono::system_clock::time_point now) const noexcept;
+
+    std::chrono::system_clock::time_point getLastInteractionTime() const noexcept { return m_lastInteractionTime; }
+
+    /**
+     * @brief Check whether running a command on the pet would leave it unchanged
+     *
+     * True if the command is not new for the Explorer achievement and, for
+     * status, no unlocked achievement is waiting to be announced.
+     *
+     * @param command Command name in lower case
+     */
+    bool isReadOnly(std::string_view command) const noexcept;
+
+private:
+    EvolutionLevel m_evolutionLevel;
+    uint32_t m_xp;
+    TimeDecay::Stats m_anchorStats;
+    std::chrono::system_clock::time_point m_lastInteractionTime;
+    uint32_t m_usedCommandsMask;
+    bool m_hasNewlyUnlocked;
+};
@@ -6,7 +6,18 @@
 #include <string_view>
 #include <optional>
 #include <filesystem>
+#include <span>
+#include <vector>
 #include "achievement_system.h"
+#include "atomic_file_writer.h"
+#include "binary_schema.h"
+#include "interaction_journal.h"
+#include "time_decay.h"
+
+class PetStore;
+class PetArchive;
+class NameTable;
+struct PetRecord;
 #include "game_config.h" // Include GameConfig
 
 /**
@@ -24,9 +35,27 @@ enum class EvolutionLevel : uint8_t {
 
 /**
  * @brief Class that holds all state information for the pet
+ * 
+ * Hunger, happiness and energy are stored as anchor values taken at the
+ * last interaction time. Getters evaluate the decay since then on read,
+ * so looking at the pet never modifies it; the decay is only written into
+ * the anchors by applyElapsedTime() when an interaction changes them.
  */
 class PetState {
 public:
+    /**
+     * @brief Bit flags for fields modified since the state was last persisted
+     */
+    enum DirtyField : uint8_t {
+        DirtyName = 1 << 0,
+        DirtyEvolution = 1 << 1,
+        DirtyXP = 1 << 2,
+        DirtyStats = 1 << 3,
+        DirtyTimes = 1 << 4,
+        DirtyAchievements = 1 << 5,
+        DirtyAll = 0x3F
+    };
+    
     /**
      * @brief Default constructor
      */
@@ -49,12 +78,127 @@ public:
      */
     bool load() noexcept;
     
+    /**
+     * @brief Get the default state file path that load() and save() use
+     * @return Path to the save file
+     */
+    static std::filesystem::path getStateFilePath() noexcept;
+    
+    /**
+     * @brief Load the pet state from a specific state file
+     * 
+     * Later saves and journal commits go to this file. A pet that was
+     * moved to the directory's PetArchive is restored to the file first.
+     * 
+     * @param statePath Path to the state file
+     * @return True if loaded successfully, false otherwise
+     */
+    bool loadFromFile(const std::filesystem::path& statePath) noexcept;
+    
+    /**
+     * @brief Read the format version of a state file without loading it
+     * 
+     * Version 5+ files must have a valid header or section table, and
+     * legacy files must parse exactly to their end, so other files that
+     * happen to start with a version byte are not taken for pets.
+     * 
+     * @param statePath Path to the state file
+     * @param version Output version
+     * @return True if the file is a state file of a known version
+     */
+    static bool peekFileVersion(const std::filesystem::path& statePath, uint8_t& version) noexcept;
+    
     /**
      * @brief Save the pet state to file
+     * 
+     * Saves to the file the pet was loaded from, or the default state file.
+     * 
      * @return True if saved successfully, false otherwise
      */
     bool save() const noexcept;
     
+    /**
+     * @brief Save the pet state to a specific state file
+     * @param statePath Path to the state file
+     * @return True if saved successfully, false otherwise
+     */
+    bool saveToFile(const std::filesystem::path& statePath) const noexcept;
+    
+    /**
+     * @brief Save the pet state to a specific state file through another writer
+     * 
+     * Bulk tools share one writer across many pets, so a batched
+     * durability policy syncs them together.
+     * 
+     * @param statePath Path to the state file
+     * @param writer Writer to use instead of this pet's own
+     * @return True if saved successfully, false otherwise
+     */
+    bool saveToFile(const std::filesystem::path& statePath, AtomicFileWriter& writer) const noexcept;
+    
+    /**
+     * @brief Load the pet state from a slot in a multi-pet store
+     * @param store The open pet store
+     * @param petId The pet ID to load
+     * @return True if loaded successfully, false otherwise
+     */
+    bool loadFromStore(PetStore& store, uint64_t petId) noexcept;
+    
+    /**
+     * @brief Save the pet state to a slot in a multi-pet store
+     * @param store The open pet store
+     * @param petId The pet ID to save under
+     * @return True if saved successfully, false otherwise
+     */
+    bool saveToStore(PetStore& store, uint64_t petId) const noexcept;
+    
+    /**
+     * @brief Load the pet state from an entry of a cold-pet archive
+     * @param archive The open archive
+     * @param name State file name the pet was archived under
+     * @return True if loaded successfully, false otherwise
+     */
+    bool loadFromArchive(const PetArchive& archive, const std::string& name) noexcept;
+    
+    /**
+     * @brief Save the pet state to an entry of a cold-pet archive
+     * @param archive The open archive; call commit() to write it
+     * @param name State file name to archive the pet under
+     * @return True if saved successfully, false otherwise
+     */
+    bool saveToArchive(PetArchive& archive, const std::string& name) const noexcept;
+    
+    /**
+     * @brief Load the pet state from a compact record
+     * @param record The record
+     * @param names The name table the record was made with
+     * @return True if loaded successfully, false if the record is invalid
+     */
+    bool loadFromRecord(const PetRecord& record, const NameTable& names) noexcept;
+    
+    /**
+     * @brief Convert the pet state to a compact record
+     * 
+     * Stats are rounded to the nearest 1/256 and timestamps down to the minute;
+     * everything else is kept exactly.
+     * 
+     * @param names Name table to intern the pet's name in
+     * @return The record
+     */
+    PetRecord toRecord(NameTable& names) const;
+    
+    /**
+     * @brief Set how aggressively saves are forced to disk
+     * 
+     * Saves are always atomic (temporary file + rename); the policy only
+     * controls fsync frequency. High-frequency callers can use a batched policy.
+     * 
+     * @param policy The durability policy to use
+     */
+    void setDurabilityPolicy(const DurabilityPolicy& policy) noexcept {
+        m_fileWriter.setPolicy(policy);
+    }
+    
     /**
      * @brief Check if a save file exists
      * @return True if a save file exists, false otherwise
@@ -75,6 +219,7 @@ public:
      */
     void setName(std::string_view name) noexcept {
         m_name = name;
+        markDirty(DirtyName);
     }
     
     /**
@@ -95,6 +240,10 @@ public:
     
     /**
      * @brief Add experience points to the pet
+     * 
+     * Evolves through every level the new XP covers, unlocking the
+     * achievements of each level passed.
+     * 
      * @param amount The amount of XP to add
      * @return True if this caused an evolution, false otherwise
      */
@@ -112,12 +261,31 @@ public:
      */
     float getMaxStatValue() const noexcept;
     
+    /**
+     * @brief Get the pet's stats at a given time
+     * 
+     * Applies the decay since the last interaction to the stored anchor
+     * values exactly as applyElapsedTime() would, without modifying the state.
+     * 
+     * @param now Time to evaluate the stats at
+     * @return Hunger, happiness and energy at that time
+     */
+    TimeDecay::Stats getStatsAt(std::chrono::system_clock::time_point now) const noexcept;
+    
+    /**
+     * @brief Get the stats stored at the last interaction time, before decay
+     * @return The anchor values of hunger, happiness and energy
+     */
+    TimeDecay::Stats getAnchorStats() const noexcept {
+        return {m_hunger, m_happiness, m_energy};
+    }
+    
     /**
      * @brief Get the pet's current hunger value
      * @return The current hunger value (raw)
      */
     float getHunger() const noexcept {
-        return m_hunger;
+        return getStatsAt(std::chrono::system_clock::now()).hunger;
     }
     
     /**
@@ -131,7 +299,7 @@ public:
      * @return The current happiness value (raw)
      */
     float getHappiness() const noexcept {
-        return m_happiness;
+        return getStatsAt(std::chrono::system_clock::now()).happiness;
     }
     
     /**
@@ -145,7 +313,7 @@ public:
      * @return The current energy value (raw)
      */
     float getEnergy() const noexcept {
-        return m_energy;
+        return getStatsAt(std::chrono::system_clock::now()).energy;
     }
     
     /**
@@ -156,6 +324,10 @@ public:
     
     /**
      * @brief Increase the pet's hunger
+     * 
+     * Like the other stat setters, changes the stored anchor value; call
+     * applyElapsedTime() first to include the decay since the last interaction.
+     * 
      * @param amount Amount to increase (may be capped at maximum)
      */
     void increaseHunger(float amount) noexcept;
@@ -190,6 +362,129 @@ public:
      */
     void decreaseEnergy(float amount) noexcept;
     
+    /**
+     * @brief Feed the pet: raise hunger, add XP and update the interaction time
+     * 
+     * Applies the elapsed time first, so the feeding acts on the current stats.
+     * Feeding several times at once gives the same result as feeding one
+     * time after another, computed in closed form: cost does not depend on
+     * the count. Recorded as one entry in the interaction journal; see
+     * commitInteractions().
+     * 
+     * @param now Time of the interaction
+     * @param times Number of feedings
+     * @return True if this caused an evolution, false otherwise
+     */
+    bool applyFeeding(std::chrono::system_clock::time_point now, uint32_t times = 1) noexcept;
+    
+    /**
+     * @brief Play with the pet: raise happiness, spend energy, add XP and update the interaction time
+     * 
+     * Applies the elapsed time first, so playing acts on the current stats.
+     * Playing several times at once gives the same result as playing one
+     * time after another, computed in closed form. Recorded as one entry in
+     * the interaction journal; see commitInteractions().
+     * 
+     * @param now Time of the interaction
+     * @param times Number of plays
+     * @return True if this caused an evolution, false otherwise
+     */
+    bool applyPlaying(std::chrono::system_clock::time_point now, uint32_t times = 1) noexcept;
+    
+    /**
+     * @brief Apply stat decay for the time passed since the last interaction
+     * 
+     * Writes the values getStatsAt() reports into the stored anchors and moves
+     * the last interaction time to now. Only needed before changing the stats;
+     * reading them does not require it. Does nothing for a brand new pet or if less than GameConfig::Time::MIN_TIME_THRESHOLD
+     * has passed. Recorded in the interaction journal; see commitInteractions().
+     * 
+     * @param now Current time
+     * @return Hours of effects applied, or 0.0 if nothing was applied
+     */
+    double applyElapsedTime(std::chrono::system_clock::time_point now) noexcept;
+    
+    /**
+     * @brief Unlock an achievement and record it in the interaction journal
+     * @param type The achievement type to unlock
+     * @return true if the achievement was newly unlocked
+     */
+    bool unlockAchievement(AchievementType type) noexcept;
+    
+    /**
+     * @brief Track a command for the Explorer achievement and record it in the interaction journal
+     * @param command The command string
+     */
+    void trackCommand(const std::string& command) noexcept;
+    
+    /**
+     * @brief Append interactions recorded since the last save or commit to the journal
+     * 
+     * Much cheaper than save(): only a few bytes are appended to the journal
+     * next to the state file. The journal is replayed by load() and folded into
+     * a new snapshot in the background once it grows past
+     * GameConfig::Persistence::JOURNAL_COMPACTION_THRESHOLD.
+     * Changes made through other setters still require save().
+     * 
+     * @return True if the interactions were persisted, false otherwise
+     */
+    bool commitInteractions() noexcept;
+    
+    /**
+     * @brief Start a unit of work
+     * 
+     * Changes made until commitTransaction() are written at most once, and not
+     * at all if nothing changed. Transactions nest; only the outermost commit
+     * writes.
+     */
+    void beginTransaction() noexcept;
+    
+    /**
+     * @brief Persist changes made since the last write and end the current transaction
+     * 
+     * Writes nothing if the state is clean, appends to the interaction journal if
+     * every change came from a journaled interaction, and saves a full snapshot
+     * otherwise. Also persists pending changes when no transaction is open.
+     * 
+     * @return True if the changes were persisted (or there were none), false otherwise
+     */
+    bool commitTransaction() noexcept;
+    
+    /**
+     * @brief Check if a transaction is open
+     * @return True between beginTransaction() and the matching commit
+     */
+    bool isInTransaction() const noexcept {
+        return m_transactionDepth > 0;
+    }
+    
+    /**
+     * @brief Check if there are changes that have not been persisted
+     * @return True if the state was modified since the last write
+     */
+    bool isDirty() const noexcept {
+        return m_dirtyFields != 0 || m_achievementSystem.isDirty();
+    }
+    
+    /**
+     * @brief Get the fields modified since the last write
+     * @return Combination of DirtyField flags
+     */
+    uint8_t getDirtyFields() const noexcept {
+        return m_dirtyFields | (m_achievementSystem.isDirty() ? DirtyAchievements : 0);
+    }
+    
+    /**
+     * @brief Get the number of writes to the state file and journal made by this object
+     * 
+     * Background journal compaction is not counted.
+     * 
+     * @return Number of successful snapshot saves and journal appends
+     */
+    uint64_t getWriteCount() const noexcept {
+        return m_writeCount;
+    }
+    
     /**
      * @brief Get the time of last interaction
      * @return Time point of the last interaction
@@ -234,7 +529,7 @@ public:
      * @return Reference to the pet's achievement system
      */
     AchievementSystem& getAchievementSystem() noexcept {
-        return m_achievementSystem;
+        return achievements();
     }
     
     /**
@@ -242,23 +537,223 @@ public:
      * @return Const reference to the pet's achievement system
      */
     const AchievementSystem& getAchievementSystem() const noexcept {
-        return m_achievementSystem;
+        return achievements();
     }
     
 private:
     /**
-     * @brief Get the file path for save data
-     * @return Path to the save file
+     * @brief Get the hours of decay due since the last interaction
+     * @param now Current time
+     * @return Hours passed, or 0.0 for a brand new pet or below GameConfig::Time::MIN_TIME_THRESHOLD
+     */
+    double getPendingHours(std::chrono::system_clock::time_point now) const noexcept;
+    
+    /**
+     * @brief Update the FullyRested achievement progress from the stored energy
+     */
+    void updateRestedProgress() noexcept;
+    
+    /**
+     * @brief Raise a stat and add XP for several interactions in a row
+     * 
+     * The stat is capped at the maximum of the level the pet has before each
+     * interaction's XP, as with one increase and one addXP() call per
+     * interaction. The cap only changes at evolutions, so the result is
+     * computed once per level reached rather than once per interaction.
+     * 
+     * @param stat The stat to raise
+     * @param amount Increase per interaction
+     * @param xpGain XP per interaction
+     * @param times Number of interactions
+     * @param fullAchievement Achievement whose progress is the stat's percentage of the maximum
+     * @return True if the pet evolved
+     */
+    bool applyRepeatedInteraction(float& stat, float amount, uint32_t xpGain, uint32_t times,
+                                  AchievementType fullAchievement) noexcept;
+    
+    /**
+     * @brief Load state from a version 5+ file image
+     * @param bytes The file contents, read in place (e.g. from a file mapping)
+     * @return True if loaded successfully, false otherwise
+     */
+    bool loadFromImage(std::span<const std::byte> bytes) noexcept;
+    
+    /**
+     * @brief Restore an archived pet to its state file and load it
+     * @param statePath Path of the missing state file
+     * @return True if the pet was archived and restored, false otherwise
+     */
+    bool rehydrateFromArchive(const std::filesystem::path& statePath) noexcept;
+    
+    /**
+     * @brief Load state from a sectioned (version 6+) file image
+     * 
+     * Only the core section is decoded; the achievements section is copied
+     * and parsed on first use. Unknown optional sections are preserved.
+     * 
+     * @param bytes The file contents
+     * @return True if loaded successfully, false otherwise
+     */
+    bool loadSections(std::span<const std::byte> bytes) noexcept;
+    
+    /**
+     * @brief Load state from a version 5 fixed-header image
+     * @param bytes The file contents
+     * @return True if loaded successfully, false otherwise
+     */
+    bool loadHeaderV5(std::span<const std::byte> bytes) noexcept;
+    
+    /**
+     * @brief Parse the achievements section if it has not been parsed yet
+     */
+    void ensureAchievementsLoaded() const noexcept;
+    
+    /**
+     * @brief Get the achievement system, parsing it first if needed
+     */
+    AchievementSystem& achievements() noexcept {
+        ensureAchievementsLoaded();
+        return m_achievementSystem;
+    }
+    
+    const AchievementSystem& achievements() const noexcept {
+        ensureAchievementsLoaded();
+        return m_achievementSystem;
+    }
+    
+    /**
+     * @brief Encode the state as a sectioned file image of StateFileFormat::CURRENT_VERSION
+     * @return The complete file contents
+     */
+    std::vector<std::byte> encodeImage() const;
+    
+    /**
+     * @brief Load state from a legacy (version 1-4) file
+     * @param reader Reader over the file contents after the version byte
+     * @param version The version of the file
+     * @return True if loaded successfully, false otherwise
+     */
+    bool loadLegacy(BinarySchema::Reader& reader, uint8_t version) noexcept;
+    
+    /**
+     * @brief Replay journaled interactions on top of the loaded snapshot
+     * @param statePath Path of the state file the journal belongs to
+     */
+    void replayJournal(const std::filesystem::path& statePath) noexcept;
+    
+    /**
+     * @brief Apply one journal record
+     * @param record The record to apply
+     */
+    void applyJournalRecord(const InteractionJournal::Record& record) noexcept;
+    
+    /**
+     * @brief Queue a journal record for the next commitInteractions()
+     * @param type Record type
+     * @param value Record field
+     * @param count Interactions in a batch record
+     */
+    void recordInteraction(JournalRecordType type, uint64_t value, uint64_t count = 1) noexcept;
+    
+    /**
+     * @brief Mark fields as modified
+     * 
+     * Changes made outside a journaled interaction can only be persisted by a snapshot.
+     * 
+     * @param fields Combination of DirtyField flags
+     */
+    void markDirty(uint8_t fields) noexcept;
+    
+    /**
+     * @brief Enter a journaled interaction
+     * @return Whether an interaction was already being applied, to pass to endInteraction()
+     */
+    bool beginInteraction() noexcept;
+    
+    /**
+     * @brief Leave a journaled interaction
+     * @param wasApplying Value returned by the matching beginInteraction()
+     */
+    void endInteraction(bool wasApplying) noexcept;
+    
+    /**
+     * @brief Account for achievement changes made directly through getAchievementSystem()
+     */
+    void collectAchievementChanges() const noexcept;
+    
+    /**
+     * @brief Mark the current state as persisted
      */
-    std::filesystem::path getStateFilePath() const noexcept;
+    void markClean() const noexcept;
     
     std::string m_name;
     EvolutionLevel m_evolutionLevel;
     uint32_t m_xp;
+    
+    // Stat anchors, valid at m_lastInteractionTime; see getStatsAt()
     float m_hunger;
     float m_happiness;
     float m_energy;
     std::chrono::system_clock::time_point m_lastInteractionTime;
     std::chrono::system_clock::time_point m_birthDate;
-    AchievementSystem m_achievementSystem;
+    
+    // Parsed lazily from m_achievementSection, see achievements()
+    mutable AchievementSystem m_achievementSystem;
+    
+    // Raw achievements section not parsed yet, empty once parsed
+    mutable std::vector<std::byte> m_achievementSection;
+    
+    // File version m_achievementSection was read from
+    uint8_t m_achievementSectionVersion = 0;
+    
+    /**
+     * @brief A section of unknown type carried over from the loaded file
+     */
+    struct PreservedSection {
+        uint16_t type;
+        uint16_t flags;
+        std::vector<std::byte> bytes;
+    };
+    
+    // Unknown sections written back on save
+    std::vector<PreservedSection> m_preservedSections;
+    
+    // State file used by the last load or save
+    mutable std::filesystem::path m_statePath;
+    
+    // Writer used by save(); tracks batched fsync state across saves
+    mutable AtomicFileWriter m_fileWriter;
+    
+    // Journal of interactions since the last snapshot
+    mutable InteractionJournal m_journal;
+    
+    // Encoded journal records not yet appended
+    mutable std::vector<std::byte> m_pendingRecords;
+    
+    // Number of records in m_pendingRecords
+    mutable uint32_t m_pendingRecordCount = 0;
+    
+    // Sequence number of the next journal record
+    mutable uint64_t m_journalSequence = 0;
+    
+    // Whether a snapshot exists on disk for the journal to build on
+    mutable bool m_hasSnapshot = false;
+    
+    // Set while replaying so replayed interactions are not recorded again
+    bool m_replayingJournal = false;
+    
+    // Set while applying a journaled interaction
+    bool m_applyingInteraction = false;
+    
+    // DirtyField flags for changes not yet persisted
+    mutable uint8_t m_dirtyFields = 0;
+    
+    // Whether some pending change was not journaled and needs a full snapshot
+    mutable bool m_snapshotRequired = false;
+    
+    // Number of successful writes, see getWriteCount()
+    mutable uint64_t m_writeCount = 0;
+    
+    // Nesting depth of open transactions
+    uint32_t m_transactionDepth = 0;
 };
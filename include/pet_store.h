@@ -0,0 +1,316 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include <utility>
+#include "leaderboard.h"
+
+/**
+ * @brief Single-file store holding many pets in fixed-size slotted pages
+ *
+ * File layout:
+ * - Page 0: StoreHeader
+ * - Pages 1..N: PageHeader, then a slot directory growing upwards,
+ *   and record bodies growing downwards from the end of the page
+ *
+ * Each slot records the pet ID it belongs to, so opening the store only
+ * needs to scan slot directories to rebuild the in-memory index and the
+ * free-space map. Records are updated in place while they fit their slot.
+ * A record that outgrows its slot is written to a new slot flagged
+ * SLOT_MOVED before the old slot is cleared; opening a store keeps the
+ * moved copy if a crash left both.
+ *
+ * Writes go through std::fstream without syncing, so the store does not
+ * survive a power loss: an in-place update can leave a record, slot or
+ * page half written (a torn page) if the machine stops mid-write. Only a
+ * crash of the process itself, after which the kernel still writes out
+ * what it was given, keeps every record intact.
+ *
+ * open() takes an exclusive flock on the store file, held until close(),
+ * so two processes never change the same store at once.
+ *
+ * The store also keeps a Leaderboard of its pets in a file next to it
+ * (leaderboardPathFor()). STORE_LEADERBOARD_CURRENT in the header says the
+ * file matches the records: it is cleared before the first change after
+ * a flush and set again once flush() has saved the leaderboard. Opening
+ * a store whose flag is clear rebuilds the leaderboard from the records.
+ */
+class PetStore {
+public:
+    // Size of every page in the file
+    static constexpr uint32_t PAGE_SIZE = 4096;
+
+    /**
+     * @brief Header stored in page 0
+     */
+    struct StoreHeader {
+        char magic[8];          // "PETSTORE"
+        uint32_t formatVersion;
+        uint32_t pageSize;
+        uint32_t pageCount;     // Including the header page
+        uint32_t flags;         // STORE_* flags
+    };
+
+    // The leaderboard file matches the records
+    static constexpr uint32_t STORE_LEADERBOARD_CURRENT = 0x0001;
+
+    /**
+     * @brief Header at the start of every data page
+     */
+    struct PageHeader {
+        uint16_t slotCount;     // Number of slot directory entries
+        uint16_t freeStart;     // First byte after the slot directory
+        uint16_t freeEnd;       // First byte of the record area
+        uint16_t reserved16;
+        uint64_t reserved64;
+    };
+
+    /**
+     * @brief Slot directory entry
+     */
+    struct Slot {
+        uint64_t petId;
+        uint16_t offset;        // Record offset within the page
+        uint16_t length;        // Current record length
+        uint16_t capacity;      // Bytes reserved for the record
+        uint16_t flags;         // SLOT_LIVE if the slot holds a record
+    };
+
+    static constexpr uint16_t SLOT_LIVE = 0x0001;
+
+    // A relocated record whose previous slot may still be live
+    static constexpr uint16_t SLOT_MOVED = 0x0002;
+
+    // Largest record that fits into an otherwise empty page
+    static constexpr size_t MAX_RECORD_SIZE = PAGE_SIZE - sizeof(PageHeader) - sizeof(Slot);
+
+    /**
+     * @brief Constructor
+     */
+    PetStore() noexcept = default;
+
+    /**
+     * @brief Destructor, closes the store
+     */
+    ~PetStore();
+
+    PetStore(const PetStore&) = delete;
+    PetStore& operator=(const PetStore&) = delete;
+
+    /**
+     * @brief Get the path of the leaderboard file of a store
+     * @param storePath Path to the store file
+     * @return The store path with ".leaderboard" appended
+     */
+    static std::filesystem::path leaderboardPathFor(const std::filesystem::path& storePath);
+
+    /**
+     * @brief Open a store file, creating it if it does not exist
+     *
+     * Blocks until no other process has the store open.
+     *
+     * @param path Path to the store file
+     * @return True if opened successfully, false otherwise
+     */
+    bool open(const std::filesystem::path& path) noexcept;
+
+    /**
+     * @brief Check if the store is open
+     * @return True if open
+     */
+    bool isOpen() const noexcept { return m_file.is_open(); }
+
+    /**
+     * @brief Get the path of the open store file
+     * @return Store file path
+     */
+    const std::filesystem::path& getPath() const noexcept { return m_path; }
+
+    /**
+     * @brief Check if a pet exists in the store
+     * @param petId The pet ID
+     * @return True if a record exists
+     */
+    bool contains(uint64_t petId) const noexcept { return m_index.count(petId) != 0; }
+
+    /**
+     * @brief Get the number of pets in the store
+     * @return Number of records
+     */
+    size_t size() const noexcept { return m_index.size(); }
+
+    /**
+     * @brief Read a pet record
+     * @param petId The pet ID
+     * @param record Output buffer, resized to the record length
+     * @return True if the record was found and read
+     */
+    bool get(uint64_t petId, std::vector<std::byte>& record) noexcept;
+
+    /**
+     * @brief Insert or update a pet record
+     *
+     * The caller updates the pet's leaderboard entry, as
+     * PetState::saveToStore() does.
+     *
+     * @param petId The pet ID
+     * @param record The record contents (at most MAX_RECORD_SIZE bytes)
+     * @return True if stored successfully
+     */
+    bool put(uint64_t petId, std::span<const std::byte> record) noexcept;
+
+    /**
+     * @brief Remove a pet record and its leaderboard entry
+     * @param petId The pet ID
+     * @return True if the record existed and was removed
+     */
+    bool erase(uint64_t petId) noexcept;
+
+    /**
+     * @brief Get the IDs of all stored pets
+     * @return Vector of pet IDs in no particular order
+     */
+    std::vector<uint64_t> getPetIds() const;
+
+    /**
+     * @brief Get the leaderboard of the stored pets
+     * @return The leaderboard
+     */
+    Leaderboard& getLeaderboard() noexcept { return m_leaderboard; }
+    const Leaderboard& getLeaderboard() const noexcept { return m_leaderboard; }
+
+    /**
+     * @brief Flush buffered writes to the operating system and save the leaderboard if it changed
+     * @return True if successful
+     */
+    bool flush() noexcept;
+
+    /**
+     * @brief Flush and close the store
+     */
+    void close() noexcept;
+
+private:
+    /**
+     * @brief Location of a record in the file
+     */
+    struct SlotLocation {
+        uint32_t page;
+        uint16_t slot;
+        uint16_t offset;
+        uint16_t length;
+        uint16_t capacity;
+    };
+
+    /**
+     * @brief Read a whole page into a buffer
+     */
+    bool readPage(uint32_t page, std::vector<std::byte>& buffer) noexcept;
+
+    /**
+     * @brief Write a whole page from a buffer
+     */
+    bool writePage(uint32_t page, std::span<const std::byte> buffer) noexcept;
+
+    /**
+     * @brief Write bytes at an absolute file offset
+     */
+    bool writeAt(uint64_t offset, const void* data, size_t size) noexcept;
+
+    /**
+     * @brief Remove a record, leaving the leaderboard alone
+     */
+    bool eraseRecord(uint64_t petId) noexcept;
+
+    /**
+     * @brief Mark a slot dead, keeping its space for reuse
+     */
+    bool clearSlot(const SlotLocation& location) noexcept;
+
+    /**
+     * @brief Insert a record into a page with enough free space
+     * @param slotFlags Flags of the new slot, SLOT_LIVE and optionally SLOT_MOVED
+     */
+    bool insert(uint64_t petId, std::span<const std::byte> record, uint16_t slotFlags) noexcept;
+
+    /**
+     * @brief Finish relocations interrupted by a crash, keeping the moved copies
+     * @param moved Live slots flagged SLOT_MOVED, found while opening
+     */
+    bool finishMoves(const std::vector<std::pair<uint64_t, SlotLocation>>& moved) noexcept;
+
+    /**
+     * @brief Take the exclusive lock on the store file, blocking until it is free
+     */
+    bool lockFile() noexcept;
+
+    /**
+     * @brief Release the lock taken by lockFile()
+     */
+    void unlockFile() noexcept;
+
+    /**
+     * @brief Compute the space available for a new record in a page
+     * @param buffer Page contents
+     * @param size Record size needed
+     * @param reuseSlot Set to the index of a reusable dead slot, or slotCount if none
+     * @return True if the record fits
+     */
+    static bool findSpace(std::span<const std::byte> buffer, size_t size, uint16_t& reuseSlot) noexcept;
+
+    /**
+     * @brief Update the free-space map entry for a page
+     */
+    void updateFreeSpace(uint32_t page, std::span<const std::byte> buffer) noexcept;
+
+    /**
+     * @brief Write the store header
+     */
+    bool writeHeader() noexcept;
+
+    /**
+     * @brief Clear STORE_LEADERBOARD_CURRENT on disk before the records change
+     */
+    bool markLeaderboardStale() noexcept;
+
+    /**
+     * @brief Load the leaderboard file, or rebuild it from the records if it is stale
+     */
+    void openLeaderboard() noexcept;
+
+    // Open store file
+    std::fstream m_file;
+
+    // Separate handle on the store file holding its lock
+#ifdef _WIN32
+    void* m_lockHandle = nullptr;
+#else
+    int m_lockFd = -1;
+#endif
+
+    // Store file path
+    std::filesystem::path m_path;
+
+    // Number of pages including the header page
+    uint32_t m_pageCount = 0;
+
+    // Pet ID to record location
+    std::unordered_map<uint64_t, SlotLocation> m_index;
+
+    // Free-space map: largest record that fits into each page without compaction
+    std::vector<uint16_t> m_freeSpace;
+
+    // Reusable page buffer
+    std::vector<std::byte> m_pageBuffer;
+
+    // STORE_* flags as written to the header
+    uint32_t m_flags = 0;
+
+    // Rankings of the stored pets
+    Leaderboard m_leaderboard;
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include "game_config.h"
+#include "pet_record.h"
+#include "pet_state.h"
+#include "time_decay.h"
+
+/**
+ * @brief Per-evolution-level sums, counts and histograms of a population
+ *
+ * The aggregates are kept up to date by deltas: every change to a pet
+ * removes its old contribution and adds the new one, so reading them never
+ * scans the pets. Stats are summed in the Q8.8 fixed point of PetRecord,
+ * which keeps the sums exact however many deltas are applied.
+ *
+ * Stats are the stored values as of the pet's last update. Decay that has
+ * not been applied yet by a tick or interaction is not included.
+ *
+ * A PopulationAggregates can also hold a delta on its own, with negative
+ * counts, to be merged into the aggregates of a population later.
+ */
+class PopulationAggregates {
+public:
+    // Number of evolution levels, Egg to Ancient
+    static constexpr size_t LEVEL_COUNT = static_cast<size_t>(EvolutionLevel::Ancient) + 1;
+
+    // Stat histogram buckets, each covering 10% of the level's maximum stat
+    static constexpr size_t HISTOGRAM_BUCKETS = 10;
+
+    /**
+     * @brief The values of one pet the aggregates depend on
+     */
+    struct PetSample {
+        uint8_t evolutionLevel;
+        uint32_t xp;
+        float hunger;
+        float happiness;
+        float energy;
+    };
+
+    /**
+     * @brief Aggregates of the pets at one evolution level
+     */
+    struct LevelStats {
+        int64_t count = 0;
+        int64_t xpSum = 0;
+
+        // Sums of the stats in Q8.8 fixed point
+        int64_t hungerSum = 0;
+        int64_t happinessSum = 0;
+        int64_t energySum = 0;
+
+        // Pets at or below the GameConfig::Warnings thresholds
+        int64_t hungerWarnings = 0;
+        int64_t happinessWarnings = 0;
+
+        // Pets by stat as a percentage of the level's maximum; 100% falls into the last bucket
+        std::array<int64_t, HISTOGRAM_BUCKETS> hungerHistogram{};
+        std::array<int64_t, HISTOGRAM_BUCKETS> happinessHistogram{};
+        std::array<int64_t, HISTOGRAM_BUCKETS> energyHistogram{};
+
+        double getAverageXP() const noexcept { return average(static_cast<double>(xpSum)); }
+        double getAverageHunger() const noexcept { return average(fromFixedSum(hungerSum)); }
+        double getAverageHappiness() const noexcept { return average(fromFixedSum(happinessSum)); }
+        double getAverageEnergy() const noexcept { return average(fromFixedSum(energySum)); }
+
+        /**
+         * @brief Add the counts and sums of another level
+         */
+        LevelStats& operator+=(const LevelStats& other) noexcept;
+
+    private:
+        double average(double sum) const noexcept { return count > 0 ? sum / static_cast<double>(count) : 0.0; }
+        static double fromFixedSum(int64_t sum) noexcept;
+    };
+
+    /**
+     * @brief Add a pet
+     * @param pet The pet's values
+     */
+    void add(const PetSample& pet) noexcept { apply(pet, 1); }
+
+    /**
+     * @brief Remove a pet
+     * @param pet The pet's values as they were added
+     */
+    void remove(const PetSample& pet) noexcept { apply(pet, -1); }
+
+    /**
+     * @brief Replace a pet's contribution after it changed
+     * @param before The pet's values before the change
+     * @param after The pet's values after the change
+     */
+    void update(const PetSample& before, const PetSample& after) noexcept {
+        if (before.evolutionLevel != after.evolutionLevel) {
+            apply(before, -1);
+            apply(after, 1);
+            return;
+        }
+
+        // Same level: only the differences touch the level's counters
+        m_levels[levelIndex(after.evolutionLevel)].xpSum +=
+            static_cast<int64_t>(after.xp) - static_cast<int64_t>(before.xp);
+        updateStats(after.evolutionLevel, {before.hunger, before.happiness, before.energy},
+                    {after.hunger, after.happiness, after.energy});
+    }
+
+    /**
+     * @brief Replace a pet's contribution after only its stats changed, as time effects do
+     * @param evolutionLevel The pet's evolution level
+     * @param before The stats before the change
+     * @param after The stats after the change
+     */
+    void updateStats(uint8_t evolutionLevel, const TimeDecay::Stats& before, const TimeDecay::Stats& after) noexcept {
+        auto& stats = m_levels[levelIndex(evolutionLevel)];
+        float scale = HISTOGRAM_SCALES[levelIndex(evolutionLevel)];
+        updateStat(stats.hungerSum, stats.hungerHistogram, before.hunger, after.hunger, scale);
+        updateStat(stats.happinessSum, stats.happinessHistogram, before.happiness, after.happiness, scale);
+        updateStat(stats.energySum, stats.energyHistogram, before.energy, after.energy, scale);
+        stats.hungerWarnings += isHungerWarning(after.hunger) - isHungerWarning(before.hunger);
+        stats.happinessWarnings += isHappinessWarning(after.happiness) - isHappinessWarning(before.happiness);
+    }
+
+    /**
+     * @brief Add the aggregates or delta of another object
+     * @param delta Aggregates to add
+     */
+    void merge(const PopulationAggregates& delta) noexcept;
+
+    /**
+     * @brief Reset every count and sum to zero
+     */
+    void clear() noexcept { m_levels = {}; }
+
+    /**
+     * @brief Get the aggregates of one evolution level
+     * @param level The evolution level
+     * @return Aggregates of the pets at that level
+     */
+    const LevelStats& getLevelStats(EvolutionLevel level) const noexcept {
+        return m_levels[levelIndex(static_cast<uint8_t>(level))];
+    }
+
+    /**
+     * @brief Get the aggregates of the whole population
+     * @return Sum of the aggregates of every level
+     */
+    LevelStats getTotalStats() const noexcept;
+
+private:
+    static constexpr size_t levelIndex(uint8_t level) noexcept {
+        return level < LEVEL_COUNT ? level : LEVEL_COUNT - 1;
+    }
+
+    // Histogram buckets per stat point, by level
+    static constexpr auto HISTOGRAM_SCALES = []() {
+        std::array<float, LEVEL_COUNT> scales{};
+        for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+            scales[level] = static_cast<float>(HISTOGRAM_BUCKETS) /
+                            GameConfig::getMaxStatForEvolutionLevel(static_cast<uint8_t>(level));
+        }
+        return scales;
+    }();
+
+    static size_t histogramBucket(float stat, float scale) noexcept {
+        if (!(stat > 0.0f)) {
+            return 0;
+        }
+        auto bucket = static_cast<size_t>(stat * scale);
+        return bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1;
+    }
+
+    // Same comparisons as the warnings TimeManager shows
+    static int64_t isHungerWarning(float hunger) noexcept {
+        return hunger <= GameConfig::Warnings::HUNGER_WARNING_THRESHOLD ? 1 : 0;
+    }
+
+    static int64_t isHappinessWarning(float happiness) noexcept {
+        return happiness <= GameConfig::Warnings::HAPPINESS_WARNING_THRESHOLD ? 1 : 0;
+    }
+
+    static void updateStat(int64_t& sum, std::array<int64_t, HISTOGRAM_BUCKETS>& histogram, float before,
+                           float after, float scale) noexcept {
+        sum += static_cast<int64_t>(PetRecord::toFixed(after)) - static_cast<int64_t>(PetRecord::toFixed(before));
+        // Unconditional, as whether the bucket changes is hard to predict
+        --histogram[histogramBucket(before, scale)];
+        ++histogram[histogramBucket(after, scale)];
+    }
+
+    /**
+     * @brief Add or remove a pet's contribution
+     */
+    void apply(const PetSample& pet, int64_t sign) noexcept;
+
+    std::array<LevelStats, LEVEL_COUNT> m_levels{};
+};
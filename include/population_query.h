@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "achievement_system.h"
+#include "pet_population.h"
+#include "work_stealing_pool.h"
+
+/**
+ * @brief Predicate over the pets of a population, compiled to filter kernels
+ *
+ * Predicates compare stat fields with constants and combine the results:
+ *
+ *     level == Teen and hunger < 10 and idle > 3d
+ *     (xp >= 5000 or has Master) and not has Explorer
+ *
+ * Fields are level (number or name), xp, hunger, happiness, energy (as of
+ * the query time, decay included) and idle (time since the last
+ * interaction, with an s, m, h or d suffix; hours without one). Operators
+ * are <, <=, >, >=, == and !=; "has" tests an unlocked achievement by name,
+ * ignoring case and spaces. "and" binds tighter than "or"; "&&", "||" and
+ * "!" are accepted as well. An empty predicate matches every pet.
+ *
+ * A compiled query is a postfix program. Each comparison runs over a whole
+ * column of a chunk at once and yields one bit per pet; the logical
+ * operators then combine 64 pets per instruction.
+ */
+class PopulationQuery {
+public:
+    /**
+     * @brief A field predicates and projections can refer to
+     */
+    enum class Field : uint8_t {
+        Level,
+        XP,
+        Hunger,
+        Happiness,
+        Energy,
+        Idle
+    };
+
+    /**
+     * @brief Comparison of a column with a constant
+     *
+     * <=, >= and != are compiled as the negation of >, < and ==.
+     */
+    enum class Comparison : uint8_t {
+        Less,
+        Greater,
+        Equal
+    };
+
+    /**
+     * @brief One step of the postfix program
+     */
+    struct Instruction {
+        enum class Kind : uint8_t {
+            Compare,        // Push the comparison of field with a constant
+            HasAchievement, // Push whether the achievement is unlocked
+            And,            // Pop two masks, push their intersection
+            Or,             // Pop two masks, push their union
+            Not             // Invert the top mask
+        };
+
+        Kind kind;
+        Field field = Field::Level;
+        Comparison comparison = Comparison::Equal;
+
+        // Invert the comparison's result
+        bool negate = false;
+
+        // Constant of the comparison, in the field's unit: level, XP, stat value or idle seconds
+        double value = 0.0;
+
+        AchievementType achievement = AchievementType::Count;
+    };
+
+    /**
+     * @brief Compile a predicate
+     * @param predicate Predicate text
+     * @param error Set to a description of the problem if compiling fails
+     * @return The query, or std::nullopt if the predicate is invalid
+     */
+    static std::optional<PopulationQuery> compile(std::string_view predicate, std::string& error);
+
+    /**
+     * @brief Look up a field by name
+     * @param name Field name, as used in predicates
+     * @return The field, or std::nullopt if there is none by that name
+     */
+    static std::optional<Field> findField(std::string_view name) noexcept;
+
+    /**
+     * @brief Get the name of an evolution level, as accepted in predicates
+     * @param level The evolution level
+     * @return The level name, or "Unknown" for levels past Ancient
+     */
+    static std::string_view getLevelName(uint8_t level) noexcept;
+
+    /**
+     * @brief Get the program of the query
+     * @return Instructions in postfix order; empty if every pet matches
+     */
+    const std::vector<Instruction>& getInstructions() const noexcept { return m_instructions; }
+
+    /**
+     * @brief Get the number of masks the program needs at once
+     * @return Maximum stack depth
+     */
+    size_t getStackDepth() const noexcept { return m_stackDepth; }
+
+    /**
+     * @brief Check if the program reads hunger, happiness or energy
+     * @return True if stats have to be decayed to the query time first
+     */
+    bool usesStats() const noexcept { return m_usesStats; }
+
+private:
+    PopulationQuery() noexcept = default;
+
+    std::vector<Instruction> m_instructions;
+    size_t m_stackDepth = 0;
+    bool m_usesStats = false;
+};
+
+/**
+ * @brief Result of running a query over a population
+ */
+struct QueryResult {
+    // Pets examined
+    size_t scanned = 0;
+
+    // Pets that matched
+    size_t matched = 0;
+
+    // Population indices of the matching pets in ascending order, if requested
+    std::vector<uint32_t> indices;
+
+    // Wall-clock duration of the run
+    std::chrono::duration<double> elapsed{0};
+};
+
+/**
+ * @brief Runs compiled queries over a population in parallel
+ *
+ * The population is split into chunks of 4096 pets that run on a
+ * WorkStealingPool. When a query reads stats, each chunk's stat columns are
+ * first copied and decayed to the query time with the TimeDecay batch
+ * kernel, so the values match PetState::getHunger() and friends while the
+ * population itself stays untouched. Comparisons use AVX2 when the CPU
+ * supports it and portable loops otherwise; both give the same bits.
+ */
+class QueryEngine {
+public:
+    // Pets per chunk; a multiple of 64 so a chunk's mask is whole words
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    /**
+     * @brief Constructor
+     * @param threadCount Number of worker threads; 0 uses the hardware concurrency
+     */
+    explicit QueryEngine(size_t threadCount = 0);
+
+    /**
+     * @brief Run a query
+     * @param query The compiled query
+     * @param population The pets to examine
+     * @param now Time at which stats and idle times are evaluated
+     * @param collectIndices Also return the indices of the matching pets
+     * @return Counts, matching indices and timing
+     */
+    QueryResult run(const PopulationQuery& query, const PetPopulation& population,
+                    std::chrono::system_clock::time_point now, bool collectIndices);
+
+    /**
+     * @brief Get the name of the comparison kernels in use
+     * @return "avx2" or "portable"
+     */
+    static const char* getImplementationName() noexcept;
+
+private:
+    // Mask words per chunk
+    static constexpr size_t CHUNK_WORDS = CHUNK_SIZE / 64;
+
+    /**
+     * @brief State of one worker, padded so workers never share a cache line
+     */
+    struct alignas(64) WorkerState {
+        size_t matched = 0;
+        std::vector<uint32_t> indices;
+
+        // Stats of the current chunk decayed to the query time
+        PetPopulation::Column<float> hunger;
+        PetPopulation::Column<float> happiness;
+        PetPopulation::Column<float> energy;
+        PetPopulation::Column<int64_t> lastInteraction;
+
+        // Mask stack, CHUNK_WORDS words per entry
+        PetPopulation::Column<uint64_t> masks;
+    };
+
+    /**
+     * @brief Run a query over the pets [begin, end) of a population
+     */
+    static void runChunk(const PopulationQuery& query, const PetPopulation& population, size_t begin, size_t end,
+                         int64_t nowSeconds, bool collectIndices, WorkerState& state);
+
+    WorkStealingPool m_pool;
+
+    // One state per worker, reused across runs
+    std::vector<WorkerState> m_states;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <functional>
+
+/**
+ * @brief Threads that each own a shard of the data and run the tasks posted to it
+ *
+ * Every shard is one thread with one queue. Whatever a shard owns is only
+ * touched by tasks posted to that shard, so the tasks need no locks; work
+ * on another shard's data is done by posting a task to that shard. Tasks
+ * posted to the same shard run in the order they were posted.
+ *
+ * The queues are lock-free multi-producer single-consumer lists: posting
+ * is one atomic exchange, and a shard runs its tasks without any
+ * synchronization beyond one acquire load per task. A shard with nothing
+ * to do sleeps; a producer only wakes it if it announced that it sleeps.
+ */
+class ShardRuntime {
+public:
+    // A task; must not throw
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Constructor, starts one thread per shard
+     * @param shardCount Number of shards; 0 uses the hardware concurrency
+     * @param pinThreads Pin shard i to CPU i modulo the CPU count (Linux only)
+     */
+    explicit ShardRuntime(size_t shardCount = 0, bool pinThreads = false);
+
+    /**
+     * @brief Destructor, runs the tasks already posted and joins the threads
+     */
+    ~ShardRuntime();
+
+    ShardRuntime(const ShardRuntime&) = delete;
+    ShardRuntime& operator=(const ShardRuntime&) = delete;
+
+    /**
+     * @brief Get the number of shards
+     */
+    size_t getShardCount() const noexcept { return m_shards.size(); }
+
+    /**
+     * @brief Get the shard that owns a key
+     */
+    size_t getShardFor(uint64_t key) const noexcept { return static_cast<size_t>(key % m_shards.size()); }
+
+    /**
+     * @brief Queue a task on a shard; safe from any thread, including the shards
+     * @param shard Index of the shard
+     * @param task The task
+     */
+    void post(size_t shard, Task task);
+
+    /**
+     * @brief Get the shard the calling thread runs
+     * @return Its index, or getShardCount() if the caller is not a shard thread of this runtime
+     */
+    size_t getCurrentShard() const noexcept;
+
+private:
+    /**
+     * @brief Queued task; the queue's last node is never freed by a producer
+     */
+    struct Node {
+        std::atomic<Node*> next{ nullptr };
+        Task task;
+    };
+
+    /**
+     * @brief A shard's queue and wakeup words, padded so shards do not share cache lines
+     */
+    struct alignas(64) Shard {
+        // Producers swap themselves in here
+        std::atomic<Node*> head{ nullptr };
+        // Bumped to wake the shard; the shard waits on it
+        std::atomic<uint32_t> wakeups{ 0 };
+        std::atomic<bool> sleeping{ false };
+        std::atomic<bool> stopping{ false };
+
+        // Only touched by the shard thread: the node before the next task
+        alignas(64) Node* tail = nullptr;
+    };
+
+    /**
+     * @brief Shard thread main loop
+     */
+    void shardLoop(size_t shard);
+
+    /**
+     * @brief Take the next task of a shard
+     * @return True if a task was taken
+     */
+    static bool pop(Shard& shard, Task& task);
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::vector<std::thread> m_threads;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+/**
+ * @brief Single-producer single-consumer ring of variable-size records in shared memory
+ *
+ * The ring's positions and wakeup words live in the shared region next to
+ * the data, so the two sides may be different processes. Records are
+ * contiguous: the producer writes a record in place between beginWrite()
+ * and endWrite(), and the consumer reads it in place between beginRead()
+ * and endRead(), so nothing is copied on either side.
+ *
+ * A side that finds the ring empty or full spins for
+ * GameConfig::Daemon::SHARED_RING_SPIN_COUNT rounds, then sleeps on a
+ * futex. The other side makes the wake system call only when a sleeper
+ * has announced itself, so a busy ring needs no system calls at all.
+ */
+class SharedRing {
+public:
+    /**
+     * @brief Get the size of the shared region for a ring
+     * @param capacity Data capacity in bytes, a power of two
+     */
+    static size_t getRegionSize(uint32_t capacity) noexcept;
+
+    /**
+     * @brief Initialize an empty ring in a zeroed region
+     * @param region The region, at least getRegionSize(capacity) bytes
+     * @param capacity Data capacity in bytes, a power of two
+     */
+    static void initialize(std::span<std::byte> region, uint32_t capacity) noexcept;
+
+    /**
+     * @brief Constructor, not attached
+     */
+    SharedRing() noexcept = default;
+
+    /**
+     * @brief Attach to a ring initialized by either side
+     * @param region The region
+     * @return True if the region holds a ring that fits in it
+     */
+    bool attach(std::span<std::byte> region) noexcept;
+
+    /**
+     * @brief Reserve space for the next record
+     * @param maxSize Largest size the record may have
+     * @param timeout How long to wait for space
+     * @return Space for the record, or an empty span on timeout, on close, or if maxSize exceeds getMaxRecordSize()
+     */
+    std::span<std::byte> beginWrite(size_t maxSize, std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * @brief Publish the record reserved by beginWrite()
+     * @param size Its actual size, at most the reserved size
+     */
+    void endWrite(size_t size) noexcept;
+
+    /**
+     * @brief Wait for the next record
+     * @param timeout How long to wait
+     * @return The record, or an empty span on timeout, on close, or if the ring is corrupt
+     */
+    std::span<const std::byte> beginRead(std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * @brief Release the record returned by beginRead(), letting the producer reuse its space
+     */
+    void endRead() noexcept;
+
+    /**
+     * @brief Mark the ring closed and wake both sides
+     */
+    void close() noexcept;
+
+    /**
+     * @brief Check whether either side closed the ring
+     */
+    bool isClosed() const noexcept;
+
+    /**
+     * @brief Get the data capacity in bytes
+     */
+    uint32_t getCapacity() const noexcept {
+        return m_capacity;
+    }
+
+    /**
+     * @brief Get the largest record the ring accepts
+     */
+    size_t getMaxRecordSize() const noexcept;
+
+private:
+    struct Control;
+
+    /**
+     * @brief Wait until a condition holds: spin, then sleep on a futex word
+     * @return True if the condition holds
+     */
+    template <typename Condition>
+    bool waitFor(Condition condition, std::atomic<uint32_t>& signal, std::atomic<uint32_t>& waiting,
+                 std::chrono::milliseconds timeout) noexcept;
+
+    Control* m_control = nullptr;
+    std::byte* m_data = nullptr;
+    uint32_t m_capacity = 0;
+
+    // Producer: start of the reserved record
+    uint64_t m_writeStart = 0;
+
+    // Consumer: position after the record being read
+    uint64_t m_readEnd = 0;
+};
+
+/**
+ * @brief Request and response rings of one client in one shared memory object
+ *
+ * The client creates the channel and passes its descriptor to the daemon
+ * over the Unix socket; the daemon attaches to the same memory. Clients
+ * produce requests and consume responses; the daemon does the opposite.
+ * Linux only: elsewhere create() and attach() fail and clients keep using
+ * the socket.
+ */
+class SharedChannel {
+public:
+    /**
+     * @brief Create a channel in new anonymous shared memory
+     * @param ringCapacity Capacity of each ring in bytes, a power of two
+     * @return The channel, or nullptr if shared memory is unavailable
+     */
+    static std::unique_ptr<SharedChannel> create(uint32_t ringCapacity) noexcept;
+
+    /**
+     * @brief Attach to a channel created by another process
+     * @param fd Descriptor of its shared memory; the channel takes ownership
+     * @return The channel, or nullptr if fd does not hold a valid channel or its size is not sealed against shrinking
+     */
+    static std::unique_ptr<SharedChannel> attach(int fd) noexcept;
+
+    /**
+     * @brief Destructor, closes both rings and unmaps the memory
+     */
+    ~SharedChannel();
+
+    SharedChannel(const SharedChannel&) = delete;
+    SharedChannel& operator=(const SharedChannel&) = delete;
+
+    /**
+     * @brief Get the descriptor of the shared memory, to pass to the other side
+     */
+    int getFd() const noexcept {
+        return m_fd;
+    }
+
+    /**
+     * @brief Get the ring of client requests
+     */
+    SharedRing& getRequests() noexcept {
+        return m_requests;
+    }
+
+    /**
+     * @brief Get the ring of daemon responses
+     */
+    SharedRing& getResponses() noexcept {
+        return m_responses;
+    }
+
+    /**
+     * @brief Close both rings, waking any side that waits on them
+     */
+    void close() noexcept;
+
+private:
+    SharedChannel() noexcept = default;
+
+    int m_fd = -1;
+    std::byte* m_memory = nullptr;
+    size_t m_size = 0;
+    SharedRing m_requests;
+    SharedRing m_responses;
+};
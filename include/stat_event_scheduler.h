@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <string_view>
+#include "time_decay.h"
+#include "timing_wheel.h"
+
+class PetState;
+class PetPopulation;
+
+/**
+ * @brief Stat thresholds a pet can cross while left alone
+ */
+enum class StatEvent : uint8_t {
+    HungerWarning = 0,      // Hunger fell to GameConfig::Warnings::HUNGER_WARNING_THRESHOLD
+    HappinessWarning = 1,   // Happiness fell to GameConfig::Warnings::HAPPINESS_WARNING_THRESHOLD
+    HungerDepleted = 2,     // Hunger reached zero
+    HappinessDepleted = 3   // Happiness reached zero
+};
+
+/**
+ * @brief Fires stat threshold events at the second they happen
+ *
+ * Stats decay linearly between interactions, so the moment each threshold
+ * is crossed is computed in advance from the pet's anchor values. Every pet
+ * keeps its next crossing in a TimingWheel; a long-running process advances
+ * the scheduler and is called back once per event instead of polling every
+ * pet. Pets must be rescheduled whenever an interaction moves their anchors.
+ */
+class StatEventScheduler {
+public:
+    // Number of StatEvent values
+    static constexpr size_t EVENT_COUNT = 4;
+
+    // Called for every event with the pet ID and the second it happened
+    using Callback = std::function<void(uint32_t petId, StatEvent event, int64_t when)>;
+
+    /**
+     * @brief Constructor
+     * @param nowSeconds Current time in seconds since the epoch
+     */
+    explicit StatEventScheduler(int64_t nowSeconds = 0) noexcept;
+
+    /**
+     * @brief Predict the events of a pet from its anchors
+     *
+     * Replaces the pet's pending events. Crossings at or before the
+     * scheduler's current time are dropped, since they already happened.
+     *
+     * @param petId Pet ID; IDs should be small and dense
+     * @param anchor Stats at the last interaction
+     * @param maxStat Maximum stat for the pet's evolution level
+     * @param anchorSeconds Last interaction time in seconds since the epoch
+     */
+    void reschedule(uint32_t petId, const TimeDecay::Stats& anchor, float maxStat, int64_t anchorSeconds);
+
+    /**
+     * @brief Predict the events of a pet from its current state
+     * @param petId Pet ID; IDs should be small and dense
+     * @param petState The pet
+     */
+    void reschedule(uint32_t petId, const PetState& petState);
+
+    /**
+     * @brief Predict the events of every pet in a population, using indices as pet IDs
+     * @param population The pets
+     */
+    void rescheduleAll(const PetPopulation& population);
+
+    /**
+     * @brief Drop the pending events of a pet
+     * @param petId Pet ID
+     */
+    void remove(uint32_t petId) noexcept;
+
+    /**
+     * @brief Get the number of pets with pending events
+     * @return Pet count
+     */
+    size_t size() const noexcept { return m_wheel.size(); }
+
+    /**
+     * @brief Get the time the scheduler has advanced to
+     * @return Time in seconds since the epoch
+     */
+    int64_t getCurrentTime() const noexcept { return m_wheel.getCurrentTime(); }
+
+    /**
+     * @brief Advance time, firing every event up to now in time order
+     * @param nowSeconds Current time in seconds since the epoch
+     * @param fire Callback for each event
+     * @return Number of events fired
+     */
+    size_t advance(int64_t nowSeconds, const Callback& fire);
+
+    /**
+     * @brief Compute when a stat first reaches an event's threshold
+     *
+     * Evaluates the stat exactly as PetState::getStatsAt() does, so the
+     * result is the first whole second at which the pet reports it.
+     *
+     * @param anchor Stats at the last interaction
+     * @param maxStat Maximum stat for the pet's evolution level
+     * @param anchorSeconds Last interaction time in seconds since the epoch
+     * @param event The threshold to predict
+     * @return Time in seconds, or nothing if the stat is already at or below the threshold
+     */
+    static std::optional<int64_t> predictCrossing(const TimeDecay::Stats& anchor, float maxStat,
+                                                  int64_t anchorSeconds, StatEvent event) noexcept;
+
+    /**
+     * @brief Get the message to show the player for an event
+     * @param event The event
+     * @return Message text
+     */
+    static std::string_view getEventMessage(StatEvent event) noexcept;
+
+private:
+    // Marks events that will not happen
+    static constexpr int64_t NEVER = INT64_MAX;
+
+    /**
+     * @brief Schedule the earliest pending event of a pet, if any
+     */
+    void scheduleNext(uint32_t petId);
+
+    // Predicted time of every event, indexed by pet ID then StatEvent
+    std::vector<std::array<int64_t, EVENT_COUNT>> m_eventTimes;
+
+    // Holds each pet's earliest pending event
+    TimingWheel m_wheel;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <filesystem>
+
+/**
+ * @brief Result of an archiving run
+ */
+struct ArchiveReport {
+    // Regular files visited
+    size_t scanned = 0;
+
+    // Idle pets moved into an archive
+    size_t archived = 0;
+
+    // Pets used more recently than the idle threshold
+    size_t active = 0;
+
+    // Files that are not pet state files
+    size_t ignored = 0;
+
+    // Pets that could not be archived; left in place
+    size_t failed = 0;
+
+    // Size of the state files and journals removed
+    uint64_t bytesRemoved = 0;
+
+    // Growth of the archive files
+    int64_t archiveBytesAdded = 0;
+
+    // Wall-clock duration of the run
+    std::chrono::duration<double> elapsed{0};
+
+    // Path and reason of every failure
+    std::vector<std::pair<std::filesystem::path, std::string>> failures;
+};
+
+/**
+ * @brief Moves idle pets into per-directory compressed archives
+ *
+ * Pets whose last interaction is older than the idle threshold are packed
+ * into the PetArchive of their directory and their state files removed,
+ * which saves both space and inodes. PetState::load() restores an archived
+ * pet to its state file on the next access.
+ */
+class StateArchiver {
+public:
+    /**
+     * @brief Constructor
+     * @param idleThreshold Minimum time since the last interaction for a pet to be archived
+     * @param threadCount Number of worker threads; 0 uses the hardware concurrency
+     */
+    explicit StateArchiver(std::chrono::seconds idleThreshold, size_t threadCount = 0) noexcept;
+
+    /**
+     * @brief Archive all idle pets below a directory
+     * @param root Directory to scan recursively
+     * @return Counts, sizes and failures of the run
+     */
+    ArchiveReport archive(const std::filesystem::path& root) const noexcept;
+
+    /**
+     * @brief Print a report in human-readable form
+     * @param report The report to print
+     */
+    static void printReport(const ArchiveReport& report) noexcept;
+
+private:
+    /**
+     * @brief Archive idle pets of one directory
+     * @param directory The directory
+     * @param paths State files found idle during the scan
+     * @param now Time the idle threshold is measured from
+     * @return Report covering only this directory
+     */
+    ArchiveReport archiveDirectory(const std::filesystem::path& directory, const std::vector<std::filesystem::path>& paths,
+                                   std::chrono::system_clock::time_point now) const;
+
+    // Minimum idle time before a pet is archived
+    std::chrono::seconds m_idleThreshold;
+
+    // Number of worker threads
+    size_t m_threadCount;
+};
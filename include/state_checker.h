@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <span>
+#include <string>
+#include <vector>
+#include <utility>
+#include <filesystem>
+
+/**
+ * @brief Result of an integrity check run
+ */
+struct CheckReport {
+    // Regular files visited
+    size_t scanned = 0;
+
+    // Checksummed files whose checksums all matched
+    size_t intact = 0;
+
+    // Readable files of a version without checksums
+    size_t unverified = 0;
+
+    // Files that are corrupt or truncated
+    size_t corrupt = 0;
+
+    // Files that are not pet state files
+    size_t ignored = 0;
+
+    // Sections whose checksum was verified
+    size_t sectionsVerified = 0;
+
+    // Time spent verifying checksummed files excluding I/O, summed over all threads
+    std::chrono::nanoseconds verifyTime{0};
+
+    // Wall-clock duration of the run
+    std::chrono::duration<double> elapsed{0};
+
+    // Path and description of every corrupt file or scan error
+    std::vector<std::pair<std::filesystem::path, std::string>> problems;
+};
+
+/**
+ * @brief Checks the integrity of every state file in a directory tree
+ *
+ * Checksummed files have their section table and every section verified
+ * against the stored CRC32C values. Older files carry no checksums and are
+ * only checked for being readable. Nothing is ever modified.
+ */
+class StateChecker {
+public:
+    /**
+     * @brief Outcome of checking one file image
+     */
+    enum class Status : uint8_t {
+        Intact,         // All checksums matched
+        Unverified,     // Structurally valid, but the version has no checksums
+        Corrupt,        // Checksum mismatch or truncated data
+        NotStateFile    // Unknown version byte
+    };
+
+    /**
+     * @brief Constructor
+     * @param threadCount Number of worker threads; 0 uses the hardware concurrency
+     */
+    explicit StateChecker(size_t threadCount = 0) noexcept;
+
+    /**
+     * @brief Check all state files below a directory
+     * @param root Directory to scan recursively, or a single file
+     * @return Counts, timings and problems found
+     */
+    CheckReport check(const std::filesystem::path& root) const noexcept;
+
+    /**
+     * @brief Check a sectioned state image
+     * @param bytes The whole file or store record, version 6 or later
+     * @param problem Set to a description when the image is corrupt
+     * @param sectionsVerified Incremented for every section whose checksum matched
+     * @return Intact or Unverified if the image is sound, Corrupt otherwise
+     */
+    static Status checkSectionedImage(std::span<const std::byte> bytes, std::string& problem, size_t& sectionsVerified) noexcept;
+
+    /**
+     * @brief Print a report in human-readable form
+     * @param report The report to print
+     */
+    static void printReport(const CheckReport& report) noexcept;
+
+private:
+    /**
+     * @brief Check one file
+     * @param path Path of the file
+     * @param problem Set to a description when the file is corrupt
+     * @param sectionsVerified Incremented for every section whose checksum matched
+     * @param verifyTime Set to the time spent verifying, excluding file I/O
+     * @return Outcome of the check
+     */
+    static Status checkFile(const std::filesystem::path& path, std::string& problem,
+                            size_t& sectionsVerified, std::chrono::nanoseconds& verifyTime) noexcept;
+
+    // Number of worker threads
+    size_t m_threadCount;
+};
@@ -0,0 +1,364 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include "binary_schema.h"
+#include "crc32c.h"
+
+/**
+ * @brief On-disk layout of the pet state file
+ *
+ * Version history:
+ * Version 1: Basic pet state
+ * Version 2: Added birth date and achievements
+ * Version 3: Changed stats from uint8_t to float
+ * Version 4: Changed stats from percentage to actual values
+ * Version 5: Fixed-offset header that can be read in place from a memory mapping
+ * Version 6: Sectioned container: a section table followed by independently
+ *            decodable sections (core stats, achievements, ...)
+ * Version 7: CRC32C checksums of the section table and of every section
+ *
+ * Versions 1-4 are variable-length streams read field by field.
+ * The version 5 header and all sectioned structures are described by
+ * BinarySchema schemas, which generate both the encoder and the
+ * bounds-checked decoder.
+ * Every version starts with the version byte, so readers can dispatch on it.
+ *
+ * New data is added to sectioned files as new section types rather than by
+ * bumping the version: readers skip sections they do not recognize unless
+ * the section is flagged SECTION_REQUIRED.
+ */
+namespace StateFileFormat {
+
+    // Version written by the current build
+    constexpr uint8_t CURRENT_VERSION = 7;
+
+    // Fixed-header version, still readable
+    constexpr uint8_t HEADER_V5_VERSION = 5;
+
+    // First version using the sectioned container
+    constexpr uint8_t FIRST_SECTIONED_VERSION = 6;
+
+    // First version whose section table and sections carry CRC32C checksums
+    constexpr uint8_t FIRST_CHECKSUMMED_VERSION = 7;
+
+    // Last version that uses the legacy stream layout
+    constexpr uint8_t LAST_LEGACY_VERSION = 4;
+
+    // Number of achievement progress slots reserved in the header
+    constexpr size_t MAX_ACHIEVEMENTS = 16;
+
+    /**
+     * @brief Version 5 file header
+     *
+     * In-memory form of the header. On disk, fields are packed little-endian
+     * in the order given by HEADER_SCHEMA, which matches this struct's layout.
+     * The pet name (nameLength bytes, not null-terminated) follows at headerSize.
+     */
+    struct alignas(8) HeaderV5 {
+        uint8_t version;                                  // Always HEADER_V5_VERSION; newer files are sectioned
+        uint8_t evolutionLevel;                           // EvolutionLevel value
+        uint16_t nameLength;                              // Name length in bytes
+        uint32_t headerSize;                              // Offset of the name, sizeof(HeaderV5) when written
+        uint32_t xp;
+        float hunger;
+        float happiness;
+        float energy;
+        int64_t lastInteractionSeconds;                   // Seconds since the epoch
+        int64_t birthDateSeconds;                         // Seconds since the epoch
+        uint64_t unlockedAchievements;                    // Bit per AchievementType
+        uint64_t newlyUnlockedAchievements;               // Bit per AchievementType
+        uint32_t achievementProgress[MAX_ACHIEVEMENTS];   // Indexed by AchievementType
+        uint32_t usedCommandsMask;                        // Bit per Explorer command
+        uint32_t reserved32;                              // Reserved for future use, written as zero
+        uint64_t journalSequence;                         // Journal records below this sequence are already applied
+        uint64_t reserved64;                              // Reserved for future use, written as zero
+    };
+
+    static_assert(sizeof(HeaderV5) == 144, "HeaderV5 layout must not change");
+    static_assert(offsetof(HeaderV5, xp) == 8);
+    static_assert(offsetof(HeaderV5, lastInteractionSeconds) == 24);
+    static_assert(offsetof(HeaderV5, unlockedAchievements) == 40);
+    static_assert(offsetof(HeaderV5, achievementProgress) == 56);
+    static_assert(offsetof(HeaderV5, usedCommandsMask) == 120);
+    static_assert(offsetof(HeaderV5, journalSequence) == 128);
+
+    /**
+     * @brief On-disk encoding of the header
+     *
+     * To add a field in a new version, append it with that version as
+     * sinceVersion and bump CURRENT_VERSION; older files decode with the
+     * field value-initialized.
+     */
+    inline constexpr auto HEADER_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("version", &HeaderV5::version, 5),
+        BinarySchema::field("evolutionLevel", &HeaderV5::evolutionLevel, 5),
+        BinarySchema::field("nameLength", &HeaderV5::nameLength, 5),
+        BinarySchema::field("headerSize", &HeaderV5::headerSize, 5),
+        BinarySchema::field("xp", &HeaderV5::xp, 5),
+        BinarySchema::field("hunger", &HeaderV5::hunger, 5),
+        BinarySchema::field("happiness", &HeaderV5::happiness, 5),
+        BinarySchema::field("energy", &HeaderV5::energy, 5),
+        BinarySchema::field("lastInteractionSeconds", &HeaderV5::lastInteractionSeconds, 5),
+        BinarySchema::field("birthDateSeconds", &HeaderV5::birthDateSeconds, 5),
+        BinarySchema::field("unlockedAchievements", &HeaderV5::unlockedAchievements, 5),
+        BinarySchema::field("newlyUnlockedAchievements", &HeaderV5::newlyUnlockedAchievements, 5),
+        BinarySchema::field("achievementProgress", &HeaderV5::achievementProgress, 5),
+        BinarySchema::field("usedCommandsMask", &HeaderV5::usedCommandsMask, 5),
+        BinarySchema::field("reserved32", &HeaderV5::reserved32, 5),
+        BinarySchema::field("journalSequence", &HeaderV5::journalSequence, 5),
+        BinarySchema::field("reserved64", &HeaderV5::reserved64, 5)
+    );
+
+    // The schema must reproduce the version 5 layout exactly
+    static_assert(HEADER_SCHEMA.encodedSize(5) == sizeof(HeaderV5));
+    static_assert(HEADER_SCHEMA.offsetOf("lastInteractionSeconds", 5) == offsetof(HeaderV5, lastInteractionSeconds));
+    static_assert(HEADER_SCHEMA.offsetOf("achievementProgress", 5) == offsetof(HeaderV5, achievementProgress));
+    static_assert(HEADER_SCHEMA.offsetOf("journalSequence", 5) == offsetof(HeaderV5, journalSequence));
+
+    /**
+     * @brief Decode and validate a version 5 header
+     * @param bytes The whole file or store record
+     * @param header Output header
+     * @return True if the header is complete and the name fits in bytes
+     */
+    inline bool decodeHeader(std::span<const std::byte> bytes, HeaderV5& header) noexcept {
+        if (bytes.empty() || static_cast<uint8_t>(bytes[0]) != HEADER_V5_VERSION ||
+            !HEADER_SCHEMA.decode(bytes, HEADER_V5_VERSION, header)) {
+            return false;
+        }
+
+        return header.headerSize >= HEADER_SCHEMA.encodedSize(HEADER_V5_VERSION) &&
+               bytes.size() >= static_cast<size_t>(header.headerSize) + header.nameLength;
+    }
+
+    /**
+     * @brief Header at the start of a sectioned (version 6+) file
+     */
+    struct ContainerHeader {
+        uint8_t version;                // CURRENT_VERSION when written
+        uint8_t reserved8;              // Written as zero
+        uint16_t sectionCount;          // Number of SectionEntry records that follow
+        uint32_t tableChecksum;         // CRC32C of the header and section table, zero before version 7
+    };
+
+    inline constexpr auto CONTAINER_HEADER_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("version", &ContainerHeader::version, 6),
+        BinarySchema::field("reserved8", &ContainerHeader::reserved8, 6),
+        BinarySchema::field("sectionCount", &ContainerHeader::sectionCount, 6),
+        BinarySchema::field("tableChecksum", &ContainerHeader::tableChecksum, 6)
+    );
+
+    /**
+     * @brief Known section types
+     */
+    enum class SectionType : uint16_t {
+        Core = 1,           // Name, evolution level, XP, stats, timestamps
+        Achievements = 2    // Unlocked bits, progress, Explorer commands
+    };
+
+    // Readers must fail instead of skipping this section if they do not know its type
+    constexpr uint16_t SECTION_REQUIRED = 0x0001;
+
+    /**
+     * @brief Section table entry
+     */
+    struct SectionEntry {
+        uint16_t type;                  // SectionType value
+        uint16_t flags;                 // SECTION_* flags
+        uint32_t offset;                // Offset of the section from the start of the file
+        uint32_t length;                // Length of the section in bytes
+        uint32_t checksum;              // CRC32C of the section bytes, zero before version 7
+    };
+
+    inline constexpr auto SECTION_ENTRY_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("type", &SectionEntry::type, 6),
+        BinarySchema::field("flags", &SectionEntry::flags, 6),
+        BinarySchema::field("offset", &SectionEntry::offset, 6),
+        BinarySchema::field("length", &SectionEntry::length, 6),
+        BinarySchema::field("checksum", &SectionEntry::checksum, 6)
+    );
+
+    /**
+     * @brief Core section: everything needed to show a pet's status
+     *
+     * The pet name (nameLength bytes) follows the encoded fields.
+     */
+    struct CoreSection {
+        uint8_t evolutionLevel;
+        uint8_t reserved8;
+        uint16_t nameLength;
+        uint32_t xp;
+        float hunger;
+        float happiness;
+        float energy;
+        uint32_t reserved32;
+        int64_t lastInteractionSeconds;
+        int64_t birthDateSeconds;
+        uint64_t journalSequence;
+    };
+
+    inline constexpr auto CORE_SECTION_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("evolutionLevel", &CoreSection::evolutionLevel, 6),
+        BinarySchema::field("reserved8", &CoreSection::reserved8, 6),
+        BinarySchema::field("nameLength", &CoreSection::nameLength, 6),
+        BinarySchema::field("xp", &CoreSection::xp, 6),
+        BinarySchema::field("hunger", &CoreSection::hunger, 6),
+        BinarySchema::field("happiness", &CoreSection::happiness, 6),
+        BinarySchema::field("energy", &CoreSection::energy, 6),
+        BinarySchema::field("reserved32", &CoreSection::reserved32, 6),
+        BinarySchema::field("lastInteractionSeconds", &CoreSection::lastInteractionSeconds, 6),
+        BinarySchema::field("birthDateSeconds", &CoreSection::birthDateSeconds, 6),
+        BinarySchema::field("journalSequence", &CoreSection::journalSequence, 6)
+    );
+
+    /**
+     * @brief Achievements section
+     */
+    struct AchievementSection {
+        uint64_t unlockedAchievements;                    // Bit per AchievementType
+        uint64_t newlyUnlockedAchievements;               // Bit per AchievementType
+        uint32_t achievementProgress[MAX_ACHIEVEMENTS];   // Indexed by AchievementType
+        uint32_t usedCommandsMask;                        // Bit per Explorer command
+        uint32_t reserved32;                              // Written as zero
+    };
+
+    inline constexpr auto ACHIEVEMENT_SECTION_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("unlockedAchievements", &AchievementSection::unlockedAchievements, 6),
+        BinarySchema::field("newlyUnlockedAchievements", &AchievementSection::newlyUnlockedAchievements, 6),
+        BinarySchema::field("achievementProgress", &AchievementSection::achievementProgress, 6),
+        BinarySchema::field("usedCommandsMask", &AchievementSection::usedCommandsMask, 6),
+        BinarySchema::field("reserved32", &AchievementSection::reserved32, 6)
+    );
+
+    /**
+     * @brief Compute the checksum of the header and section table
+     *
+     * Covers every byte from the start of the file to the end of the
+     * section table, except the tableChecksum field itself.
+     *
+     * @param bytes The whole file or store record
+     * @param tableEnd Offset of the end of the section table
+     * @return CRC32C of the covered bytes
+     */
+    inline uint32_t computeTableChecksum(std::span<const std::byte> bytes, size_t tableEnd) noexcept {
+        constexpr size_t checksumOffset = CONTAINER_HEADER_SCHEMA.offsetOf("tableChecksum", CURRENT_VERSION);
+        constexpr size_t headerSize = CONTAINER_HEADER_SCHEMA.encodedSize(CURRENT_VERSION);
+        uint32_t crc = Crc32c::compute(bytes.first(checksumOffset));
+        return Crc32c::compute(bytes.subspan(headerSize, tableEnd - headerSize), crc);
+    }
+
+    /**
+     * @brief Check a section against its checksum
+     * @param bytes The whole file or store record
+     * @param entry Section table entry, already validated by decodeSectionTable()
+     * @param version Format version of bytes
+     * @return True if the section is intact or the version has no checksums
+     */
+    inline bool verifySection(std::span<const std::byte> bytes, const SectionEntry& entry, uint8_t version) noexcept {
+        return version < FIRST_CHECKSUMMED_VERSION ||
+               Crc32c::compute(bytes.subspan(entry.offset, entry.length)) == entry.checksum;
+    }
+
+    /**
+     * @brief A section to be written by encodeSections()
+     */
+    struct SectionPayload {
+        uint16_t type;
+        uint16_t flags;
+        std::span<const std::byte> bytes;
+    };
+
+    /**
+     * @brief Build a sectioned file image in one buffer
+     * @param sections Sections in the order they should be stored
+     * @return The encoded image
+     */
+    inline std::vector<std::byte> encodeSections(std::span<const SectionPayload> sections) {
+        constexpr size_t headerSize = CONTAINER_HEADER_SCHEMA.encodedSize(CURRENT_VERSION);
+        constexpr size_t entrySize = SECTION_ENTRY_SCHEMA.encodedSize(CURRENT_VERSION);
+
+        size_t totalSize = headerSize + entrySize * sections.size();
+        for (const auto& section : sections) {
+            totalSize += section.bytes.size();
+        }
+
+        std::vector<std::byte> image(totalSize);
+        ContainerHeader header{ CURRENT_VERSION, 0, static_cast<uint16_t>(sections.size()), 0 };
+        CONTAINER_HEADER_SCHEMA.encode(header, CURRENT_VERSION, image);
+
+        size_t entryOffset = headerSize;
+        size_t dataOffset = headerSize + entrySize * sections.size();
+        for (const auto& section : sections) {
+            SectionEntry entry{ section.type, section.flags, static_cast<uint32_t>(dataOffset),
+                                static_cast<uint32_t>(section.bytes.size()), Crc32c::compute(section.bytes) };
+            SECTION_ENTRY_SCHEMA.encode(entry, CURRENT_VERSION, std::span(image).subspan(entryOffset));
+            std::copy(section.bytes.begin(), section.bytes.end(), image.begin() + static_cast<std::ptrdiff_t>(dataOffset));
+            entryOffset += entrySize;
+            dataOffset += section.bytes.size();
+        }
+
+        header.tableChecksum = computeTableChecksum(image, entryOffset);
+        CONTAINER_HEADER_SCHEMA.encode(header, CURRENT_VERSION, image);
+        return image;
+    }
+
+    /**
+     * @brief Decode and validate the section table of a sectioned file
+     * @param bytes The whole file or store record
+     * @param entries Output section table
+     * @return True if the header is valid, the table matches its checksum
+     *         and every section lies within bytes
+     */
+    inline bool decodeSectionTable(std::span<const std::byte> bytes, std::vector<SectionEntry>& entries) {
+        ContainerHeader header;
+        if (bytes.empty()) {
+            return false;
+        }
+
+        auto version = static_cast<uint8_t>(bytes[0]);
+        if (version < FIRST_SECTIONED_VERSION || version > CURRENT_VERSION ||
+            !CONTAINER_HEADER_SCHEMA.decode(bytes, version, header)) {
+            return false;
+        }
+
+        size_t headerSize = CONTAINER_HEADER_SCHEMA.encodedSize(version);
+        size_t entrySize = SECTION_ENTRY_SCHEMA.encodedSize(version);
+        size_t tableEnd = headerSize + entrySize * header.sectionCount;
+        if (bytes.size() < tableEnd) {
+            return false;
+        }
+
+        if (version >= FIRST_CHECKSUMMED_VERSION && computeTableChecksum(bytes, tableEnd) != header.tableChecksum) {
+            return false;
+        }
+
+        entries.resize(header.sectionCount);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            SECTION_ENTRY_SCHEMA.decode(bytes.subspan(headerSize + i * entrySize), version, entries[i]);
+            if (entries[i].offset > bytes.size() || entries[i].length > bytes.size() - entries[i].offset) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Find a section in a decoded section table
+     * @param entries Section table
+     * @param type Section type to look for
+     * @return The first entry of that type, or std::nullopt
+     */
+    inline std::optional<SectionEntry> findSection(std::span<const SectionEntry> entries, SectionType type) noexcept {
+        for (const auto& entry : entries) {
+            if (entry.type == static_cast<uint16_t>(type)) {
+                return entry;
+            }
+        }
+        return std::nullopt;
+    }
+}
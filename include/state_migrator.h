@@ -0,0 +1,80 @@
+#pragma once
+
+#include "atomic_file_writer.h"
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <filesystem>
+
+/**
+ * @brief Result of a bulk migration run
+ */
+struct MigrationReport {
+    // Regular files visited
+    size_t scanned = 0;
+
+    // Legacy files rewritten in the current format
+    size_t migrated = 0;
+
+    // Files already in the current format
+    size_t upToDate = 0;
+
+    // Files that are not pet state files
+    size_t ignored = 0;
+
+    // Legacy files that could not be migrated; left untouched
+    size_t failed = 0;
+
+    // Total size of the migrated files before rewriting
+    uint64_t bytesMigrated = 0;
+
+    // Wall-clock duration of the run
+    std::chrono::duration<double> elapsed{0};
+
+    // Path and reason of every failure
+    std::vector<std::pair<std::filesystem::path, std::string>> failures;
+};
+
+/**
+ * @brief Upgrades every legacy state file in a directory tree to the current format
+ *
+ * Files are recognized with PetState::peekFileVersion(), which checks the
+ * header of version 5+ files and fully parses legacy ones; anything else
+ * is counted as ignored and left alone. Versions older than the current
+ * one are loaded (replaying any journal next to them) and saved
+ * back in place through the atomic writer, so an interrupted run leaves
+ * each file either fully old or fully new. Files already in the current
+ * format are skipped, which makes rerunning after an interruption cheap.
+ */
+class StateMigrator {
+public:
+    /**
+     * @brief Constructor
+     * @param threadCount Number of worker threads; 0 uses the hardware concurrency
+     * @param policy Durability policy for the rewritten files
+     */
+    explicit StateMigrator(size_t threadCount = 0, DurabilityPolicy policy = DurabilityPolicy::always()) noexcept;
+
+    /**
+     * @brief Migrate all state files below a directory
+     * @param root Directory to scan recursively, or a single file
+     * @return Counts, throughput figures and failures of the run
+     */
+    MigrationReport migrate(const std::filesystem::path& root) const noexcept;
+
+    /**
+     * @brief Print a report in human-readable form
+     * @param report The report to print
+     */
+    static void printReport(const MigrationReport& report) noexcept;
+
+private:
+    // Number of worker threads
+    size_t m_threadCount;
+
+    // Durability policy for the rewritten files
+    DurabilityPolicy m_policy;
+};
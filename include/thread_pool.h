@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * @brief Fixed-size pool of worker threads consuming a shared task queue
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Constructor, starts the worker threads
+     * @param threadCount Number of workers; 0 uses the hardware concurrency
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * @brief Destructor, finishes queued tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a task
+     * @param task The task to run on a worker thread; must not throw
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Wait until the queue is empty and no task is running
+     */
+    void wait();
+
+    /**
+     * @brief Get the number of worker threads
+     * @return Number of workers
+     */
+    size_t getThreadCount() const noexcept { return m_workers.size(); }
+
+private:
+    /**
+     * @brief Worker thread main loop
+     */
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_idle;
+
+    // Tasks currently executing
+    size_t m_running = 0;
+
+    // Set by the destructor to stop the workers
+    bool m_stopping = false;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <vector>
+#include "achievement_system.h"
+#include "pet_population.h"
+#include "work_stealing_pool.h"
+
+/**
+ * @brief Something that happened to a pet during a tick
+ */
+struct TickEvent {
+    enum class Type : uint8_t {
+        Evolved,                // value is the new EvolutionLevel
+        AchievementUnlocked     // value is the AchievementType
+    };
+
+    // Index of the pet in the population
+    uint32_t petIndex;
+
+    Type type;
+    uint8_t value;
+};
+
+/**
+ * @brief Result of one tick over a population
+ */
+struct TickReport {
+    // Pets whose elapsed time was applied
+    size_t updated = 0;
+
+    // Events of every pet, ordered by pet index
+    std::vector<TickEvent> events;
+
+    // Wall-clock duration of the tick
+    std::chrono::duration<double> elapsed{0};
+};
+
+/**
+ * @brief Advances time for a whole population in parallel
+ *
+ * The population is split into chunks whose columns all start on a cache
+ * line, so no two threads ever write the same line. Chunks run on a
+ * WorkStealingPool: each one applies the batch time decay, unlocks
+ * FullyRested for pets whose energy reached the maximum, and evolves pets
+ * with enough XP, as PetState::applyElapsedTime() and PetState::addXP()
+ * would. Each worker collects events and the change to the population's
+ * aggregates in its own buffer; the buffers are merged once all chunks are
+ * done.
+ */
+class TickEngine {
+public:
+    // Chunk sizes are a multiple of this many pets; one cache line of the narrowest column
+    static constexpr size_t CHUNK_GRANULE = PetPopulation::COLUMN_ALIGNMENT;
+
+    // Pets per chunk by default
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+
+    /**
+     * @brief Constructor
+     * @param threadCount Number of worker threads; 0 uses the hardware concurrency
+     * @param chunkSize Pets per chunk, rounded up to a multiple of CHUNK_GRANULE
+     */
+    explicit TickEngine(size_t threadCount = 0, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    /**
+     * @brief Apply the time passed up to now to every pet
+     * @param population The pets to update
+     * @param now Current time, shared by all pets
+     * @return Counts, events and timing
+     */
+    TickReport tick(PetPopulation& population, std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Get the number of worker threads
+     * @return Number of workers
+     */
+    size_t getThreadCount() const noexcept { return m_pool.getThreadCount(); }
+
+    /**
+     * @brief Get the number of pets per chunk
+     * @return Chunk size
+     */
+    size_t getChunkSize() const noexcept { return m_chunkSize; }
+
+    /**
+     * @brief Get the number of chunks moved between workers to balance load
+     * @return Steal count, summed over all ticks
+     */
+    uint64_t getStealCount() const noexcept { return m_pool.getStealCount(); }
+
+private:
+    /**
+     * @brief Output of one worker, padded so workers never share a cache line
+     */
+    struct alignas(64) WorkerOutput {
+        size_t updated = 0;
+        std::vector<TickEvent> events;
+
+        // Change to the population's aggregates
+        PopulationAggregates aggregates;
+    };
+
+    /**
+     * @brief Tick the pets [begin, end) of a population
+     */
+    static void tickChunk(PetPopulation& population, size_t begin, size_t end, int64_t nowSeconds,
+                          WorkerOutput& output);
+
+    WorkStealingPool m_pool;
+    size_t m_chunkSize;
+
+    // One output per worker, reused across ticks
+    std::vector<WorkerOutput> m_outputs;
+};
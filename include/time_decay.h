@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+/**
+ * @brief Time effects applied to whole columns of pets at once
+ *
+ * The batch kernel uses AVX2 or SSE4.2 when the CPU supports them and a
+ * scalar loop otherwise. Every implementation performs the same operations
+ * as PetState::applyElapsedTime() in the same precision, so all of them
+ * produce bit-identical stats.
+ */
+namespace TimeDecay {
+
+    /**
+     * @brief The stats time acts on
+     */
+    struct Stats {
+        float hunger;
+        float happiness;
+        float energy;
+    };
+
+    /**
+     * @brief Compute stats after some time away from the pet
+     *
+     * Hunger and happiness fall and energy rises linearly, clamped to zero
+     * and maxStat. A pure function of its arguments, used both to evaluate
+     * stats on read and to apply them.
+     *
+     * @param stats Stats at the start of the period
+     * @param maxStat Maximum stat for the pet's evolution level
+     * @param hoursPassed Length of the period in hours
+     * @return Stats at the end of the period
+     */
+    Stats applyHours(const Stats& stats, float maxStat, double hoursPassed) noexcept;
+
+    /**
+     * @brief Columns read and updated by the kernel, all of the same length
+     */
+    struct Columns {
+        std::span<float> hunger;
+        std::span<float> happiness;
+        std::span<float> energy;
+        std::span<const uint8_t> evolutionLevels;
+        std::span<int64_t> lastInteractionSeconds;  // Seconds since the epoch, 0 if never
+    };
+
+    /**
+     * @brief Apply the time passed since each pet's last interaction
+     *
+     * Pets that never interacted, or whose last interaction is less than
+     * GameConfig::Time::MIN_TIME_THRESHOLD ago, are left untouched. The
+     * others lose hunger and happiness, gain energy capped at the maximum
+     * for their evolution level, and have their interaction time set to now.
+     *
+     * @param columns The pets to update
+     * @param nowSeconds Current time in seconds since the epoch, shared by all pets
+     * @return Number of pets updated
+     */
+    size_t applyTimeEffectsBatch(const Columns& columns, int64_t nowSeconds) noexcept;
+
+    /**
+     * @brief Implementations of the batch kernel
+     */
+    enum class Kernel : uint8_t {
+        Portable,   // Scalar loop, runs everywhere
+        Sse42,
+        Avx2
+    };
+
+    /**
+     * @brief Check whether a kernel can run on this CPU
+     * @param kernel The kernel
+     * @return True if the CPU supports the kernel's instructions
+     */
+    bool isKernelSupported(Kernel kernel) noexcept;
+
+    /**
+     * @brief Apply time effects with a specific kernel, as applyTimeEffectsBatch() would
+     *
+     * Lets benchmarks and tests compare the kernels on the same columns.
+     * A kernel the CPU does not support falls back to the portable one.
+     *
+     * @param kernel The kernel to use
+     * @param columns The pets to update
+     * @param nowSeconds Current time in seconds since the epoch, shared by all pets
+     * @return Number of pets updated
+     */
+    size_t applyTimeEffectsWith(Kernel kernel, const Columns& columns, int64_t nowSeconds) noexcept;
+
+    /**
+     * @brief Get the name of a kernel
+     * @return "avx2", "sse4.2" or "portable"
+     */
+    const char* getKernelName(Kernel kernel) noexcept;
+
+    /**
+     * @brief Get the name of the implementation applyTimeEffectsBatch() uses
+     * @return "avx2", "sse4.2" or "portable"
+     */
+    const char* getImplementationName() noexcept;
+}
@@ -20,12 +20,23 @@ public:
      * @brief Apply time-based effects to the pet
      * 
      * This method calculates how much time has passed since the last interaction
-     * and applies appropriate effects (hunger decrease, etc.)
+     * and applies appropriate effects (hunger decrease, etc.). Only needed before
+     * an interaction changes the stats; use describeTimeEffects() to report them.
      * 
      * @return Optional string with a message about significant time passing
      */
     std::optional<std::string> applyTimeEffects() noexcept;
 
+    /**
+     * @brief Describe the time passed since the last interaction without applying it
+     * 
+     * The pet's getters already include the decay, so read-only commands
+     * use this and leave the state unmodified.
+     * 
+     * @return Optional string with a message about significant time passing
+     */
+    std::optional<std::string> describeTimeEffects() const noexcept;
+
     /**
      * @brief Format time since last interaction
      * @param now Current time
@@ -41,6 +52,13 @@ public:
     std::string formatPetAge(const std::chrono::system_clock::time_point& now) const noexcept;
 
 private:
+    /**
+     * @brief Build the message about time passing
+     * @param hoursPassed Hours since the last interaction
+     * @return Optional string if the time passed is significant
+     */
+    std::optional<std::string> formatTimeEffectsMessage(double hoursPassed) const noexcept;
+
     // Reference to the pet state
     PetState& m_petState;
 };
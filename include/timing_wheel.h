@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <functional>
+
+/**
+ * @brief Hierarchical timing wheel with one-second resolution
+ *
+ * Holds at most one timer per ID. Level 0 has one slot per second; each
+ * higher level has slots SLOT_COUNT times wider, and its timers are
+ * cascaded down as time reaches them. Timers beyond the last level wait
+ * in an overflow list until the top level wraps.
+ *
+ * Scheduling and cancelling are O(1). Advancing fires each timer in O(1)
+ * amortized and skips empty stretches of time using a bitmap of occupied
+ * slots per level, so its cost does not depend on the time elapsed.
+ */
+class TimingWheel {
+public:
+    // Bits of the time each level indexes
+    static constexpr unsigned SLOT_BITS = 6;
+
+    // Slots per level
+    static constexpr size_t SLOT_COUNT = size_t{1} << SLOT_BITS;
+
+    // Levels before the overflow list; 4 levels span about 194 days
+    static constexpr size_t LEVEL_COUNT = 4;
+
+    // Called with the ID and scheduled time of every timer that fires
+    using Callback = std::function<void(uint32_t id, int64_t when)>;
+
+    /**
+     * @brief Constructor
+     * @param now Current time in seconds; timers at or before it fire on the next advance()
+     */
+    explicit TimingWheel(int64_t now = 0) noexcept;
+
+    /**
+     * @brief Schedule a timer, replacing any timer with the same ID
+     * @param id Timer ID; IDs should be small and dense, such as pet indices
+     * @param when Time in seconds to fire at
+     */
+    void schedule(uint32_t id, int64_t when);
+
+    /**
+     * @brief Cancel a timer
+     * @param id Timer ID
+     * @return True if the timer was scheduled
+     */
+    bool cancel(uint32_t id) noexcept;
+
+    /**
+     * @brief Check if a timer is scheduled
+     * @param id Timer ID
+     * @return True if the timer has not fired or been cancelled
+     */
+    bool isScheduled(uint32_t id) const noexcept {
+        return id < m_nodes.size() && m_nodes[id].list != NO_LIST;
+    }
+
+    /**
+     * @brief Get the number of scheduled timers
+     * @return Timer count
+     */
+    size_t size() const noexcept { return m_size; }
+
+    /**
+     * @brief Get the time the wheel has advanced to
+     * @return Time in seconds
+     */
+    int64_t getCurrentTime() const noexcept { return m_now; }
+
+    /**
+     * @brief Advance time, firing every timer scheduled at or before now
+     *
+     * Timers fire in time order, and each is removed before its callback
+     * runs, so the callback may schedule it again. Timers scheduled at or
+     * before now from a callback fire in the same call.
+     *
+     * @param now New current time in seconds; earlier times are ignored
+     * @param fire Callback for each timer that fires
+     * @return Number of timers fired
+     */
+    size_t advance(int64_t now, const Callback& fire);
+
+private:
+    // Marks the end of a list and unscheduled nodes
+    static constexpr uint32_t NO_LIST = UINT32_MAX;
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    // List indices after the wheel slots
+    static constexpr uint32_t OVERFLOW_LIST = static_cast<uint32_t>(LEVEL_COUNT * SLOT_COUNT);
+    static constexpr uint32_t DUE_LIST = OVERFLOW_LIST + 1;
+    static constexpr size_t LIST_COUNT = DUE_LIST + 1;
+
+    /**
+     * @brief A timer, linked into the list of its slot
+     */
+    struct Node {
+        int64_t when = 0;
+        uint32_t prev = NO_NODE;
+        uint32_t next = NO_NODE;
+        uint32_t list = NO_LIST;
+    };
+
+    /**
+     * @brief Get the list a timer belongs in relative to the current time
+     */
+    uint32_t listFor(int64_t when) const noexcept;
+
+    /**
+     * @brief Link a node at the head of a list
+     */
+    void link(uint32_t id, uint32_t list) noexcept;
+
+    /**
+     * @brief Unlink a node from its list
+     */
+    void unlink(uint32_t id) noexcept;
+
+    /**
+     * @brief Get the next second at which a timer fires or cascades
+     * @return Time in seconds, after the current time
+     */
+    int64_t nextEventTime() const noexcept;
+
+    /**
+     * @brief Re-insert every timer of a list relative to the current time
+     */
+    void cascade(uint32_t list) noexcept;
+
+    /**
+     * @brief Fire every timer of a list, including ones the callbacks make due
+     */
+    size_t fireList(uint32_t list, const Callback& fire);
+
+    // Timers indexed by ID
+    std::vector<Node> m_nodes;
+
+    // Head node of every slot, the overflow list and the due list
+    std::array<uint32_t, LIST_COUNT> m_heads;
+
+    // Bit per slot of each level, set while the slot holds timers
+    std::array<uint64_t, LEVEL_COUNT> m_occupiedSlots{};
+
+    // Last second processed
+    int64_t m_now;
+
+    // Number of scheduled timers
+    size_t m_size = 0;
+};
@@ -23,13 +23,15 @@ public:
      * @param achievementManager Reference to the achievement manager
      * @param interactionManager Reference to the interaction manager
      * @param timeManager Reference to the time manager
+     * @param out Stream the interface is written to
      */
     UIManager(
         PetState& petState,
         DisplayManager& displayManager,
         AchievementManager& achievementManager,
         InteractionManager& interactionManager,
-        TimeManager& timeManager
+        TimeManager& timeManager,
+        std::ostream& out = std::cout
     ) noexcept;
 
     /**
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * @brief Pool of worker threads running indexed tasks with work stealing
+ *
+ * parallelFor() splits the task indices into one contiguous range per
+ * worker. Each worker takes tasks from the front of its own range; once it
+ * runs dry it steals the back half of another worker's range. A range is
+ * a single atomic word, so taking and stealing are lock-free compare-and-
+ * swaps and neighbouring tasks stay on the same thread unless load is
+ * uneven. The calling thread takes part as worker 0.
+ */
+class WorkStealingPool {
+public:
+    // Called with the task index and the index of the worker running it
+    using Task = std::function<void(size_t task, size_t worker)>;
+
+    /**
+     * @brief Constructor, starts the worker threads
+     * @param threadCount Number of workers including the caller; 0 uses the hardware concurrency
+     */
+    explicit WorkStealingPool(size_t threadCount = 0);
+
+    /**
+     * @brief Destructor, joins the worker threads
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Run a task for every index and wait for all of them
+     *
+     * Not reentrant: tasks must not call parallelFor() on the same pool.
+     *
+     * @param taskCount Number of tasks, less than 2^32
+     * @param task The task; must not throw
+     */
+    void parallelFor(size_t taskCount, const Task& task);
+
+    /**
+     * @brief Get the number of workers, including the calling thread
+     * @return Number of workers
+     */
+    size_t getThreadCount() const noexcept { return m_ranges.size(); }
+
+    /**
+     * @brief Get the number of tasks taken from another worker's range
+     * @return Steal count, summed over all parallelFor() calls
+     */
+    uint64_t getStealCount() const noexcept { return m_steals.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Unclaimed task indices of one worker, packed as begin << 32 | end
+     *
+     * Padded to a cache line so workers taking from their own ranges do
+     * not contend.
+     */
+    struct alignas(64) Range {
+        std::atomic<uint64_t> bounds{0};
+    };
+
+    static constexpr uint64_t pack(uint32_t begin, uint32_t end) noexcept {
+        return (static_cast<uint64_t>(begin) << 32) | end;
+    }
+
+    /**
+     * @brief Worker thread main loop
+     */
+    void workerLoop(size_t worker);
+
+    /**
+     * @brief Run tasks until no worker has any left
+     */
+    void runTasks(size_t worker);
+
+    /**
+     * @brief Take the first task of a worker's own range
+     * @return True if a task was taken
+     */
+    bool takeOwn(size_t worker, uint32_t& task) noexcept;
+
+    /**
+     * @brief Move half of another worker's range into this worker's range
+     * @return True if anything was stolen
+     */
+    bool steal(size_t worker) noexcept;
+
+    // One range per worker, sized once by the constructor
+    std::vector<Range> m_ranges;
+    std::vector<std::thread> m_threads;
+
+    // The task of the current parallelFor() call
+    const Task* m_task = nullptr;
+
+    std::mutex m_mutex;
+    std::condition_variable m_started;
+    std::condition_variable m_finished;
+
+    // Incremented for every parallelFor() call to wake the workers
+    uint64_t m_generation = 0;
+
+    // Threads still running tasks of the current call
+    size_t m_active = 0;
+
+    // Set by the destructor to stop the workers
+    bool m_stopping = false;
+
+    std::atomic<uint64_t> m_steals{0};
+};
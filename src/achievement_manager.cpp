@@ -3,8 +3,9 @@
 #include <algorithm>
 #include <cmath>
 
-AchievementManager::AchievementManager(PetState& petState) noexcept
+AchievementManager::AchievementManager(PetState& petState, std::ostream& out) noexcept
     : m_petState(petState)
+    , m_out(out)
 {
 }
 
@@ -14,14 +15,14 @@ bool AchievementManager::displayAchievements(bool newlyUnlocked) const noexcept
     
     if (unlockedAchievements.empty()) {
         if (!newlyUnlocked) {
-            std::cout << "\nNo achievements unlocked yet." << std::endl;
+            m_out << "\nNo achievements unlocked yet." << std::endl;
         }
         return false;
     }
     
-    std::cout << "\nAchievements:" << std::endl;
+    m_out << "\nAchievements:" << std::endl;
     for (const auto& achievement : unlockedAchievements) {
-        std::cout << "  - " << AchievementSystem::getName(achievement) 
+        m_out << "  - " << AchievementSystem::getName(achievement) 
                 << ": " << AchievementSystem::getDescription(achievement) << std::endl;
     }
     
@@ -35,7 +36,7 @@ bool AchievementManager::displayNewlyUnlockedAchievements() noexcept {
     bool hasDisplayed = false;
     for (const auto& achievement : newlyUnlocked) {
         if (achievement != AchievementType::FirstSteps) { // First Steps is handled separately
-            std::cout << "\nAchievement unlocked: " 
+            m_out << "\nAchievement unlocked: " 
                     << AchievementSystem::getName(achievement) 
                     << "!" << std::endl;
             hasDisplayed = true;
@@ -50,10 +51,10 @@ void AchievementManager::showAllAchievements() const noexcept {
     const auto& achievementSystem = m_petState.getAchievementSystem();
     auto unlockedAchievements = achievementSystem.getUnlockedAchievements();
     
-    std::cout << "\n===== ACHIEVEMENTS =====\n" << std::endl;
+    m_out << "\n===== ACHIEVEMENTS =====\n" << std::endl;
     
     // First show locked achievements with progress
-    std::cout << "LOCKED ACHIEVEMENTS:" << std::endl;
+    m_out << "LOCKED ACHIEVEMENTS:" << std::endl;
     
     bool hasLockedAchievements = false;
     
@@ -61,7 +62,7 @@ void AchievementManager::showAllAchievements() const noexcept {
     if (std::find(unlockedAchievements.begin(), unlockedAchievements.end(), AchievementType::Playful) 
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::Playful) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::Playful) 
                 << ": " << AchievementSystem::getDescription(AchievementType::Playful) 
                 << " (" << achievementSystem.getProgress(AchievementType::Playful) 
                 << "/" << AchievementSystem::getRequiredProgress(AchievementType::Playful) << ")" << std::endl;
@@ -72,7 +73,7 @@ void AchievementManager::showAllAchievements() const noexcept {
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
         auto currentLevel = static_cast<int>(m_petState.getEvolutionLevel());
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::Evolution) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::Evolution) 
                 << ": " << AchievementSystem::getDescription(AchievementType::Evolution) 
                 << " (Level " << currentLevel << "/6)" << std::endl;
     }
@@ -82,7 +83,7 @@ void AchievementManager::showAllAchievements() const noexcept {
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
         auto currentLevel = static_cast<int>(m_petState.getEvolutionLevel());
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::Master) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::Master) 
                 << ": " << AchievementSystem::getDescription(AchievementType::Master) 
                 << " (Level " << currentLevel << "/5)" << std::endl;
     }
@@ -92,7 +93,7 @@ void AchievementManager::showAllAchievements() const noexcept {
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
         auto currentLevel = static_cast<int>(m_petState.getEvolutionLevel());
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::Eternal) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::Eternal) 
                 << ": " << AchievementSystem::getDescription(AchievementType::Eternal) 
                 << " (Level " << currentLevel << "/6)" << std::endl;
     }
@@ -102,7 +103,7 @@ void AchievementManager::showAllAchievements() const noexcept {
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
         auto currentHungerPercent = static_cast<int>((m_petState.getHunger() / m_petState.getMaxStatValue()) * 100.0f);
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::WellFed) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::WellFed) 
                 << ": " << AchievementSystem::getDescription(AchievementType::WellFed) 
                 << " (" << currentHungerPercent << "/100)" << std::endl;
     }
@@ -112,7 +113,7 @@ void AchievementManager::showAllAchievements() const noexcept {
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
         auto currentHappinessPercent = static_cast<int>((m_petState.getHappiness() / m_petState.getMaxStatValue()) * 100.0f);
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::HappyDays) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::HappyDays) 
                 << ": " << AchievementSystem::getDescription(AchievementType::HappyDays) 
                 << " (" << currentHappinessPercent << "/100)" << std::endl;
     }
@@ -122,7 +123,7 @@ void AchievementManager::showAllAchievements() const noexcept {
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
         auto currentEnergyPercent = static_cast<int>((m_petState.getEnergy() / m_petState.getMaxStatValue()) * 100.0f);
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::FullyRested) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::FullyRested) 
                 << ": " << AchievementSystem::getDescription(AchievementType::FullyRested) 
                 << " (" << currentEnergyPercent << "/100)" << std::endl;
     }
@@ -131,7 +132,7 @@ void AchievementManager::showAllAchievements() const noexcept {
     if (std::find(unlockedAchievements.begin(), unlockedAchievements.end(), AchievementType::Dedicated) 
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::Dedicated) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::Dedicated) 
                 << ": " << AchievementSystem::getDescription(AchievementType::Dedicated) 
                 << " (" << achievementSystem.getProgress(AchievementType::Dedicated) 
                 << "/" << AchievementSystem::getRequiredProgress(AchievementType::Dedicated) << ")" << std::endl;
@@ -141,7 +142,7 @@ void AchievementManager::showAllAchievements() const noexcept {
     if (std::find(unlockedAchievements.begin(), unlockedAchievements.end(), AchievementType::Explorer) 
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::Explorer) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::Explorer) 
                 << ": " << AchievementSystem::getDescription(AchievementType::Explorer) 
                 << " (" << achievementSystem.getProgress(AchievementType::Explorer) 
                 << "/" << AchievementSystem::getRequiredProgress(AchievementType::Explorer) << ")" << std::endl;
@@ -151,24 +152,24 @@ void AchievementManager::showAllAchievements() const noexcept {
     if (std::find(unlockedAchievements.begin(), unlockedAchievements.end(), AchievementType::Survivor) 
         == unlockedAchievements.end()) {
         hasLockedAchievements = true;
-        std::cout << "  - " << AchievementSystem::getName(AchievementType::Survivor) 
+        m_out << "  - " << AchievementSystem::getName(AchievementType::Survivor) 
                 << ": " << AchievementSystem::getDescription(AchievementType::Survivor) 
                 << " (" << achievementSystem.getProgress(AchievementType::Survivor) 
                 << "/" << AchievementSystem::getRequiredProgress(AchievementType::Survivor) << ")" << std::endl;
     }
     
     if (!hasLockedAchievements) {
-        std::cout << "  None - You've unlocked all achievements!" << std::endl;
+        m_out << "  None - You've unlocked all achievements!" << std::endl;
     }
     
     // Then show unlocked achievements
-    std::cout << "\nUNLOCKED ACHIEVEMENTS:" << std::endl;
+    m_out << "\nUNLOCKED ACHIEVEMENTS:" << std::endl;
     
     if (unlockedAchievements.empty()) {
-        std::cout << "  None yet. Keep playing!" << std::endl;
+        m_out << "  None yet. Keep playing!" << std::endl;
     } else {
         for (const auto& achievement : unlockedAchievements) {
-            std::cout << "  - " << AchievementSystem::getName(achievement) 
+            m_out << "  - " << AchievementSystem::getName(achievement) 
                     << ": " << AchievementSystem::getDescription(achievement) << std::endl;
         }
     }
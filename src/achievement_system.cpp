@@ -1,14 +1,14 @@
 #include "../include/achievement_system.h"
 #include <iostream>
 #include <algorithm>
-#include <set>
+#include <bit>
 #include <string>
 
 AchievementSystem::AchievementSystem() noexcept
     : m_unlockedAchievements(0), 
       m_newlyUnlockedAchievements(0),
       m_progress{},
-      m_usedCommands{}
+      m_usedCommandsMask(0)
 {
     // Initialize progress array to zeros
     std::fill(m_progress.begin(), m_progress.end(), 0);
@@ -38,6 +38,7 @@ bool AchievementSystem::unlock(AchievementType type) noexcept {
     // Unlock the achievement
     m_unlockedAchievements.set(index);
     m_newlyUnlockedAchievements.set(index);
+    m_dirty = true;
     
     return true;
 }
@@ -83,12 +84,16 @@ std::vector<AchievementType> AchievementSystem::getNewlyUnlockedAchievements() n
 }
 
 void AchievementSystem::clearNewlyUnlocked() noexcept {
-    m_newlyUnlockedAchievements.reset();
+    if (m_newlyUnlockedAchievements.any()) {
+        m_newlyUnlockedAchievements.reset();
+        m_dirty = true;
+    }
 }
 
 void AchievementSystem::setUnlockedBitset(const std::bitset<64>& bitset) noexcept {
     m_unlockedAchievements = bitset;
     m_newlyUnlockedAchievements.reset(); // Clear newly unlocked tracking when setting from saved state
+    m_dirty = true;
 }
 
 void AchievementSystem::incrementProgress(AchievementType type, uint32_t amount) noexcept {
@@ -103,6 +108,7 @@ void AchievementSystem::incrementProgress(AchievementType type, uint32_t amount)
     
     size_t index = static_cast<size_t>(type);
     m_progress[index] += amount;
+    m_dirty = true;
     
     // Check if we've reached the required progress
     if (m_progress[index] >= ACHIEVEMENT_REQUIRED_PROGRESS[index]) {
@@ -121,7 +127,10 @@ void AchievementSystem::setProgress(AchievementType type, uint32_t progress) noe
     }
     
     size_t index = static_cast<size_t>(type);
-    m_progress[index] = progress;
+    if (m_progress[index] != progress) {
+        m_progress[index] = progress;
+        m_dirty = true;
+    }
     
     // Check if we've reached the required progress
     if (m_progress[index] >= ACHIEVEMENT_REQUIRED_PROGRESS[index]) {
@@ -142,22 +151,19 @@ uint32_t AchievementSystem::getProgress(AchievementType type) const noexcept {
     return m_progress[static_cast<size_t>(type)];
 }
 
-uint32_t AchievementSystem::getRequiredProgress(AchievementType type) noexcept {
-    if (type == AchievementType::Count) {
-        return 0;
+std::optional<size_t> AchievementSystem::findExplorerCommand(std::string_view command) noexcept {
+    auto it = std::find(EXPLORER_COMMANDS.begin(), EXPLORER_COMMANDS.end(), command);
+    if (it == EXPLORER_COMMANDS.end()) {
+        return std::nullopt;
     }
     
-    return ACHIEVEMENT_REQUIRED_PROGRESS[static_cast<size_t>(type)];
+    return static_cast<size_t>(it - EXPLORER_COMMANDS.begin());
 }
 
 void AchievementSystem::trackUniqueCommand(const std::string& command) noexcept {
-    // Only basic commands from the help menu should be considered for the Explorer achievement
-    static const std::set<std::string> validCommands = {
-        "status", "feed", "play", "evolve", "achievements", "help", "clear"
-    };
-    
     // Skip the command if it's not one of the main commands
-    if (validCommands.find(command) == validCommands.end()) {
+    auto index = findExplorerCommand(command);
+    if (!index) {
         return;
     }
     
@@ -166,63 +172,58 @@ void AchievementSystem::trackUniqueCommand(const std::string& command) noexcept
         return;
     }
     
-    // Add command to the list of used commands
-    m_usedCommands.insert(command);
+    // Add command to the set of used commands
+    uint32_t bit = 1u << *index;
+    if (m_usedCommandsMask & bit) {
+        return;
+    }
+    m_usedCommandsMask |= bit;
+    m_dirty = true;
     
     // If the user has used all commands, unlock the achievement
-    if (m_usedCommands.size() >= validCommands.size()) {
+    auto usedCount = static_cast<uint32_t>(std::popcount(m_usedCommandsMask));
+    if (usedCount >= EXPLORER_COMMANDS.size()) {
         unlock(AchievementType::Explorer);
     } else {
         // Update progress for the Explorer achievement
-        setProgress(AchievementType::Explorer, static_cast<uint32_t>(m_usedCommands.size()));
+        setProgress(AchievementType::Explorer, usedCount);
     }
 }
 
-bool AchievementSystem::save(std::ofstream& file) const noexcept {
-    if (!file) {
-        return false;
-    }
-    
-    // Write achievements bitset
-    uint64_t achievementBits = m_unlockedAchievements.to_ullong();
-    file.write(reinterpret_cast<const char*>(&achievementBits), sizeof(achievementBits));
+void AchievementSystem::writeSection(StateFileFormat::AchievementSection& section) const noexcept {
+    section.unlockedAchievements = m_unlockedAchievements.to_ullong();
+    section.newlyUnlockedAchievements = m_newlyUnlockedAchievements.to_ullong();
     
-    // Write newly unlocked achievements bitset
-    uint64_t newAchievementBits = m_newlyUnlockedAchievements.to_ullong();
-    file.write(reinterpret_cast<const char*>(&newAchievementBits), sizeof(newAchievementBits));
+    std::fill(std::begin(section.achievementProgress), std::end(section.achievementProgress), 0u);
+    std::copy(m_progress.begin(), m_progress.end(), section.achievementProgress);
     
-    // Write achievement progress for each achievement
-    for (size_t i = 0; i < static_cast<size_t>(AchievementType::Count); ++i) {
-        uint32_t progress = m_progress[i];
-        file.write(reinterpret_cast<const char*>(&progress), sizeof(progress));
-    }
+    section.usedCommandsMask = m_usedCommandsMask;
+}
+
+void AchievementSystem::readSection(const StateFileFormat::AchievementSection& section) noexcept {
+    m_unlockedAchievements = std::bitset<64>(section.unlockedAchievements);
+    m_newlyUnlockedAchievements = std::bitset<64>(section.newlyUnlockedAchievements);
     
-    // Write used commands for Explorer achievement
-    uint32_t usedCommandsSize = static_cast<uint32_t>(m_usedCommands.size());
-    file.write(reinterpret_cast<const char*>(&usedCommandsSize), sizeof(usedCommandsSize));
-    for (const auto& command : m_usedCommands) {
-        uint32_t commandLength = static_cast<uint32_t>(command.length());
-        file.write(reinterpret_cast<const char*>(&commandLength), sizeof(commandLength));
-        file.write(command.c_str(), commandLength);
-    }
+    std::copy_n(section.achievementProgress, m_progress.size(), m_progress.begin());
     
-    return file.good();
+    // Ignore bits for commands this build does not know about
+    m_usedCommandsMask = section.usedCommandsMask & ((1u << EXPLORER_COMMANDS.size()) - 1);
 }
 
-bool AchievementSystem::load(std::ifstream& file, uint8_t version) noexcept {
-    if (!file) {
+bool AchievementSystem::load(BinarySchema::Reader& reader, uint8_t version) noexcept {
+    if (!reader.ok()) {
         return false;
     }
     
     // Read achievements bitset
     uint64_t achievementBits = 0;
-    file.read(reinterpret_cast<char*>(&achievementBits), sizeof(achievementBits));
+    reader.read(achievementBits);
     m_unlockedAchievements = std::bitset<64>(achievementBits);
     
     // Read newly unlocked achievements bitset (only for version 4+)
     if (version >= 4) {
         uint64_t newAchievementBits = 0;
-        file.read(reinterpret_cast<char*>(&newAchievementBits), sizeof(newAchievementBits));
+        reader.read(newAchievementBits);
         m_newlyUnlockedAchievements = std::bitset<64>(newAchievementBits);
     } else {
         // For older versions, clear the newly unlocked achievements
@@ -232,15 +233,16 @@ bool AchievementSystem::load(std::ifstream& file, uint8_t version) noexcept {
     // Read progress for each achievement
     for (size_t i = 0; i < static_cast<size_t>(AchievementType::Count); ++i) {
         uint32_t progress = 0;
-        file.read(reinterpret_cast<char*>(&progress), sizeof(progress));
+        reader.read(progress);
         m_progress[i] = progress;
     }
     
     // Read used commands count
+    m_usedCommandsMask = 0;
     uint32_t commandCount = 0;
-    file.read(reinterpret_cast<char*>(&commandCount), sizeof(commandCount));
+    reader.read(commandCount);
     
-    // Проверяем на разумные пределы - не более 100 команд
+    // Explorer only tracks a handful of commands; clamp a corrupt count as older builds did
     const uint32_t maxReasonableCommands = 100;
     if (commandCount > maxReasonableCommands) {
         commandCount = maxReasonableCommands;
@@ -249,19 +251,23 @@ bool AchievementSystem::load(std::ifstream& file, uint8_t version) noexcept {
     // Read each command
     for (uint32_t i = 0; i < commandCount; ++i) {
         uint32_t length = 0;
-        file.read(reinterpret_cast<char*>(&length), sizeof(length));
+        reader.read(length);
         
-        // Проверяем на разумные пределы - команда не может быть длиннее 50 символов
+        // Commands are short words; skip implausible entries without consuming them,
+        // matching older builds so files they accepted keep loading
         const uint32_t maxReasonableLength = 50;
         if (length > maxReasonableLength || length == 0) {
             continue;
         }
         
-        std::string command(length, ' ');
-        file.read(&command[0], length);
+        auto bytes = reader.readBytes(length);
+        std::string_view command(reinterpret_cast<const char*>(bytes.data()), bytes.size());
         
-        m_usedCommands.insert(command);
+        if (auto index = findExplorerCommand(command)) {
+            m_usedCommandsMask |= (1u << *index);
+        }
     }
     
-    return true; // Изменено с !file.fail() на true, так как мы теперь обрабатываем ошибки сами
+    // Fails if the stream ended before all fields were read
+    return reader.ok();
 }
@@ -0,0 +1,792 @@
+#include "../include/admin_commands.h"
+#include "../include/state_migrator.h"
+#include "../include/state_checker.h"
+#include "../include/state_archiver.h"
+#include "../include/tick_engine.h"
+#include "../include/population_query.h"
+#include "../include/file_tree_scanner.h"
+#include "../include/pet_store.h"
+#include "../include/pet_daemon.h"
+#include "../include/daemon_protocol.h"
+#include "../include/daemon_client.h"
+#include "../include/pet_state.h"
+#include "../include/game_config.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <charconv>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <optional>
+#include <ctime>
+
+namespace {
+    /**
+     * @brief Parse the value of a numeric option
+     * @param option Option name, for the error message
+     * @param value Option value
+     * @param count Output value
+     * @return True if value is a non-negative integer
+     */
+    bool parseCount(std::string_view option, std::string_view value, size_t& count) noexcept {
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+        if (error != std::errc() || end != value.data() + value.size()) {
+            std::cerr << "Invalid value for " << option << ": " << value << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+AdminCommands::AdminCommands() noexcept {
+    m_handlers["migrate"] = &AdminCommands::runMigrate;
+    m_handlers["fsck"] = &AdminCommands::runFsck;
+    m_handlers["archive"] = &AdminCommands::runArchive;
+    m_handlers["tick-bench"] = &AdminCommands::runTickBench;
+    m_handlers["query"] = &AdminCommands::runQuery;
+    m_handlers["leaderboard"] = &AdminCommands::runLeaderboard;
+    m_handlers["daemon"] = &AdminCommands::runDaemon;
+    m_handlers["daemon-bench"] = &AdminCommands::runDaemonBench;
+}
+
+bool AdminCommands::isAdminCommand(std::string_view command) const noexcept {
+    return m_handlers.find(command) != m_handlers.end();
+}
+
+int AdminCommands::run(const std::vector<std::string_view>& args) const noexcept {
+    if (args.empty()) {
+        return 1;
+    }
+    
+    auto it = m_handlers.find(args[0]);
+    if (it == m_handlers.end()) {
+        return 1;
+    }
+    
+    try {
+        return it->second(std::vector<std::string_view>(args.begin() + 1, args.end()));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int AdminCommands::runMigrate(const std::vector<std::string_view>& args) {
+    std::string_view directory;
+    size_t jobs = 0;
+    DurabilityPolicy policy = DurabilityPolicy::always();
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--jobs" && i + 1 < args.size()) {
+            if (!parseCount("--jobs", args[++i], jobs)) {
+                return 1;
+            }
+        } else if (args[i] == "--no-sync") {
+            // File data is still synced before each rename; only the renames are left to the OS
+            policy = DurabilityPolicy::never();
+        } else if (args[i] == "--batched") {
+            // Each worker syncs its files in groups rather than one by one
+            policy = DurabilityPolicy::batched(GameConfig::Persistence::BATCHED_SYNC_EVERY_N_SAVES,
+                std::chrono::milliseconds(GameConfig::Persistence::BATCHED_SYNC_INTERVAL_MS));
+        } else if (directory.empty()) {
+            directory = args[i];
+        } else {
+            directory = {};
+            break;
+        }
+    }
+    
+    if (directory.empty()) {
+        std::cerr << "Usage: pet migrate <dir> [--jobs N] [--batched | --no-sync]" << std::endl;
+        return 1;
+    }
+    
+    std::filesystem::path root(directory);
+    if (!std::filesystem::exists(root)) {
+        std::cerr << "No such file or directory: " << root.string() << std::endl;
+        return 1;
+    }
+    
+    StateMigrator migrator(jobs, policy);
+    auto report = migrator.migrate(root);
+    StateMigrator::printReport(report);
+    return report.failed == 0 ? 0 : 1;
+}
+
+int AdminCommands::runFsck(const std::vector<std::string_view>& args) {
+    std::string_view directory;
+    size_t jobs = 0;
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--jobs" && i + 1 < args.size()) {
+            if (!parseCount("--jobs", args[++i], jobs)) {
+                return 1;
+            }
+        } else if (directory.empty()) {
+            directory = args[i];
+        } else {
+            directory = {};
+            break;
+        }
+    }
+    
+    if (directory.empty()) {
+        std::cerr << "Usage: pet fsck <dir> [--jobs N]" << std::endl;
+        return 1;
+    }
+    
+    std::filesystem::path root(directory);
+    if (!std::filesystem::exists(root)) {
+        std::cerr << "No such file or directory: " << root.string() << std::endl;
+        return 1;
+    }
+    
+    StateChecker checker(jobs);
+    auto report = checker.check(root);
+    StateChecker::printReport(report);
+    return report.problems.empty() ? 0 : 1;
+}
+
+int AdminCommands::runArchive(const std::vector<std::string_view>& args) {
+    std::string_view directory;
+    size_t jobs = 0;
+    size_t idleDays = GameConfig::Persistence::ARCHIVE_IDLE_DAYS;
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--jobs" && i + 1 < args.size()) {
+            if (!parseCount("--jobs", args[++i], jobs)) {
+                return 1;
+            }
+        } else if (args[i] == "--idle-days" && i + 1 < args.size()) {
+            if (!parseCount("--idle-days", args[++i], idleDays)) {
+                return 1;
+            }
+        } else if (directory.empty()) {
+            directory = args[i];
+        } else {
+            directory = {};
+            break;
+        }
+    }
+    
+    if (directory.empty()) {
+        std::cerr << "Usage: pet archive <dir> [--idle-days N] [--jobs N]" << std::endl;
+        return 1;
+    }
+    
+    std::filesystem::path root(directory);
+    if (!std::filesystem::is_directory(root)) {
+        std::cerr << "No such directory: " << root.string() << std::endl;
+        return 1;
+    }
+    
+    StateArchiver archiver(std::chrono::hours(24 * static_cast<int64_t>(idleDays)), jobs);
+    auto report = archiver.archive(root);
+    StateArchiver::printReport(report);
+    return report.failed == 0 ? 0 : 1;
+}
+
+int AdminCommands::runTickBench(const std::vector<std::string_view>& args) {
+    size_t petCount = 1000000;
+    size_t maxJobs = 0;
+    size_t ticks = 10;
+    bool compareKernels = false;
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--kernel") {
+            compareKernels = true;
+        } else if (args[i] == "--pets" && i + 1 < args.size()) {
+            if (!parseCount("--pets", args[++i], petCount)) {
+                return 1;
+            }
+        } else if (args[i] == "--jobs" && i + 1 < args.size()) {
+            if (!parseCount("--jobs", args[++i], maxJobs)) {
+                return 1;
+            }
+        } else if (args[i] == "--ticks" && i + 1 < args.size()) {
+            if (!parseCount("--ticks", args[++i], ticks)) {
+                return 1;
+            }
+        } else {
+            std::cerr << "Usage: pet tick-bench [--pets N] [--jobs N] [--ticks N] [--kernel]" << std::endl;
+            return 1;
+        }
+    }
+    if (maxJobs == 0) {
+        maxJobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    // Synthetic pets with varied stats, levels and XP so ticks evolve and unlock some of them
+    auto start = std::chrono::system_clock::now();
+    PetPopulation basePopulation;
+    basePopulation.reserve(petCount);
+    uint32_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+    for (size_t i = 0; i < petCount; ++i) {
+        auto pet = basePopulation[basePopulation.add("bench", start - std::chrono::minutes(next() % 600))];
+        pet.decreaseHunger(static_cast<float>(next() % 50));
+        pet.decreaseHappiness(static_cast<float>(next() % 50));
+        pet.decreaseEnergy(static_cast<float>(next() % 50));
+        pet.addXP(next() % 400);
+    }
+    
+    if (compareKernels) {
+        // One thread, whole columns, so only the decay kernel differs between rows
+        std::cout << "Ticking " << petCount << " pets " << ticks << " times, one hour apart, on one thread\n"
+                  << "Kernel    Mpets/s  Speedup" << std::endl;
+        
+        double portableRate = 0.0;
+        for (auto kernel : { TimeDecay::Kernel::Portable, TimeDecay::Kernel::Sse42, TimeDecay::Kernel::Avx2 }) {
+            std::cout << std::left << std::setw(8) << TimeDecay::getKernelName(kernel) << std::right;
+            if (!TimeDecay::isKernelSupported(kernel)) {
+                std::cout << "  not supported by this CPU" << std::endl;
+                continue;
+            }
+            
+            PetPopulation population = basePopulation;
+            TimeDecay::Columns columns{
+                population.getHungerColumn(),
+                population.getHappinessColumn(),
+                population.getEnergyColumn(),
+                population.getEvolutionLevelColumn(),
+                population.getLastInteractionColumn()
+            };
+            
+            auto kernelStart = std::chrono::steady_clock::now();
+            for (size_t t = 1; t <= ticks; ++t) {
+                auto now = start + std::chrono::hours(static_cast<int64_t>(t));
+                TimeDecay::applyTimeEffectsWith(kernel, columns,
+                    std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count());
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - kernelStart;
+            
+            double rate = static_cast<double>(petCount * ticks) / std::max(elapsed.count(), 1e-9) / 1e6;
+            if (kernel == TimeDecay::Kernel::Portable) {
+                portableRate = rate;
+            }
+            std::cout << "  " << std::fixed << std::setprecision(1) << std::setw(7) << rate << "  "
+                      << std::setprecision(2) << std::setw(6) << rate / portableRate << "x" << std::endl;
+        }
+        return 0;
+    }
+    
+    std::cout << "Ticking " << petCount << " pets " << ticks << " times, one hour apart ("
+              << TimeDecay::getImplementationName() << " decay kernel)\n"
+              << "Threads  Mpets/s  Speedup  Events  Steals" << std::endl;
+    
+    double baseRate = 0.0;
+    for (size_t jobs = 1; ; jobs = std::min(jobs * 2, maxJobs)) {
+        PetPopulation population = basePopulation;
+        TickEngine engine(jobs);
+        
+        std::chrono::duration<double> elapsed{0};
+        size_t events = 0;
+        for (size_t t = 1; t <= ticks; ++t) {
+            auto report = engine.tick(population, start + std::chrono::hours(static_cast<int64_t>(t)));
+            elapsed += report.elapsed;
+            events += report.events.size();
+        }
+        
+        double rate = static_cast<double>(petCount * ticks) / std::max(elapsed.count(), 1e-9) / 1e6;
+        if (jobs == 1) {
+            baseRate = rate;
+        }
+        std::cout << std::setw(7) << jobs << "  "
+                  << std::fixed << std::setprecision(1) << std::setw(7) << rate << "  "
+                  << std::setprecision(2) << std::setw(6) << rate / baseRate << "x  "
+                  << std::setw(6) << events << "  "
+                  << std::setw(6) << engine.getStealCount() << std::endl;
+        
+        if (jobs == maxJobs) {
+            break;
+        }
+    }
+    return 0;
+}
+
+int AdminCommands::runQuery(const std::vector<std::string_view>& args) {
+    enum class OutputMode { Count, Ids, Select };
+    
+    std::string_view source;
+    std::string predicate;
+    OutputMode mode = OutputMode::Count;
+    std::vector<std::string_view> columns;
+    size_t jobs = 0;
+    bool usageError = false;
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--jobs" && i + 1 < args.size()) {
+            if (!parseCount("--jobs", args[++i], jobs)) {
+                return 1;
+            }
+        } else if (args[i] == "--count") {
+            mode = OutputMode::Count;
+        } else if (args[i] == "--ids") {
+            mode = OutputMode::Ids;
+        } else if (args[i] == "--select" && i + 1 < args.size()) {
+            mode = OutputMode::Select;
+            columns.clear();
+            std::string_view list = args[++i];
+            while (!list.empty()) {
+                size_t comma = list.find(',');
+                columns.push_back(list.substr(0, comma));
+                list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+            }
+        } else if (args[i].starts_with("--")) {
+            usageError = true;
+        } else if (source.empty()) {
+            source = args[i];
+        } else {
+            // The predicate may be quoted as one argument or spread over several
+            if (!predicate.empty()) {
+                predicate += ' ';
+            }
+            predicate += args[i];
+        }
+    }
+    
+    if (source.empty() || usageError || (mode == OutputMode::Select && columns.empty())) {
+        std::cerr << "Usage: pet query <dir|store> [predicate] [--count | --ids | --select FIELDS] [--jobs N]" << std::endl;
+        return 1;
+    }
+    
+    for (auto column : columns) {
+        if (column != "id" && column != "name" && !PopulationQuery::findField(column)) {
+            std::cerr << "Unknown field in --select: " << column << std::endl;
+            return 1;
+        }
+    }
+    
+    std::string error;
+    auto query = PopulationQuery::compile(predicate, error);
+    if (!query) {
+        std::cerr << "Invalid predicate: " << error << std::endl;
+        return 1;
+    }
+    
+    std::filesystem::path root(source);
+    if (!std::filesystem::exists(root)) {
+        std::cerr << "No such file or directory: " << root.string() << std::endl;
+        return 1;
+    }
+    
+    // Identifier of each pet: its state file, or its ID in a store
+    PetPopulation population;
+    std::vector<std::string> labels;
+    size_t failed = 0;
+    
+    if (std::filesystem::is_directory(root)) {
+        std::mutex mutex;
+        FileTreeScanner scanner(jobs);
+        scanner.scan(root, [&](const std::filesystem::path& path) {
+            uint8_t version = 0;
+            if (FileTreeScanner::isAuxiliaryFile(path) || !PetState::peekFileVersion(path, version)) {
+                return;
+            }
+            PetState petState;
+            bool loaded = petState.loadFromFile(path);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (loaded) {
+                population.add(petState);
+                labels.push_back(path.string());
+            } else {
+                ++failed;
+            }
+        }, [&](const std::filesystem::path& path, std::string reason) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::cerr << path.string() << ": " << reason << std::endl;
+            ++failed;
+        });
+    } else {
+        PetStore store;
+        if (!store.open(root)) {
+            return 1;
+        }
+        auto petIds = store.getPetIds();
+        std::sort(petIds.begin(), petIds.end());
+        population.reserve(petIds.size());
+        PetState petState;
+        for (auto petId : petIds) {
+            if (petState.loadFromStore(store, petId)) {
+                population.add(petState);
+                labels.push_back(std::to_string(petId));
+            } else {
+                ++failed;
+            }
+        }
+    }
+    if (failed > 0) {
+        std::cerr << failed << " pets could not be loaded" << std::endl;
+    }
+    
+    auto now = std::chrono::system_clock::now();
+    QueryEngine engine(jobs);
+    auto result = engine.run(*query, population, now, mode != OutputMode::Count);
+    
+    if (mode == OutputMode::Count) {
+        std::cout << result.matched << " of " << result.scanned << " pets match ("
+                  << std::fixed << std::setprecision(2) << result.elapsed.count() * 1000.0 << " ms, "
+                  << QueryEngine::getImplementationName() << " filter kernels)" << std::endl;
+        return 0;
+    }
+    
+    // Directory scans load pets in no particular order; list them by path
+    if (std::filesystem::is_directory(root)) {
+        std::sort(result.indices.begin(), result.indices.end(), [&labels](uint32_t a, uint32_t b) {
+            return labels[a] < labels[b];
+        });
+    }
+    
+    if (mode == OutputMode::Ids) {
+        for (auto index : result.indices) {
+            std::cout << labels[index] << '\n';
+        }
+        std::cout << std::flush;
+        return 0;
+    }
+    
+    // Tab-separated projection with a header line
+    for (size_t c = 0; c < columns.size(); ++c) {
+        std::cout << (c > 0 ? "\t" : "") << columns[c];
+    }
+    std::cout << '\n' << std::fixed << std::setprecision(2);
+    for (auto index : result.indices) {
+        auto pet = population[index];
+        auto stats = pet.getStatsAt(now);
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (c > 0) {
+                std::cout << '\t';
+            }
+            if (columns[c] == "id") {
+                std::cout << labels[index];
+                continue;
+            }
+            if (columns[c] == "name") {
+                std::cout << pet.getName();
+                continue;
+            }
+            switch (*PopulationQuery::findField(columns[c])) {
+                case PopulationQuery::Field::Level:
+                    std::cout << PopulationQuery::getLevelName(static_cast<uint8_t>(pet.getEvolutionLevel()));
+                    break;
+                case PopulationQuery::Field::XP:
+                    std::cout << pet.getXP();
+                    break;
+                case PopulationQuery::Field::Hunger:
+                    std::cout << stats.hunger;
+                    break;
+                case PopulationQuery::Field::Happiness:
+                    std::cout << stats.happiness;
+                    break;
+                case PopulationQuery::Field::Energy:
+                    std::cout << stats.energy;
+                    break;
+                case PopulationQuery::Field::Idle:
+                    // Hours, like the predicate's default unit
+                    std::cout << std::chrono::duration<double, std::ratio<3600>>(now - pet.getLastInteractionTime()).count();
+                    break;
+            }
+        }
+        std::cout << '\n';
+    }
+    std::cout << std::flush;
+    return 0;
+}
+
+int AdminCommands::runLeaderboard(const std::vector<std::string_view>& args) {
+    std::string_view source;
+    size_t top = 0;
+    size_t oldest = 0;
+    std::optional<uint64_t> rankPetId;
+    bool usageError = false;
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--top" && i + 1 < args.size()) {
+            if (!parseCount("--top", args[++i], top)) {
+                return 1;
+            }
+        } else if (args[i] == "--oldest" && i + 1 < args.size()) {
+            if (!parseCount("--oldest", args[++i], oldest)) {
+                return 1;
+            }
+        } else if (args[i] == "--rank" && i + 1 < args.size()) {
+            size_t petId = 0;
+            if (!parseCount("--rank", args[++i], petId)) {
+                return 1;
+            }
+            rankPetId = petId;
+        } else if (args[i].starts_with("--") || !source.empty()) {
+            usageError = true;
+        } else {
+            source = args[i];
+        }
+    }
+    
+    if (source.empty() || usageError) {
+        std::cerr << "Usage: pet leaderboard <store> [--top N] [--oldest N] [--rank ID]" << std::endl;
+        return 1;
+    }
+    if (top == 0 && oldest == 0 && !rankPetId) {
+        top = GameConfig::Persistence::LEADERBOARD_DEFAULT_SIZE;
+    }
+    
+    std::filesystem::path path(source);
+    if (!std::filesystem::is_regular_file(path)) {
+        std::cerr << "No such pet store: " << path.string() << std::endl;
+        return 1;
+    }
+    
+    PetStore store;
+    if (!store.open(path)) {
+        return 1;
+    }
+    const auto& leaderboard = store.getLeaderboard();
+    
+    // Only the listed pets are loaded, for their names
+    PetState petState;
+    auto printEntry = [&](size_t rank, const Leaderboard::Entry& entry) {
+        std::cout << std::setw(6) << rank << ". "
+                  << (petState.loadFromStore(store, entry.petId) ? petState.getName() : std::string_view("?"))
+                  << " (" << entry.petId << ")";
+    };
+    
+    if (top > 0) {
+        std::cout << "Most XP (" << leaderboard.size() << " pets):\n";
+        size_t rank = 0;
+        for (const auto& entry : leaderboard.getTopXP(top)) {
+            printEntry(++rank, entry);
+            std::cout << "  " << entry.xp << " XP\n";
+        }
+    }
+    
+    if (oldest > 0) {
+        std::cout << "Oldest (" << leaderboard.size() << " pets):\n";
+        size_t rank = 0;
+        for (const auto& entry : leaderboard.getOldest(oldest)) {
+            printEntry(++rank, entry);
+            
+            auto birthTimeT = static_cast<std::time_t>(entry.birthSeconds);
+            std::tm birthTm;
+#ifdef _WIN32
+            localtime_s(&birthTm, &birthTimeT);
+#else
+            localtime_r(&birthTimeT, &birthTm);
+#endif
+            char birthStr[20];
+            std::strftime(birthStr, sizeof(birthStr), "%d %b %Y", &birthTm);
+            std::cout << "  born " << birthStr << '\n';
+        }
+    }
+    
+    if (rankPetId) {
+        auto xpRank = leaderboard.getXPRank(*rankPetId);
+        if (!xpRank) {
+            std::cout << std::flush;
+            std::cerr << "No pet " << *rankPetId << " in " << path.string() << std::endl;
+            return 1;
+        }
+        std::cout << "Pet " << *rankPetId << ": #" << *xpRank << " by XP, #"
+                  << *leaderboard.getAgeRank(*rankPetId) << " by age, of " << leaderboard.size() << " pets\n";
+    }
+    
+    std::cout << std::flush;
+    return 0;
+}
+
+int AdminCommands::runDaemon(const std::vector<std::string_view>& args) {
+    std::filesystem::path socketPath = DaemonProtocol::getSocketPath();
+    size_t shardCount = 0;
+    bool pinThreads = false;
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--socket" && i + 1 < args.size()) {
+            socketPath = args[++i];
+        } else if (args[i] == "--shards" && i + 1 < args.size()) {
+            if (!parseCount("--shards", args[++i], shardCount)) {
+                return 1;
+            }
+        } else if (args[i] == "--pin") {
+            pinThreads = true;
+        } else {
+            std::cerr << "Usage: pet daemon [--socket PATH] [--shards N] [--pin]" << std::endl;
+            return 1;
+        }
+    }
+    
+    PetDaemon daemon(socketPath, shardCount, pinThreads);
+    return daemon.run();
+}
+
+int AdminCommands::runDaemonBench(const std::vector<std::string_view>& args) {
+    size_t requestCount = 100000;
+    size_t maxPipeline = 256;
+    size_t petCount = 4;
+    size_t shardCount = 0;
+    bool wantText = true;
+    std::vector<DaemonConnection::Transport> transports = {
+        DaemonConnection::Transport::Socket, DaemonConnection::Transport::SharedMemory
+    };
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--requests" && i + 1 < args.size()) {
+            if (!parseCount("--requests", args[++i], requestCount)) {
+                return 1;
+            }
+        } else if (args[i] == "--pipeline" && i + 1 < args.size()) {
+            if (!parseCount("--pipeline", args[++i], maxPipeline)) {
+                return 1;
+            }
+        } else if (args[i] == "--pets" && i + 1 < args.size()) {
+            if (!parseCount("--pets", args[++i], petCount)) {
+                return 1;
+            }
+        } else if (args[i] == "--shards" && i + 1 < args.size()) {
+            if (!parseCount("--shards", args[++i], shardCount)) {
+                return 1;
+            }
+        } else if (args[i] == "--no-text") {
+            // Status requests without output can be answered from the pet's snapshot
+            wantText = false;
+        } else if (args[i] == "--transport" && i + 1 < args.size()) {
+            std::string_view transport = args[++i];
+            if (transport == "socket") {
+                transports = { DaemonConnection::Transport::Socket };
+            } else if (transport == "shm") {
+                transports = { DaemonConnection::Transport::SharedMemory };
+            } else if (transport != "both") {
+                transports.clear();
+            }
+        } else {
+            requestCount = 0;
+            break;
+        }
+    }
+    if (requestCount == 0 || maxPipeline == 0 || petCount == 0 || transports.empty()) {
+        std::cerr << "Usage: pet daemon-bench [--requests N] [--pipeline N] [--pets N] [--shards N] "
+                  << "[--no-text] [--transport socket|shm|both]" << std::endl;
+        return 1;
+    }
+    
+    // Fresh pets and a private daemon, so the user's own pet and daemon are never touched
+    auto directory = std::filesystem::temp_directory_path() /
+        ("pet-daemon-bench-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(directory);
+    std::vector<std::filesystem::path> statePaths;
+    for (size_t i = 0; i < petCount; ++i) {
+        PetState pet;
+        pet.setName("bench");
+        statePaths.push_back(directory / ("pet" + std::to_string(i) + ".dat"));
+        if (!pet.saveToFile(statePaths.back())) {
+            std::filesystem::remove_all(directory);
+            return 1;
+        }
+    }
+    
+    PetDaemon daemon(directory / "bench.sock", shardCount);
+    if (!daemon.start()) {
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+    std::thread server([&daemon]() { daemon.serve(); });
+    
+    int exitCode = 0;
+    for (auto transport : transports) {
+        bool shared = transport == DaemonConnection::Transport::SharedMemory;
+        DaemonConnection connection;
+        std::vector<uint32_t> petIds;
+        if (connection.connect(directory / "bench.sock", transport)) {
+            for (const auto& statePath : statePaths) {
+                if (auto petId = connection.openPet(statePath)) {
+                    petIds.push_back(*petId);
+                }
+            }
+        }
+        
+        if (petIds.size() != petCount) {
+            std::cerr << "Failed to open the benchmark pets in the daemon over "
+                      << (shared ? "shared memory" : "the socket") << std::endl;
+            exitCode = 1;
+            break;
+        }
+        
+        std::cout << (shared ? "Shared memory" : "Socket") << ": " << requestCount
+                  << (wantText ? " status (with output)" : " status") << " and feed requests for " << petCount << " pets, at most N in flight\n"
+                  << "      N  Requests/s  Speedup  p50 (us)  p99 (us)" << std::endl;
+        
+        // Send times by sequence, so each result yields the latency of its request
+        std::vector<std::chrono::steady_clock::time_point> sendTimes(requestCount);
+        std::vector<double> latencies(requestCount);
+        double baseRate = 0.0;
+        for (size_t depth = 1; exitCode == 0; depth = std::min(depth * 2, maxPipeline)) {
+            size_t sent = 0;
+            size_t received = 0;
+            uint32_t firstSequence = 0;
+            auto start = std::chrono::steady_clock::now();
+            while (received < requestCount) {
+                while (sent < requestCount && connection.getPendingCount() < depth) {
+                    bool status = sent % 2 == 0;
+                    sendTimes[sent] = std::chrono::steady_clock::now();
+                    uint32_t sequence = connection.sendCommand(petIds[sent % petCount],
+                        status ? DaemonProtocol::CommandId::Status : DaemonProtocol::CommandId::Feed, 1,
+                        status && wantText ? DaemonProtocol::COMMAND_WANT_TEXT : 0);
+                    if (sent++ == 0) {
+                        firstSequence = sequence;
+                    }
+                }
+                if (!connection.flush()) {
+                    std::cerr << "Daemon connection failed" << std::endl;
+                    exitCode = 1;
+                    break;
+                }
+                
+                // Results must come back in order with the sequence numbers they were sent with
+                DaemonProtocol::CommandResult result;
+                std::string_view text;
+                if (!connection.receive(result, &text) || result.status != DaemonProtocol::Status::Ok ||
+                    result.sequence != firstSequence + static_cast<uint32_t>(received)) {
+                    std::cerr << "Daemon request " << received << " failed" << std::endl;
+                    exitCode = 1;
+                    break;
+                }
+                std::chrono::duration<double, std::micro> latency = std::chrono::steady_clock::now() - sendTimes[received];
+                latencies[received++] = latency.count();
+            }
+            if (exitCode != 0) {
+                break;
+            }
+            
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            double rate = static_cast<double>(requestCount) / std::max(elapsed.count(), 1e-9);
+            if (depth == 1) {
+                baseRate = rate;
+            }
+            auto percentile = [&latencies](double fraction) {
+                auto it = latencies.begin() + static_cast<ptrdiff_t>(fraction * static_cast<double>(latencies.size() - 1));
+                std::nth_element(latencies.begin(), it, latencies.end());
+                return *it;
+            };
+            std::cout << std::setw(7) << depth << "  "
+                      << std::fixed << std::setprecision(0) << std::setw(10) << rate << "  "
+                      << std::setprecision(2) << std::setw(6) << rate / baseRate << "x  "
+                      << std::setprecision(1) << std::setw(8) << percentile(0.5) << "  "
+                      << std::setw(8) << percentile(0.99) << std::endl;
+            
+            if (depth == maxPipeline) {
+                break;
+            }
+        }
+        if (exitCode != 0) {
+            break;
+        }
+    }
+    
+    daemon.stop();
+    server.join();
+    std::filesystem::remove_all(directory);
+    return exitCode;
+}
@@ -0,0 +1,303 @@
+#include "../include/atomic_file_writer.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+    // Distinguishes temporary files of writers in the same process
+    std::atomic<uint64_t> nextTempFileId{0};
+
+    /**
+     * @brief Get a temporary file name next to a path, unique across processes and threads
+     */
+    std::filesystem::path makeTempPath(const std::filesystem::path& path) {
+        std::string suffix = ".tmp.";
+#ifdef _WIN32
+        suffix += std::to_string(_getpid());
+#else
+        suffix += std::to_string(::getpid());
+#endif
+        suffix += '.';
+        suffix += std::to_string(nextTempFileId.fetch_add(1, std::memory_order_relaxed));
+
+        auto tempPath = path;
+        tempPath += suffix;
+        return tempPath;
+    }
+}
+
+#ifndef _WIN32
+namespace {
+    /**
+     * @brief Write a whole buffer to a descriptor
+     * @return True if every byte was written
+     */
+    bool writeAll(int fd, std::span<const std::byte> data) noexcept {
+        // A single write normally suffices; loop only for short writes
+        const std::byte* cursor = data.data();
+        size_t remaining = data.size();
+        while (remaining > 0) {
+            ssize_t written = ::write(fd, cursor, remaining);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            cursor += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+}
+#endif
+
+AtomicFileWriter::AtomicFileWriter(DurabilityPolicy policy) noexcept
+    : m_policy(policy)
+    , m_lastSync(std::chrono::steady_clock::now())
+{
+}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    if (m_policy.mode != DurabilityPolicy::Mode::Never) {
+        flush();
+    }
+}
+
+AtomicFileWriter::AtomicFileWriter(const AtomicFileWriter& other) noexcept
+    : m_policy(other.m_policy)
+    , m_lastSync(std::chrono::steady_clock::now())
+{
+    // Pending syncs stay with the writer that made them
+}
+
+AtomicFileWriter& AtomicFileWriter::operator=(const AtomicFileWriter& other) noexcept {
+    m_policy = other.m_policy;
+    return *this;
+}
+
+bool AtomicFileWriter::shouldSync() const noexcept {
+    switch (m_policy.mode) {
+        case DurabilityPolicy::Mode::Always:
+            return true;
+        case DurabilityPolicy::Mode::Batched:
+            return m_unsyncedSaves + 1 >= m_policy.maxUnsyncedSaves ||
+                   std::chrono::steady_clock::now() - m_lastSync >= m_policy.maxUnsyncedTime;
+        case DurabilityPolicy::Mode::Never:
+        default:
+            return false;
+    }
+}
+
+bool AtomicFileWriter::write(const std::filesystem::path& path, std::span<const std::byte> data) noexcept {
+    try {
+        // Unique per writer, so concurrent saves of one path never share a temporary file
+        auto tempPath = makeTempPath(path);
+        bool sync = shouldSync();
+
+#ifdef _WIN32
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                std::cerr << "Failed to open temporary state file: " << tempPath.string() << std::endl;
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file.flush()) {
+                std::cerr << "Error writing temporary state file: " << tempPath.string() << std::endl;
+                std::filesystem::remove(tempPath);
+                return false;
+            }
+        }
+
+        // The data must be on disk before the rename can expose it
+        if (!syncFile(tempPath)) {
+            std::cerr << "Error syncing temporary state file: " << tempPath.string() << std::endl;
+            std::filesystem::remove(tempPath);
+            return false;
+        }
+        DWORD flags = MOVEFILE_REPLACE_EXISTING | (sync ? MOVEFILE_WRITE_THROUGH : 0);
+        if (!MoveFileExW(tempPath.c_str(), path.c_str(), flags)) {
+            std::cerr << "Failed to replace state file: " << path.string() << std::endl;
+            std::filesystem::remove(tempPath);
+            return false;
+        }
+#else
+        int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd < 0) {
+            std::cerr << "Failed to open temporary state file: " << tempPath.string() << std::endl;
+            return false;
+        }
+
+        // The data must be on disk before the rename can expose it, whatever the
+        // policy: otherwise a power loss could leave an empty file under the old name
+        bool ok = writeAll(fd, data) && ::fdatasync(fd) == 0;
+        ok = (::close(fd) == 0) && ok;
+        if (!ok) {
+            std::cerr << "Error writing temporary state file: " << tempPath.string() << std::endl;
+            ::unlink(tempPath.c_str());
+            return false;
+        }
+
+        if (::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::cerr << "Failed to replace state file: " << path.string() << std::endl;
+            ::unlink(tempPath.c_str());
+            return false;
+        }
+
+        // Persist the rename itself; the policy only decides when
+        if (sync) {
+            syncDirectory(path.parent_path());
+        }
+#endif
+
+        recordSave(path.parent_path(), true, sync);
+
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while writing file: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool AtomicFileWriter::append(const std::filesystem::path& path, std::span<const std::byte> data) noexcept {
+    try {
+        bool sync = shouldSync();
+
+#ifdef _WIN32
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::app);
+            if (!file) {
+                std::cerr << "Failed to open file for appending: " << path.string() << std::endl;
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file.flush()) {
+                std::cerr << "Error appending to file: " << path.string() << std::endl;
+                return false;
+            }
+        }
+        if (sync && !syncFile(path)) {
+            std::cerr << "Error syncing file: " << path.string() << std::endl;
+            return false;
+        }
+#else
+        // The file must already exist: creating it is write()'s job, which also persists the directory entry
+        int fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "Failed to open file for appending: " << path.string() << std::endl;
+            return false;
+        }
+
+        bool ok = writeAll(fd, data) && (!sync || ::fdatasync(fd) == 0);
+        ok = (::close(fd) == 0) && ok;
+        if (!ok) {
+            std::cerr << "Error appending to file: " << path.string() << std::endl;
+            return false;
+        }
+#endif
+
+        recordSave(path, false, sync);
+
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while appending to file: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void AtomicFileWriter::recordSave(const std::filesystem::path& path, bool isDirectory, bool synced) noexcept {
+    if (synced) {
+        // Earlier saves of the batch become durable together with this one
+        if (!flush()) {
+            std::cerr << "Failed to sync earlier saves" << std::endl;
+        }
+        return;
+    }
+
+    ++m_unsyncedSaves;
+
+    // Nothing ever flushes under the never policy, so there is nothing to remember
+    if (m_policy.mode == DurabilityPolicy::Mode::Never) {
+        return;
+    }
+    auto& pending = isDirectory ? m_pendingDirectories : m_pendingFiles;
+    try {
+        if (std::find(pending.begin(), pending.end(), path) == pending.end()) {
+            pending.push_back(path);
+        }
+    } catch (const std::exception& e) {
+        // Without a record of the path, sync it now
+        std::cerr << "Exception while recording unsynced save: " << e.what() << std::endl;
+        if (isDirectory) {
+            syncDirectory(path);
+        } else {
+            syncFile(path);
+        }
+    }
+}
+
+bool AtomicFileWriter::flush() noexcept {
+    bool ok = true;
+    for (const auto& path : m_pendingFiles) {
+        ok = syncFile(path) && ok;
+    }
+    for (const auto& directory : m_pendingDirectories) {
+        ok = syncDirectory(directory) && ok;
+    }
+
+    m_pendingFiles.clear();
+    m_pendingDirectories.clear();
+    m_unsyncedSaves = 0;
+    m_lastSync = std::chrono::steady_clock::now();
+    return ok;
+}
+
+bool AtomicFileWriter::syncFile(const std::filesystem::path& path) noexcept {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool ok = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    return ok;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+bool AtomicFileWriter::syncDirectory(const std::filesystem::path& directory) noexcept {
+#ifdef _WIN32
+    // Directories cannot be flushed; synced renames use MOVEFILE_WRITE_THROUGH instead
+    (void)directory;
+    return true;
+#else
+    int dirFd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(dirFd) == 0;
+    ::close(dirFd);
+    return ok;
+#endif
+}
@@ -1,30 +1,64 @@
 #include "../include/command_handler_base.h"
 #include "../include/game_logic.h"
+#include "../include/interaction_journal.h"
 #include <algorithm>
+#include <iostream>
+#include <charconv>
+#include <optional>
+
+namespace {
+    /**
+     * @brief Parse the repeat count of an interaction command
+     * @param args Arguments following the command name
+     * @param err Stream the usage is written to if the arguments are invalid
+     * @return The value of --times, 1 without it, or nothing if the arguments are invalid
+     */
+    std::optional<uint32_t> parseTimes(const std::vector<std::string_view>& args, std::ostream& err) noexcept {
+        if (args.empty()) {
+            return 1;
+        }
+        
+        uint32_t times = 0;
+        if (args.size() == 2 && args[0] == "--times") {
+            auto value = args[1];
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), times);
+            if (error == std::errc() && end == value.data() + value.size() && times > 0 && times <= MAX_BATCH_COUNT) {
+                return times;
+            }
+        }
+        
+        err << "Usage: feed|play [--times N], with N from 1 to " << MAX_BATCH_COUNT << std::endl;
+        return std::nullopt;
+    }
+}
 
 void CommandHandlerBase::initializeCommandHandlers() noexcept {
     // Initialize command handlers using lambda functions
-    m_commandHandlers["status"] = [](GameLogic& gameLogic) -> void {
+    m_commandHandlers["status"] = [](GameLogic& gameLogic, const std::vector<std::string_view>& /* args */) -> void {
         gameLogic.showStatus();
     };
     
-    m_commandHandlers["feed"] = [](GameLogic& gameLogic) -> void {
-        gameLogic.feedPet();
+    m_commandHandlers["feed"] = [this](GameLogic& gameLogic, const std::vector<std::string_view>& args) -> void {
+        if (auto times = parseTimes(args, m_err)) {
+            gameLogic.feedPet(*times);
+        }
     };
     
-    m_commandHandlers["play"] = [](GameLogic& gameLogic) -> void {
-        gameLogic.playWithPet();
+    m_commandHandlers["play"] = [this](GameLogic& gameLogic, const std::vector<std::string_view>& args) -> void {
+        if (auto times = parseTimes(args, m_err)) {
+            gameLogic.playWithPet(*times);
+        }
     };
     
-    m_commandHandlers["evolve"] = [](GameLogic& gameLogic) -> void {
+    m_commandHandlers["evolve"] = [](GameLogic& gameLogic, const std::vector<std::string_view>& /* args */) -> void {
         gameLogic.showEvolutionProgress();
     };
     
-    m_commandHandlers["achievements"] = [](GameLogic& gameLogic) -> void {
+    m_commandHandlers["achievements"] = [](GameLogic& gameLogic, const std::vector<std::string_view>& /* args */) -> void {
         gameLogic.showAchievements();
     };
     
-    m_commandHandlers["new"] = [](GameLogic& gameLogic) -> void {
+    m_commandHandlers["new"] = [](GameLogic& gameLogic, const std::vector<std::string_view>& /* args */) -> void {
         gameLogic.createNewPet();
     };
 }
@@ -43,10 +77,22 @@ bool CommandHandlerBase::processCommand(const std::vector<std::string_view>& arg
     
     auto it = m_commandHandlers.find(lowerCommand);
     if (it != m_commandHandlers.end()) {
+        // Each command is one unit of work: at most one write, none if nothing changed.
+        // The interactive loop commits each command it runs, so it stays outside
+        PetState& petState = gameLogic.getPetState();
+        bool isUnitOfWork = lowerCommand != "interactive";
+        if (isUnitOfWork) {
+            petState.beginTransaction();
+        }
+        
         // Отслеживаем команду для достижения Explorer
         gameLogic.trackCommand(std::string(lowerCommand));
         
-        it->second(gameLogic);
+        it->second(gameLogic, std::vector<std::string_view>(args.begin() + 1, args.end()));
+        
+        if (isUnitOfWork) {
+            petState.commitTransaction();
+        }
         return true;
     }
     
@@ -1,10 +1,13 @@
 #include "../include/command_parser.h"
 #include "../include/game_logic.h"
+#include "../include/game_config.h"
 #include <iostream>
 #include <algorithm>
 #include <filesystem>
 
-CommandParser::CommandParser() noexcept {
+CommandParser::CommandParser(std::ostream& out, std::ostream& err) noexcept
+    : CommandHandlerBase(out, err)
+{
     // Initialize command handlers
     initializeCommandHandlers();
 }
@@ -14,13 +17,13 @@ void CommandParser::initializeCommandHandlers() noexcept {
     CommandHandlerBase::initializeCommandHandlers();
     
     // Add help command for command line mode
-    m_commandHandlers["help"] = [this](GameLogic& /* gameLogic */) -> void {
+    m_commandHandlers["help"] = [this](GameLogic& /* gameLogic */, const std::vector<std::string_view>& /* args */) -> void {
         // Use the updated showHelp method instead of duplicating code
         this->showHelp();
     };
     
     // Add command for starting interactive mode
-    m_commandHandlers["interactive"] = [](GameLogic& gameLogic) -> void {
+    m_commandHandlers["interactive"] = [](GameLogic& gameLogic, const std::vector<std::string_view>& /* args */) -> void {
         gameLogic.runInteractiveMode();
     };
 }
@@ -46,8 +49,8 @@ bool CommandParser::processCommand(const std::vector<std::string_view>& args, Ga
         bool petExists = petState.load();
         
         if (petExists) {
-            std::cout << "A pet already exists. Overwriting will delete your current pet permanently.\n";
-            std::cout << "Do you want to create a new pet anyway? (yes/no): ";
+            m_out << "A pet already exists. Overwriting will delete your current pet permanently.\n";
+            m_out << "Do you want to create a new pet anyway? (yes/no): ";
             
             std::string response;
             std::getline(std::cin, response);
@@ -61,7 +64,7 @@ bool CommandParser::processCommand(const std::vector<std::string_view>& args, Ga
                 gameLogic.createNewPet(true);
                 return true;
             } else {
-                std::cout << "Operation canceled. Your pet is safe." << std::endl;
+                m_out << "Operation canceled. Your pet is safe." << std::endl;
                 return true;
             }
         } else {
@@ -76,22 +79,45 @@ bool CommandParser::processCommand(const std::vector<std::string_view>& args, Ga
 }
 
 void CommandParser::showHelp() const noexcept {
-    std::cout << "Virtual Pet Application - Command Line Mode\n"
+    m_out << "Virtual Pet Application - Command Line Mode\n"
               << "------------------------------------------\n"
               << "Usage: pet [command] [options]\n\n";
               
     // Category 1: Pet Interaction
-    std::cout << "Pet Interaction:\n"
+    m_out << "Pet Interaction:\n"
               << "  status       - Show pet status\n"
-              << "  feed         - Feed your pet\n"
-              << "  play         - Play with your pet\n"
+              << "  feed [--times N]\n"
+              << "               - Feed your pet, N times at once\n"
+              << "  play [--times N]\n"
+              << "               - Play with your pet, N times at once\n"
               << "  evolve       - Show evolution progress\n"
               << "  achievements - Show all achievements and progress\n\n";
               
     // Category 2: Application Management
-    std::cout << "Application Management:\n"
+    m_out << "Application Management:\n"
               << "  new [-f]     - Create a new pet (use -f to force overwrite)\n"
               << "  help         - Show this help message\n"
-              << "  interactive  - Start interactive mode\n"
+              << "  interactive  - Start interactive mode\n\n";
+              
+    // Category 3: Administration
+    m_out << "Administration:\n"
+              << "  migrate <dir> [--jobs N] [--batched | --no-sync]\n"
+              << "               - Upgrade all state files below <dir> to the current format\n"
+              << "  fsck <dir> [--jobs N]\n"
+              << "               - Verify the checksums of all state files below <dir>\n"
+              << "  archive <dir> [--idle-days N] [--jobs N]\n"
+              << "               - Compress pets idle for N days (default: " << GameConfig::Persistence::ARCHIVE_IDLE_DAYS << ") into archives\n"
+              << "  tick-bench [--pets N] [--jobs N] [--ticks N] [--kernel]\n"
+              << "               - Measure parallel tick throughput from 1 to N threads,\n"
+              << "                 or with --kernel the throughput of each decay kernel\n"
+              << "  query <dir|store> [predicate] [--count | --ids | --select FIELDS] [--jobs N]\n"
+              << "               - Count, list or tabulate the pets matching a predicate\n"
+              << "  leaderboard <store> [--top N] [--oldest N] [--rank ID]\n"
+              << "               - Show the pets with the most XP, the oldest pets, or a pet's rank\n"
+              << "  daemon [--socket PATH] [--shards N] [--pin]\n"
+              << "               - Keep pets loaded and serve commands; other pet commands use it while it runs\n"
+              << "  daemon-bench [--requests N] [--pipeline N] [--pets N] [--shards N]\n"
+              << "               [--no-text] [--transport socket|shm|both]\n"
+              << "               - Measure daemon throughput and latency with 1 to N requests in flight\n"
               << std::endl;
 }
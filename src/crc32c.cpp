@@ -0,0 +1,112 @@
+#include "../include/crc32c.h"
+#include <array>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PET_CRC32C_SSE42 1
+#include <nmmintrin.h>
+#endif
+
+namespace {
+    // Reflected Castagnoli polynomial
+    constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+    // Slicing-by-8 tables: TABLES[k][b] is the CRC of byte b followed by k zero bytes
+    constexpr auto TABLES = []() {
+        std::array<std::array<uint32_t, 256>, 8> tables{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
+            }
+            tables[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (size_t k = 1; k < tables.size(); ++k) {
+                tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+            }
+        }
+        return tables;
+    }();
+
+    constexpr uint32_t loadLE32(const uint8_t* data) noexcept {
+        return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+               (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    uint32_t updatePortable(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+        while (size >= 8) {
+            uint32_t low = loadLE32(data) ^ crc;
+            uint32_t high = loadLE32(data + 4);
+            crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^
+                  TABLES[5][(low >> 16) & 0xFF] ^ TABLES[4][low >> 24] ^
+                  TABLES[3][high & 0xFF] ^ TABLES[2][(high >> 8) & 0xFF] ^
+                  TABLES[1][(high >> 16) & 0xFF] ^ TABLES[0][high >> 24];
+            data += 8;
+            size -= 8;
+        }
+        while (size--) {
+            crc = (crc >> 8) ^ TABLES[0][(crc ^ *data++) & 0xFF];
+        }
+        return crc;
+    }
+
+#ifdef PET_CRC32C_SSE42
+    __attribute__((target("sse4.2")))
+    uint32_t updateHardware(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+#ifdef __x86_64__
+        uint64_t crc64 = crc;
+        while (size >= 8) {
+            uint64_t word = 0;
+            std::memcpy(&word, data, sizeof(word));
+            crc64 = _mm_crc32_u64(crc64, word);
+            data += 8;
+            size -= 8;
+        }
+        crc = static_cast<uint32_t>(crc64);
+#endif
+        while (size >= 4) {
+            uint32_t word = 0;
+            std::memcpy(&word, data, sizeof(word));
+            crc = _mm_crc32_u32(crc, word);
+            data += 4;
+            size -= 4;
+        }
+        while (size--) {
+            crc = _mm_crc32_u8(crc, *data++);
+        }
+        return crc;
+    }
+#endif
+
+    using UpdateFunction = uint32_t (*)(uint32_t, const uint8_t*, size_t) noexcept;
+
+    UpdateFunction selectUpdate() noexcept {
+#ifdef PET_CRC32C_SSE42
+        if (__builtin_cpu_supports("sse4.2")) {
+            return updateHardware;
+        }
+#endif
+        return updatePortable;
+    }
+
+    // Chosen once at startup from the CPU features
+    const UpdateFunction UPDATE = selectUpdate();
+}
+
+namespace Crc32c {
+
+    uint32_t compute(std::span<const std::byte> bytes, uint32_t crc) noexcept {
+        auto data = reinterpret_cast<const uint8_t*>(bytes.data());
+        return ~UPDATE(~crc, data, bytes.size());
+    }
+
+    uint32_t computePortable(std::span<const std::byte> bytes, uint32_t crc) noexcept {
+        auto data = reinterpret_cast<const uint8_t*>(bytes.data());
+        return ~updatePortable(~crc, data, bytes.size());
+    }
+
+    bool isHardwareAccelerated() noexcept {
+        return UPDATE != updatePortable;
+    }
+}
@@ -0,0 +1,412 @@
+#include "../include/daemon_client.h"
+#include "../include/daemon_protocol.h"
+#include "../include/pet_state.h"
+#include "../include/binary_schema.h"
+#include "../include/shared_ring.h"
+#include "../include/game_config.h"
+#include <iostream>
+#include <array>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+    // Bytes read from the daemon at a time
+    constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+
+    // While waiting on shared memory, check this often whether the daemon exited
+    constexpr std::chrono::milliseconds SHARED_IDLE_TIMEOUT(100);
+
+    // Commands that only print and commit; `new` and the load prompt read the terminal
+    constexpr std::array<std::string_view, 5> FORWARDABLE_COMMANDS = {
+        "status", "feed", "play", "evolve", "achievements"
+    };
+
+#ifndef _WIN32
+    /**
+     * @brief Closes a socket when it goes out of scope
+     */
+    struct SocketGuard {
+        int fd;
+        ~SocketGuard() {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    };
+#endif
+}
+
+bool DaemonClient::isForwardable(std::string_view command) noexcept {
+    // The daemon lower-cases commands the same way
+    return std::any_of(FORWARDABLE_COMMANDS.begin(), FORWARDABLE_COMMANDS.end(), [command](std::string_view name) {
+        return std::equal(name.begin(), name.end(), command.begin(), command.end(), [](char a, char b) {
+            return a == std::tolower(static_cast<unsigned char>(b));
+        });
+    });
+}
+
+std::optional<int> DaemonClient::forward(const std::vector<std::string_view>& args) noexcept {
+#ifdef _WIN32
+    (void)args;
+    return std::nullopt;
+#else
+    try {
+        if (const char* disabled = std::getenv("PET_NO_DAEMON"); disabled && *disabled) {
+            return std::nullopt;
+        }
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::string socketPath = DaemonProtocol::getSocketPath().string();
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            return std::nullopt;
+        }
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+        // No daemon: run the command in this process
+        SocketGuard socket{ ::socket(AF_UNIX, SOCK_STREAM, 0) };
+        if (socket.fd < 0 || ::connect(socket.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            return std::nullopt;
+        }
+
+        auto request = DaemonProtocol::encodeRequest(PetState::getStateFilePath(), args);
+        if (!DaemonProtocol::sendMessage(socket.fd, DaemonProtocol::MessageType::Request, request)) {
+            // The daemon went away before reading anything
+            return std::nullopt;
+        }
+
+        // From here on the command may have run, so it must not run again locally
+        DaemonProtocol::MessageType type;
+        std::vector<std::byte> payload;
+        while (DaemonProtocol::receiveMessage(socket.fd, type, payload)) {
+            std::string_view text(reinterpret_cast<const char*>(payload.data()), payload.size());
+            switch (type) {
+                case DaemonProtocol::MessageType::Stdout:
+                    std::cout << text;
+                    break;
+                case DaemonProtocol::MessageType::Stderr:
+                    std::cout << std::flush;
+                    std::cerr << text;
+                    break;
+                case DaemonProtocol::MessageType::Exit:
+                    std::cout << std::flush;
+                    return payload.size() == sizeof(int32_t) ? BinarySchema::loadLE<int32_t>(payload.data()) : 1;
+                case DaemonProtocol::MessageType::RunLocally:
+                    return std::nullopt;
+                default:
+                    break;
+            }
+        }
+
+        std::cout << std::flush;
+        std::cerr << "Lost connection to the pet daemon at " << socketPath << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+#endif
+}
+
+DaemonConnection::DaemonConnection() noexcept = default;
+
+DaemonConnection::~DaemonConnection() {
+    close();
+}
+
+bool DaemonConnection::connect(const std::filesystem::path& socketPath, Transport transport) noexcept {
+    close();
+#ifdef _WIN32
+    (void)socketPath; (void)transport;
+    return false;
+#else
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::string path = socketPath.string();
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    m_fd = fd;
+    if (transport == Transport::Socket) {
+        return true;
+    }
+
+    // The daemon maps the same memory; from here on the socket carries nothing
+    auto channel = SharedChannel::create(GameConfig::Daemon::SHARED_RING_CAPACITY);
+    std::span<const std::byte> payload;
+    try {
+        if (!channel || !DaemonProtocol::sendDescriptor(m_fd, DaemonProtocol::MessageType::AttachSharedMemory, channel->getFd()) ||
+            !receiveMessage(DaemonProtocol::MessageType::SharedMemoryAttached, payload) ||
+            payload.size() != 1 || static_cast<DaemonProtocol::Status>(payload[0]) != DaemonProtocol::Status::Ok) {
+            close();
+            return false;
+        }
+    } catch (const std::exception&) {
+        close();
+        return false;
+    }
+    m_channel = std::move(channel);
+    return true;
+#endif
+}
+
+void DaemonConnection::close() noexcept {
+    // Closing the rings lets the daemon's thread for this channel exit at once
+    m_channel.reset();
+    m_holdingResponse = false;
+#ifndef _WIN32
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+#endif
+    m_fd = -1;
+    m_pendingCount = 0;
+    m_output.clear();
+    m_outputPos = 0;
+    m_input.clear();
+    m_inputPos = 0;
+}
+
+std::optional<uint32_t> DaemonConnection::openPet(const std::filesystem::path& statePath) {
+    // Responses come in order, so an earlier command's result would arrive first
+    if (!isConnected() || m_pendingCount > 0) {
+        return std::nullopt;
+    }
+
+    std::vector<std::byte> request;
+    DaemonProtocol::appendOpenPet(request, m_nextSequence++, std::filesystem::absolute(statePath));
+    if (m_channel) {
+        auto out = reserveSharedRequest(request.size());
+        if (out.empty()) {
+            return std::nullopt;
+        }
+        std::memcpy(out.data(), request.data(), request.size());
+        m_channel->getRequests().endWrite(request.size());
+    } else {
+        m_output.insert(m_output.end(), request.begin(), request.end());
+    }
+
+    std::span<const std::byte> payload;
+    DaemonProtocol::OpenPetResult result;
+    if (!receiveMessage(DaemonProtocol::MessageType::PetOpened, payload) ||
+        !DaemonProtocol::decodePetOpened(payload, result) || result.status != DaemonProtocol::Status::Ok) {
+        return std::nullopt;
+    }
+    return result.petId;
+}
+
+uint32_t DaemonConnection::sendCommand(uint32_t petId, DaemonProtocol::CommandId command, uint32_t count, uint8_t flags) {
+    DaemonProtocol::CommandRequest request{};
+    request.sequence = m_nextSequence++;
+    request.petId = petId;
+    request.command = command;
+    request.flags = flags;
+    request.count = count;
+    ++m_pendingCount;
+
+    if (m_channel) {
+        // Encoded in place; the daemon sees it as soon as endWrite() publishes it
+        auto out = reserveSharedRequest(DaemonProtocol::COMMAND_MESSAGE_SIZE);
+        if (!out.empty()) {
+            DaemonProtocol::writeCommand(out, request);
+            m_channel->getRequests().endWrite(DaemonProtocol::COMMAND_MESSAGE_SIZE);
+        }
+    } else {
+        DaemonProtocol::appendCommand(m_output, request);
+    }
+    return request.sequence;
+}
+
+bool DaemonConnection::flush() noexcept {
+    while (m_outputPos < m_output.size()) {
+        if (!exchange(false)) {
+            return false;
+        }
+    }
+    return isConnected();
+}
+
+bool DaemonConnection::receive(DaemonProtocol::CommandResult& result, std::string_view* text) {
+    if (m_pendingCount == 0) {
+        return false;
+    }
+
+    std::span<const std::byte> payload;
+    std::string_view ignoredText;
+    if (!receiveMessage(DaemonProtocol::MessageType::CommandResult, payload) ||
+        !DaemonProtocol::decodeCommandResult(payload, result, text ? *text : ignoredText)) {
+        return false;
+    }
+    --m_pendingCount;
+    return true;
+}
+
+bool DaemonConnection::receiveMessage(DaemonProtocol::MessageType type, std::span<const std::byte>& payload) {
+    releaseSharedResponse();
+    for (;;) {
+        // With shared memory this only holds results moved out of a full ring, which come first
+        DaemonProtocol::MessageType receivedType;
+        auto buffered = std::span<const std::byte>(m_input).subspan(m_inputPos);
+        switch (DaemonProtocol::parseMessage(buffered, receivedType, payload)) {
+            case DaemonProtocol::ParseResult::Complete:
+                m_inputPos += DaemonProtocol::HEADER_SIZE + payload.size();
+                return receivedType == type;
+            case DaemonProtocol::ParseResult::Invalid:
+                close();
+                return false;
+            case DaemonProtocol::ParseResult::Incomplete:
+                break;
+        }
+
+        if (m_channel) {
+            return receiveSharedMessage(type, payload);
+        }
+        if (!exchange(true)) {
+            return false;
+        }
+    }
+}
+
+bool DaemonConnection::receiveSharedMessage(DaemonProtocol::MessageType type, std::span<const std::byte>& payload) noexcept {
+    SharedRing& responses = m_channel->getResponses();
+    std::span<const std::byte> record;
+    while (record.empty()) {
+        record = responses.beginRead(SHARED_IDLE_TIMEOUT);
+        if (record.empty() && (responses.isClosed() || !isDaemonAlive())) {
+            close();
+            return false;
+        }
+    }
+
+    // Held in the ring until the next call, so the caller reads the text where the daemon wrote it
+    m_holdingResponse = true;
+    DaemonProtocol::MessageType receivedType;
+    return DaemonProtocol::parseMessage(record, receivedType, payload) == DaemonProtocol::ParseResult::Complete &&
+           DaemonProtocol::HEADER_SIZE + payload.size() == record.size() && receivedType == type;
+}
+
+std::span<std::byte> DaemonConnection::reserveSharedRequest(size_t size) {
+    SharedRing& requests = m_channel->getRequests();
+    auto out = requests.beginWrite(size, std::chrono::milliseconds(0));
+    while (out.empty()) {
+        // The daemon may be waiting for room for results; take them out so neither side waits forever
+        releaseSharedResponse();
+        SharedRing& responses = m_channel->getResponses();
+        for (auto record = responses.beginRead(std::chrono::milliseconds(0)); !record.empty();
+             record = responses.beginRead(std::chrono::milliseconds(0))) {
+            m_input.insert(m_input.end(), record.begin(), record.end());
+            responses.endRead();
+        }
+
+        if (requests.isClosed() || !isDaemonAlive()) {
+            close();
+            return {};
+        }
+        out = requests.beginWrite(size, SHARED_IDLE_TIMEOUT);
+    }
+    return out;
+}
+
+void DaemonConnection::releaseSharedResponse() noexcept {
+    if (m_holdingResponse) {
+        m_channel->getResponses().endRead();
+        m_holdingResponse = false;
+    }
+    if (m_inputPos > 0 && m_inputPos == m_input.size()) {
+        m_input.clear();
+        m_inputPos = 0;
+    }
+}
+
+bool DaemonConnection::isDaemonAlive() const noexcept {
+#ifdef _WIN32
+    return false;
+#else
+    // After attaching, the daemon writes nothing to the socket; anything readable means it closed
+    pollfd pollFd{ m_fd, POLLIN, 0 };
+    return m_fd >= 0 && ::poll(&pollFd, 1, 0) == 0;
+#endif
+}
+
+bool DaemonConnection::exchange(bool waitForInput) noexcept {
+#ifdef _WIN32
+    (void)waitForInput;
+    return false;
+#else
+    if (!isConnected()) {
+        return false;
+    }
+
+    // Reading while sending keeps the daemon from stalling on a full socket to us
+    bool hasOutput = m_outputPos < m_output.size();
+    if (!hasOutput && !waitForInput) {
+        return true;
+    }
+    pollfd pollFd{ m_fd, static_cast<short>(POLLIN | (hasOutput ? POLLOUT : 0)), 0 };
+    if (::poll(&pollFd, 1, -1) < 0) {
+        return errno == EINTR;
+    }
+
+    try {
+        if (pollFd.revents & (POLLIN | POLLHUP | POLLERR)) {
+            // Parsed messages are dropped before the buffer grows
+            if (m_inputPos > 0) {
+                m_input.erase(m_input.begin(), m_input.begin() + static_cast<ptrdiff_t>(m_inputPos));
+                m_inputPos = 0;
+            }
+            size_t pos = m_input.size();
+            m_input.resize(pos + READ_CHUNK_SIZE);
+            ssize_t received = ::recv(m_fd, m_input.data() + pos, READ_CHUNK_SIZE, 0);
+            m_input.resize(pos + static_cast<size_t>(std::max<ssize_t>(received, 0)));
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                close();
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        close();
+        return false;
+    }
+
+    if (pollFd.revents & POLLOUT) {
+        ssize_t sent = ::send(m_fd, m_output.data() + m_outputPos, m_output.size() - m_outputPos, MSG_NOSIGNAL);
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            close();
+            return false;
+        }
+        m_outputPos += static_cast<size_t>(std::max<ssize_t>(sent, 0));
+        if (m_outputPos == m_output.size()) {
+            m_output.clear();
+            m_outputPos = 0;
+        }
+    }
+    return true;
+#endif
+}
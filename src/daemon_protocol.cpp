@@ -0,0 +1,338 @@
+#include "../include/daemon_protocol.h"
+#include "../include/binary_schema.h"
+#include "../include/game_config.h"
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+    // Schema version of the binary request and result records
+    constexpr uint8_t PROTOCOL_SCHEMA_VERSION = 1;
+
+    constexpr auto COMMAND_REQUEST_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("sequence", &DaemonProtocol::CommandRequest::sequence),
+        BinarySchema::field("petId", &DaemonProtocol::CommandRequest::petId),
+        BinarySchema::field("command", &DaemonProtocol::CommandRequest::command),
+        BinarySchema::field("flags", &DaemonProtocol::CommandRequest::flags),
+        BinarySchema::field("reserved16", &DaemonProtocol::CommandRequest::reserved16),
+        BinarySchema::field("count", &DaemonProtocol::CommandRequest::count)
+    );
+
+    constexpr auto COMMAND_RESULT_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("sequence", &DaemonProtocol::CommandResult::sequence),
+        BinarySchema::field("status", &DaemonProtocol::CommandResult::status),
+        BinarySchema::field("evolutionLevel", &DaemonProtocol::CommandResult::evolutionLevel),
+        BinarySchema::field("evolved", &DaemonProtocol::CommandResult::evolved),
+        BinarySchema::field("reserved8", &DaemonProtocol::CommandResult::reserved8),
+        BinarySchema::field("xp", &DaemonProtocol::CommandResult::xp),
+        BinarySchema::field("hunger", &DaemonProtocol::CommandResult::hunger),
+        BinarySchema::field("happiness", &DaemonProtocol::CommandResult::happiness),
+        BinarySchema::field("energy", &DaemonProtocol::CommandResult::energy)
+    );
+
+    constexpr auto OPEN_PET_RESULT_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("sequence", &DaemonProtocol::OpenPetResult::sequence),
+        BinarySchema::field("status", &DaemonProtocol::OpenPetResult::status),
+        BinarySchema::field("petId", &DaemonProtocol::OpenPetResult::petId)
+    );
+
+    constexpr size_t COMMAND_REQUEST_SIZE = COMMAND_REQUEST_SCHEMA.encodedSize(PROTOCOL_SCHEMA_VERSION);
+    constexpr size_t COMMAND_RESULT_SIZE = COMMAND_RESULT_SCHEMA.encodedSize(PROTOCOL_SCHEMA_VERSION);
+    constexpr size_t OPEN_PET_RESULT_SIZE = OPEN_PET_RESULT_SCHEMA.encodedSize(PROTOCOL_SCHEMA_VERSION);
+
+    static_assert(DaemonProtocol::COMMAND_MESSAGE_SIZE == DaemonProtocol::HEADER_SIZE + COMMAND_REQUEST_SIZE);
+    static_assert(DaemonProtocol::COMMAND_RESULT_MESSAGE_SIZE == DaemonProtocol::HEADER_SIZE + COMMAND_RESULT_SIZE);
+
+    // Handler names in CommandHandlerBase::initializeCommandHandlers(), indexed by CommandId
+    constexpr std::string_view COMMAND_NAMES[] = {
+        {}, "status", "feed", "play", "evolve", "achievements"
+    };
+
+    void writeHeader(std::byte* out, DaemonProtocol::MessageType type, size_t payloadSize) noexcept {
+        BinarySchema::storeLE(out, static_cast<uint32_t>(payloadSize));
+        BinarySchema::storeLE(out + sizeof(uint32_t), type);
+    }
+
+    /**
+     * @brief Append a message header for a payload of the given size
+     * @return Offset of the payload in buffer
+     */
+    size_t appendHeader(std::vector<std::byte>& buffer, DaemonProtocol::MessageType type, size_t payloadSize) {
+        size_t pos = buffer.size();
+        buffer.resize(pos + DaemonProtocol::HEADER_SIZE + payloadSize);
+        writeHeader(buffer.data() + pos, type, payloadSize);
+        return pos + DaemonProtocol::HEADER_SIZE;
+    }
+
+    void appendString(std::vector<std::byte>& buffer, std::string_view value) {
+        size_t pos = buffer.size();
+        buffer.resize(pos + sizeof(uint32_t) + value.size());
+        BinarySchema::storeLE(buffer.data() + pos, static_cast<uint32_t>(value.size()));
+        std::memcpy(buffer.data() + pos + sizeof(uint32_t), value.data(), value.size());
+    }
+
+    bool readString(BinarySchema::Reader& reader, std::string& value) {
+        uint32_t length = 0;
+        if (!reader.read(length)) {
+            return false;
+        }
+        auto bytes = reader.readBytes(length);
+        value.assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return reader.ok();
+    }
+
+#ifndef _WIN32
+    bool sendAll(int fd, const std::byte* data, size_t size) noexcept {
+        while (size > 0) {
+            ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    bool receiveAll(int fd, std::byte* data, size_t size) noexcept {
+        while (size > 0) {
+            ssize_t received = ::recv(fd, data, size, 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                return false;
+            }
+            data += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+#endif
+}
+
+namespace DaemonProtocol {
+
+    std::filesystem::path getSocketPath() {
+        if (const char* socketPath = std::getenv("PET_DAEMON_SOCKET"); socketPath && *socketPath) {
+            return socketPath;
+        }
+        if (const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR"); runtimeDir && *runtimeDir) {
+            return std::filesystem::path(runtimeDir) / GameConfig::Daemon::SOCKET_FILE_NAME;
+        }
+#ifdef _WIN32
+        return std::filesystem::temp_directory_path() / GameConfig::Daemon::SOCKET_FILE_NAME;
+#else
+        return "/tmp/pet-" + std::to_string(getuid()) + ".sock";
+#endif
+    }
+
+    std::optional<std::string_view> getCommandName(CommandId command) noexcept {
+        auto index = static_cast<size_t>(command);
+        if (index == 0 || index >= std::size(COMMAND_NAMES)) {
+            return std::nullopt;
+        }
+        return COMMAND_NAMES[index];
+    }
+
+    bool sendMessage(int fd, MessageType type, std::span<const std::byte> payload) noexcept {
+#ifdef _WIN32
+        (void)fd; (void)type; (void)payload;
+        return false;
+#else
+        std::byte header[HEADER_SIZE];
+        BinarySchema::storeLE(header, static_cast<uint32_t>(payload.size()));
+        BinarySchema::storeLE(header + sizeof(uint32_t), type);
+
+        // Small messages go out in one write
+        if (payload.size() <= 256) {
+            std::byte message[HEADER_SIZE + 256];
+            std::memcpy(message, header, HEADER_SIZE);
+            if (!payload.empty()) {
+                std::memcpy(message + HEADER_SIZE, payload.data(), payload.size());
+            }
+            return sendAll(fd, message, HEADER_SIZE + payload.size());
+        }
+        return sendAll(fd, header, HEADER_SIZE) && sendAll(fd, payload.data(), payload.size());
+#endif
+    }
+
+    bool receiveMessage(int fd, MessageType& type, std::vector<std::byte>& payload) noexcept {
+#ifdef _WIN32
+        (void)fd; (void)type; (void)payload;
+        return false;
+#else
+        try {
+            std::byte header[HEADER_SIZE];
+            if (!receiveAll(fd, header, HEADER_SIZE)) {
+                return false;
+            }
+
+            auto length = BinarySchema::loadLE<uint32_t>(header);
+            if (length > GameConfig::Daemon::MAX_MESSAGE_SIZE) {
+                return false;
+            }
+            type = BinarySchema::loadLE<MessageType>(header + sizeof(uint32_t));
+            payload.resize(length);
+            return receiveAll(fd, payload.data(), length);
+        } catch (const std::exception&) {
+            return false;
+        }
+#endif
+    }
+
+    std::vector<std::byte> encodeRequest(const std::filesystem::path& statePath, const std::vector<std::string_view>& args) {
+        std::vector<std::byte> payload;
+        appendString(payload, statePath.string());
+        for (auto arg : args) {
+            appendString(payload, arg);
+        }
+        return payload;
+    }
+
+    bool decodeRequest(std::span<const std::byte> payload, std::string& statePath, std::vector<std::string>& args) {
+        BinarySchema::Reader reader(payload);
+        if (!readString(reader, statePath)) {
+            return false;
+        }
+
+        args.clear();
+        while (reader.remaining() > 0) {
+            if (!readString(reader, args.emplace_back())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ParseResult parseMessage(std::span<const std::byte> buffer, MessageType& type, std::span<const std::byte>& payload) noexcept {
+        if (buffer.size() < HEADER_SIZE) {
+            return ParseResult::Incomplete;
+        }
+
+        auto length = BinarySchema::loadLE<uint32_t>(buffer.data());
+        if (length > GameConfig::Daemon::MAX_MESSAGE_SIZE) {
+            return ParseResult::Invalid;
+        }
+        if (buffer.size() - HEADER_SIZE < length) {
+            return ParseResult::Incomplete;
+        }
+
+        type = BinarySchema::loadLE<MessageType>(buffer.data() + sizeof(uint32_t));
+        payload = buffer.subspan(HEADER_SIZE, length);
+        return ParseResult::Complete;
+    }
+
+    void appendMessage(std::vector<std::byte>& buffer, MessageType type, std::span<const std::byte> payload) {
+        size_t pos = appendHeader(buffer, type, payload.size());
+        if (!payload.empty()) {
+            std::memcpy(buffer.data() + pos, payload.data(), payload.size());
+        }
+    }
+
+    void appendOpenPet(std::vector<std::byte>& buffer, uint32_t sequence, const std::filesystem::path& statePath) {
+        std::string path = statePath.string();
+        size_t pos = appendHeader(buffer, MessageType::OpenPet, 2 * sizeof(uint32_t) + path.size());
+        BinarySchema::storeLE(buffer.data() + pos, sequence);
+        BinarySchema::storeLE(buffer.data() + pos + sizeof(uint32_t), static_cast<uint32_t>(path.size()));
+        std::memcpy(buffer.data() + pos + 2 * sizeof(uint32_t), path.data(), path.size());
+    }
+
+    bool decodeOpenPet(std::span<const std::byte> payload, uint32_t& sequence, std::string& statePath) {
+        BinarySchema::Reader reader(payload);
+        return reader.read(sequence) && readString(reader, statePath) && reader.remaining() == 0;
+    }
+
+    void appendPetOpened(std::vector<std::byte>& buffer, const OpenPetResult& result) {
+        size_t pos = appendHeader(buffer, MessageType::PetOpened, OPEN_PET_RESULT_SIZE);
+        OPEN_PET_RESULT_SCHEMA.encode(result, PROTOCOL_SCHEMA_VERSION,
+                                      std::span(buffer.data() + pos, OPEN_PET_RESULT_SIZE));
+    }
+
+    bool decodePetOpened(std::span<const std::byte> payload, OpenPetResult& result) noexcept {
+        return payload.size() == OPEN_PET_RESULT_SIZE &&
+               OPEN_PET_RESULT_SCHEMA.decode(payload, PROTOCOL_SCHEMA_VERSION, result);
+    }
+
+    void appendCommand(std::vector<std::byte>& buffer, const CommandRequest& request) {
+        size_t pos = buffer.size();
+        buffer.resize(pos + COMMAND_MESSAGE_SIZE);
+        writeCommand(std::span(buffer).subspan(pos), request);
+    }
+
+    void writeCommand(std::span<std::byte> out, const CommandRequest& request) noexcept {
+        writeHeader(out.data(), MessageType::Command, COMMAND_REQUEST_SIZE);
+        COMMAND_REQUEST_SCHEMA.encode(request, PROTOCOL_SCHEMA_VERSION, out.subspan(HEADER_SIZE));
+    }
+
+    bool decodeCommand(std::span<const std::byte> payload, CommandRequest& request) noexcept {
+        return payload.size() == COMMAND_REQUEST_SIZE &&
+               COMMAND_REQUEST_SCHEMA.decode(payload, PROTOCOL_SCHEMA_VERSION, request);
+    }
+
+    void appendCommandResult(std::vector<std::byte>& buffer, const CommandResult& result, std::string_view text) {
+        size_t pos = buffer.size();
+        buffer.resize(pos + COMMAND_RESULT_MESSAGE_SIZE + text.size());
+        if (!text.empty()) {
+            std::memcpy(buffer.data() + pos + COMMAND_RESULT_MESSAGE_SIZE, text.data(), text.size());
+        }
+        writeCommandResult(std::span(buffer).subspan(pos), result, text.size());
+    }
+
+    void writeCommandResult(std::span<std::byte> out, const CommandResult& result, size_t textSize) noexcept {
+        writeHeader(out.data(), MessageType::CommandResult, COMMAND_RESULT_SIZE + textSize);
+        COMMAND_RESULT_SCHEMA.encode(result, PROTOCOL_SCHEMA_VERSION, out.subspan(HEADER_SIZE));
+    }
+
+    bool decodeCommandResult(std::span<const std::byte> payload, CommandResult& result, std::string_view& text) noexcept {
+        if (!COMMAND_RESULT_SCHEMA.decode(payload, PROTOCOL_SCHEMA_VERSION, result)) {
+            return false;
+        }
+        auto rest = payload.subspan(COMMAND_RESULT_SIZE);
+        text = std::string_view(reinterpret_cast<const char*>(rest.data()), rest.size());
+        return true;
+    }
+
+    bool sendDescriptor(int fd, MessageType type, int descriptor) noexcept {
+#ifdef _WIN32
+        (void)fd; (void)type; (void)descriptor;
+        return false;
+#else
+        std::byte header[HEADER_SIZE];
+        writeHeader(header, type, 0);
+        iovec data{ header, HEADER_SIZE };
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        msghdr message{};
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        cmsghdr* rights = CMSG_FIRSTHDR(&message);
+        rights->cmsg_level = SOL_SOCKET;
+        rights->cmsg_type = SCM_RIGHTS;
+        rights->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(rights), &descriptor, sizeof(int));
+
+        // The descriptor travels with the first byte, so the header goes out in one piece
+        ssize_t sent;
+        do {
+            sent = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+        } while (sent < 0 && errno == EINTR);
+        return sent == static_cast<ssize_t>(HEADER_SIZE);
+#endif
+    }
+}
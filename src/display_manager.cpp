@@ -6,79 +6,82 @@
 #include <iomanip>
 #include <format>
 
-DisplayManager::DisplayManager(PetState& petState) noexcept
+DisplayManager::DisplayManager(PetState& petState, std::ostream& out) noexcept
     : m_petState(petState)
+    , m_out(out)
 {
 }
 
 void DisplayManager::displayMessage(std::string_view message) const noexcept {
-    std::cout << message << std::endl;
+    m_out << message << std::endl;
 }
 
 void DisplayManager::clearScreen() const noexcept {
 #ifdef _WIN32
     system("cls");
 #else
-    system("clear");
+    // The escape sequences `clear` prints, written to the output stream so they
+    // reach the client's terminal when the command runs in `pet daemon`
+    m_out << "\033[H\033[2J\033[3J" << std::flush;
 #endif
 }
 
 void DisplayManager::displayPetHeader() const noexcept {
-    std::cout << m_petState.getAsciiArt() << std::endl;
+    m_out << m_petState.getAsciiArt() << std::endl;
     
-    std::cout << "Name: " << m_petState.getName() << std::endl;
-    std::cout << "Evolution: ";
+    m_out << "Name: " << m_petState.getName() << std::endl;
+    m_out << "Evolution: ";
     
     switch (m_petState.getEvolutionLevel()) {
         case EvolutionLevel::Egg:
-            std::cout << "Egg (Level 0)";
+            m_out << "Egg (Level 0)";
             break;
         case EvolutionLevel::Baby:
-            std::cout << "Baby (Level 1)";
+            m_out << "Baby (Level 1)";
             break;
         case EvolutionLevel::Child:
-            std::cout << "Child (Level 2)";
+            m_out << "Child (Level 2)";
             break;
         case EvolutionLevel::Teen:
-            std::cout << "Teen (Level 3)";
+            m_out << "Teen (Level 3)";
             break;
         case EvolutionLevel::Adult:
-            std::cout << "Adult (Level 4)";
+            m_out << "Adult (Level 4)";
             break;
         case EvolutionLevel::Master:
-            std::cout << "Master (Level 5)";
+            m_out << "Master (Level 5)";
             break;
         case EvolutionLevel::Ancient:
-            std::cout << "Ancient";
+            m_out << "Ancient";
             break;
     }
-    std::cout << std::endl;
+    m_out << std::endl;
     
     // Add pet description - using the more detailed status description instead of the basic description
-    std::cout << "Status: " << m_petState.getStatusDescription() << std::endl;
+    m_out << "Status: " << m_petState.getStatusDescription() << std::endl;
     
     // Get maximum stat value for current evolution level
     float maxStatValue = m_petState.getMaxStatValue();
     
     // Statistics right after the description - display absolute values not percentages
-    std::cout << "\nStats:" << std::endl;
-    std::cout << "  Hunger: " << static_cast<int>(std::floor(m_petState.getHunger())) << " / "
+    m_out << "\nStats:" << std::endl;
+    m_out << "  Hunger: " << static_cast<int>(std::floor(m_petState.getHunger())) << " / "
               << static_cast<int>(maxStatValue) << std::endl;
-    std::cout << "  Happiness: " << static_cast<int>(std::floor(m_petState.getHappiness())) << " / "
+    m_out << "  Happiness: " << static_cast<int>(std::floor(m_petState.getHappiness())) << " / "
               << static_cast<int>(maxStatValue) << std::endl;
-    std::cout << "  Energy: " << static_cast<int>(std::floor(m_petState.getEnergy())) << " / "
+    m_out << "  Energy: " << static_cast<int>(std::floor(m_petState.getEnergy())) << " / "
               << static_cast<int>(maxStatValue) << std::endl;
-    std::cout << "  XP: " << m_petState.getXP();
+    m_out << "  XP: " << m_petState.getXP();
     
     if (m_petState.getEvolutionLevel() != EvolutionLevel::Ancient) {
-        std::cout << " / " << m_petState.getXPForNextLevel() << " for next level";
+        m_out << " / " << m_petState.getXPForNextLevel() << " for next level";
     }
-    std::cout << std::endl;
+    m_out << std::endl;
     
     // Add achievements information
     const auto& achievementSystem = m_petState.getAchievementSystem();
     auto unlockedAchievements = achievementSystem.getUnlockedAchievements();
-    std::cout << "Achievements: " << unlockedAchievements.size() << "/" << static_cast<int>(AchievementType::Count) << " unlocked" << std::endl << std::endl;
+    m_out << "Achievements: " << unlockedAchievements.size() << "/" << static_cast<int>(AchievementType::Count) << " unlocked" << std::endl << std::endl;
 }
 
 std::string_view DisplayManager::getEvolutionLevelName(EvolutionLevel level) const noexcept {
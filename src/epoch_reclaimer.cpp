@@ -0,0 +1,66 @@
+#include "../include/epoch_reclaimer.h"
+#include <algorithm>
+
+namespace {
+    // Retired objects a writer collects before it tries to free them
+    constexpr size_t RECLAIM_THRESHOLD = 64;
+}
+
+EpochReclaimer::EpochReclaimer(size_t maxReaders)
+    : m_slots(std::make_unique<Slot[]>(maxReaders))
+    , m_slotCount(maxReaders) {
+}
+
+EpochReclaimer::Reader EpochReclaimer::registerReader() noexcept {
+    for (size_t i = 0; i < m_slotCount; ++i) {
+        bool expected = false;
+        if (!m_slots[i].used.load(std::memory_order_relaxed) &&
+            m_slots[i].used.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return Reader(this, i);
+        }
+    }
+    return Reader();
+}
+
+EpochReclaimer::Reader::~Reader() {
+    if (m_reclaimer) {
+        m_reclaimer->m_slots[m_slot].used.store(false, std::memory_order_release);
+    }
+}
+
+EpochReclaimer::ReadGuard::ReadGuard(const Reader& reader) noexcept
+    : m_epoch(reader.m_reclaimer->m_slots[reader.m_slot].epoch) {
+    // Sequentially consistent, so the pointer loads that follow come after the slot is visible to writers.
+    // A stale epoch only delays reclamation
+    m_epoch.store(reader.m_reclaimer->m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+EpochReclaimer::ReadGuard::~ReadGuard() {
+    m_epoch.store(0, std::memory_order_release);
+}
+
+uint64_t EpochReclaimer::getOldestActiveEpoch() const noexcept {
+    uint64_t oldest = UINT64_MAX;
+    for (size_t i = 0; i < m_slotCount; ++i) {
+        uint64_t epoch = m_slots[i].epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0) {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+    return oldest;
+}
+
+void EpochReclaimer::RetireList::add(std::shared_ptr<const void> object) {
+    // Read after the caller unpublished the object: a guard that may hold it started in this epoch or before
+    m_objects.emplace_back(m_reclaimer.m_epoch.load(std::memory_order_seq_cst), std::move(object));
+    if (m_objects.size() >= RECLAIM_THRESHOLD) {
+        reclaim();
+    }
+}
+
+void EpochReclaimer::RetireList::reclaim() noexcept {
+    // Guards that start from now on see a later epoch than any object retired so far
+    m_reclaimer.m_epoch.fetch_add(1, std::memory_order_seq_cst);
+    uint64_t oldest = m_reclaimer.getOldestActiveEpoch();
+    std::erase_if(m_objects, [oldest](const auto& retired) { return retired.first < oldest; });
+}
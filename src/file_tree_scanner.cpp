@@ -0,0 +1,82 @@
+#include "../include/file_tree_scanner.h"
+#include "../include/thread_pool.h"
+#include "../include/pet_archive.h"
+#include <vector>
+
+namespace {
+    // Files handed to a worker per task, to keep queue overhead low on large trees
+    constexpr size_t FILES_PER_TASK = 64;
+}
+
+FileTreeScanner::FileTreeScanner(size_t threadCount) noexcept
+    : m_threadCount(threadCount)
+{
+}
+
+size_t FileTreeScanner::scan(const std::filesystem::path& root, const FileVisitor& visit, const ErrorHandler& onError) const noexcept {
+    size_t fileCount = 0;
+
+    auto visitBatch = [&visit, &onError](const std::vector<std::filesystem::path>& batch) {
+        for (const auto& path : batch) {
+            try {
+                visit(path);
+            } catch (const std::exception& e) {
+                onError(path, e.what());
+            }
+        }
+    };
+
+    try {
+        ThreadPool pool(m_threadCount);
+        std::vector<std::filesystem::path> batch;
+        batch.reserve(FILES_PER_TASK);
+
+        auto submitBatch = [&]() {
+            if (!batch.empty()) {
+                pool.submit([&visitBatch, batch = std::move(batch)]() { visitBatch(batch); });
+                batch = {};
+                batch.reserve(FILES_PER_TASK);
+            }
+        };
+
+        auto addFile = [&](const std::filesystem::path& path) {
+            ++fileCount;
+            batch.push_back(path);
+            if (batch.size() == FILES_PER_TASK) {
+                submitBatch();
+            }
+        };
+
+        if (std::filesystem::is_regular_file(root)) {
+            addFile(root);
+        } else {
+            std::error_code error;
+            std::filesystem::recursive_directory_iterator it(root, std::filesystem::directory_options::skip_permission_denied, error);
+            for (std::filesystem::recursive_directory_iterator end; !error && it != end; it.increment(error)) {
+                std::error_code entryError;
+                if (it->is_symlink(entryError) || !it->is_regular_file(entryError)) {
+                    continue;
+                }
+                addFile(it->path());
+            }
+
+            if (error) {
+                onError(root, "directory scan stopped: " + error.message());
+            }
+        }
+
+        submitBatch();
+        pool.wait();
+    } catch (const std::exception& e) {
+        onError(root, e.what());
+    }
+
+    return fileCount;
+}
+
+bool FileTreeScanner::isAuxiliaryFile(const std::filesystem::path& path) {
+    auto fileName = path.filename().string();
+    return path.extension() == ".journal" || fileName == PetArchive::FILE_NAME ||
+           fileName == PetArchive::LOCK_FILE_NAME ||
+           fileName.find(".tmp.") != std::string::npos;
+}
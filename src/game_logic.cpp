@@ -5,15 +5,16 @@
 #include <format>
 #include <memory>
 
-GameLogic::GameLogic(PetState& petState) noexcept
+GameLogic::GameLogic(PetState& petState, std::ostream& out) noexcept
     : m_petState(petState)
+    , m_out(out)
 {
     // Initialize all managers
-    m_displayManager = std::make_unique<DisplayManager>(m_petState);
-    m_achievementManager = std::make_unique<AchievementManager>(m_petState);
+    m_displayManager = std::make_unique<DisplayManager>(m_petState, m_out);
+    m_achievementManager = std::make_unique<AchievementManager>(m_petState, m_out);
     m_timeManager = std::make_unique<TimeManager>(m_petState);
     m_interactionManager = std::make_unique<InteractionManager>(
-        m_petState, *m_displayManager, *m_achievementManager);
+        m_petState, *m_displayManager, *m_achievementManager, m_out);
     
     // Note: UIManager will be initialized later via initializeUIManager()
 }
@@ -25,7 +26,8 @@ void GameLogic::initializeUIManager() noexcept {
         *m_displayManager, 
         *m_achievementManager, 
         *m_interactionManager, 
-        *m_timeManager
+        *m_timeManager,
+        m_out
     );
     
     // Set up the connection with UI manager after creating all objects
@@ -35,10 +37,10 @@ void GameLogic::initializeUIManager() noexcept {
 }
 
 void GameLogic::showStatus() const noexcept {
-    // Apply time effects first
-    auto message = m_timeManager->applyTimeEffects();
+    // Report time effects; the displayed stats include them without modifying the pet
+    auto message = m_timeManager->describeTimeEffects();
     if (message) {
-        std::cout << *message << std::endl;
+        m_out << *message << std::endl;
     }
     
     // Display newly unlocked achievements
@@ -52,32 +54,26 @@ void GameLogic::showStatus() const noexcept {
     m_interactionManager->showStatus();
 }
 
-void GameLogic::feedPet() noexcept {
+void GameLogic::feedPet(uint32_t times) noexcept {
     // Apply time effects first
     auto message = m_timeManager->applyTimeEffects();
     if (message) {
-        std::cout << *message << std::endl;
+        m_out << *message << std::endl;
     }
     
     // Feed the pet
-    m_interactionManager->feedPet();
-    
-    // Save the pet state
-    m_petState.save();
+    m_interactionManager->feedPet(times);
 }
 
-void GameLogic::playWithPet() noexcept {
+void GameLogic::playWithPet(uint32_t times) noexcept {
     // Apply time effects first
     auto message = m_timeManager->applyTimeEffects();
     if (message) {
-        std::cout << *message << std::endl;
+        m_out << *message << std::endl;
     }
     
     // Play with the pet
-    m_interactionManager->playWithPet();
-    
-    // Save the pet state
-    m_petState.save();
+    m_interactionManager->playWithPet(times);
 }
 
 void GameLogic::showEvolutionProgress() const noexcept {
@@ -93,7 +89,7 @@ void GameLogic::showAchievements() const noexcept {
 bool GameLogic::createNewPet(bool force) noexcept {
     // Check if a pet already exists
     if (m_petState.saveFileExists() && !force) {
-        std::cout << "A pet already exists. Use -f to force creation of a new pet." << std::endl;
+        m_out << "A pet already exists. Use -f to force creation of a new pet." << std::endl;
         return false;
     }
     
@@ -113,5 +109,5 @@ void GameLogic::runInteractiveMode() noexcept {
 
 void GameLogic::trackCommand(const std::string& command) noexcept {
     // Pass the command to the achievement system for tracking
-    m_petState.getAchievementSystem().trackUniqueCommand(command);
+    m_petState.trackCommand(command);
 }
@@ -0,0 +1,383 @@
+#include "../include/interaction_journal.h"
+#include "../include/mapped_file.h"
+#include "../include/atomic_file_writer.h"
+#include "../include/binary_schema.h"
+#include <iostream>
+#include <cstring>
+
+namespace {
+    constexpr char JOURNAL_MAGIC[8] = { 'P', 'E', 'T', 'J', 'R', 'N', 'L', '2' };
+    constexpr size_t JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC) + sizeof(uint64_t);
+
+    // Journals whose times are whole seconds and whose batch counts share the field
+    constexpr char LEGACY_JOURNAL_MAGIC[8] = { 'P', 'E', 'T', 'J', 'R', 'N', 'L', '1' };
+
+    // Position of the count in the field of legacy batch records; the time takes the bits below it
+    constexpr unsigned LEGACY_BATCH_COUNT_SHIFT = 40;
+
+    constexpr uint64_t NANOSECONDS_PER_SECOND = 1'000'000'000;
+
+    // Longest possible encoding of a 64-bit varint
+    constexpr size_t MAX_VARINT_LENGTH = 10;
+
+    void appendVarint(std::vector<std::byte>& buffer, uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<std::byte>(value));
+    }
+
+    bool readVarint(std::span<const std::byte> bytes, size_t& pos, uint64_t& value) noexcept {
+        value = 0;
+        for (size_t shift = 0, i = 0; i < MAX_VARINT_LENGTH && pos < bytes.size(); ++i, shift += 7) {
+            auto byte = static_cast<uint8_t>(bytes[pos++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    enum class JournalFormat {
+        Invalid,
+        Legacy,     // "PETJRNL1"
+        Current     // "PETJRNL2"
+    };
+
+    /**
+     * @brief Identify a journal and read the sequence number of its first record
+     */
+    JournalFormat readHeader(std::span<const std::byte> bytes, uint64_t& firstSequence) noexcept {
+        if (bytes.size() < JOURNAL_HEADER_SIZE) {
+            return JournalFormat::Invalid;
+        }
+        if (std::memcmp(bytes.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0) {
+            firstSequence = BinarySchema::loadLE<uint64_t>(bytes.data() + sizeof(JOURNAL_MAGIC));
+            return JournalFormat::Current;
+        }
+        if (std::memcmp(bytes.data(), LEGACY_JOURNAL_MAGIC, sizeof(LEGACY_JOURNAL_MAGIC)) == 0) {
+            // Legacy headers hold the sequence in host byte order
+            std::memcpy(&firstSequence, bytes.data() + sizeof(LEGACY_JOURNAL_MAGIC), sizeof(firstSequence));
+            return JournalFormat::Legacy;
+        }
+        return JournalFormat::Invalid;
+    }
+
+    std::vector<std::byte> makeHeader(uint64_t firstSequence) {
+        std::vector<std::byte> header(JOURNAL_HEADER_SIZE);
+        std::memcpy(header.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        BinarySchema::storeLE(header.data() + sizeof(JOURNAL_MAGIC), firstSequence);
+        return header;
+    }
+
+    /**
+     * @brief Decode a record payload, converting legacy records to the current meaning
+     */
+    bool decodeRecord(std::span<const std::byte> payload, JournalFormat format, InteractionJournal::Record& record) noexcept {
+        if (payload.empty()) {
+            return false;
+        }
+
+        size_t pos = 1;
+        record = { static_cast<JournalRecordType>(payload[0]), 0, 1 };
+        if (!readVarint(payload, pos, record.value) || (pos < payload.size() && !readVarint(payload, pos, record.count))) {
+            return false;
+        }
+
+        if (format == JournalFormat::Legacy) {
+            switch (record.type) {
+                case JournalRecordType::FeedBatch:
+                case JournalRecordType::PlayBatch:
+                    record.count = record.value >> LEGACY_BATCH_COUNT_SHIFT;
+                    record.value &= (uint64_t{1} << LEGACY_BATCH_COUNT_SHIFT) - 1;
+                    [[fallthrough]];
+                case JournalRecordType::Feed:
+                case JournalRecordType::Play:
+                case JournalRecordType::TimeEffects:
+                    record.value *= NANOSECONDS_PER_SECOND;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Walk the records of a journal image
+     * @param bytes The whole journal file
+     * @param visit Called with (sequence, record offset, payload) for every complete record
+     * @param endSequence Set to the sequence following the last complete record
+     * @param format Set to the format of the journal, before the first record is visited
+     * @return Size of the valid part of the journal, or 0 if the header is invalid
+     */
+    template <typename Visitor>
+    size_t walkRecords(std::span<const std::byte> bytes, Visitor&& visit, uint64_t& endSequence,
+                       JournalFormat& format) noexcept {
+        uint64_t sequence = 0;
+        format = readHeader(bytes, sequence);
+        if (format == JournalFormat::Invalid) {
+            return 0;
+        }
+
+        size_t pos = JOURNAL_HEADER_SIZE;
+        while (pos < bytes.size()) {
+            size_t recordStart = pos;
+            uint64_t length = 0;
+            if (!readVarint(bytes, pos, length) || length > bytes.size() - pos) {
+                // Partially written record at the end of the journal
+                pos = recordStart;
+                break;
+            }
+
+            visit(sequence, recordStart, bytes.subspan(pos, static_cast<size_t>(length)));
+            pos += static_cast<size_t>(length);
+            ++sequence;
+        }
+
+        endSequence = sequence;
+        return pos;
+    }
+
+    /**
+     * @brief Rewrite a legacy journal in the current format
+     * @param bytes The whole legacy journal
+     * @return Header and records, one record per legacy record so sequence numbers are kept
+     */
+    std::vector<std::byte> upgradeLegacyJournal(std::span<const std::byte> bytes) {
+        uint64_t firstSequence = 0;
+        readHeader(bytes, firstSequence);
+        auto image = makeHeader(firstSequence);
+
+        uint64_t endSequence = 0;
+        JournalFormat format = JournalFormat::Invalid;
+        walkRecords(bytes, [&](uint64_t, size_t offset, std::span<const std::byte> payload) {
+            InteractionJournal::Record record{};
+            if (decodeRecord(payload, format, record)) {
+                InteractionJournal::encodeRecord(image, record);
+            } else {
+                // Keep a record this build cannot read as it is
+                auto recordEnd = static_cast<size_t>(payload.data() + payload.size() - bytes.data());
+                image.insert(image.end(), bytes.begin() + offset, bytes.begin() + recordEnd);
+            }
+        }, endSequence, format);
+        return image;
+    }
+}
+
+InteractionJournal::~InteractionJournal() {
+    waitForCompaction();
+}
+
+void InteractionJournal::setPath(const std::filesystem::path& path) noexcept {
+    waitForCompaction();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (path != m_path) {
+        m_path = path;
+        m_scanned = false;
+    }
+}
+
+uint64_t InteractionJournal::replay(uint64_t fromSequence, const std::function<void(const Record&)>& apply) noexcept {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_scanned = true;
+    m_validSize = 0;
+    m_endSequence = fromSequence;
+
+    MappedFile mappedFile(m_path);
+    if (!mappedFile.isOpen()) {
+        return fromSequence;
+    }
+
+    auto bytes = mappedFile.data();
+    uint64_t endSequence = 0;
+    JournalFormat format = JournalFormat::Invalid;
+    m_validSize = walkRecords(bytes, [&](uint64_t sequence, size_t, std::span<const std::byte> payload) {
+        Record record{};
+        if (sequence >= fromSequence && decodeRecord(payload, format, record)) {
+            apply(record);
+        }
+    }, endSequence, format);
+    m_legacyFormat = format == JournalFormat::Legacy;
+
+    if (m_validSize == 0 && !bytes.empty()) {
+        std::cerr << "Ignoring invalid journal: " << m_path.string() << std::endl;
+        return fromSequence;
+    }
+
+    m_endSequence = endSequence;
+    return std::max(endSequence, fromSequence);
+}
+
+bool InteractionJournal::append(std::span<const std::byte> records, uint32_t count, uint64_t firstSequence,
+                                AtomicFileWriter& writer) noexcept {
+    if (count == 0) {
+        return true;
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_scanned) {
+            MappedFile mappedFile(m_path);
+            JournalFormat format = JournalFormat::Invalid;
+            m_validSize = mappedFile.isOpen() ?
+                walkRecords(mappedFile.data(), [](uint64_t, size_t, auto) {}, m_endSequence, format) : 0;
+            m_legacyFormat = format == JournalFormat::Legacy;
+            m_scanned = true;
+        }
+
+        bool continuesJournal = m_validSize != 0 && m_endSequence == firstSequence;
+        if (!continuesJournal || m_legacyFormat) {
+            // Start a new journal whose first record is firstSequence, or convert a
+            // legacy journal the records continue. Replacing the file atomically
+            // also persists its directory entry when synced
+            std::vector<std::byte> image;
+            if (continuesJournal) {
+                MappedFile mappedFile(m_path);
+                image = upgradeLegacyJournal(mappedFile.data());
+            } else {
+                image = makeHeader(firstSequence);
+            }
+            image.insert(image.end(), records.begin(), records.end());
+            if (!writer.write(m_path, image)) {
+                std::cerr << "Error writing journal: " << m_path.string() << std::endl;
+                m_scanned = false;
+                return false;
+            }
+            m_validSize = image.size();
+            m_legacyFormat = false;
+        } else {
+            // Cut off a partial record left by an interrupted append
+            if (std::filesystem::file_size(m_path) != m_validSize) {
+                std::filesystem::resize_file(m_path, m_validSize);
+            }
+
+            if (!writer.append(m_path, records)) {
+                std::cerr << "Error writing journal: " << m_path.string() << std::endl;
+                m_scanned = false;
+                return false;
+            }
+            m_validSize += records.size();
+        }
+
+        m_endSequence = firstSequence + count;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while writing journal: " << e.what() << std::endl;
+        m_scanned = false;
+        return false;
+    }
+}
+
+uint64_t InteractionJournal::size() const noexcept {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_scanned ? m_validSize : 0;
+}
+
+void InteractionJournal::clear() noexcept {
+    waitForCompaction();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::error_code error;
+    std::filesystem::remove(m_path, error);
+    m_validSize = 0;
+    m_endSequence = 0;
+    m_scanned = true;
+}
+
+void InteractionJournal::compactAsync(const std::filesystem::path& snapshotPath, std::vector<std::byte> snapshot, uint64_t sequence) noexcept {
+    waitForCompaction();
+
+    try {
+        m_compactor = std::thread([this, snapshotPath, snapshot = std::move(snapshot), sequence]() {
+            // The snapshot must be in place before any record is dropped
+            AtomicFileWriter writer;
+            if (writer.write(snapshotPath, snapshot)) {
+                truncateBefore(sequence);
+            }
+        });
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to start journal compaction: " << e.what() << std::endl;
+    }
+}
+
+void InteractionJournal::waitForCompaction() noexcept {
+    if (m_compactor.joinable()) {
+        m_compactor.join();
+    }
+}
+
+void InteractionJournal::truncateBefore(uint64_t sequence) noexcept {
+    try {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::vector<std::byte> compacted;
+        uint64_t endSequence = 0;
+        {
+            MappedFile mappedFile(m_path);
+            if (!mappedFile.isOpen()) {
+                return;
+            }
+
+            auto bytes = mappedFile.data();
+            size_t keepFrom = 0;
+            bool hasFoldedRecords = false;
+            JournalFormat format = JournalFormat::Invalid;
+            size_t validSize = walkRecords(bytes, [&](uint64_t recordSequence, size_t offset, auto) {
+                if (recordSequence < sequence) {
+                    hasFoldedRecords = true;
+                } else if (recordSequence == sequence) {
+                    keepFrom = offset;
+                }
+            }, endSequence, format);
+
+            // Nothing to drop, e.g. the journal was already rewritten. A legacy
+            // journal is left for the next append to convert; replay skips the
+            // records the snapshot already holds
+            if (validSize == 0 || format != JournalFormat::Current || !hasFoldedRecords) {
+                return;
+            }
+
+            if (endSequence > sequence) {
+                // Keep records appended after the snapshot was taken
+                compacted = makeHeader(sequence);
+                compacted.insert(compacted.end(), bytes.begin() + keepFrom, bytes.begin() + validSize);
+            }
+        }
+
+        if (compacted.empty()) {
+            std::filesystem::remove(m_path);
+            m_validSize = 0;
+            return;
+        }
+
+        AtomicFileWriter writer(DurabilityPolicy::never());
+        if (writer.write(m_path, compacted)) {
+            m_validSize = compacted.size();
+            m_endSequence = endSequence;
+        } else {
+            m_scanned = false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while compacting journal: " << e.what() << std::endl;
+        m_scanned = false;
+    }
+}
+
+void InteractionJournal::encodeRecord(std::vector<std::byte>& buffer, const Record& record) {
+    std::vector<std::byte> payload;
+    payload.reserve(1 + 2 * MAX_VARINT_LENGTH);
+    payload.push_back(static_cast<std::byte>(record.type));
+    appendVarint(payload, record.value);
+    if (record.count != 1) {
+        appendVarint(payload, record.count);
+    }
+
+    appendVarint(buffer, payload.size());
+    buffer.insert(buffer.end(), payload.begin(), payload.end());
+}
@@ -8,43 +8,39 @@
 InteractionManager::InteractionManager(
     PetState& petState, 
     DisplayManager& displayManager, 
-    AchievementManager& achievementManager) noexcept
+    AchievementManager& achievementManager,
+    std::ostream& out) noexcept
     : m_petState(petState)
     , m_displayManager(displayManager)
     , m_achievementManager(achievementManager)
+    , m_out(out)
 {
 }
 
-void InteractionManager::feedPet() noexcept {
+void InteractionManager::feedPet(uint32_t times) noexcept {
     // Get maximum stat value for this evolution level
     float maxStatValue = m_petState.getMaxStatValue();
     
     // Check if pet was already full
     bool wasFull = (m_petState.getHunger() >= maxStatValue - 0.01f); // Small epsilon to handle floating point comparisons
+    uint32_t xpBefore = m_petState.getXP();
+    auto levelBefore = m_petState.getEvolutionLevel();
     
-    // Increase hunger using absolute value from config
-    m_petState.increaseHunger(GameConfig::getFeedingHungerIncrease());
-    
-    // Add XP
-    bool evolved = m_petState.addXP(GameConfig::getFeedingXPGain());
-    
-    // Update interaction time
-    m_petState.updateInteractionTime();
+    // Increase hunger, add XP and update interaction time, all feedings at once
+    bool evolved = m_petState.applyFeeding(std::chrono::system_clock::now(), times);
     
     // Unlock first steps achievement if first time feeding
-    if (m_petState.getAchievementSystem().unlock(AchievementType::FirstSteps)) {
-        std::cout << "\nAchievement unlocked: " 
+    if (m_petState.unlockAchievement(AchievementType::FirstSteps)) {
+        m_out << "\nAchievement unlocked: " 
                 << AchievementSystem::getName(AchievementType::FirstSteps) 
                 << "!" << std::endl;
     }
     
     // Display message
+    showBatchSummary("fed", times, xpBefore);
     if (evolved) {
-        std::cout << "Your pet " << m_petState.getName() << " has evolved to " 
-                << m_displayManager.getEvolutionLevelName(m_petState.getEvolutionLevel()) 
-                << "!" << std::endl;
-        std::cout << m_petState.getAsciiArt() << std::endl;
-        std::cout << m_petState.getDescription() << std::endl;
+        showEvolution(levelBefore);
+        maxStatValue = m_petState.getMaxStatValue();
     } else if (wasFull && m_petState.getHunger() >= maxStatValue - 0.01f) {
         m_displayManager.displayMessage("Your pet is already full! It doesn't want to eat more.");
     } else if (m_petState.getHunger() >= maxStatValue - 0.01f) {
@@ -57,42 +53,32 @@ void InteractionManager::feedPet() noexcept {
     m_achievementManager.displayNewlyUnlockedAchievements();
     
     // Show current hunger level (display absolute value, not percentage)
-    std::cout << "Hunger: " << static_cast<int>(std::floor(m_petState.getHunger())) << " / " 
+    m_out << "Hunger: " << static_cast<int>(std::floor(m_petState.getHunger())) << " / " 
               << static_cast<int>(maxStatValue) << std::endl;
-    std::cout << "XP: " << m_petState.getXP();
+    m_out << "XP: " << m_petState.getXP();
     if (m_petState.getEvolutionLevel() != EvolutionLevel::Ancient) {
-        std::cout << " / " << m_petState.getXPForNextLevel() << " for next level";
+        m_out << " / " << m_petState.getXPForNextLevel() << " for next level";
     }
-    std::cout << std::endl;
+    m_out << std::endl;
 }
 
-void InteractionManager::playWithPet() noexcept {
+void InteractionManager::playWithPet(uint32_t times) noexcept {
     // Get maximum stat value for this evolution level
     float maxStatValue = m_petState.getMaxStatValue();
     
     // Check if pet was already at max happiness
     bool wasMax = (m_petState.getHappiness() >= maxStatValue - 0.01f); // Small epsilon to handle floating point comparisons
+    uint32_t xpBefore = m_petState.getXP();
+    auto levelBefore = m_petState.getEvolutionLevel();
     
-    // Increase happiness and decrease energy using absolute values from config
-    m_petState.increaseHappiness(GameConfig::getPlayingHappinessIncrease());
-    m_petState.decreaseEnergy(GameConfig::getPlayingEnergyDecrease());
-    
-    // Add XP
-    bool evolved = m_petState.addXP(GameConfig::getPlayingXPGain());
-    
-    // Update interaction time
-    m_petState.updateInteractionTime();
-    
-    // Track play count for Playful achievement
-    m_petState.getAchievementSystem().incrementProgress(AchievementType::Playful);
+    // Increase happiness, decrease energy, add XP and track play count for Playful achievement, all plays at once
+    bool evolved = m_petState.applyPlaying(std::chrono::system_clock::now(), times);
     
     // Display message
+    showBatchSummary("played with", times, xpBefore);
     if (evolved) {
-        std::cout << "Your pet " << m_petState.getName() << " has evolved to " 
-                << m_displayManager.getEvolutionLevelName(m_petState.getEvolutionLevel()) 
-                << "!" << std::endl;
-        std::cout << m_petState.getAsciiArt() << std::endl;
-        std::cout << m_petState.getDescription() << std::endl;
+        showEvolution(levelBefore);
+        maxStatValue = m_petState.getMaxStatValue();
     } else if (wasMax && m_petState.getHappiness() >= maxStatValue - 0.01f) {
         m_displayManager.displayMessage("Your pet is already extremely happy! It's having the time of its life!");
     } else {
@@ -103,15 +89,34 @@ void InteractionManager::playWithPet() noexcept {
     m_achievementManager.displayNewlyUnlockedAchievements();
     
     // Show current stats (display absolute values, not percentages)
-    std::cout << "Happiness: " << static_cast<int>(std::floor(m_petState.getHappiness())) << " / " 
+    m_out << "Happiness: " << static_cast<int>(std::floor(m_petState.getHappiness())) << " / " 
               << static_cast<int>(maxStatValue) << std::endl;
-    std::cout << "Energy: " << static_cast<int>(std::floor(m_petState.getEnergy())) << " / " 
+    m_out << "Energy: " << static_cast<int>(std::floor(m_petState.getEnergy())) << " / " 
               << static_cast<int>(maxStatValue) << std::endl;
-    std::cout << "XP: " << m_petState.getXP();
+    m_out << "XP: " << m_petState.getXP();
     if (m_petState.getEvolutionLevel() != EvolutionLevel::Ancient) {
-        std::cout << " / " << m_petState.getXPForNextLevel() << " for next level";
+        m_out << " / " << m_petState.getXPForNextLevel() << " for next level";
+    }
+    m_out << std::endl;
+}
+
+void InteractionManager::showBatchSummary(std::string_view action, uint32_t times, uint32_t xpBefore) const noexcept {
+    if (times > 1) {
+        m_out << "You " << action << " " << m_petState.getName() << " " << times << " times (+"
+                  << m_petState.getXP() - xpBefore << " XP)." << std::endl;
+    }
+}
+
+void InteractionManager::showEvolution(EvolutionLevel levelBefore) const noexcept {
+    auto levelsGained = static_cast<int>(m_petState.getEvolutionLevel()) - static_cast<int>(levelBefore);
+    m_out << "Your pet " << m_petState.getName() << " has evolved to " 
+            << m_displayManager.getEvolutionLevelName(m_petState.getEvolutionLevel());
+    if (levelsGained > 1) {
+        m_out << ", skipping ahead " << levelsGained << " levels";
     }
-    std::cout << std::endl;
+    m_out << "!" << std::endl;
+    m_out << m_petState.getAsciiArt() << std::endl;
+    m_out << m_petState.getDescription() << std::endl;
 }
 
 void InteractionManager::showStatus() const noexcept {
@@ -139,23 +144,23 @@ void InteractionManager::showStatus() const noexcept {
     int hours = (timeSinceLastInteraction % (60 * 24)) / 60;
     int minutes = timeSinceLastInteraction % 60;
     
-    std::cout << "Last interaction: " << lastInteractionStr;
-    std::cout << " (";
+    m_out << "Last interaction: " << lastInteractionStr;
+    m_out << " (";
     if (days > 0) {
-        std::cout << days << "d";
+        m_out << days << "d";
         if (hours > 0 || minutes > 0) {
-            std::cout << " ";
+            m_out << " ";
         }
     }
     if (hours > 0) {
-        std::cout << hours << "h";
+        m_out << hours << "h";
         if (minutes > 0) {
-            std::cout << " ";
+            m_out << " ";
         }
     }
-    std::cout << minutes << "m";
-    std::cout << ")";
-    std::cout << std::endl;
+    m_out << minutes << "m";
+    m_out << ")";
+    m_out << std::endl;
     
     // Handle birth date
     auto birthTime_t = std::chrono::system_clock::to_time_t(birthDate);
@@ -174,108 +179,108 @@ void InteractionManager::showStatus() const noexcept {
     int ageYears = age / (24 * 365);
     int ageDays = (age % (24 * 365)) / 24;
     
-    std::cout << "Birth date: " << birthDateStr;
-    std::cout << " (";
+    m_out << "Birth date: " << birthDateStr;
+    m_out << " (";
     if (ageYears > 0) {
-        std::cout << ageYears << "y";
+        m_out << ageYears << "y";
         if (ageDays > 0) {
-            std::cout << " ";
+            m_out << " ";
         }
     }
     
     // Always show days, even if 0 days
-    std::cout << ageDays << "d";
+    m_out << ageDays << "d";
     
-    std::cout << ")";
-    std::cout << std::endl << std::endl;
+    m_out << ")";
+    m_out << std::endl << std::endl;
 }
 
 void InteractionManager::showEvolutionProgress() const noexcept {
-    std::cout << "\n" << m_petState.getAsciiArt() << std::endl;
+    m_out << "\n" << m_petState.getAsciiArt() << std::endl;
     
-    std::cout << "Current evolution: ";
+    m_out << "Current evolution: ";
     switch (m_petState.getEvolutionLevel()) {
         case EvolutionLevel::Egg:
-            std::cout << "Egg (Level 0)";
+            m_out << "Egg (Level 0)";
             break;
         case EvolutionLevel::Baby:
-            std::cout << "Baby (Level 1)";
+            m_out << "Baby (Level 1)";
             break;
         case EvolutionLevel::Child:
-            std::cout << "Child (Level 2)";
+            m_out << "Child (Level 2)";
             break;
         case EvolutionLevel::Teen:
-            std::cout << "Teen (Level 3)";
+            m_out << "Teen (Level 3)";
             break;
         case EvolutionLevel::Adult:
-            std::cout << "Adult (Level 4)";
+            m_out << "Adult (Level 4)";
             break;
         case EvolutionLevel::Master:
-            std::cout << "Master (Level 5)";
+            m_out << "Master (Level 5)";
             break;
         case EvolutionLevel::Ancient:
-            std::cout << "Ancient";
+            m_out << "Ancient";
             break;
     }
-    std::cout << std::endl;
+    m_out << std::endl;
     
-    std::cout << "Description: " << m_petState.getDescription() << std::endl;
+    m_out << "Description: " << m_petState.getDescription() << std::endl;
     
     if (m_petState.getEvolutionLevel() != EvolutionLevel::Ancient) {
         uint32_t currentXP = m_petState.getXP();
         uint32_t requiredXP = m_petState.getXPForNextLevel();
         float percentage = static_cast<float>(currentXP) / requiredXP * 100.0f;
         
-        std::cout << "\nProgress to next evolution:" << std::endl;
-        std::cout << "XP: " << currentXP << " / " << requiredXP 
+        m_out << "\nProgress to next evolution:" << std::endl;
+        m_out << "XP: " << currentXP << " / " << requiredXP 
                 << " (" << static_cast<int>(percentage) << "%)" << std::endl;
         
         // Display a simple progress bar
-        std::cout << "[";
+        m_out << "[";
         int barWidth = 20;
         int pos = static_cast<int>(barWidth * percentage / 100.0f);
         for (int i = 0; i < barWidth; ++i) {
-            if (i < pos) std::cout << "=";
-            else if (i == pos) std::cout << ">";
-            else std::cout << " ";
+            if (i < pos) m_out << "=";
+            else if (i == pos) m_out << ">";
+            else m_out << " ";
         }
-        std::cout << "] " << static_cast<int>(percentage) << "%" << std::endl;
+        m_out << "] " << static_cast<int>(percentage) << "%" << std::endl;
         
         // Show next evolution level
-        std::cout << "\nNext evolution: ";
+        m_out << "\nNext evolution: ";
         switch (m_petState.getEvolutionLevel()) {
             case EvolutionLevel::Egg:
-                std::cout << "Baby (Level 1)";
+                m_out << "Baby (Level 1)";
                 break;
             case EvolutionLevel::Baby:
-                std::cout << "Child (Level 2)";
+                m_out << "Child (Level 2)";
                 break;
             case EvolutionLevel::Child:
-                std::cout << "Teen (Level 3)";
+                m_out << "Teen (Level 3)";
                 break;
             case EvolutionLevel::Teen:
-                std::cout << "Adult (Level 4)";
+                m_out << "Adult (Level 4)";
                 break;
             case EvolutionLevel::Adult:
-                std::cout << "Master (Level 5)";
+                m_out << "Master (Level 5)";
                 break;
             case EvolutionLevel::Master:
-                std::cout << "Ancient";
+                m_out << "Ancient";
                 break;
             case EvolutionLevel::Ancient:
-                std::cout << "Already at maximum evolution";
+                m_out << "Already at maximum evolution";
                 break;
         }
-        std::cout << std::endl;
+        m_out << std::endl;
     } else {
-        std::cout << "\nYour pet has reached the highest evolution level!" << std::endl;
+        m_out << "\nYour pet has reached the highest evolution level!" << std::endl;
     }
 }
 
 bool InteractionManager::createNewPet(bool force) noexcept {
     // Check if a save file exists and we're not forcing overwrite
     if (m_petState.saveFileExists() && !force) {
-        std::cout << "A pet already exists. Do you want to overwrite it? (yes/no): ";
+        m_out << "A pet already exists. Do you want to overwrite it? (yes/no): ";
         std::string response;
         std::getline(std::cin, response);
         
@@ -284,13 +289,13 @@ bool InteractionManager::createNewPet(bool force) noexcept {
                       [](unsigned char c) { return std::tolower(c); });
         
         if (response != "yes" && response != "y") {
-            std::cout << "Pet creation cancelled." << std::endl;
+            m_out << "Pet creation cancelled." << std::endl;
             return false;
         }
     }
     
     // Ask for pet name
-    std::cout << "Enter a name for your new pet: ";
+    m_out << "Enter a name for your new pet: ";
     std::string name;
     std::getline(std::cin, name);
     
@@ -305,7 +310,7 @@ bool InteractionManager::createNewPet(bool force) noexcept {
     
     // Initialize new pet with the given name
     m_petState.initialize(name);
-    std::cout << "\nCreated a new pet named '" << name << "'!" << std::endl;
+    m_out << "\nCreated a new pet named '" << name << "'!" << std::endl;
     
     // Show the new pet's status
     showStatus();
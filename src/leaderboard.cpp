@@ -0,0 +1,192 @@
+#include "../include/leaderboard.h"
+#include "../include/binary_schema.h"
+#include "../include/mapped_file.h"
+#include "../include/atomic_file_writer.h"
+#include "../include/crc32c.h"
+#include <iostream>
+#include <cstring>
+
+namespace {
+    constexpr char LEADERBOARD_MAGIC[8] = { 'P', 'E', 'T', 'L', 'D', 'R', 'B', '1' };
+
+    // Schema version of the leaderboard structures
+    constexpr uint8_t LEADERBOARD_SCHEMA_VERSION = 1;
+
+    constexpr auto LEADERBOARD_HEADER_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("entryCount", &Leaderboard::LeaderboardHeader::entryCount),
+        BinarySchema::field("checksum", &Leaderboard::LeaderboardHeader::checksum),
+        BinarySchema::field("reserved32", &Leaderboard::LeaderboardHeader::reserved32)
+    );
+
+    constexpr size_t LEADERBOARD_HEADER_SIZE = LEADERBOARD_HEADER_SCHEMA.encodedSize(LEADERBOARD_SCHEMA_VERSION);
+
+    // Pet ID, XP and birth date
+    constexpr size_t ENTRY_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(int64_t);
+}
+
+void Leaderboard::update(const Entry& entry) {
+    auto [it, inserted] = m_entries.try_emplace(entry.petId, entry);
+    if (!inserted) {
+        // Most saves change neither the XP nor the birth date
+        if (it->second.xp == entry.xp && it->second.birthSeconds == entry.birthSeconds) {
+            return;
+        }
+        m_byXP.erase(xpKey(it->second));
+        m_byAge.erase(ageKey(it->second));
+        it->second = entry;
+    }
+    m_byXP.insert(xpKey(entry));
+    m_byAge.insert(ageKey(entry));
+}
+
+bool Leaderboard::remove(uint64_t petId) noexcept {
+    auto it = m_entries.find(petId);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    m_byXP.erase(xpKey(it->second));
+    m_byAge.erase(ageKey(it->second));
+    m_entries.erase(it);
+    return true;
+}
+
+void Leaderboard::clear() noexcept {
+    m_entries.clear();
+    m_byXP.clear();
+    m_byAge.clear();
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::getTopXP(size_t count, size_t offset) const {
+    return lookup(m_byXP.range(offset, count));
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::getOldest(size_t count, size_t offset) const {
+    return lookup(m_byAge.range(offset, count));
+}
+
+std::optional<size_t> Leaderboard::getXPRank(uint64_t petId) const noexcept {
+    auto it = m_entries.find(petId);
+    if (it == m_entries.end()) {
+        return std::nullopt;
+    }
+    return m_byXP.rank(xpKey(it->second)) + 1;
+}
+
+std::optional<size_t> Leaderboard::getAgeRank(uint64_t petId) const noexcept {
+    auto it = m_entries.find(petId);
+    if (it == m_entries.end()) {
+        return std::nullopt;
+    }
+    return m_byAge.rank(ageKey(it->second)) + 1;
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::lookup(const std::vector<OrderStatisticTree::Key>& keys) const {
+    std::vector<Entry> entries;
+    entries.reserve(keys.size());
+    for (const auto& key : keys) {
+        entries.push_back(m_entries.at(key.id));
+    }
+    return entries;
+}
+
+bool Leaderboard::load(const std::filesystem::path& path) noexcept {
+    try {
+        clear();
+
+        MappedFile mappedFile(path);
+        if (!mappedFile.isOpen()) {
+            return false;
+        }
+
+        auto bytes = mappedFile.data();
+        if (bytes.size() < sizeof(LEADERBOARD_MAGIC) ||
+            std::memcmp(bytes.data(), LEADERBOARD_MAGIC, sizeof(LEADERBOARD_MAGIC)) != 0) {
+            std::cerr << "Invalid leaderboard: " << path.string() << std::endl;
+            return false;
+        }
+
+        BinarySchema::Reader reader(bytes.subspan(sizeof(LEADERBOARD_MAGIC)));
+        LeaderboardHeader header;
+        if (!LEADERBOARD_HEADER_SCHEMA.decode(reader.readBytes(LEADERBOARD_HEADER_SIZE), LEADERBOARD_SCHEMA_VERSION, header)) {
+            std::cerr << "Truncated leaderboard: " << path.string() << std::endl;
+            return false;
+        }
+
+        auto body = reader.readBytes(static_cast<size_t>(header.entryCount) * (ENTRY_SIZE + sizeof(uint32_t)));
+        if (!reader.ok() || Crc32c::compute(body) != header.checksum) {
+            std::cerr << "Corrupt leaderboard: " << path.string() << std::endl;
+            return false;
+        }
+
+        BinarySchema::Reader bodyReader(body);
+        std::vector<Entry> byXP(header.entryCount);
+        std::vector<OrderStatisticTree::Key> keys(header.entryCount);
+        m_entries.reserve(header.entryCount);
+        for (uint32_t i = 0; i < header.entryCount; ++i) {
+            Entry& entry = byXP[i];
+            bodyReader.read(entry.petId);
+            bodyReader.read(entry.xp);
+            bodyReader.read(entry.birthSeconds);
+            keys[i] = xpKey(entry);
+            m_entries.emplace(entry.petId, entry);
+        }
+
+        // assign() rejects keys out of order; a pet listed twice leaves fewer entries
+        bool valid = m_entries.size() == header.entryCount && m_byXP.assign(keys);
+        for (uint32_t i = 0; valid && i < header.entryCount; ++i) {
+            uint32_t index = 0;
+            bodyReader.read(index);
+            valid = index < byXP.size();
+            if (valid) {
+                keys[i] = ageKey(byXP[index]);
+            }
+        }
+        if (!valid || !bodyReader.ok() || !m_byAge.assign(keys)) {
+            std::cerr << "Corrupt leaderboard: " << path.string() << std::endl;
+            clear();
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while loading leaderboard: " << e.what() << std::endl;
+        clear();
+        return false;
+    }
+}
+
+bool Leaderboard::save(const std::filesystem::path& path) const noexcept {
+    try {
+        size_t count = m_entries.size();
+        std::vector<std::byte> image(sizeof(LEADERBOARD_MAGIC) + LEADERBOARD_HEADER_SIZE +
+                                     count * (ENTRY_SIZE + sizeof(uint32_t)));
+        std::memcpy(image.data(), LEADERBOARD_MAGIC, sizeof(LEADERBOARD_MAGIC));
+        size_t bodyStart = sizeof(LEADERBOARD_MAGIC) + LEADERBOARD_HEADER_SIZE;
+        std::byte* out = image.data() + bodyStart;
+
+        // Position of every pet in XP order, for the age order that follows
+        std::unordered_map<uint64_t, uint32_t> positions;
+        positions.reserve(count);
+        m_byXP.forEach([&](const OrderStatisticTree::Key& key) {
+            const Entry& entry = m_entries.at(key.id);
+            positions.emplace(entry.petId, static_cast<uint32_t>(positions.size()));
+            BinarySchema::storeLE(out, entry.petId);
+            BinarySchema::storeLE(out + sizeof(uint64_t), entry.xp);
+            BinarySchema::storeLE(out + sizeof(uint64_t) + sizeof(uint32_t), entry.birthSeconds);
+            out += ENTRY_SIZE;
+        });
+        m_byAge.forEach([&](const OrderStatisticTree::Key& key) {
+            BinarySchema::storeLE(out, positions.at(key.id));
+            out += sizeof(uint32_t);
+        });
+
+        LeaderboardHeader header{ static_cast<uint32_t>(count), Crc32c::compute(std::span(image).subspan(bodyStart)), 0 };
+        LEADERBOARD_HEADER_SCHEMA.encode(header, LEADERBOARD_SCHEMA_VERSION,
+                                         std::span(image).subspan(sizeof(LEADERBOARD_MAGIC)));
+
+        AtomicFileWriter writer;
+        return writer.write(path, image);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while saving leaderboard: " << e.what() << std::endl;
+        return false;
+    }
+}
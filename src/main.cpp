@@ -9,6 +9,8 @@
 #include "../include/pet_state.h"
 #include "../include/game_logic.h"
 #include "../include/ui_manager.h"
+#include "../include/admin_commands.h"
+#include "../include/daemon_client.h"
 
 int main(int argc, char* argv[]) {
     try {
@@ -19,6 +21,19 @@ int main(int argc, char* argv[]) {
             args.push_back(argv[i]);
         }
 
+        // Admin commands work on state files directly, without loading a pet
+        AdminCommands adminCommands;
+        if (!args.empty() && adminCommands.isAdminCommand(args[0])) {
+            return adminCommands.run(args);
+        }
+
+        // A running `pet daemon` has the pet loaded already
+        if (!args.empty() && DaemonClient::isForwardable(args[0])) {
+            if (auto exitCode = DaemonClient::forward(args)) {
+                return *exitCode;
+            }
+        }
+
         // Create command parser
         auto parser = std::make_unique<CommandParser>();
         
@@ -45,9 +60,8 @@ int main(int argc, char* argv[]) {
                         // Set up cyclic reference AFTER creating the object via shared_ptr
                         gameLogic->initializeUIManager();
                         
+                        // Creates and saves the new pet
                         gameLogic->createNewPet(true);
-                        // Save the new pet
-                        petState->save();
                         // Run interactive mode
                         gameLogic->runInteractiveMode();
                     } else {
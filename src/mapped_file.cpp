@@ -0,0 +1,86 @@
+#include "../include/mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& path) noexcept {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return;
+    }
+
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    if (m_size > 0) {
+        m_mappingHandle = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_mappingHandle) {
+            m_data = static_cast<const std::byte*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!m_data) {
+            if (m_mappingHandle) {
+                CloseHandle(m_mappingHandle);
+                m_mappingHandle = nullptr;
+            }
+            CloseHandle(file);
+            m_size = 0;
+            return;
+        }
+    }
+
+    // The mapping keeps its own reference to the file
+    CloseHandle(file);
+    m_isOpen = true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat fileStat;
+    if (::fstat(fd, &fileStat) != 0) {
+        ::close(fd);
+        return;
+    }
+
+    m_size = static_cast<size_t>(fileStat.st_size);
+    if (m_size > 0) {
+        void* mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            m_size = 0;
+            return;
+        }
+        m_data = static_cast<const std::byte*>(mapping);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    m_isOpen = true;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    if (!m_data) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mappingHandle);
+#else
+    ::munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+}
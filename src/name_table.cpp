@@ -0,0 +1,26 @@
+#include "../include/name_table.h"
+
+NameTable::NameTable() {
+    intern({});
+}
+
+uint32_t NameTable::intern(std::string_view name) {
+    auto it = m_ids.find(name);
+    if (it != m_ids.end()) {
+        return it->second;
+    }
+
+    auto id = static_cast<uint32_t>(m_names.size());
+    const std::string& stored = m_names.emplace_back(name);
+    m_ids.emplace(stored, id);
+    return id;
+}
+
+bool NameTable::find(std::string_view name, uint32_t& id) const noexcept {
+    auto it = m_ids.find(name);
+    if (it == m_ids.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
@@ -0,0 +1,226 @@
+#include "../include/order_statistic_tree.h"
+#include <bit>
+
+void OrderStatisticTree::clear() noexcept {
+    m_nodes.clear();
+    m_free.clear();
+    m_root = NIL;
+}
+
+void OrderStatisticTree::insert(const Key& key) {
+    uint32_t node = allocate(key);
+    m_root = insertInto(m_root, node);
+}
+
+bool OrderStatisticTree::erase(const Key& key) noexcept {
+    return eraseFrom(m_root, key);
+}
+
+size_t OrderStatisticTree::rank(const Key& key) const noexcept {
+    size_t rank = 0;
+    uint32_t node = m_root;
+    while (node != NIL) {
+        const Node& current = m_nodes[node];
+        if (current.key < key) {
+            rank += sizeOf(current.left) + 1;
+            node = current.right;
+        } else {
+            node = current.left;
+        }
+    }
+    return rank;
+}
+
+std::optional<OrderStatisticTree::Key> OrderStatisticTree::select(size_t position) const noexcept {
+    uint32_t node = m_root;
+    while (node != NIL) {
+        const Node& current = m_nodes[node];
+        size_t leftSize = sizeOf(current.left);
+        if (position < leftSize) {
+            node = current.left;
+        } else if (position == leftSize) {
+            return current.key;
+        } else {
+            position -= leftSize + 1;
+            node = current.right;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<OrderStatisticTree::Key> OrderStatisticTree::range(size_t first, size_t count) const {
+    std::vector<Key> keys;
+    if (first >= size() || count == 0) {
+        return keys;
+    }
+    keys.reserve(std::min(count, size() - first));
+
+    // Descend to the first key, keeping the nodes still to be visited after it:
+    // those where the search went left, and the first key itself
+    std::vector<uint32_t> stack;
+    uint32_t node = m_root;
+    while (node != NIL) {
+        const Node& current = m_nodes[node];
+        size_t leftSize = sizeOf(current.left);
+        if (first < leftSize) {
+            stack.push_back(node);
+            node = current.left;
+        } else if (first == leftSize) {
+            stack.push_back(node);
+            break;
+        } else {
+            first -= leftSize + 1;
+            node = current.right;
+        }
+    }
+
+    // Then walk in order
+    while (!stack.empty() && keys.size() < count) {
+        node = stack.back();
+        stack.pop_back();
+        keys.push_back(m_nodes[node].key);
+        for (node = m_nodes[node].right; node != NIL; node = m_nodes[node].left) {
+            stack.push_back(node);
+        }
+    }
+    return keys;
+}
+
+bool OrderStatisticTree::assign(std::span<const Key> keys) {
+    clear();
+    for (size_t i = 1; i < keys.size(); ++i) {
+        if (!(keys[i - 1] < keys[i])) {
+            return false;
+        }
+    }
+    m_nodes.reserve(keys.size());
+
+    // Build the Cartesian tree of the priorities, keeping its right spine on a stack
+    std::vector<uint32_t> spine;
+    for (const auto& key : keys) {
+        uint32_t node = allocate(key);
+        uint32_t last = NIL;
+        while (!spine.empty() && m_nodes[spine.back()].priority < m_nodes[node].priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        m_nodes[node].left = last;
+        if (!spine.empty()) {
+            m_nodes[spine.back()].right = node;
+        }
+        spine.push_back(node);
+    }
+    m_root = spine.empty() ? NIL : spine.front();
+    computeSizes(m_root);
+    return true;
+}
+
+uint64_t OrderStatisticTree::priorityOf(const Key& key) noexcept {
+    // SplitMix64 finalizer over both halves of the key
+    uint64_t x = key.id ^ std::rotl(key.score, 32) ^ 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+uint32_t OrderStatisticTree::allocate(const Key& key) {
+    Node node{key, priorityOf(key), NIL, NIL, 1};
+    if (!m_free.empty()) {
+        uint32_t index = m_free.back();
+        m_free.pop_back();
+        m_nodes[index] = node;
+        return index;
+    }
+    m_nodes.push_back(node);
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+uint32_t OrderStatisticTree::insertInto(uint32_t node, uint32_t newNode) noexcept {
+    if (node == NIL) {
+        return newNode;
+    }
+
+    // The new node goes where its priority fits, taking the keys below it as children
+    const Key& key = m_nodes[newNode].key;
+    if (m_nodes[newNode].priority > m_nodes[node].priority) {
+        auto [left, right] = split(node, key);
+        m_nodes[newNode].left = left;
+        m_nodes[newNode].right = right;
+        updateSize(newNode);
+        return newNode;
+    }
+
+    ++m_nodes[node].size;
+    if (key < m_nodes[node].key) {
+        m_nodes[node].left = insertInto(m_nodes[node].left, newNode);
+    } else {
+        m_nodes[node].right = insertInto(m_nodes[node].right, newNode);
+    }
+    return node;
+}
+
+std::pair<uint32_t, uint32_t> OrderStatisticTree::split(uint32_t node, const Key& key) noexcept {
+    if (node == NIL) {
+        return {NIL, NIL};
+    }
+    if (m_nodes[node].key < key) {
+        auto [left, right] = split(m_nodes[node].right, key);
+        m_nodes[node].right = left;
+        updateSize(node);
+        return {node, right};
+    }
+    auto [left, right] = split(m_nodes[node].left, key);
+    m_nodes[node].left = right;
+    updateSize(node);
+    return {left, node};
+}
+
+uint32_t OrderStatisticTree::merge(uint32_t left, uint32_t right) noexcept {
+    if (left == NIL) {
+        return right;
+    }
+    if (right == NIL) {
+        return left;
+    }
+    if (m_nodes[left].priority > m_nodes[right].priority) {
+        m_nodes[left].right = merge(m_nodes[left].right, right);
+        updateSize(left);
+        return left;
+    }
+    m_nodes[right].left = merge(left, m_nodes[right].left);
+    updateSize(right);
+    return right;
+}
+
+bool OrderStatisticTree::eraseFrom(uint32_t& node, const Key& key) noexcept {
+    if (node == NIL) {
+        return false;
+    }
+    if (m_nodes[node].key == key) {
+        uint32_t removed = node;
+        node = merge(m_nodes[removed].left, m_nodes[removed].right);
+        m_free.push_back(removed);
+        return true;
+    }
+
+    // Children are taken by value: m_free may grow, but m_nodes never moves here
+    uint32_t child = key < m_nodes[node].key ? m_nodes[node].left : m_nodes[node].right;
+    if (!eraseFrom(child, key)) {
+        return false;
+    }
+    if (key < m_nodes[node].key) {
+        m_nodes[node].left = child;
+    } else {
+        m_nodes[node].right = child;
+    }
+    --m_nodes[node].size;
+    return true;
+}
+
+uint32_t OrderStatisticTree::computeSizes(uint32_t node) noexcept {
+    if (node == NIL) {
+        return 0;
+    }
+    m_nodes[node].size = 1 + computeSizes(m_nodes[node].left) + computeSizes(m_nodes[node].right);
+    return m_nodes[node].size;
+}
@@ -0,0 +1,349 @@
+#include "../include/pet_archive.h"
+#include "../include/binary_schema.h"
+#include "../include/mapped_file.h"
+#include "../include/atomic_file_writer.h"
+#include "../include/crc32c.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+    constexpr char ARCHIVE_MAGIC[8] = { 'P', 'E', 'T', 'A', 'R', 'C', 'H', '1' };
+
+    // Schema version of the archive structures
+    constexpr uint8_t ARCHIVE_SCHEMA_VERSION = 1;
+
+    // Raw deflate: the entry checksum replaces the zlib header and trailer
+    constexpr int RAW_DEFLATE_WINDOW_BITS = -15;
+
+    constexpr auto ARCHIVE_HEADER_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("dictionarySize", &PetArchive::ArchiveHeader::dictionarySize),
+        BinarySchema::field("dictionaryChecksum", &PetArchive::ArchiveHeader::dictionaryChecksum),
+        BinarySchema::field("entryCount", &PetArchive::ArchiveHeader::entryCount),
+        BinarySchema::field("reserved32", &PetArchive::ArchiveHeader::reserved32)
+    );
+
+    constexpr auto ENTRY_HEADER_SCHEMA = BinarySchema::makeSchema(
+        BinarySchema::field("nameLength", &PetArchive::EntryHeader::nameLength),
+        BinarySchema::field("reserved16", &PetArchive::EntryHeader::reserved16),
+        BinarySchema::field("rawSize", &PetArchive::EntryHeader::rawSize),
+        BinarySchema::field("compressedSize", &PetArchive::EntryHeader::compressedSize),
+        BinarySchema::field("checksum", &PetArchive::EntryHeader::checksum)
+    );
+
+    constexpr size_t ARCHIVE_HEADER_SIZE = ARCHIVE_HEADER_SCHEMA.encodedSize(ARCHIVE_SCHEMA_VERSION);
+    constexpr size_t ENTRY_HEADER_SIZE = ENTRY_HEADER_SCHEMA.encodedSize(ARCHIVE_SCHEMA_VERSION);
+
+    Bytef* zlibBytes(const std::byte* bytes) noexcept {
+        return reinterpret_cast<Bytef*>(const_cast<std::byte*>(bytes));
+    }
+
+    /**
+     * @brief Compress with raw deflate against a preset dictionary
+     * @param input Data to compress
+     * @param dictionary Preset dictionary, may be empty
+     * @param output Output buffer, resized to the compressed size
+     * @return True if successful
+     */
+    bool deflateWithDictionary(std::span<const std::byte> input, std::span<const std::byte> dictionary,
+                               std::vector<std::byte>& output) {
+        z_stream stream{};
+        if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, RAW_DEFLATE_WINDOW_BITS, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+
+        bool ok = dictionary.empty() ||
+                  deflateSetDictionary(&stream, zlibBytes(dictionary.data()), static_cast<uInt>(dictionary.size())) == Z_OK;
+        if (ok) {
+            output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+            stream.next_in = zlibBytes(input.data());
+            stream.avail_in = static_cast<uInt>(input.size());
+            stream.next_out = zlibBytes(output.data());
+            stream.avail_out = static_cast<uInt>(output.size());
+            ok = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+            output.resize(stream.total_out);
+        }
+
+        deflateEnd(&stream);
+        return ok;
+    }
+
+    /**
+     * @brief Decompress raw deflate data made by deflateWithDictionary()
+     * @param input Compressed data
+     * @param dictionary The dictionary used for compression
+     * @param output Output buffer, already sized to the expected decompressed size
+     * @return True if the data decompressed to exactly output.size() bytes
+     */
+    bool inflateWithDictionary(std::span<const std::byte> input, std::span<const std::byte> dictionary,
+                               std::span<std::byte> output) {
+        z_stream stream{};
+        if (inflateInit2(&stream, RAW_DEFLATE_WINDOW_BITS) != Z_OK) {
+            return false;
+        }
+
+        bool ok = dictionary.empty() ||
+                  inflateSetDictionary(&stream, zlibBytes(dictionary.data()), static_cast<uInt>(dictionary.size())) == Z_OK;
+        if (ok) {
+            stream.next_in = zlibBytes(input.data());
+            stream.avail_in = static_cast<uInt>(input.size());
+            stream.next_out = zlibBytes(output.data());
+            stream.avail_out = static_cast<uInt>(output.size());
+            ok = inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out == output.size();
+        }
+
+        inflateEnd(&stream);
+        return ok;
+    }
+}
+
+PetArchive::Lock::Lock(const std::filesystem::path& archivePath) noexcept {
+    try {
+        auto lockPath = archivePath.parent_path() / LOCK_FILE_NAME;
+#ifdef _WIN32
+        HANDLE handle = CreateFileW(lockPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                    nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            std::cerr << "Cannot open archive lock: " << lockPath.string() << std::endl;
+            return;
+        }
+        m_handle = handle;
+        OVERLAPPED overlapped{};
+        m_locked = LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped) != 0;
+#else
+        m_fd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (m_fd < 0) {
+            std::cerr << "Cannot open archive lock: " << lockPath.string() << std::endl;
+            return;
+        }
+        int result;
+        do {
+            result = ::flock(m_fd, LOCK_EX);
+        } while (result != 0 && errno == EINTR);
+        m_locked = result == 0;
+#endif
+        if (!m_locked) {
+            std::cerr << "Cannot lock archive: " << archivePath.string() << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while locking pet archive: " << e.what() << std::endl;
+    }
+}
+
+PetArchive::Lock::~Lock() {
+    // Closing the file releases the lock
+#ifdef _WIN32
+    if (m_handle) {
+        CloseHandle(static_cast<HANDLE>(m_handle));
+    }
+#else
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+#endif
+}
+
+std::filesystem::path PetArchive::archivePathFor(const std::filesystem::path& statePath) {
+    return statePath.parent_path() / FILE_NAME;
+}
+
+bool PetArchive::open(const std::filesystem::path& path) noexcept {
+    try {
+        m_path = path;
+        m_dictionary.clear();
+        m_entries.clear();
+
+        MappedFile mappedFile(path);
+        if (!mappedFile.isOpen()) {
+            // A missing archive is simply empty
+            return !std::filesystem::exists(path);
+        }
+
+        auto bytes = mappedFile.data();
+        if (bytes.size() < sizeof(ARCHIVE_MAGIC) || std::memcmp(bytes.data(), ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0) {
+            std::cerr << "Invalid pet archive: " << path.string() << std::endl;
+            return false;
+        }
+
+        BinarySchema::Reader reader(bytes.subspan(sizeof(ARCHIVE_MAGIC)));
+        ArchiveHeader header;
+        if (!ARCHIVE_HEADER_SCHEMA.decode(reader.readBytes(ARCHIVE_HEADER_SIZE), ARCHIVE_SCHEMA_VERSION, header)) {
+            std::cerr << "Truncated pet archive: " << path.string() << std::endl;
+            return false;
+        }
+
+        auto dictionary = reader.readBytes(header.dictionarySize);
+        if (!reader.ok() || Crc32c::compute(dictionary) != header.dictionaryChecksum) {
+            std::cerr << "Corrupt pet archive dictionary: " << path.string() << std::endl;
+            return false;
+        }
+        m_dictionary.assign(dictionary.begin(), dictionary.end());
+
+        for (uint32_t i = 0; i < header.entryCount; ++i) {
+            EntryHeader entryHeader;
+            if (!ENTRY_HEADER_SCHEMA.decode(reader.readBytes(ENTRY_HEADER_SIZE), ARCHIVE_SCHEMA_VERSION, entryHeader)) {
+                break;
+            }
+
+            auto name = reader.readBytes(entryHeader.nameLength);
+            auto compressed = reader.readBytes(entryHeader.compressedSize);
+            if (!reader.ok()) {
+                break;
+            }
+
+            m_entries[std::string(reinterpret_cast<const char*>(name.data()), name.size())] =
+                Entry{ entryHeader.rawSize, entryHeader.checksum, std::vector<std::byte>(compressed.begin(), compressed.end()) };
+        }
+
+        if (!reader.ok()) {
+            std::cerr << "Truncated pet archive: " << path.string() << std::endl;
+            m_entries.clear();
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while opening pet archive: " << e.what() << std::endl;
+        m_entries.clear();
+        return false;
+    }
+}
+
+bool PetArchive::trainDictionary() noexcept {
+    if (m_entries.empty()) {
+        return true;
+    }
+
+    try {
+        std::vector<std::vector<std::byte>> images;
+        images.reserve(m_entries.size());
+        for (const auto& [name, entry] : m_entries) {
+            images.emplace_back();
+            if (!get(name, images.back())) {
+                return false;
+            }
+        }
+
+        // zlib finds matches closest to the end of the dictionary most cheaply,
+        // so the dictionary is simply a run of images spread over the archive.
+        // Archives of only a few pets are smaller without one.
+        size_t sampleCount = std::min(images.size() / PETS_PER_DICTIONARY_SAMPLE, MAX_DICTIONARY_SAMPLES);
+        std::vector<std::byte> dictionary;
+        for (size_t i = 0; i < sampleCount; ++i) {
+            const auto& sample = images[i * (images.size() / sampleCount)];
+            if (dictionary.size() + sample.size() > MAX_DICTIONARY_SIZE) {
+                break;
+            }
+            dictionary.insert(dictionary.end(), sample.begin(), sample.end());
+        }
+
+        std::map<std::string, Entry> entries;
+        size_t index = 0;
+        for (const auto& [name, entry] : m_entries) {
+            Entry recompressed{ entry.rawSize, entry.checksum, {} };
+            if (!deflateWithDictionary(images[index++], dictionary, recompressed.compressed)) {
+                return false;
+            }
+            entries.emplace(name, std::move(recompressed));
+        }
+
+        m_dictionary = std::move(dictionary);
+        m_entries = std::move(entries);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while training archive dictionary: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetArchive::get(const std::string& name, std::vector<std::byte>& image) const noexcept {
+    try {
+        auto it = m_entries.find(name);
+        if (it == m_entries.end()) {
+            return false;
+        }
+
+        const auto& entry = it->second;
+        image.resize(entry.rawSize);
+        if (!inflateWithDictionary(entry.compressed, m_dictionary, image) || Crc32c::compute(image) != entry.checksum) {
+            std::cerr << "Corrupt archived pet '" << name << "' in " << m_path.string() << std::endl;
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while extracting archived pet: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetArchive::put(const std::string& name, std::span<const std::byte> image) noexcept {
+    try {
+        Entry entry{ static_cast<uint32_t>(image.size()), Crc32c::compute(image), {} };
+        if (!deflateWithDictionary(image, m_dictionary, entry.compressed)) {
+            std::cerr << "Failed to compress pet '" << name << "'" << std::endl;
+            return false;
+        }
+
+        m_entries[name] = std::move(entry);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while archiving pet: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetArchive::erase(const std::string& name) noexcept {
+    return m_entries.erase(name) != 0;
+}
+
+bool PetArchive::commit() const noexcept {
+    try {
+        if (m_entries.empty()) {
+            std::error_code error;
+            std::filesystem::remove(m_path, error);
+            return !error;
+        }
+
+        size_t totalSize = sizeof(ARCHIVE_MAGIC) + ARCHIVE_HEADER_SIZE + m_dictionary.size();
+        for (const auto& [name, entry] : m_entries) {
+            totalSize += ENTRY_HEADER_SIZE + name.size() + entry.compressed.size();
+        }
+
+        std::vector<std::byte> image(totalSize);
+        std::memcpy(image.data(), ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+        size_t pos = sizeof(ARCHIVE_MAGIC);
+
+        ArchiveHeader header{ static_cast<uint32_t>(m_dictionary.size()), Crc32c::compute(m_dictionary),
+                              static_cast<uint32_t>(m_entries.size()), 0 };
+        ARCHIVE_HEADER_SCHEMA.encode(header, ARCHIVE_SCHEMA_VERSION, std::span(image).subspan(pos));
+        pos += ARCHIVE_HEADER_SIZE;
+        std::copy(m_dictionary.begin(), m_dictionary.end(), image.begin() + static_cast<std::ptrdiff_t>(pos));
+        pos += m_dictionary.size();
+
+        for (const auto& [name, entry] : m_entries) {
+            EntryHeader entryHeader{ static_cast<uint16_t>(name.size()), 0, entry.rawSize,
+                                     static_cast<uint32_t>(entry.compressed.size()), entry.checksum };
+            ENTRY_HEADER_SCHEMA.encode(entryHeader, ARCHIVE_SCHEMA_VERSION, std::span(image).subspan(pos));
+            pos += ENTRY_HEADER_SIZE;
+            std::memcpy(image.data() + pos, name.data(), name.size());
+            pos += name.size();
+            std::copy(entry.compressed.begin(), entry.compressed.end(), image.begin() + static_cast<std::ptrdiff_t>(pos));
+            pos += entry.compressed.size();
+        }
+
+        AtomicFileWriter writer;
+        return writer.write(m_path, image);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while writing pet archive: " << e.what() << std::endl;
+        return false;
+    }
+}
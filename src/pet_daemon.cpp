@@ -0,0 +1,1055 @@
+#include "../include/pet_daemon.h"
+#include "../include/daemon_protocol.h"
+#include "../include/shared_ring.h"
+#include "../include/pet_state.h"
+#include "../include/game_logic.h"
+#include "../include/ui_manager.h"
+#include "../include/interaction_journal.h"
+#include "../include/binary_schema.h"
+#include "../include/game_config.h"
+#include <iostream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <csignal>
+#include <future>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+    // Set by SIGINT and SIGTERM, with the wake pipe of the daemon in run()
+    volatile std::sig_atomic_t g_stopRequested = 0;
+    volatile std::sig_atomic_t g_signalWakeFd = -1;
+
+    // Bytes read from a connection at a time
+    constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+
+    // Descriptors a client may pass before using them
+    constexpr size_t MAX_RECEIVED_FDS = 4;
+
+    // A shared memory thread rechecks whether its channel closed this often
+    constexpr std::chrono::milliseconds SHARED_IDLE_TIMEOUT(100);
+
+    // Chunks of the snapshot table; pet IDs beyond have no snapshots
+    constexpr size_t SNAPSHOT_CHUNK_COUNT = GameConfig::Daemon::MAX_SNAPSHOT_PETS / 1024;
+
+    /**
+     * @brief Stream buffer over a fixed span; output past its end is dropped
+     */
+    class SpanStreamBuf : public std::streambuf {
+    public:
+        explicit SpanStreamBuf(std::span<std::byte> buffer) noexcept {
+            auto* begin = reinterpret_cast<char*>(buffer.data());
+            setp(begin, begin + buffer.size());
+        }
+
+        size_t size() const noexcept {
+            return static_cast<size_t>(pptr() - pbase());
+        }
+
+    protected:
+        // Dropped output still counts as written, so the stream never fails
+        int_type overflow(int_type c) override {
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char* text, std::streamsize count) override {
+            auto stored = std::min<std::streamsize>(count, epptr() - pptr());
+            std::memcpy(pptr(), text, static_cast<size_t>(stored));
+            pbump(static_cast<int>(stored));
+            return count;
+        }
+    };
+
+    /**
+     * @brief Get the one name of a state file that all paths to it share
+     *
+     * Pets are keyed by path: two names for one file would load it on two
+     * shards, whose saves would then overwrite each other.
+     */
+    std::string canonicalStatePath(const std::string& statePath) {
+        std::error_code error;
+        auto path = std::filesystem::weakly_canonical(statePath, error);
+        return error ? std::filesystem::path(statePath).lexically_normal().string() : path.string();
+    }
+
+    /**
+     * @brief Check that a response ring takes a command result with the longest text
+     *
+     * The client picks the ring size; a smaller ring would never have room
+     * for the response and leave the channel thread waiting for it.
+     */
+    bool fitsCommandResult(const SharedRing& responses) noexcept {
+        return responses.getMaxRecordSize() >= DaemonProtocol::COMMAND_RESULT_MESSAGE_SIZE + GameConfig::Daemon::SHARED_TEXT_LIMIT;
+    }
+
+    /**
+     * @brief Append captured output in messages of at most the maximum size
+     */
+    void appendOutput(std::vector<std::byte>& output, DaemonProtocol::MessageType type, std::string_view text) {
+        auto bytes = std::as_bytes(std::span(text.data(), text.size()));
+        while (!bytes.empty()) {
+            auto chunk = bytes.first(std::min<size_t>(bytes.size(), GameConfig::Daemon::MAX_MESSAGE_SIZE));
+            DaemonProtocol::appendMessage(output, type, chunk);
+            bytes = bytes.subspan(chunk.size());
+        }
+    }
+
+#ifndef _WIN32
+    void setNonBlocking(int fd) noexcept {
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    /**
+     * @brief Receive bytes and any descriptors passed with them
+     * @return The result of recvmsg()
+     */
+    ssize_t receiveWithDescriptors(int fd, std::byte* data, size_t size, std::vector<int>& descriptors) {
+        iovec buffer{ data, size };
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_RECEIVED_FDS)];
+        msghdr message{};
+        message.msg_iov = &buffer;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        int flags = 0;
+#ifdef MSG_CMSG_CLOEXEC
+        flags |= MSG_CMSG_CLOEXEC;
+#endif
+        ssize_t received = ::recvmsg(fd, &message, flags);
+        if (received < 0) {
+            return received;
+        }
+
+        for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+                continue;
+            }
+            size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; ++i) {
+                int descriptor;
+                std::memcpy(&descriptor, CMSG_DATA(header) + i * sizeof(int), sizeof(int));
+                if (descriptors.size() < MAX_RECEIVED_FDS) {
+                    descriptors.push_back(descriptor);
+                } else {
+                    ::close(descriptor);
+                }
+            }
+        }
+        return received;
+    }
+#endif
+}
+
+PetDaemon::SharedSession::~SharedSession() {
+    if (channel) {
+        channel->close();
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+PetDaemon::PetDaemon(std::filesystem::path socketPath, size_t shardCount, bool pinThreads) noexcept
+    : m_socketPath(std::move(socketPath))
+    , m_reclaimer(GameConfig::Daemon::MAX_SHARED_CHANNELS + 1)
+    , m_snapshotChunks(std::make_unique<std::atomic<SnapshotChunk*>[]>(SNAPSHOT_CHUNK_COUNT))
+    , m_shardCount(shardCount)
+    , m_pinThreads(pinThreads) {
+}
+
+PetDaemon::~PetDaemon() {
+    // Shared memory threads wait on the shards, so they stop first; the shards finish what is queued
+    for (auto& connection : m_connections) {
+        closeConnection(connection);
+    }
+    m_connections.clear();
+    m_runtime.reset();
+    m_shards.clear();
+
+    // No reader is left, so published snapshots go directly
+    for (size_t chunk = 0; chunk < SNAPSHOT_CHUNK_COUNT; ++chunk) {
+        SnapshotChunk* snapshots = m_snapshotChunks[chunk].load(std::memory_order_acquire);
+        if (snapshots) {
+            for (auto& snapshot : snapshots->snapshots) {
+                delete snapshot.load(std::memory_order_acquire);
+            }
+            delete snapshots;
+        }
+    }
+
+#ifndef _WIN32
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        ::unlink(m_socketPath.c_str());
+    }
+    for (int fd : m_wakeFds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+}
+
+int PetDaemon::run() noexcept {
+#ifdef _WIN32
+    std::cerr << "pet daemon needs Unix domain sockets, which this platform does not provide" << std::endl;
+    return 1;
+#else
+    if (!start()) {
+        return 1;
+    }
+
+    // The handler only sets a flag and writes to the pipe, both async-signal-safe
+    g_stopRequested = 0;
+    g_signalWakeFd = m_wakeFds[1];
+    struct sigaction stopAction{};
+    stopAction.sa_handler = [](int) {
+        g_stopRequested = 1;
+        char byte = 0;
+        [[maybe_unused]] auto written = ::write(g_signalWakeFd, &byte, 1);
+    };
+    sigemptyset(&stopAction.sa_mask);
+    struct sigaction oldInt{}, oldTerm{}, oldPipe{};
+    sigaction(SIGINT, &stopAction, &oldInt);
+    sigaction(SIGTERM, &stopAction, &oldTerm);
+
+    // A client that hangs up early must not kill the daemon
+    struct sigaction ignoreAction{};
+    ignoreAction.sa_handler = SIG_IGN;
+    sigemptyset(&ignoreAction.sa_mask);
+    sigaction(SIGPIPE, &ignoreAction, &oldPipe);
+
+    std::cout << "pet daemon listening on " << m_socketPath.string() << std::endl;
+    serve();
+
+    sigaction(SIGINT, &oldInt, nullptr);
+    sigaction(SIGTERM, &oldTerm, nullptr);
+    sigaction(SIGPIPE, &oldPipe, nullptr);
+    g_signalWakeFd = -1;
+
+    std::cout << "pet daemon stopped after " << getCommandCount() << " commands" << std::endl;
+    return 0;
+#endif
+}
+
+bool PetDaemon::start() noexcept {
+#ifdef _WIN32
+    return false;
+#else
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::string socketPath = m_socketPath.string();
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid daemon socket path: " << socketPath << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // A socket file left behind by a daemon that did not exit cleanly is replaced; a live one is not
+    std::error_code error;
+    if (std::filesystem::exists(m_socketPath, error)) {
+        int probeFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        bool alive = probeFd >= 0 && ::connect(probeFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probeFd >= 0) {
+            ::close(probeFd);
+        }
+        if (alive) {
+            std::cerr << "A pet daemon is already listening on " << socketPath << std::endl;
+            return false;
+        }
+        ::unlink(socketPath.c_str());
+    }
+
+    if (::pipe(m_wakeFds) != 0) {
+        std::cerr << "Failed to create daemon wake pipe: " << std::strerror(errno) << std::endl;
+        m_wakeFds[0] = m_wakeFds[1] = -1;
+        return false;
+    }
+    setNonBlocking(m_wakeFds[0]);
+    setNonBlocking(m_wakeFds[1]);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to create daemon socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    setNonBlocking(fd);
+
+    // Only the user who started the daemon may connect
+    mode_t oldMask = ::umask(0077);
+    int bound = ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ::umask(oldMask);
+
+    if (bound != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    m_listenFd = fd;
+    m_stopRequested = false;
+
+    try {
+        if (!m_runtime) {
+            m_runtime = std::make_unique<ShardRuntime>(m_shardCount, m_pinThreads);
+            for (size_t i = 0; i < m_runtime->getShardCount(); ++i) {
+                m_shards.push_back(std::make_unique<Shard>(m_reclaimer));
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to start the daemon's shards: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+#endif
+}
+
+uint64_t PetDaemon::getCommandCount() const noexcept {
+    uint64_t count = getSnapshotReadCount();
+    for (const auto& shard : m_shards) {
+        count += shard->commandCount.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+uint64_t PetDaemon::getSnapshotReadCount() const noexcept {
+    std::lock_guard<std::mutex> lock(m_readerMutex);
+    uint64_t count = m_finishedReads;
+    for (const SnapshotReader* reader : m_readers) {
+        count += reader->reads.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+std::unique_ptr<PetDaemon::SnapshotReader> PetDaemon::addReader() {
+    auto reader = std::make_unique<SnapshotReader>(m_reclaimer.registerReader());
+    std::lock_guard<std::mutex> lock(m_readerMutex);
+    m_readers.push_back(reader.get());
+    return reader;
+}
+
+void PetDaemon::removeReader(SnapshotReader& reader) noexcept {
+    std::lock_guard<std::mutex> lock(m_readerMutex);
+    m_finishedReads += reader.reads.load(std::memory_order_relaxed);
+    std::erase(m_readers, &reader);
+}
+
+void PetDaemon::serve() noexcept {
+#ifndef _WIN32
+    try {
+        m_pollReader = addReader();
+    } catch (const std::exception&) {
+        // Every read-only command runs on its shard instead
+    }
+
+    std::vector<pollfd> pollFds;
+    while (!m_stopRequested && !g_stopRequested) {
+        pollFds.clear();
+        pollFds.push_back({ m_listenFd, POLLIN, 0 });
+        pollFds.push_back({ m_wakeFds[0], POLLIN, 0 });
+        for (const auto& connection : m_connections) {
+            // Backpressure: a client that does not read its responses gets no more requests run
+            bool acceptInput = !connection.peerClosed && connection.getPendingOutput() < GameConfig::Daemon::MAX_PENDING_OUTPUT &&
+                               connection.pending.size() < GameConfig::Daemon::MAX_QUEUED_REQUESTS;
+            short events = acceptInput ? POLLIN : 0;
+            if (connection.getPendingOutput() > 0) {
+                events |= POLLOUT;
+            }
+            pollFds.push_back({ connection.fd, events, 0 });
+        }
+
+        if (::poll(pollFds.data(), pollFds.size(), -1) < 0) {
+            if (errno != EINTR) {
+                std::cerr << "pet daemon: poll failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+            continue;
+        }
+
+        // Shards write to the wake pipe too when responses finish; every connection may have some
+        bool responsesReady = false;
+        if (pollFds[1].revents & POLLIN) {
+            char drain[64];
+            while (::read(m_wakeFds[0], drain, sizeof(drain)) > 0) {
+            }
+            responsesReady = m_responsesReady.exchange(false, std::memory_order_acq_rel);
+        }
+
+        // Connections accepted below are not in pollFds yet and are served next time
+        size_t polledCount = m_connections.size();
+        if (pollFds[0].revents & POLLIN) {
+            acceptConnections();
+        }
+
+        for (size_t i = 0; i < polledCount; ++i) {
+            short revents = pollFds[i + 2].revents;
+            if (revents == 0 && !responsesReady) {
+                continue;
+            }
+            if (!serviceConnection(m_connections[i], (revents & (POLLIN | POLLHUP | POLLERR)) != 0)) {
+                closeConnection(m_connections[i]);
+            }
+        }
+        std::erase_if(m_connections, [](const Connection& connection) { return connection.fd < 0; });
+    }
+
+    for (auto& connection : m_connections) {
+        closeConnection(connection);
+    }
+    m_connections.clear();
+    ::close(m_listenFd);
+    ::unlink(m_socketPath.c_str());
+    m_listenFd = -1;
+
+    if (m_pollReader) {
+        removeReader(*m_pollReader);
+        m_pollReader.reset();
+    }
+#endif
+}
+
+void PetDaemon::stop() noexcept {
+    m_stopRequested = true;
+#ifndef _WIN32
+    if (m_wakeFds[1] >= 0) {
+        char byte = 0;
+        [[maybe_unused]] auto written = ::write(m_wakeFds[1], &byte, 1);
+    }
+#endif
+}
+
+void PetDaemon::acceptConnections() noexcept {
+#ifndef _WIN32
+    for (;;) {
+        int fd = ::accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "pet daemon: accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        setNonBlocking(fd);
+
+        try {
+            m_connections.emplace_back().fd = fd;
+        } catch (const std::exception&) {
+            ::close(fd);
+            return;
+        }
+    }
+#endif
+}
+
+void PetDaemon::closeConnection(Connection& connection) noexcept {
+    // Waits for the shared memory thread, which sees the closed channel within one idle timeout
+    connection.shared.reset();
+#ifndef _WIN32
+    for (int fd : connection.receivedFds) {
+        ::close(fd);
+    }
+    if (connection.fd >= 0) {
+        ::close(connection.fd);
+    }
+#endif
+    connection.receivedFds.clear();
+    connection.fd = -1;
+}
+
+bool PetDaemon::serviceConnection(Connection& connection, bool readable) noexcept {
+#ifdef _WIN32
+    (void)connection; (void)readable;
+    return false;
+#else
+    try {
+        if (readable && !connection.peerClosed) {
+            size_t pos = connection.input.size();
+            connection.input.resize(pos + READ_CHUNK_SIZE);
+            ssize_t received = receiveWithDescriptors(connection.fd, connection.input.data() + pos, READ_CHUNK_SIZE,
+                                                      connection.receivedFds);
+            connection.input.resize(pos + static_cast<size_t>(std::max<ssize_t>(received, 0)));
+            if (received == 0) {
+                connection.peerClosed = true;
+            } else if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return false;
+            }
+        }
+
+        // Requests left over from a full output buffer or queue run as soon as it drains
+        for (;;) {
+            if (!runRequests(connection) || !collectResponses(connection) || !sendOutput(connection)) {
+                return false;
+            }
+            if (connection.getPendingOutput() >= GameConfig::Daemon::MAX_PENDING_OUTPUT ||
+                connection.pending.size() >= GameConfig::Daemon::MAX_QUEUED_REQUESTS) {
+                return true;
+            }
+
+            DaemonProtocol::MessageType type;
+            std::span<const std::byte> payload;
+            if (DaemonProtocol::parseMessage(connection.input, type, payload) != DaemonProtocol::ParseResult::Complete) {
+                break;
+            }
+        }
+
+        // Responses to everything the client sent before it shut down are still delivered
+        return !connection.peerClosed || connection.getPendingOutput() > 0 || !connection.pending.empty();
+    } catch (const std::exception& e) {
+        std::cerr << "pet daemon: " << e.what() << std::endl;
+        return false;
+    }
+#endif
+}
+
+bool PetDaemon::runRequests(Connection& connection) {
+    std::span<const std::byte> input = connection.input;
+    size_t consumed = 0;
+    while (connection.getPendingOutput() < GameConfig::Daemon::MAX_PENDING_OUTPUT &&
+           connection.pending.size() < GameConfig::Daemon::MAX_QUEUED_REQUESTS) {
+        DaemonProtocol::MessageType type;
+        std::span<const std::byte> payload;
+        auto result = DaemonProtocol::parseMessage(input.subspan(consumed), type, payload);
+        if (result == DaemonProtocol::ParseResult::Invalid) {
+            return false;
+        }
+        if (result == DaemonProtocol::ParseResult::Incomplete) {
+            break;
+        }
+
+        bool wellFormed = type == DaemonProtocol::MessageType::AttachSharedMemory
+            ? payload.empty() && attachSharedMemory(connection)
+            : dispatchRequest(connection, type, payload);
+        if (!wellFormed) {
+            return false;
+        }
+        consumed += DaemonProtocol::HEADER_SIZE + payload.size();
+    }
+
+    connection.input.erase(connection.input.begin(), connection.input.begin() + static_cast<ptrdiff_t>(consumed));
+    return true;
+}
+
+bool PetDaemon::collectResponses(Connection& connection) {
+    while (!connection.pending.empty() && connection.pending.front()->done.load(std::memory_order_acquire)) {
+        const PendingResponse& response = *connection.pending.front();
+        if (response.failed) {
+            return false;
+        }
+        connection.output.insert(connection.output.end(), response.bytes.begin(), response.bytes.end());
+        if (response.petId) {
+            auto it = connection.pendingByPet.find(*response.petId);
+            if (--it->second == 0) {
+                connection.pendingByPet.erase(it);
+            }
+        }
+        connection.pending.pop_front();
+    }
+    return true;
+}
+
+void PetDaemon::completeResponse(PendingResponse& response) noexcept {
+    response.done.store(true, std::memory_order_release);
+#ifndef _WIN32
+    if (!m_responsesReady.exchange(true, std::memory_order_acq_rel)) {
+        char byte = 0;
+        [[maybe_unused]] auto written = ::write(m_wakeFds[1], &byte, 1);
+    }
+#endif
+}
+
+bool PetDaemon::dispatchRequest(Connection& connection, DaemonProtocol::MessageType type,
+                                std::span<const std::byte> payload) {
+    auto response = std::make_shared<PendingResponse>();
+    switch (type) {
+        case DaemonProtocol::MessageType::Request: {
+            std::string statePath;
+            std::vector<std::string> args;
+            if (!DaemonProtocol::decodeRequest(payload, statePath, args) || args.empty()) {
+                return false;
+            }
+            statePath = canonicalStatePath(statePath);
+            uint32_t petId = getPetId(statePath);
+            postResponse(petId, response, [this, petId, statePath = std::move(statePath), args = std::move(args)](
+                                              Shard& shard, std::vector<std::byte>& output) {
+                handleRequest(shard, petId, statePath, args, output);
+            });
+            break;
+        }
+        case DaemonProtocol::MessageType::OpenPet: {
+            DaemonProtocol::OpenPetResult result{};
+            std::string statePath;
+            if (!DaemonProtocol::decodeOpenPet(payload, result.sequence, statePath)) {
+                return false;
+            }
+            statePath = canonicalStatePath(statePath);
+            result.petId = getPetId(statePath);
+            postResponse(result.petId, response, [this, result, statePath = std::move(statePath)](
+                                                     Shard& shard, std::vector<std::byte>& output) {
+                handleOpenPet(shard, result, statePath, output);
+            });
+            break;
+        }
+        case DaemonProtocol::MessageType::Command: {
+            DaemonProtocol::CommandRequest request;
+            if (!DaemonProtocol::decodeCommand(payload, request)) {
+                return false;
+            }
+
+            // Answered now unless an earlier request of this connection may still change the pet
+            DaemonProtocol::CommandResult result;
+            if (m_pollReader && !connection.pendingByPet.contains(request.petId) &&
+                readSnapshot(*m_pollReader, request, result)) {
+                DaemonProtocol::appendCommandResult(response->bytes, result, {});
+                response->done.store(true, std::memory_order_relaxed);
+                connection.pending.push_back(std::move(response));
+                return true;
+            }
+            postResponse(request.petId, response, [this, request](Shard& shard, std::vector<std::byte>& output) {
+                handleCommand(shard, request, output);
+            });
+            break;
+        }
+        default:
+            return false;
+    }
+    ++connection.pendingByPet[*response->petId];
+    connection.pending.push_back(std::move(response));
+    return true;
+}
+
+void PetDaemon::postResponse(uint32_t petId, std::shared_ptr<PendingResponse> response,
+                             std::function<void(Shard&, std::vector<std::byte>&)> task) {
+    response->petId = petId;
+    m_runtime->post(m_runtime->getShardFor(petId), [this, petId, response = std::move(response), task = std::move(task)]() {
+        try {
+            task(getShard(petId), response->bytes);
+        } catch (const std::exception& e) {
+            std::cerr << "pet daemon: " << e.what() << std::endl;
+            response->failed = true;
+        }
+        completeResponse(*response);
+    });
+}
+
+uint32_t PetDaemon::getPetId(const std::string& statePath) {
+    std::lock_guard<std::mutex> lock(m_petIdMutex);
+    auto [it, inserted] = m_petIds.try_emplace(statePath, static_cast<uint32_t>(m_petIds.size()));
+
+    // The chunk exists before the ID is handed out, so shards and readers never allocate it
+    size_t chunk = it->second / SnapshotChunk::SIZE;
+    if (inserted && chunk < SNAPSHOT_CHUNK_COUNT && !m_snapshotChunks[chunk].load(std::memory_order_relaxed)) {
+        m_snapshotChunks[chunk].store(new SnapshotChunk, std::memory_order_release);
+    }
+    return it->second;
+}
+
+void PetDaemon::publishSnapshot(Shard& shard, uint32_t petId, const ResidentPet* pet, const std::string& statePath) {
+    size_t chunk = petId / SnapshotChunk::SIZE;
+    SnapshotChunk* snapshots = chunk < SNAPSHOT_CHUNK_COUNT ? m_snapshotChunks[chunk].load(std::memory_order_acquire) : nullptr;
+    if (!snapshots) {
+        return;
+    }
+
+    const ResidentSnapshot* snapshot = pet ? new ResidentSnapshot{ PetSnapshot(*pet->petState), pet->stamp, statePath } : nullptr;
+    const ResidentSnapshot* old = snapshots->snapshots[petId % SnapshotChunk::SIZE].exchange(snapshot, std::memory_order_seq_cst);
+    shard.retired.retire(std::unique_ptr<const ResidentSnapshot>(old));
+}
+
+bool PetDaemon::readSnapshot(SnapshotReader& reader, const DaemonProtocol::CommandRequest& request,
+                             DaemonProtocol::CommandResult& result) noexcept {
+    bool readOnly = request.command == DaemonProtocol::CommandId::Status ||
+                    request.command == DaemonProtocol::CommandId::Evolve ||
+                    request.command == DaemonProtocol::CommandId::Achievements;
+    size_t chunk = request.petId / SnapshotChunk::SIZE;
+    if (!readOnly || (request.flags & DaemonProtocol::COMMAND_WANT_TEXT) || !reader.slot.isValid() ||
+        chunk >= SNAPSHOT_CHUNK_COUNT) {
+        return false;
+    }
+    SnapshotChunk* snapshots = m_snapshotChunks[chunk].load(std::memory_order_acquire);
+    if (!snapshots) {
+        return false;
+    }
+
+    EpochReclaimer::ReadGuard guard(reader.slot);
+    const ResidentSnapshot* snapshot = snapshots->snapshots[request.petId % SnapshotChunk::SIZE].load(std::memory_order_seq_cst);
+
+    // Another process wrote the pet: its shard reloads it
+    if (!snapshot || !snapshot->pet.isReadOnly(*DaemonProtocol::getCommandName(request.command)) ||
+        readStamp(snapshot->statePath) != snapshot->stamp) {
+        return false;
+    }
+
+    // The same values executeCommand() reports after running the command
+    auto stats = snapshot->pet.getStatsAt(std::chrono::system_clock::now());
+    result = {};
+    result.sequence = request.sequence;
+    result.status = DaemonProtocol::Status::Ok;
+    result.evolutionLevel = static_cast<uint8_t>(snapshot->pet.getEvolutionLevel());
+    result.xp = snapshot->pet.getXP();
+    result.hunger = stats.hunger;
+    result.happiness = stats.happiness;
+    result.energy = stats.energy;
+    reader.reads.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void PetDaemon::callOnShard(uint32_t petId, const std::function<void(Shard&)>& task) {
+    // The promise is shared so the shard may still touch it after the waiter returned
+    auto done = std::make_shared<std::promise<void>>();
+    auto finished = done->get_future();
+    m_runtime->post(m_runtime->getShardFor(petId), [this, petId, &task, done]() {
+        try {
+            task(getShard(petId));
+            done->set_value();
+        } catch (...) {
+            done->set_exception(std::current_exception());
+        }
+    });
+    finished.get();
+}
+
+bool PetDaemon::sendOutput(Connection& connection) noexcept {
+#ifdef _WIN32
+    (void)connection;
+    return false;
+#else
+    while (connection.getPendingOutput() > 0) {
+        ssize_t sent = ::send(connection.fd, connection.output.data() + connection.outputPos,
+                              connection.getPendingOutput(), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return false;
+        }
+        connection.outputPos += static_cast<size_t>(sent);
+    }
+
+    if (connection.outputPos == connection.output.size()) {
+        connection.output.clear();
+        connection.outputPos = 0;
+    } else if (connection.outputPos >= connection.output.size() / 2) {
+        connection.output.erase(connection.output.begin(),
+                                connection.output.begin() + static_cast<ptrdiff_t>(connection.outputPos));
+        connection.outputPos = 0;
+    }
+    return true;
+#endif
+}
+
+void PetDaemon::handleRequest(Shard& shard, uint32_t petId, const std::string& statePath,
+                              const std::vector<std::string>& args, std::vector<std::byte>& output) {
+    shard.petPaths.try_emplace(petId, statePath);
+    ResidentPet* pet = getResidentPet(shard, petId, statePath);
+
+    // No pet to load: the client asks whether to create one, which needs its terminal
+    if (!pet) {
+        DaemonProtocol::appendMessage(output, DaemonProtocol::MessageType::RunLocally, {});
+        return;
+    }
+
+    std::vector<std::string_view> argViews(args.begin(), args.end());
+    int32_t exitCode = runCaptured(shard, *pet, petId, statePath, argViews, &shard.outText);
+
+    std::byte exitPayload[sizeof(int32_t)];
+    BinarySchema::storeLE(exitPayload, exitCode);
+    appendOutput(output, DaemonProtocol::MessageType::Stdout, shard.outText.view());
+    appendOutput(output, DaemonProtocol::MessageType::Stderr, shard.errText.view());
+    DaemonProtocol::appendMessage(output, DaemonProtocol::MessageType::Exit, exitPayload);
+}
+
+void PetDaemon::handleOpenPet(Shard& shard, DaemonProtocol::OpenPetResult result, const std::string& statePath,
+                              std::vector<std::byte>& output) {
+    shard.petPaths.try_emplace(result.petId, statePath);
+    ResidentPet* pet = getResidentPet(shard, result.petId, statePath);
+
+    result.status = pet ? DaemonProtocol::Status::Ok : DaemonProtocol::Status::LoadFailed;
+    DaemonProtocol::appendPetOpened(output, result);
+}
+
+void PetDaemon::handleCommand(Shard& shard, const DaemonProtocol::CommandRequest& request, std::vector<std::byte>& output) {
+    auto result = executeCommand(shard, request, &shard.outText);
+    std::string_view text;
+    if (result.status == DaemonProtocol::Status::Ok && (request.flags & DaemonProtocol::COMMAND_WANT_TEXT)) {
+        text = shard.outText.view();
+    }
+
+    // Text that would not fit in one message is cut short; the stats are always complete
+    constexpr size_t MAX_TEXT_SIZE = GameConfig::Daemon::MAX_MESSAGE_SIZE - 64;
+    DaemonProtocol::appendCommandResult(output, result, text.substr(0, MAX_TEXT_SIZE));
+}
+
+bool PetDaemon::attachSharedMemory(Connection& connection) {
+    if (connection.receivedFds.empty() || connection.shared) {
+        return false;
+    }
+    int fd = connection.receivedFds.front();
+    connection.receivedFds.erase(connection.receivedFds.begin());
+
+    // Each channel has a thread, so their number is bounded
+    auto sharedCount = std::count_if(m_connections.begin(), m_connections.end(), [](const Connection& other) {
+        return other.shared != nullptr;
+    });
+    auto status = DaemonProtocol::Status::Ok;
+    if (static_cast<size_t>(sharedCount) >= GameConfig::Daemon::MAX_SHARED_CHANNELS) {
+#ifndef _WIN32
+        ::close(fd);
+#endif
+        status = DaemonProtocol::Status::Unavailable;
+    } else if (auto channel = SharedChannel::attach(fd); channel && fitsCommandResult(channel->getResponses())) {
+        auto session = std::make_unique<SharedSession>();
+        session->channel = std::move(channel);
+        session->worker = std::thread([this, channel = session->channel.get()]() { serveSharedChannel(*channel); });
+        connection.shared = std::move(session);
+    } else {
+        status = DaemonProtocol::Status::InvalidArgument;
+    }
+
+    // Queued behind earlier responses, which may still be running
+    auto response = std::make_shared<PendingResponse>();
+    std::byte statusByte = static_cast<std::byte>(status);
+    DaemonProtocol::appendMessage(response->bytes, DaemonProtocol::MessageType::SharedMemoryAttached,
+                                  std::span(&statusByte, 1));
+    response->done.store(true, std::memory_order_relaxed);
+    connection.pending.push_back(std::move(response));
+    return true;
+}
+
+void PetDaemon::serveSharedChannel(SharedChannel& channel) noexcept {
+    SharedRing& requests = channel.getRequests();
+    SharedRing& responses = channel.getResponses();
+    std::unique_ptr<SnapshotReader> reader;
+
+    // Waits in slices so a closed channel is noticed even if its wakeup is lost
+    auto reserve = [&responses](size_t size) {
+        std::span<std::byte> out;
+        while (out.empty() && !responses.isClosed()) {
+            out = responses.beginWrite(size, SHARED_IDLE_TIMEOUT);
+        }
+        return out;
+    };
+
+    try {
+        reader = addReader();
+        while (!requests.isClosed()) {
+            auto record = requests.beginRead(SHARED_IDLE_TIMEOUT);
+            if (record.empty()) {
+                continue;
+            }
+
+            // One whole message per record, read in place
+            DaemonProtocol::MessageType type;
+            std::span<const std::byte> payload;
+            if (DaemonProtocol::parseMessage(record, type, payload) != DaemonProtocol::ParseResult::Complete ||
+                DaemonProtocol::HEADER_SIZE + payload.size() != record.size()) {
+                break;
+            }
+
+            if (type == DaemonProtocol::MessageType::Command) {
+                DaemonProtocol::CommandRequest request;
+                if (!DaemonProtocol::decodeCommand(payload, request)) {
+                    break;
+                }
+
+                // Requests of a channel run one at a time, so the snapshot already has the earlier ones
+                DaemonProtocol::CommandResult result;
+                if (readSnapshot(*reader, request, result)) {
+                    auto out = reserve(DaemonProtocol::COMMAND_RESULT_MESSAGE_SIZE);
+                    if (out.empty()) {
+                        break;
+                    }
+                    DaemonProtocol::writeCommandResult(out, result, 0);
+                    responses.endWrite(DaemonProtocol::COMMAND_RESULT_MESSAGE_SIZE);
+                    requests.endRead();
+                    continue;
+                }
+
+                // The command renders its output directly behind the result in the response ring
+                auto out = reserve(DaemonProtocol::COMMAND_RESULT_MESSAGE_SIZE + GameConfig::Daemon::SHARED_TEXT_LIMIT);
+                if (out.empty()) {
+                    break;
+                }
+                SpanStreamBuf text(out.subspan(DaemonProtocol::COMMAND_RESULT_MESSAGE_SIZE));
+                callOnShard(request.petId, [&](Shard& shard) { result = executeCommand(shard, request, &text); });
+
+                bool wantText = result.status == DaemonProtocol::Status::Ok && (request.flags & DaemonProtocol::COMMAND_WANT_TEXT);
+                size_t textSize = wantText ? text.size() : 0;
+                DaemonProtocol::writeCommandResult(out, result, textSize);
+                responses.endWrite(DaemonProtocol::COMMAND_RESULT_MESSAGE_SIZE + textSize);
+            } else if (type == DaemonProtocol::MessageType::OpenPet) {
+                DaemonProtocol::OpenPetResult result{};
+                std::string statePath;
+                if (!DaemonProtocol::decodeOpenPet(payload, result.sequence, statePath)) {
+                    break;
+                }
+                statePath = canonicalStatePath(statePath);
+                result.petId = getPetId(statePath);
+                std::vector<std::byte> output;
+                callOnShard(result.petId, [&](Shard& shard) { handleOpenPet(shard, result, statePath, output); });
+                auto out = reserve(output.size());
+                if (out.empty()) {
+                    break;
+                }
+                std::memcpy(out.data(), output.data(), output.size());
+                responses.endWrite(output.size());
+            } else {
+                // Text requests stay on the socket
+                break;
+            }
+
+            requests.endRead();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "pet daemon: " << e.what() << std::endl;
+    }
+    if (reader) {
+        removeReader(*reader);
+    }
+    channel.close();
+}
+
+DaemonProtocol::CommandResult PetDaemon::executeCommand(Shard& shard, const DaemonProtocol::CommandRequest& request,
+                                                       std::streambuf* text) {
+    DaemonProtocol::CommandResult result{};
+    result.sequence = request.sequence;
+
+    auto commandName = DaemonProtocol::getCommandName(request.command);
+    bool repeatable = request.command == DaemonProtocol::CommandId::Feed || request.command == DaemonProtocol::CommandId::Play;
+    if (!commandName) {
+        result.status = DaemonProtocol::Status::UnknownCommand;
+        return result;
+    }
+    if (repeatable && (request.count == 0 || request.count > MAX_BATCH_COUNT)) {
+        result.status = DaemonProtocol::Status::InvalidArgument;
+        return result;
+    }
+    // A pet ID reaches its shard with the OpenPet that assigned it, before any command can use it
+    auto path = shard.petPaths.find(request.petId);
+    if (path == shard.petPaths.end()) {
+        result.status = DaemonProtocol::Status::UnknownPet;
+        return result;
+    }
+
+    const std::string& statePath = path->second;
+    ResidentPet* pet = getResidentPet(shard, request.petId, statePath);
+    if (!pet) {
+        result.status = DaemonProtocol::Status::LoadFailed;
+        return result;
+    }
+
+    // Same arguments as the command line, so the handlers stay the only implementation
+    char countText[16];
+    char* end = std::to_chars(countText, countText + sizeof(countText), request.count).ptr;
+    std::vector<std::string_view> args{ *commandName };
+    if (repeatable) {
+        args.insert(args.end(), { "--times", std::string_view(countText, static_cast<size_t>(end - countText)) });
+    }
+
+    auto levelBefore = pet->petState->getEvolutionLevel();
+    bool wantText = (request.flags & DaemonProtocol::COMMAND_WANT_TEXT) != 0;
+    runCaptured(shard, *pet, request.petId, statePath, args, wantText ? text : &shard.outText);
+
+    const PetState& petState = *pet->petState;
+    result.status = DaemonProtocol::Status::Ok;
+    result.evolutionLevel = static_cast<uint8_t>(petState.getEvolutionLevel());
+    result.evolved = petState.getEvolutionLevel() != levelBefore ? 1 : 0;
+    result.xp = petState.getXP();
+    result.hunger = petState.getHunger();
+    result.happiness = petState.getHappiness();
+    result.energy = petState.getEnergy();
+    return result;
+}
+
+int32_t PetDaemon::runCaptured(Shard& shard, ResidentPet& pet, uint32_t petId, const std::string& statePath,
+                               const std::vector<std::string_view>& args, std::streambuf* out) {
+    shard.outText.str({});
+    shard.errText.str({});
+    // Also clears any error state an earlier command left on the streams
+    shard.out.rdbuf(out);
+    shard.err.clear();
+
+    int32_t exitCode = 0;
+    if (!shard.parser.processCommand(args, *pet.gameLogic)) {
+        shard.parser.showHelp();
+        exitCode = 1;
+    }
+    shard.out.rdbuf(&shard.outText);
+    pet.stamp = readStamp(statePath);
+    shard.commandCount.fetch_add(1, std::memory_order_relaxed);
+    publishSnapshot(shard, petId, &pet, statePath);
+    return exitCode;
+}
+
+PetDaemon::ResidentPet* PetDaemon::getResidentPet(Shard& shard, uint32_t petId, const std::string& statePath) {
+    uint64_t now = shard.commandCount.load(std::memory_order_relaxed);
+    auto it = shard.pets.find(petId);
+    if (it != shard.pets.end()) {
+        if (it->second.stamp == readStamp(statePath)) {
+            it->second.lastUsed = now;
+            return &it->second;
+        }
+
+        // Changed by another process since our last commit
+        shard.pets.erase(it);
+        publishSnapshot(shard, petId, nullptr, statePath);
+    }
+
+    // Each shard keeps its share of the resident pets
+    size_t maxPets = std::max<size_t>(1, GameConfig::Daemon::MAX_RESIDENT_PETS / m_shards.size());
+    if (shard.pets.size() >= maxPets) {
+        auto oldest = std::min_element(shard.pets.begin(), shard.pets.end(), [](const auto& a, const auto& b) {
+            return a.second.lastUsed < b.second.lastUsed;
+        });
+        publishSnapshot(shard, oldest->first, nullptr, {});
+        shard.pets.erase(oldest);
+    }
+
+    auto petState = std::make_unique<PetState>();
+    if (!petState->loadFromFile(statePath)) {
+        return nullptr;
+    }
+
+    auto gameLogic = std::make_shared<GameLogic>(*petState, shard.out);
+    gameLogic->initializeUIManager();
+
+    auto& pet = shard.pets[petId];
+    pet.petState = std::move(petState);
+    pet.gameLogic = std::move(gameLogic);
+    pet.stamp = readStamp(statePath);
+    pet.lastUsed = now;
+    publishSnapshot(shard, petId, &pet, statePath);
+    return &pet;
+}
+
+PetDaemon::FileStamp PetDaemon::readStamp(const std::filesystem::path& statePath) noexcept {
+    FileStamp stamp;
+    std::error_code error;
+    stamp.stateTime = std::filesystem::last_write_time(statePath, error);
+    stamp.stateSize = std::filesystem::file_size(statePath, error);
+
+    auto journalPath = statePath;
+    journalPath += ".journal";
+    stamp.journalTime = std::filesystem::last_write_time(journalPath, error);
+    stamp.journalSize = std::filesystem::file_size(journalPath, error);
+    return stamp;
+}
@@ -0,0 +1,129 @@
+#include "../include/pet_population.h"
+#include "../include/pet_store.h"
+#include "../include/time_decay.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+    int64_t toSeconds(std::chrono::system_clock::time_point time) noexcept {
+        return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+    }
+}
+
+void PetPopulation::reserve(size_t count) {
+    m_hunger.reserve(count);
+    m_happiness.reserve(count);
+    m_energy.reserve(count);
+    m_xp.reserve(count);
+    m_evolutionLevels.reserve(count);
+    m_lastInteractionSeconds.reserve(count);
+    m_birthDateSeconds.reserve(count);
+    m_achievementBits.reserve(count);
+    m_names.reserve(count);
+}
+
+void PetPopulation::clear() noexcept {
+    m_hunger.clear();
+    m_happiness.clear();
+    m_energy.clear();
+    m_xp.clear();
+    m_evolutionLevels.clear();
+    m_lastInteractionSeconds.clear();
+    m_birthDateSeconds.clear();
+    m_achievementBits.clear();
+    m_names.clear();
+    m_aggregates.clear();
+}
+
+size_t PetPopulation::add(std::string_view name, std::chrono::system_clock::time_point now) {
+    return append(name, static_cast<uint8_t>(EvolutionLevel::Egg), 0,
+                  GameConfig::InitialStats::INITIAL_HUNGER, GameConfig::InitialStats::INITIAL_HAPPINESS,
+                  GameConfig::InitialStats::INITIAL_ENERGY, toSeconds(now), toSeconds(now), 0);
+}
+
+size_t PetPopulation::add(const PetState& petState) {
+    // Anchors and their timestamp, so the decay since then is still pending
+    auto stats = petState.getAnchorStats();
+    return append(petState.getName(), static_cast<uint8_t>(petState.getEvolutionLevel()), petState.getXP(),
+                  stats.hunger, stats.happiness, stats.energy,
+                  toSeconds(petState.getLastInteractionTime()), toSeconds(petState.getBirthDate()),
+                  petState.getAchievementSystem().getUnlockedBits());
+}
+
+size_t PetPopulation::loadFromStore(PetStore& store) {
+    auto petIds = store.getPetIds();
+    reserve(size() + petIds.size());
+
+    size_t failures = 0;
+    PetState petState;
+    for (auto petId : petIds) {
+        if (petState.loadFromStore(store, petId)) {
+            add(petState);
+        } else {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+size_t PetPopulation::applyTimeEffectsBatch(std::chrono::system_clock::time_point now) noexcept {
+    return applyTimeEffectsRange(0, size(), toSeconds(now), m_aggregates);
+}
+
+size_t PetPopulation::applyTimeEffectsRange(size_t begin, size_t end, int64_t nowSeconds,
+                                            PopulationAggregates& delta) noexcept {
+    // Blocks small enough to keep the old values on the stack
+    constexpr size_t BLOCK_SIZE = 256;
+    std::array<float, BLOCK_SIZE> hunger;
+    std::array<float, BLOCK_SIZE> happiness;
+    std::array<float, BLOCK_SIZE> energy;
+    std::array<int64_t, BLOCK_SIZE> lastInteraction;
+
+    size_t applied = 0;
+    for (size_t blockBegin = begin; blockBegin < end; blockBegin += BLOCK_SIZE) {
+        size_t count = std::min(BLOCK_SIZE, end - blockBegin);
+        std::copy_n(m_hunger.begin() + blockBegin, count, hunger.begin());
+        std::copy_n(m_happiness.begin() + blockBegin, count, happiness.begin());
+        std::copy_n(m_energy.begin() + blockBegin, count, energy.begin());
+        std::copy_n(m_lastInteractionSeconds.begin() + blockBegin, count, lastInteraction.begin());
+
+        TimeDecay::Columns columns{
+            std::span<float>(m_hunger).subspan(blockBegin, count),
+            std::span<float>(m_happiness).subspan(blockBegin, count),
+            std::span<float>(m_energy).subspan(blockBegin, count),
+            std::span<const uint8_t>(m_evolutionLevels).subspan(blockBegin, count),
+            std::span<int64_t>(m_lastInteractionSeconds).subspan(blockBegin, count)
+        };
+        size_t blockApplied = TimeDecay::applyTimeEffectsBatch(columns, nowSeconds);
+        if (blockApplied == 0) {
+            continue;
+        }
+        applied += blockApplied;
+
+        // The kernel moves the interaction time of every pet it updates
+        for (size_t i = 0; i < count; ++i) {
+            size_t index = blockBegin + i;
+            if (m_lastInteractionSeconds[index] != lastInteraction[i]) {
+                delta.updateStats(m_evolutionLevels[index], {hunger[i], happiness[i], energy[i]},
+                                  {m_hunger[index], m_happiness[index], m_energy[index]});
+            }
+        }
+    }
+    return applied;
+}
+
+size_t PetPopulation::append(std::string_view name, uint8_t evolutionLevel, uint32_t xp, float hunger, float happiness,
+                             float energy, int64_t lastInteractionSeconds, int64_t birthDateSeconds,
+                             uint64_t achievementBits) {
+    m_hunger.push_back(hunger);
+    m_happiness.push_back(happiness);
+    m_energy.push_back(energy);
+    m_xp.push_back(xp);
+    m_evolutionLevels.push_back(evolutionLevel);
+    m_lastInteractionSeconds.push_back(lastInteractionSeconds);
+    m_birthDateSeconds.push_back(birthDateSeconds);
+    m_achievementBits.push_back(achievementBits);
+    m_names.emplace_back(name);
+    m_aggregates.add({evolutionLevel, xp, hunger, happiness, energy});
+    return m_xp.size() - 1;
+}
@@ -0,0 +1,64 @@
+#include "../include/pet_record.h"
+#include <algorithm>
+
+namespace {
+    // Stat rates per hour in fixed point
+    constexpr uint64_t HUNGER_RATE = PetRecord::toFixed(GameConfig::getHungerDecreaseRate());
+    constexpr uint64_t HAPPINESS_RATE = PetRecord::toFixed(GameConfig::getHappinessDecreaseRate());
+    constexpr uint64_t ENERGY_RATE = PetRecord::toFixed(GameConfig::getEnergyIncreaseRate());
+
+    uint16_t decrease(uint16_t stat, uint64_t ratePerHour, uint32_t minutes) noexcept {
+        uint64_t amount = ratePerHour * minutes / 60;
+        return amount >= stat ? uint16_t{0} : static_cast<uint16_t>(stat - amount);
+    }
+
+    uint16_t increase(uint16_t stat, uint64_t ratePerHour, uint32_t minutes, uint16_t maxStat) noexcept {
+        uint64_t value = stat + ratePerHour * minutes / 60;
+        return value >= maxStat ? maxStat : static_cast<uint16_t>(value);
+    }
+}
+
+uint32_t PetRecord::toMinutes(std::chrono::system_clock::time_point time) noexcept {
+    auto minutes = std::chrono::floor<std::chrono::minutes>(time.time_since_epoch()).count();
+    return static_cast<uint32_t>(std::clamp<int64_t>(minutes, 0, MAX_MINUTES));
+}
+
+uint32_t PetRecord::getProgress(AchievementType type) const noexcept {
+    if (type == AchievementType::Count) {
+        return 0;
+    }
+    if ((unlockedAchievements >> static_cast<size_t>(type)) & 1) {
+        return AchievementSystem::getRequiredProgress(type);
+    }
+    if (type == AchievementType::Explorer) {
+        return static_cast<uint32_t>(std::popcount(usedCommandsMask));
+    }
+
+    unsigned bits = getProgressBits(type);
+    return (achievementProgress >> getProgressShift(type)) & ((uint32_t{1} << bits) - 1);
+}
+
+void PetRecord::setProgress(AchievementType type, uint32_t progress) noexcept {
+    unsigned bits = getProgressBits(type);
+    if (bits == 0) {
+        return;
+    }
+
+    uint32_t mask = ((uint32_t{1} << bits) - 1) << getProgressShift(type);
+    uint32_t value = std::min(progress, AchievementSystem::getRequiredProgress(type) - 1);
+    achievementProgress = (achievementProgress & ~mask) | (value << getProgressShift(type));
+}
+
+bool PetRecord::applyElapsedTime(uint32_t nowMinutes) noexcept {
+    if (lastInteractionMinutes == 0 || nowMinutes < lastInteractionMinutes + MIN_ELAPSED_MINUTES) {
+        return false;
+    }
+
+    uint32_t minutes = nowMinutes - lastInteractionMinutes;
+    auto maxStat = toFixed(GameConfig::getMaxStatForEvolutionLevel(evolutionLevel));
+    hunger = decrease(hunger, HUNGER_RATE, minutes);
+    happiness = decrease(happiness, HAPPINESS_RATE, minutes);
+    energy = increase(energy, ENERGY_RATE, minutes, maxStat);
+    lastInteractionMinutes = nowMinutes;
+    return true;
+}
@@ -0,0 +1,33 @@
+#include "../include/pet_snapshot.h"
+
+PetSnapshot::PetSnapshot(const PetState& petState) noexcept
+    : m_evolutionLevel(petState.getEvolutionLevel())
+    , m_xp(petState.getXP())
+    , m_anchorStats(petState.getAnchorStats())
+    , m_lastInteractionTime(petState.getLastInteractionTime())
+    , m_usedCommandsMask(petState.getAchievementSystem().getUsedCommandsMask())
+    , m_hasNewlyUnlocked(petState.getAchievementSystem().getNewlyUnlockedBits() != 0) {
+}
+
+TimeDecay::Stats PetSnapshot::getStatsAt(std::chrono::system_clock::time_point now) const noexcept {
+    // Same rules as PetState::getPendingHours()
+    if (m_lastInteractionTime == std::chrono::system_clock::time_point{}) {
+        return m_anchorStats;
+    }
+    double hoursPassed = std::chrono::duration<double, std::ratio<3600, 1>>(now - m_lastInteractionTime).count();
+    if (hoursPassed < GameConfig::Time::MIN_TIME_THRESHOLD) {
+        return m_anchorStats;
+    }
+    return TimeDecay::applyHours(m_anchorStats, getMaxStatValue(), hoursPassed);
+}
+
+bool PetSnapshot::isReadOnly(std::string_view command) const noexcept {
+    // A first use is tracked for Explorer and written
+    for (size_t index = 0; !AchievementSystem::getExplorerCommand(index).empty(); ++index) {
+        if (AchievementSystem::getExplorerCommand(index) == command && (m_usedCommandsMask & (uint32_t{1} << index)) == 0) {
+            return false;
+        }
+    }
+    // status announces newly unlocked achievements and clears them
+    return command != "status" || !m_hasNewlyUnlocked;
+}
@@ -1,5 +1,11 @@
 #include "../include/pet_state.h"
 #include "../include/game_config.h"
+#include "../include/mapped_file.h"
+#include "../include/state_file_format.h"
+#include "../include/pet_store.h"
+#include "../include/pet_archive.h"
+#include "../include/pet_record.h"
+#include "../include/name_table.h"
 #include <fstream>
 #include <iostream>
 #include <chrono>
@@ -7,6 +13,9 @@
 #include <stdexcept>
 #include <array>
 #include <algorithm>
+#include <climits>
+#include <bit>
+#include <utility>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -44,10 +53,14 @@ void PetState::initialize(std::string_view name) noexcept {
     m_birthDate = std::chrono::system_clock::now();
     
     // Reset achievements system when creating a new pet
+    m_achievementSection.clear();
     m_achievementSystem.reset();
+    m_preservedSections.clear();
+    
+    markDirty(DirtyAll);
 }
 
-std::filesystem::path PetState::getStateFilePath() const noexcept {
+std::filesystem::path PetState::getStateFilePath() noexcept {
     std::filesystem::path statePath;
     
 #ifdef _WIN32
@@ -81,7 +94,15 @@ std::filesystem::path PetState::getStateFilePath() const noexcept {
 bool PetState::saveFileExists() const noexcept {
     try {
         auto statePath = getStateFilePath();
-        return std::filesystem::exists(statePath);
+        if (std::filesystem::exists(statePath)) {
+            return true;
+        }
+        
+        // An archived pet still exists, it is only restored on the next load
+        PetArchive archive;
+        return std::filesystem::exists(PetArchive::archivePathFor(statePath)) &&
+               archive.open(PetArchive::archivePathFor(statePath)) &&
+               archive.contains(statePath.filename().string());
     } catch (const std::exception& e) {
         std::cerr << "Error checking save file: " << e.what() << std::endl;
         return false;
@@ -89,186 +110,918 @@ bool PetState::saveFileExists() const noexcept {
 }
 
 bool PetState::load() noexcept {
+    return loadFromFile(getStateFilePath());
+}
+
+bool PetState::loadFromFile(const std::filesystem::path& statePath) noexcept {
     try {
-        auto statePath = getStateFilePath();
+        m_statePath = statePath;
         
-        if (!std::filesystem::exists(statePath)) {
-            return false;
+        MappedFile mappedFile(statePath);
+        if (!mappedFile.isOpen()) {
+            if (std::filesystem::exists(statePath)) {
+                std::cerr << "Failed to open state file: " << statePath.string() << std::endl;
+                return false;
+            }
+            
+            // A missing file means there is no pet yet, unless it was archived
+            return rehydrateFromArchive(statePath);
         }
         
-        std::ifstream file(statePath, std::ios::binary);
-        if (!file) {
-            std::cerr << "Failed to open state file: " << statePath.string() << std::endl;
+        auto bytes = mappedFile.data();
+        if (bytes.empty()) {
+            std::cerr << "Error reading state file: " << statePath.string() << std::endl;
             return false;
         }
         
         // Read file format version
-        uint8_t version = 0;
-        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        uint8_t version = static_cast<uint8_t>(bytes[0]);
         
-        if (version > 4) {
+        if (version > StateFileFormat::CURRENT_VERSION) {
             std::cerr << "Unsupported state file version: " << static_cast<int>(version) << std::endl;
             return false;
         }
         
-        // Read name
-        uint16_t nameLength = 0;
-        file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+        if (version >= StateFileFormat::HEADER_V5_VERSION) {
+            if (!loadFromImage(bytes)) {
+                std::cerr << "Error reading state file: " << statePath.string() << std::endl;
+                return false;
+            }
+            replayJournal(statePath);
+            return true;
+        }
+        
+        // Older versions use the legacy sequential layout
+        m_achievementSection.clear();
+        m_preservedSections.clear();
+        BinarySchema::Reader reader(bytes.subspan(sizeof(version)));
+        if (!loadLegacy(reader, version)) {
+            std::cerr << "Error reading state file: " << statePath.string() << std::endl;
+            return false;
+        }
         
-        m_name.resize(nameLength);
-        file.read(&m_name[0], nameLength);
+        // Legacy files predate the journal
+        m_journalSequence = 0;
+        replayJournal(statePath);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while loading state: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetState::peekFileVersion(const std::filesystem::path& statePath, uint8_t& version) noexcept {
+    using namespace StateFileFormat;
+    
+    try {
+        MappedFile mappedFile(statePath);
+        if (!mappedFile.isOpen() || mappedFile.data().empty()) {
+            return false;
+        }
         
-        // Read basic stats
-        uint8_t evolutionLevel = 0;
-        file.read(reinterpret_cast<char*>(&evolutionLevel), sizeof(evolutionLevel));
-        m_evolutionLevel = static_cast<EvolutionLevel>(evolutionLevel);
+        auto bytes = mappedFile.data();
+        version = static_cast<uint8_t>(bytes[0]);
+        if (version == 0 || version > CURRENT_VERSION) {
+            return false;
+        }
         
-        file.read(reinterpret_cast<char*>(&m_xp), sizeof(m_xp));
+        // A leading version byte alone is too weak: any file could start with one
+        if (version == HEADER_V5_VERSION) {
+            HeaderV5 header;
+            return decodeHeader(bytes, header);
+        }
+        if (version >= FIRST_SECTIONED_VERSION) {
+            std::vector<SectionEntry> entries;
+            return decodeSectionTable(bytes, entries) && findSection(entries, SectionType::Core).has_value();
+        }
         
-        // For version 1 and 2, read stats as uint8_t and convert to float
-        if (version <= 2) {
-            uint8_t hunger = 0, happiness = 0, energy = 0;
-            file.read(reinterpret_cast<char*>(&hunger), sizeof(hunger));
-            file.read(reinterpret_cast<char*>(&happiness), sizeof(happiness));
-            file.read(reinterpret_cast<char*>(&energy), sizeof(energy));
-            
-            // Convert from percentage (0-100) to actual values based on max
-            float maxStat = getMaxStatValue();
-            m_hunger = (static_cast<float>(hunger) / 100.0f) * maxStat;
-            m_happiness = (static_cast<float>(happiness) / 100.0f) * maxStat;
-            m_energy = (static_cast<float>(energy) / 100.0f) * maxStat;
-        } else {
-            // For future versions, read stats as float directly
-            file.read(reinterpret_cast<char*>(&m_hunger), sizeof(m_hunger));
-            file.read(reinterpret_cast<char*>(&m_happiness), sizeof(m_happiness));
-            file.read(reinterpret_cast<char*>(&m_energy), sizeof(m_energy));
+        // Legacy files have no header to check, so they must parse exactly to the end
+        PetState petState;
+        BinarySchema::Reader reader(bytes.subspan(sizeof(version)));
+        return petState.loadLegacy(reader, version) && reader.remaining() == 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while reading state file version: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetState::loadFromImage(std::span<const std::byte> bytes) noexcept {
+    if (bytes.empty()) {
+        return false;
+    }
+    
+    m_achievementSection.clear();
+    m_preservedSections.clear();
+    
+    auto version = static_cast<uint8_t>(bytes[0]);
+    if (version == StateFileFormat::HEADER_V5_VERSION) {
+        return loadHeaderV5(bytes);
+    }
+    return loadSections(bytes);
+}
+
+bool PetState::loadSections(std::span<const std::byte> bytes) noexcept {
+    using namespace StateFileFormat;
+    
+    try {
+        std::vector<SectionEntry> entries;
+        if (!decodeSectionTable(bytes, entries)) {
+            return false;
+        }
+        auto version = static_cast<uint8_t>(bytes[0]);
+        
+        // Sections are small, so all of them are verified up front, including lazily parsed ones
+        for (const auto& entry : entries) {
+            if (!verifySection(bytes, entry, version)) {
+                std::cerr << "State file section " << entry.type << " is corrupt (checksum mismatch)" << std::endl;
+                return false;
+            }
+        }
+        
+        // Core section: always needed
+        auto coreEntry = findSection(entries, SectionType::Core);
+        if (!coreEntry) {
+            return false;
+        }
+        
+        auto coreBytes = bytes.subspan(coreEntry->offset, coreEntry->length);
+        size_t coreSize = CORE_SECTION_SCHEMA.encodedSize(version);
+        CoreSection core;
+        if (!CORE_SECTION_SCHEMA.decode(coreBytes, version, core) ||
+            coreBytes.size() - coreSize < core.nameLength ||
+            core.evolutionLevel > static_cast<uint8_t>(EvolutionLevel::Ancient)) {
+            return false;
         }
         
-        // Read last interaction time
-        uint64_t lastInteractionSeconds = 0;
-        file.read(reinterpret_cast<char*>(&lastInteractionSeconds), sizeof(lastInteractionSeconds));
+        m_name.assign(reinterpret_cast<const char*>(coreBytes.data() + coreSize), core.nameLength);
+        m_evolutionLevel = static_cast<EvolutionLevel>(core.evolutionLevel);
+        m_xp = core.xp;
+        m_hunger = core.hunger;
+        m_happiness = core.happiness;
+        m_energy = core.energy;
         m_lastInteractionTime = std::chrono::system_clock::time_point(
-            std::chrono::seconds(lastInteractionSeconds));
-        
-        // Read birth date if version >= 2
-        if (version >= 2) {
-            uint64_t birthDateSeconds = 0;
-            file.read(reinterpret_cast<char*>(&birthDateSeconds), sizeof(birthDateSeconds));
-            m_birthDate = std::chrono::system_clock::time_point(
-                std::chrono::seconds(birthDateSeconds));
-        } else {
-            // For old versions, set to current time
-            m_birthDate = std::chrono::system_clock::now();
+            std::chrono::seconds(core.lastInteractionSeconds));
+        m_birthDate = std::chrono::system_clock::time_point(
+            std::chrono::seconds(core.birthDateSeconds));
+        m_journalSequence = core.journalSequence;
+        
+        // Achievements section: kept raw and parsed on first use
+        m_achievementSystem.reset();
+        if (auto achievementEntry = findSection(entries, SectionType::Achievements)) {
+            auto achievementBytes = bytes.subspan(achievementEntry->offset, achievementEntry->length);
+            if (achievementBytes.size() < ACHIEVEMENT_SECTION_SCHEMA.encodedSize(version)) {
+                return false;
+            }
+            m_achievementSection.assign(achievementBytes.begin(), achievementBytes.end());
+            m_achievementSectionVersion = version;
         }
         
-        // Read achievement progress if version >= 2
-        if (version >= 2) {
-            if (!m_achievementSystem.load(file, version)) {
-                std::cerr << "Failed to load achievement progress" << std::endl;
+        // Sections from newer builds are kept so that saving does not drop them
+        for (const auto& entry : entries) {
+            if (entry.type == static_cast<uint16_t>(SectionType::Core) ||
+                entry.type == static_cast<uint16_t>(SectionType::Achievements)) {
+                continue;
+            }
+            
+            if (entry.flags & SECTION_REQUIRED) {
+                std::cerr << "Unsupported state file section: " << entry.type << std::endl;
                 return false;
             }
+            
+            auto sectionBytes = bytes.subspan(entry.offset, entry.length);
+            m_preservedSections.push_back({ entry.type, entry.flags,
+                std::vector<std::byte>(sectionBytes.begin(), sectionBytes.end()) });
         }
         
-        if (!file) {
-            std::cerr << "Error reading state file: " << statePath.string() << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while reading state sections: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetState::loadHeaderV5(std::span<const std::byte> bytes) noexcept {
+    StateFileFormat::HeaderV5 header;
+    if (!StateFileFormat::decodeHeader(bytes, header) ||
+        header.evolutionLevel > static_cast<uint8_t>(EvolutionLevel::Ancient)) {
+        return false;
+    }
+    
+    const char* name = reinterpret_cast<const char*>(bytes.data() + header.headerSize);
+    m_name.assign(name, header.nameLength);
+    
+    m_evolutionLevel = static_cast<EvolutionLevel>(header.evolutionLevel);
+    m_xp = header.xp;
+    m_hunger = header.hunger;
+    m_happiness = header.happiness;
+    m_energy = header.energy;
+    m_lastInteractionTime = std::chrono::system_clock::time_point(
+        std::chrono::seconds(header.lastInteractionSeconds));
+    m_birthDate = std::chrono::system_clock::time_point(
+        std::chrono::seconds(header.birthDateSeconds));
+    
+    StateFileFormat::AchievementSection achievements{};
+    achievements.unlockedAchievements = header.unlockedAchievements;
+    achievements.newlyUnlockedAchievements = header.newlyUnlockedAchievements;
+    std::copy(std::begin(header.achievementProgress), std::end(header.achievementProgress),
+              achievements.achievementProgress);
+    achievements.usedCommandsMask = header.usedCommandsMask;
+    m_achievementSystem.readSection(achievements);
+    
+    m_journalSequence = header.journalSequence;
+    
+    return true;
+}
+
+bool PetState::loadLegacy(BinarySchema::Reader& reader, uint8_t version) noexcept {
+    // Read name
+    uint16_t nameLength = 0;
+    reader.read(nameLength);
+    
+    auto name = reader.readBytes(nameLength);
+    m_name.assign(reinterpret_cast<const char*>(name.data()), name.size());
+    
+    // Read basic stats
+    uint8_t evolutionLevel = 0;
+    reader.read(evolutionLevel);
+    m_evolutionLevel = static_cast<EvolutionLevel>(evolutionLevel);
+    
+    reader.read(m_xp);
+    
+    // For version 1 and 2, read stats as uint8_t and convert to float
+    if (version <= 2) {
+        uint8_t hunger = 0, happiness = 0, energy = 0;
+        reader.read(hunger);
+        reader.read(happiness);
+        reader.read(energy);
+        
+        // Convert from percentage (0-100) to actual values based on max
+        float maxStat = getMaxStatValue();
+        m_hunger = (static_cast<float>(hunger) / 100.0f) * maxStat;
+        m_happiness = (static_cast<float>(happiness) / 100.0f) * maxStat;
+        m_energy = (static_cast<float>(energy) / 100.0f) * maxStat;
+    } else {
+        // For future versions, read stats as float directly
+        reader.read(m_hunger);
+        reader.read(m_happiness);
+        reader.read(m_energy);
+    }
+    
+    // Read last interaction time
+    uint64_t lastInteractionSeconds = 0;
+    reader.read(lastInteractionSeconds);
+    m_lastInteractionTime = std::chrono::system_clock::time_point(
+        std::chrono::seconds(lastInteractionSeconds));
+    
+    // Read birth date if version >= 2
+    if (version >= 2) {
+        uint64_t birthDateSeconds = 0;
+        reader.read(birthDateSeconds);
+        m_birthDate = std::chrono::system_clock::time_point(
+            std::chrono::seconds(birthDateSeconds));
+    } else {
+        // For old versions, set to current time
+        m_birthDate = std::chrono::system_clock::now();
+    }
+    
+    // Read achievement progress if version >= 2
+    if (version >= 2) {
+        if (!m_achievementSystem.load(reader, version)) {
             return false;
         }
+    }
+    
+    return reader.ok() && evolutionLevel <= static_cast<uint8_t>(EvolutionLevel::Ancient);
+}
+
+void PetState::replayJournal(const std::filesystem::path& statePath) noexcept {
+    auto journalPath = statePath;
+    journalPath += ".journal";
+    m_journal.setPath(journalPath);
+    
+    m_pendingRecords.clear();
+    m_pendingRecordCount = 0;
+    m_hasSnapshot = true;
+    
+    // Achievements unlocked again during replay were already announced
+    std::optional<uint64_t> newlyUnlocked;
+    
+    m_replayingJournal = true;
+    m_journalSequence = m_journal.replay(m_journalSequence, [&](const InteractionJournal::Record& record) {
+        if (!newlyUnlocked) {
+            newlyUnlocked = achievements().getNewlyUnlockedBits();
+        }
+        applyJournalRecord(record);
+    });
+    m_replayingJournal = false;
+    
+    if (newlyUnlocked) {
+        achievements().setNewlyUnlockedBits(*newlyUnlocked);
+    }
+    
+    // The loaded state matches what is on disk
+    markClean();
+}
+
+void PetState::applyJournalRecord(const InteractionJournal::Record& record) noexcept {
+    auto time = InteractionJournal::decodeTime(record.value);
+    
+    switch (record.type) {
+        case JournalRecordType::Feed:
+            applyFeeding(time);
+            break;
+        case JournalRecordType::Play:
+            applyPlaying(time);
+            break;
+        case JournalRecordType::FeedBatch:
+        case JournalRecordType::PlayBatch: {
+            auto times = static_cast<uint32_t>(std::min<uint64_t>(record.count, MAX_BATCH_COUNT));
+            if (record.type == JournalRecordType::FeedBatch) {
+                applyFeeding(time, times);
+            } else {
+                applyPlaying(time, times);
+            }
+            break;
+        }
+        case JournalRecordType::TimeEffects:
+            applyElapsedTime(time);
+            break;
+        case JournalRecordType::AchievementUnlock:
+            if (record.value < static_cast<uint64_t>(AchievementType::Count)) {
+                unlockAchievement(static_cast<AchievementType>(record.value));
+            }
+            break;
+        case JournalRecordType::CommandUsed: {
+            auto command = AchievementSystem::getExplorerCommand(static_cast<size_t>(record.value));
+            if (!command.empty()) {
+                achievements().trackUniqueCommand(std::string(command));
+            }
+            break;
+        }
+        default:
+            // Records from a newer build are skipped
+            break;
+    }
+}
+
+void PetState::recordInteraction(JournalRecordType type, uint64_t value, uint64_t count) noexcept {
+    if (m_replayingJournal) {
+        return;
+    }
+    
+    try {
+        InteractionJournal::encodeRecord(m_pendingRecords, { type, value, count });
+        ++m_pendingRecordCount;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while recording interaction: " << e.what() << std::endl;
+    }
+}
+
+bool PetState::applyFeeding(std::chrono::system_clock::time_point now, uint32_t times) noexcept {
+    times = static_cast<uint32_t>(std::min<uint64_t>(times, MAX_BATCH_COUNT));
+    if (times == 0) {
+        return false;
+    }
+    
+    bool wasApplying = beginInteraction();
+    applyElapsedTime(now);
+    bool evolved = applyRepeatedInteraction(m_hunger, GameConfig::getFeedingHungerIncrease(),
+                                            GameConfig::getFeedingXPGain(), times, AchievementType::WellFed);
+    m_lastInteractionTime = now;
+    markDirty(DirtyTimes);
+    
+    if (times == 1) {
+        recordInteraction(JournalRecordType::Feed, InteractionJournal::encodeTime(now));
+    } else {
+        recordInteraction(JournalRecordType::FeedBatch, InteractionJournal::encodeTime(now), times);
+    }
+    endInteraction(wasApplying);
+    return evolved;
+}
+
+bool PetState::applyPlaying(std::chrono::system_clock::time_point now, uint32_t times) noexcept {
+    times = static_cast<uint32_t>(std::min<uint64_t>(times, MAX_BATCH_COUNT));
+    if (times == 0) {
+        return false;
+    }
+    
+    bool wasApplying = beginInteraction();
+    applyElapsedTime(now);
+    
+    // Energy only falls, and its floor does not depend on the level
+    decreaseEnergy(static_cast<float>(times) * GameConfig::getPlayingEnergyDecrease());
+    bool evolved = applyRepeatedInteraction(m_happiness, GameConfig::getPlayingHappinessIncrease(),
+                                            GameConfig::getPlayingXPGain(), times, AchievementType::HappyDays);
+    m_lastInteractionTime = now;
+    markDirty(DirtyTimes);
+    
+    // Track play count for Playful achievement
+    achievements().incrementProgress(AchievementType::Playful, times);
+    
+    if (times == 1) {
+        recordInteraction(JournalRecordType::Play, InteractionJournal::encodeTime(now));
+    } else {
+        recordInteraction(JournalRecordType::PlayBatch, InteractionJournal::encodeTime(now), times);
+    }
+    endInteraction(wasApplying);
+    return evolved;
+}
+
+bool PetState::applyRepeatedInteraction(float& stat, float amount, uint32_t xpGain, uint32_t times,
+                                        AchievementType fullAchievement) noexcept {
+    bool evolved = false;
+    uint64_t remaining = times;
+    
+    // One pass per level: every iteration either uses up the interactions or evolves the pet
+    while (remaining > 0) {
+        // Interactions at this level, up to and including the one whose XP evolves the pet
+        uint64_t atLevel = remaining;
+        uint32_t xpForNextLevel = getXPForNextLevel();
+        if (m_evolutionLevel != EvolutionLevel::Ancient && xpGain > 0) {
+            atLevel = m_xp >= xpForNextLevel ? 1 :
+                std::min<uint64_t>(remaining, (xpForNextLevel - m_xp + xpGain - 1) / xpGain);
+        }
+        
+        // The stat only rises within a level, so its highest percentage is the final one
+        float maxStat = getMaxStatValue();
+        stat = std::min(stat + static_cast<float>(atLevel) * amount, maxStat);
+        float percentageNow = (stat / maxStat) * 100.0f;
+        achievements().setProgress(fullAchievement, static_cast<uint32_t>(percentageNow));
+        
+        uint64_t xpAfter = std::min<uint64_t>(uint64_t{m_xp} + atLevel * xpGain, UINT32_MAX);
+        evolved |= addXP(static_cast<uint32_t>(xpAfter - m_xp));
+        remaining -= atLevel;
+    }
+    
+    markDirty(DirtyStats);
+    return evolved;
+}
+
+double PetState::getPendingHours(std::chrono::system_clock::time_point now) const noexcept {
+    if (m_lastInteractionTime == std::chrono::system_clock::time_point{}) {
+        // First interaction, no effects to apply
+        return 0.0;
+    }
+    
+    // Calculate hours passed
+    double hoursPassed = std::chrono::duration<double, std::ratio<3600, 1>>(now - m_lastInteractionTime).count();
+    
+    // Avoid changes on frequent status checks
+    if (hoursPassed < GameConfig::Time::MIN_TIME_THRESHOLD) {
+        return 0.0;
+    }
+    return hoursPassed;
+}
+
+TimeDecay::Stats PetState::getStatsAt(std::chrono::system_clock::time_point now) const noexcept {
+    double hoursPassed = getPendingHours(now);
+    if (hoursPassed == 0.0) {
+        return getAnchorStats();
+    }
+    return TimeDecay::applyHours(getAnchorStats(), getMaxStatValue(), hoursPassed);
+}
+
+double PetState::applyElapsedTime(std::chrono::system_clock::time_point now) noexcept {
+    double hoursPassed = getPendingHours(now);
+    if (hoursPassed == 0.0) {
+        return 0.0;
+    }
+    
+    // The same closed form the getters evaluate, so reads before and after agree
+    bool wasApplying = beginInteraction();
+    auto stats = TimeDecay::applyHours(getAnchorStats(), getMaxStatValue(), hoursPassed);
+    m_hunger = stats.hunger;
+    m_happiness = stats.happiness;
+    m_energy = stats.energy;
+    updateRestedProgress();
+    
+    m_lastInteractionTime = now;
+    markDirty(DirtyStats | DirtyTimes);
+    
+    recordInteraction(JournalRecordType::TimeEffects, InteractionJournal::encodeTime(now));
+    endInteraction(wasApplying);
+    return hoursPassed;
+}
+
+bool PetState::unlockAchievement(AchievementType type) noexcept {
+    bool wasApplying = beginInteraction();
+    bool unlocked = achievements().unlock(type);
+    if (unlocked) {
+        recordInteraction(JournalRecordType::AchievementUnlock, static_cast<uint64_t>(type));
+    }
+    endInteraction(wasApplying);
+    return unlocked;
+}
+
+void PetState::trackCommand(const std::string& command) noexcept {
+    bool wasApplying = beginInteraction();
+    uint32_t usedBefore = achievements().getUsedCommandsMask();
+    achievements().trackUniqueCommand(command);
+    
+    uint32_t newlyUsed = achievements().getUsedCommandsMask() & ~usedBefore;
+    if (newlyUsed != 0) {
+        recordInteraction(JournalRecordType::CommandUsed, static_cast<uint64_t>(std::countr_zero(newlyUsed)));
+    }
+    endInteraction(wasApplying);
+}
+
+bool PetState::commitInteractions() noexcept {
+    collectAchievementChanges();
+    
+    // Changes the journal cannot express, or no snapshot for the journal to build on
+    if (m_snapshotRequired || (m_pendingRecordCount != 0 && !m_hasSnapshot)) {
+        return save();
+    }
+    
+    if (m_pendingRecordCount == 0) {
+        markClean();
+        return true;
+    }
+    
+    try {
+        if (!m_journal.append(m_pendingRecords, m_pendingRecordCount, m_journalSequence, m_fileWriter)) {
+            // Fall back to a full snapshot
+            return save();
+        }
+        
+        ++m_writeCount;
+        m_journalSequence += m_pendingRecordCount;
+        m_pendingRecords.clear();
+        m_pendingRecordCount = 0;
+        markClean();
+        
+        // Fold the journal into a new snapshot once it gets large
+        if (m_journal.size() >= GameConfig::Persistence::JOURNAL_COMPACTION_THRESHOLD) {
+            m_journal.compactAsync(m_statePath, encodeImage(), m_journalSequence);
+        }
         
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Exception while loading state: " << e.what() << std::endl;
+        std::cerr << "Exception while committing interactions: " << e.what() << std::endl;
         return false;
     }
 }
 
+void PetState::beginTransaction() noexcept {
+    if (m_transactionDepth++ > 0) {
+        return;
+    }
+    
+    collectAchievementChanges();
+}
+
+bool PetState::commitTransaction() noexcept {
+    if (m_transactionDepth > 0) {
+        if (--m_transactionDepth > 0) {
+            return true;
+        }
+    }
+    
+    if (!isDirty()) {
+        return true;
+    }
+    
+    return commitInteractions();
+}
+
+void PetState::markDirty(uint8_t fields) noexcept {
+    m_dirtyFields |= fields;
+    if (!m_applyingInteraction) {
+        m_snapshotRequired = true;
+    }
+}
+
+bool PetState::beginInteraction() noexcept {
+    if (!m_applyingInteraction) {
+        collectAchievementChanges();
+    }
+    return std::exchange(m_applyingInteraction, true);
+}
+
+void PetState::endInteraction(bool wasApplying) noexcept {
+    if (!wasApplying && m_achievementSystem.isDirty()) {
+        // Achievement changes made by the interaction are reproduced by replaying it
+        m_dirtyFields |= DirtyAchievements;
+        m_achievementSystem.clearDirty();
+    }
+    m_applyingInteraction = wasApplying;
+}
+
+void PetState::collectAchievementChanges() const noexcept {
+    if (m_achievementSystem.isDirty()) {
+        m_dirtyFields |= DirtyAchievements;
+        m_snapshotRequired = true;
+        m_achievementSystem.clearDirty();
+    }
+}
+
+void PetState::markClean() const noexcept {
+    m_dirtyFields = 0;
+    m_snapshotRequired = false;
+    m_achievementSystem.clearDirty();
+}
+
+std::vector<std::byte> PetState::encodeImage() const {
+    using namespace StateFileFormat;
+    
+    // Core section: fixed fields followed by the name
+    CoreSection core{};
+    core.evolutionLevel = static_cast<uint8_t>(m_evolutionLevel);
+    core.nameLength = static_cast<uint16_t>(std::min<size_t>(m_name.size(), UINT16_MAX));
+    core.xp = m_xp;
+    core.hunger = m_hunger;
+    core.happiness = m_happiness;
+    core.energy = m_energy;
+    core.lastInteractionSeconds = std::chrono::duration_cast<std::chrono::seconds>(
+            m_lastInteractionTime.time_since_epoch()).count();
+    core.birthDateSeconds = std::chrono::duration_cast<std::chrono::seconds>(
+            m_birthDate.time_since_epoch()).count();
+    core.journalSequence = m_journalSequence;
+    
+    constexpr size_t coreSize = CORE_SECTION_SCHEMA.encodedSize(CURRENT_VERSION);
+    std::vector<std::byte> coreBytes(coreSize + core.nameLength);
+    CORE_SECTION_SCHEMA.encode(core, CURRENT_VERSION, coreBytes);
+    std::memcpy(coreBytes.data() + coreSize, m_name.data(), core.nameLength);
+    
+    // Achievements section: reuse the raw bytes if they were never parsed
+    std::vector<std::byte> achievementBytes;
+    if (m_achievementSection.empty() || m_achievementSectionVersion != CURRENT_VERSION) {
+        ensureAchievementsLoaded();
+        AchievementSection achievements{};
+        m_achievementSystem.writeSection(achievements);
+        achievementBytes.resize(ACHIEVEMENT_SECTION_SCHEMA.encodedSize(CURRENT_VERSION));
+        ACHIEVEMENT_SECTION_SCHEMA.encode(achievements, CURRENT_VERSION, achievementBytes);
+    }
+    
+    std::vector<SectionPayload> sections;
+    sections.reserve(2 + m_preservedSections.size());
+    sections.push_back({ static_cast<uint16_t>(SectionType::Core), SECTION_REQUIRED, coreBytes });
+    sections.push_back({ static_cast<uint16_t>(SectionType::Achievements), 0,
+                         achievementBytes.empty() ? std::span<const std::byte>(m_achievementSection) : achievementBytes });
+    for (const auto& section : m_preservedSections) {
+        sections.push_back({ section.type, section.flags, section.bytes });
+    }
+    
+    // One contiguous buffer, so a save is a single write
+    return encodeSections(sections);
+}
+
+void PetState::ensureAchievementsLoaded() const noexcept {
+    if (m_achievementSection.empty()) {
+        return;
+    }
+    
+    StateFileFormat::AchievementSection section;
+    if (StateFileFormat::ACHIEVEMENT_SECTION_SCHEMA.decode(m_achievementSection, m_achievementSectionVersion, section)) {
+        m_achievementSystem.readSection(section);
+    }
+    m_achievementSection.clear();
+}
+
 bool PetState::save() const noexcept {
+    // Keep saving to the file the pet was loaded from
+    return saveToFile(m_statePath.empty() ? getStateFilePath() : m_statePath);
+}
+
+bool PetState::saveToFile(const std::filesystem::path& statePath) const noexcept {
+    return saveToFile(statePath, m_fileWriter);
+}
+
+bool PetState::saveToFile(const std::filesystem::path& statePath, AtomicFileWriter& writer) const noexcept {
     try {
-        auto statePath = getStateFilePath();
+        m_statePath = statePath;
         
         // Create parent directory if it doesn't exist
-        std::filesystem::create_directories(statePath.parent_path());
+        if (statePath.has_parent_path()) {
+            std::filesystem::create_directories(statePath.parent_path());
+        }
+        
+        auto journalPath = statePath;
+        journalPath += ".journal";
+        m_journal.setPath(journalPath);
+        
+        // The snapshot includes everything recorded so far
+        m_journalSequence += m_pendingRecordCount;
+        m_pendingRecords.clear();
+        m_pendingRecordCount = 0;
+        
+        // A running compaction writes an older snapshot to the same file;
+        // it must land before this save, not after it
+        m_journal.waitForCompaction();
         
-        std::ofstream file(statePath, std::ios::binary | std::ios::trunc);
-        if (!file) {
-            std::cerr << "Failed to open state file for writing: " << statePath.string() << std::endl;
+        // Write to a temporary file and rename it over the old one,
+        // so an interrupted save never leaves a truncated state file
+        if (!writer.write(statePath, encodeImage())) {
             return false;
         }
+        ++m_writeCount;
+        m_hasSnapshot = true;
+        markClean();
         
-        // File format version
-        // Version 1: Basic pet state
-        // Version 2: Added birth date and achievements
-        // Version 3: Changed stats from uint8_t to float
-        // Version 4: Changed stats from percentage to actual values
-        const uint8_t version = 4;
-        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
-        
-        // Write name
-        uint16_t nameLength = static_cast<uint16_t>(m_name.size());
-        file.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
-        file.write(m_name.c_str(), nameLength);
-        
-        // Write basic stats
-        uint8_t evolutionLevel = static_cast<uint8_t>(m_evolutionLevel);
-        file.write(reinterpret_cast<const char*>(&evolutionLevel), sizeof(evolutionLevel));
-        file.write(reinterpret_cast<const char*>(&m_xp), sizeof(m_xp));
-        
-        // Write stats as float
-        file.write(reinterpret_cast<const char*>(&m_hunger), sizeof(m_hunger));
-        file.write(reinterpret_cast<const char*>(&m_happiness), sizeof(m_happiness));
-        file.write(reinterpret_cast<const char*>(&m_energy), sizeof(m_energy));
-        
-        // Write last interaction time
-        auto lastInteractionSeconds = std::chrono::duration_cast<std::chrono::seconds>(
-                m_lastInteractionTime.time_since_epoch()).count();
-        file.write(reinterpret_cast<const char*>(&lastInteractionSeconds), sizeof(lastInteractionSeconds));
-        
-        // Write birth date
-        auto birthDateSeconds = std::chrono::duration_cast<std::chrono::seconds>(
-                m_birthDate.time_since_epoch()).count();
-        file.write(reinterpret_cast<const char*>(&birthDateSeconds), sizeof(birthDateSeconds));
-        
-        // Write achievement progress
-        if (!m_achievementSystem.save(file)) {
-            std::cerr << "Failed to save achievement progress" << std::endl;
+        // Every journaled record is now part of the snapshot
+        m_journal.clear();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while saving state: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetState::loadFromStore(PetStore& store, uint64_t petId) noexcept {
+    try {
+        std::vector<std::byte> record;
+        if (!store.get(petId, record)) {
+            return false;
+        }
+        
+        if (record.empty() || static_cast<uint8_t>(record[0]) < StateFileFormat::HEADER_V5_VERSION ||
+            static_cast<uint8_t>(record[0]) > StateFileFormat::CURRENT_VERSION) {
+            std::cerr << "Unsupported record version for pet " << petId << std::endl;
             return false;
         }
         
-        if (!file) {
-            std::cerr << "Error writing state file: " << statePath.string() << std::endl;
+        if (!loadFromImage(record)) {
+            std::cerr << "Error reading record for pet " << petId << std::endl;
             return false;
         }
         
+        markClean();
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Exception while saving state: " << e.what() << std::endl;
+        std::cerr << "Exception while loading pet " << petId << ": " << e.what() << std::endl;
         return false;
     }
 }
 
-bool PetState::addXP(uint32_t amount) noexcept {
-    m_xp += amount;
+bool PetState::saveToStore(PetStore& store, uint64_t petId) const noexcept {
+    try {
+        if (!store.put(petId, encodeImage())) {
+            return false;
+        }
+        
+        // Saving is where XP gains and new pets reach the store, so rank them here
+        auto birthSeconds = std::chrono::duration_cast<std::chrono::seconds>(m_birthDate.time_since_epoch()).count();
+        store.getLeaderboard().update({ petId, getXP(), birthSeconds });
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while saving pet " << petId << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetState::loadFromArchive(const PetArchive& archive, const std::string& name) noexcept {
+    try {
+        std::vector<std::byte> image;
+        if (!archive.get(name, image)) {
+            return false;
+        }
+        
+        if (image.empty() || static_cast<uint8_t>(image[0]) < StateFileFormat::HEADER_V5_VERSION ||
+            static_cast<uint8_t>(image[0]) > StateFileFormat::CURRENT_VERSION || !loadFromImage(image)) {
+            std::cerr << "Error reading archived pet '" << name << "'" << std::endl;
+            return false;
+        }
+        
+        markClean();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while loading archived pet '" << name << "': " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetState::saveToArchive(PetArchive& archive, const std::string& name) const noexcept {
+    try {
+        return archive.put(name, encodeImage());
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while archiving pet '" << name << "': " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetState::loadFromRecord(const PetRecord& record, const NameTable& names) noexcept {
+    if (record.evolutionLevel > static_cast<uint8_t>(EvolutionLevel::Ancient)) {
+        return false;
+    }
     
-    // Check if we should evolve
-    uint32_t xpForNextLevel = getXPForNextLevel();
+    try {
+        m_name = names.get(record.nameId);
+        m_evolutionLevel = static_cast<EvolutionLevel>(record.evolutionLevel);
+        m_xp = record.xp;
+        m_hunger = PetRecord::fromFixed(record.hunger);
+        m_happiness = PetRecord::fromFixed(record.happiness);
+        m_energy = PetRecord::fromFixed(record.energy);
+        m_lastInteractionTime = PetRecord::fromMinutes(record.lastInteractionMinutes);
+        m_birthDate = PetRecord::fromMinutes(record.birthDateMinutes);
+        
+        StateFileFormat::AchievementSection achievements{};
+        achievements.unlockedAchievements = record.unlockedAchievements;
+        achievements.newlyUnlockedAchievements = record.newlyUnlockedAchievements;
+        for (size_t i = 0; i < AchievementSystem::getAchievementCount(); ++i) {
+            achievements.achievementProgress[i] = record.getProgress(static_cast<AchievementType>(i));
+        }
+        achievements.usedCommandsMask = record.usedCommandsMask;
+        m_achievementSection.clear();
+        m_achievementSystem.readSection(achievements);
+        m_preservedSections.clear();
+        
+        markClean();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while loading pet record: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+PetRecord PetState::toRecord(NameTable& names) const {
+    const auto& achievementSystem = achievements();
+    
+    PetRecord record{};
+    record.xp = m_xp;
+    record.lastInteractionMinutes = PetRecord::toMinutes(m_lastInteractionTime);
+    record.birthDateMinutes = PetRecord::toMinutes(m_birthDate);
+    record.nameId = names.intern(m_name);
+    record.hunger = PetRecord::toFixed(m_hunger);
+    record.happiness = PetRecord::toFixed(m_happiness);
+    record.energy = PetRecord::toFixed(m_energy);
+    record.unlockedAchievements = static_cast<uint16_t>(achievementSystem.getUnlockedBits());
+    record.newlyUnlockedAchievements = static_cast<uint16_t>(achievementSystem.getNewlyUnlockedBits());
+    record.evolutionLevel = static_cast<uint8_t>(m_evolutionLevel) & 0xF;
+    record.usedCommandsMask = static_cast<uint8_t>(achievementSystem.getUsedCommandsMask());
     
-    if (xpForNextLevel > 0 && m_xp >= xpForNextLevel) {
+    // Unlocked achievements report their required progress, so only locked ones are stored
+    for (size_t i = 0; i < AchievementSystem::getAchievementCount(); ++i) {
+        auto type = static_cast<AchievementType>(i);
+        if (!achievementSystem.isUnlocked(type)) {
+            record.setProgress(type, achievementSystem.getProgress(type));
+        }
+    }
+    return record;
+}
+
+bool PetState::rehydrateFromArchive(const std::filesystem::path& statePath) noexcept {
+    try {
+        auto archivePath = PetArchive::archivePathFor(statePath);
+        if (!std::filesystem::exists(archivePath)) {
+            return false;
+        }
+        
+        // Held until the entry is dropped, so no other restore or archive run commits in between
+        PetArchive::Lock lock(archivePath);
+        if (!lock.isLocked()) {
+            return false;
+        }
+        if (std::filesystem::exists(statePath)) {
+            // Restored by someone else while we waited for the lock
+            return loadFromFile(statePath);
+        }
+        
+        PetArchive archive;
+        auto name = statePath.filename().string();
+        if (!archive.open(archivePath) || !archive.contains(name) || !loadFromArchive(archive, name)) {
+            return false;
+        }
+        replayJournal(statePath);
+        
+        // The state file must be in place before the entry is dropped;
+        // if the archive rewrite fails the stale entry is shadowed by the file
+        if (!saveToFile(statePath)) {
+            return false;
+        }
+        archive.erase(name);
+        archive.commit();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while restoring archived pet: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool PetState::addXP(uint32_t amount) noexcept {
+    // Saturate rather than wrap around to a lower level's XP
+    m_xp = static_cast<uint32_t>(std::min<uint64_t>(uint64_t{m_xp} + amount, UINT32_MAX));
+    markDirty(DirtyXP);
+    
+    // Evolve through every level the XP covers
+    bool evolved = false;
+    while (m_evolutionLevel != EvolutionLevel::Ancient && m_xp >= getXPForNextLevel()) {
         // Evolve to the next level
         m_evolutionLevel = static_cast<EvolutionLevel>(static_cast<uint8_t>(m_evolutionLevel) + 1);
+        markDirty(DirtyEvolution);
+        evolved = true;
         
         // Unlock achievement for evolution
-        m_achievementSystem.unlock(AchievementType::Evolution);
+        achievements().unlock(AchievementType::Evolution);
         
         // Special achievements for reaching Master and Ancient levels
         if (m_evolutionLevel == EvolutionLevel::Master) {
-            m_achievementSystem.unlock(AchievementType::Master);
+            achievements().unlock(AchievementType::Master);
         } else if (m_evolutionLevel == EvolutionLevel::Ancient) {
-            m_achievementSystem.unlock(AchievementType::Eternal);
+            achievements().unlock(AchievementType::Eternal);
         }
-        
-        return true;
     }
     
-    return false;
+    return evolved;
 }
 
 uint32_t PetState::getXPForNextLevel() const noexcept {
@@ -278,6 +1031,7 @@ uint32_t PetState::getXPForNextLevel() const noexcept {
 
 void PetState::increaseHunger(float amount) noexcept {
     m_hunger += amount;
+    markDirty(DirtyStats);
     
     // Cap at max
     if (m_hunger > getMaxStatValue()) {
@@ -286,15 +1040,17 @@ void PetState::increaseHunger(float amount) noexcept {
     
     // Update progress for achievement - based on percentage (0-100 scale)
     float percentageNow = (m_hunger / getMaxStatValue()) * 100.0f;
-    m_achievementSystem.setProgress(AchievementType::WellFed, static_cast<uint32_t>(percentageNow));
+    achievements().setProgress(AchievementType::WellFed, static_cast<uint32_t>(percentageNow));
 }
 
 void PetState::decreaseHunger(float amount) noexcept {
     m_hunger = (m_hunger > amount) ? (m_hunger - amount) : 0.0f;
+    markDirty(DirtyStats);
 }
 
 void PetState::increaseHappiness(float amount) noexcept {
     m_happiness += amount;
+    markDirty(DirtyStats);
     
     // Cap at max
     if (m_happiness > getMaxStatValue()) {
@@ -303,32 +1059,40 @@ void PetState::increaseHappiness(float amount) noexcept {
     
     // Update progress for achievement - based on percentage (0-100 scale)
     float percentageNow = (m_happiness / getMaxStatValue()) * 100.0f;
-    m_achievementSystem.setProgress(AchievementType::HappyDays, static_cast<uint32_t>(percentageNow));
+    achievements().setProgress(AchievementType::HappyDays, static_cast<uint32_t>(percentageNow));
 }
 
 void PetState::decreaseHappiness(float amount) noexcept {
     m_happiness = (m_happiness > amount) ? (m_happiness - amount) : 0.0f;
+    markDirty(DirtyStats);
 }
 
 void PetState::increaseEnergy(float amount) noexcept {
     m_energy += amount;
+    markDirty(DirtyStats);
     
     // Cap at max
     if (m_energy > getMaxStatValue()) {
         m_energy = getMaxStatValue();
     }
     
+    updateRestedProgress();
+}
+
+void PetState::updateRestedProgress() noexcept {
     // Update progress for achievement - based on percentage (0-100 scale)
     float percentageNow = (m_energy / getMaxStatValue()) * 100.0f;
-    m_achievementSystem.setProgress(AchievementType::FullyRested, static_cast<uint32_t>(percentageNow));
+    achievements().setProgress(AchievementType::FullyRested, static_cast<uint32_t>(percentageNow));
 }
 
 void PetState::decreaseEnergy(float amount) noexcept {
     m_energy = (m_energy > amount) ? (m_energy - amount) : 0.0f;
+    markDirty(DirtyStats);
 }
 
 void PetState::updateInteractionTime() noexcept {
     m_lastInteractionTime = std::chrono::system_clock::now();
+    markDirty(DirtyTimes);
 }
 
 float PetState::getMaxStatValue() const noexcept {
@@ -0,0 +1,565 @@
+#include "../include/pet_store.h"
+#include "../include/pet_state.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+    constexpr char STORE_MAGIC[8] = { 'P', 'E', 'T', 'S', 'T', 'O', 'R', 'E' };
+    constexpr uint32_t STORE_FORMAT_VERSION = 1;
+
+    PetStore::PageHeader readPageHeader(std::span<const std::byte> page) noexcept {
+        PetStore::PageHeader header;
+        std::memcpy(&header, page.data(), sizeof(header));
+        return header;
+    }
+
+    PetStore::Slot readSlot(std::span<const std::byte> page, uint16_t index) noexcept {
+        PetStore::Slot slot;
+        std::memcpy(&slot, page.data() + sizeof(PetStore::PageHeader) + index * sizeof(PetStore::Slot), sizeof(slot));
+        return slot;
+    }
+
+    void writeSlot(std::span<std::byte> page, uint16_t index, const PetStore::Slot& slot) noexcept {
+        std::memcpy(page.data() + sizeof(PetStore::PageHeader) + index * sizeof(PetStore::Slot), &slot, sizeof(slot));
+    }
+
+    /**
+     * @brief Check that a page's directory and records lie within the page
+     *
+     * Everything else reads slots and records at the offsets stored here,
+     * so a page that fails this check is never used.
+     */
+    bool isValidPage(std::span<const std::byte> page) noexcept {
+        auto header = readPageHeader(page);
+        size_t directoryEnd = sizeof(PetStore::PageHeader) + static_cast<size_t>(header.slotCount) * sizeof(PetStore::Slot);
+        if (directoryEnd > header.freeStart || header.freeStart > header.freeEnd || header.freeEnd > PetStore::PAGE_SIZE) {
+            return false;
+        }
+
+        for (uint16_t i = 0; i < header.slotCount; ++i) {
+            auto slot = readSlot(page, i);
+            if (slot.offset < header.freeEnd || static_cast<size_t>(slot.offset) + slot.capacity > PetStore::PAGE_SIZE ||
+                slot.length > slot.capacity) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t slotFileOffset(uint32_t page, uint16_t index) noexcept {
+        return static_cast<uint64_t>(page) * PetStore::PAGE_SIZE + sizeof(PetStore::PageHeader) + index * sizeof(PetStore::Slot);
+    }
+}
+
+static_assert(sizeof(PetStore::PageHeader) == 16);
+static_assert(sizeof(PetStore::Slot) == 16);
+
+PetStore::~PetStore() {
+    close();
+}
+
+std::filesystem::path PetStore::leaderboardPathFor(const std::filesystem::path& storePath) {
+    return std::filesystem::path(storePath).concat(".leaderboard");
+}
+
+bool PetStore::open(const std::filesystem::path& path) noexcept {
+    try {
+        close();
+        m_index.clear();
+        m_freeSpace.clear();
+        m_leaderboard.clear();
+        m_pageCount = 0;
+        m_flags = 0;
+        m_path = path;
+        m_pageBuffer.resize(PAGE_SIZE);
+
+        if (!std::filesystem::exists(path)) {
+            if (path.has_parent_path()) {
+                std::filesystem::create_directories(path.parent_path());
+            }
+            std::ofstream create(path, std::ios::binary);
+            if (!create) {
+                std::cerr << "Failed to create pet store: " << path.string() << std::endl;
+                return false;
+            }
+        }
+
+        if (!lockFile()) {
+            return false;
+        }
+
+        m_file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (!m_file) {
+            std::cerr << "Failed to open pet store: " << path.string() << std::endl;
+            unlockFile();
+            return false;
+        }
+
+        m_file.seekg(0, std::ios::end);
+        auto fileSize = static_cast<uint64_t>(m_file.tellg());
+
+        // New store: write the header page
+        if (fileSize == 0) {
+            m_pageCount = 1;
+            std::fill(m_pageBuffer.begin(), m_pageBuffer.end(), std::byte{0});
+            if (!writePage(0, m_pageBuffer) || !writeHeader()) {
+                m_file.close();
+                unlockFile();
+                return false;
+            }
+            m_freeSpace.assign(1, 0);
+            return true;
+        }
+
+        StoreHeader header{};
+        m_file.seekg(0);
+        m_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!m_file || std::memcmp(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0 ||
+            header.formatVersion != STORE_FORMAT_VERSION || header.pageSize != PAGE_SIZE ||
+            static_cast<uint64_t>(header.pageCount) * PAGE_SIZE > fileSize) {
+            std::cerr << "Invalid pet store: " << path.string() << std::endl;
+            m_file.close();
+            unlockFile();
+            return false;
+        }
+
+        // Rebuild the index and free-space map from the slot directories
+        m_pageCount = header.pageCount;
+        m_flags = header.flags;
+        m_freeSpace.assign(m_pageCount, 0);
+        std::vector<std::pair<uint64_t, SlotLocation>> moved;
+        for (uint32_t page = 1; page < m_pageCount; ++page) {
+            if (!readPage(page, m_pageBuffer)) {
+                m_file.close();
+                unlockFile();
+                return false;
+            }
+            if (!isValidPage(m_pageBuffer)) {
+                std::cerr << "Invalid pet store page " << page << ": " << path.string() << std::endl;
+                m_file.close();
+                unlockFile();
+                return false;
+            }
+
+            auto pageHeader = readPageHeader(m_pageBuffer);
+            for (uint16_t i = 0; i < pageHeader.slotCount; ++i) {
+                auto slot = readSlot(m_pageBuffer, i);
+                if (slot.flags & SLOT_LIVE) {
+                    SlotLocation location{ page, i, slot.offset, slot.length, slot.capacity };
+                    if (slot.flags & SLOT_MOVED) {
+                        moved.emplace_back(slot.petId, location);
+                    } else {
+                        m_index[slot.petId] = location;
+                    }
+                }
+            }
+            updateFreeSpace(page, m_pageBuffer);
+        }
+
+        if (!finishMoves(moved)) {
+            m_file.close();
+            unlockFile();
+            return false;
+        }
+
+        openLeaderboard();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while opening pet store: " << e.what() << std::endl;
+        m_file.close();
+        unlockFile();
+        return false;
+    }
+}
+
+bool PetStore::get(uint64_t petId, std::vector<std::byte>& record) noexcept {
+    auto it = m_index.find(petId);
+    if (it == m_index.end()) {
+        return false;
+    }
+
+    const auto& location = it->second;
+    record.resize(location.length);
+    m_file.seekg(static_cast<std::streamoff>(static_cast<uint64_t>(location.page) * PAGE_SIZE + location.offset));
+    m_file.read(reinterpret_cast<char*>(record.data()), location.length);
+
+    if (!m_file) {
+        m_file.clear();
+        return false;
+    }
+    return true;
+}
+
+bool PetStore::put(uint64_t petId, std::span<const std::byte> record) noexcept {
+    if (!isOpen() || record.size() > MAX_RECORD_SIZE || !markLeaderboardStale()) {
+        return false;
+    }
+
+    auto it = m_index.find(petId);
+    if (it != m_index.end()) {
+        auto& location = it->second;
+
+        // Fast path: overwrite the record in place
+        if (record.size() <= location.capacity) {
+            uint64_t recordOffset = static_cast<uint64_t>(location.page) * PAGE_SIZE + location.offset;
+            if (!writeAt(recordOffset, record.data(), record.size())) {
+                return false;
+            }
+
+            if (record.size() != location.length) {
+                Slot slot{ petId, location.offset, static_cast<uint16_t>(record.size()), location.capacity, SLOT_LIVE };
+                if (!writeAt(slotFileOffset(location.page, location.slot), &slot, sizeof(slot))) {
+                    return false;
+                }
+                location.length = static_cast<uint16_t>(record.size());
+            }
+            return true;
+        }
+
+        // The record outgrew its slot: write the new copy before clearing the old one,
+        // so a crash in between leaves two copies for open() to choose from rather than none
+        auto oldLocation = location;
+        if (!insert(petId, record, SLOT_LIVE | SLOT_MOVED) || !clearSlot(oldLocation)) {
+            return false;
+        }
+
+        const auto& newLocation = m_index[petId];
+        Slot slot{ petId, newLocation.offset, newLocation.length, newLocation.capacity, SLOT_LIVE };
+        return writeAt(slotFileOffset(newLocation.page, newLocation.slot), &slot, sizeof(slot));
+    }
+
+    return insert(petId, record, SLOT_LIVE);
+}
+
+bool PetStore::erase(uint64_t petId) noexcept {
+    if (!contains(petId) || !markLeaderboardStale() || !eraseRecord(petId)) {
+        return false;
+    }
+    m_leaderboard.remove(petId);
+    return true;
+}
+
+bool PetStore::eraseRecord(uint64_t petId) noexcept {
+    auto it = m_index.find(petId);
+    if (it == m_index.end()) {
+        return false;
+    }
+
+    if (!clearSlot(it->second)) {
+        return false;
+    }
+
+    m_index.erase(it);
+    return true;
+}
+
+bool PetStore::clearSlot(const SlotLocation& location) noexcept {
+    // Keep the slot's space reserved so it can be reused by another record
+    Slot slot{ 0, location.offset, 0, location.capacity, 0 };
+    if (!writeAt(slotFileOffset(location.page, location.slot), &slot, sizeof(slot))) {
+        return false;
+    }
+
+    m_freeSpace[location.page] = std::max(m_freeSpace[location.page], location.capacity);
+    return true;
+}
+
+bool PetStore::finishMoves(const std::vector<std::pair<uint64_t, SlotLocation>>& moved) noexcept {
+    for (const auto& [petId, location] : moved) {
+        // The old copy is still live only if the move was interrupted
+        auto it = m_index.find(petId);
+        if (it != m_index.end() && !clearSlot(it->second)) {
+            return false;
+        }
+
+        Slot slot{ petId, location.offset, location.length, location.capacity, SLOT_LIVE };
+        if (!writeAt(slotFileOffset(location.page, location.slot), &slot, sizeof(slot))) {
+            return false;
+        }
+        m_index[petId] = location;
+    }
+
+    if (!moved.empty()) {
+        m_file.flush();
+    }
+    return static_cast<bool>(m_file);
+}
+
+bool PetStore::insert(uint64_t petId, std::span<const std::byte> record, uint16_t slotFlags) noexcept {
+    // Find a page with room using the free-space map, newest pages first
+    uint32_t targetPage = 0;
+    for (uint32_t page = m_pageCount; page-- > 1;) {
+        if (m_freeSpace[page] >= record.size()) {
+            targetPage = page;
+            break;
+        }
+    }
+
+    uint16_t reuseSlot = 0;
+    if (targetPage != 0) {
+        if (!readPage(targetPage, m_pageBuffer) || !findSpace(m_pageBuffer, record.size(), reuseSlot)) {
+            // Free-space map was optimistic; refresh it and fall back to a new page
+            if (m_file) {
+                updateFreeSpace(targetPage, m_pageBuffer);
+            }
+            targetPage = 0;
+        }
+    }
+
+    bool appended = targetPage == 0;
+    if (appended) {
+        // Append a fresh page; the header counts it only once it is written
+        targetPage = m_pageCount++;
+        m_freeSpace.push_back(0);
+
+        std::fill(m_pageBuffer.begin(), m_pageBuffer.end(), std::byte{0});
+        PageHeader pageHeader{ 0, sizeof(PageHeader), PAGE_SIZE, 0, 0 };
+        std::memcpy(m_pageBuffer.data(), &pageHeader, sizeof(pageHeader));
+        reuseSlot = 0;
+    }
+
+    auto pageHeader = readPageHeader(m_pageBuffer);
+    Slot slot{};
+    if (reuseSlot < pageHeader.slotCount) {
+        // Reuse a dead slot together with its record space
+        slot = readSlot(m_pageBuffer, reuseSlot);
+    } else {
+        // Carve a new record from the end of the free area
+        reuseSlot = pageHeader.slotCount++;
+        pageHeader.freeStart += sizeof(Slot);
+        pageHeader.freeEnd -= static_cast<uint16_t>(record.size());
+        slot.offset = pageHeader.freeEnd;
+        slot.capacity = static_cast<uint16_t>(record.size());
+        std::memcpy(m_pageBuffer.data(), &pageHeader, sizeof(pageHeader));
+    }
+
+    slot.petId = petId;
+    slot.length = static_cast<uint16_t>(record.size());
+    slot.flags = slotFlags;
+    writeSlot(m_pageBuffer, reuseSlot, slot);
+    std::memcpy(m_pageBuffer.data() + slot.offset, record.data(), record.size());
+
+    // A page past the header's count is ignored on open, so a failure here leaves the store valid
+    if (!writePage(targetPage, m_pageBuffer) || (appended && !writeHeader())) {
+        if (appended) {
+            --m_pageCount;
+            m_freeSpace.pop_back();
+        }
+        return false;
+    }
+
+    m_index[petId] = { targetPage, reuseSlot, slot.offset, slot.length, slot.capacity };
+    updateFreeSpace(targetPage, m_pageBuffer);
+    return true;
+}
+
+bool PetStore::findSpace(std::span<const std::byte> buffer, size_t size, uint16_t& reuseSlot) noexcept {
+    auto pageHeader = readPageHeader(buffer);
+
+    // Prefer the smallest dead slot that fits
+    reuseSlot = pageHeader.slotCount;
+    uint16_t bestCapacity = UINT16_MAX;
+    for (uint16_t i = 0; i < pageHeader.slotCount; ++i) {
+        auto slot = readSlot(buffer, i);
+        if (!(slot.flags & SLOT_LIVE) && slot.capacity >= size && slot.capacity < bestCapacity) {
+            reuseSlot = i;
+            bestCapacity = slot.capacity;
+        }
+    }
+    if (reuseSlot < pageHeader.slotCount) {
+        return true;
+    }
+
+    return static_cast<size_t>(pageHeader.freeEnd - pageHeader.freeStart) >= size + sizeof(Slot);
+}
+
+void PetStore::updateFreeSpace(uint32_t page, std::span<const std::byte> buffer) noexcept {
+    auto pageHeader = readPageHeader(buffer);
+
+    size_t contiguous = pageHeader.freeEnd - pageHeader.freeStart;
+    uint16_t largest = contiguous > sizeof(Slot) ? static_cast<uint16_t>(contiguous - sizeof(Slot)) : 0;
+
+    for (uint16_t i = 0; i < pageHeader.slotCount; ++i) {
+        auto slot = readSlot(buffer, i);
+        if (!(slot.flags & SLOT_LIVE)) {
+            largest = std::max(largest, slot.capacity);
+        }
+    }
+
+    m_freeSpace[page] = largest;
+}
+
+std::vector<uint64_t> PetStore::getPetIds() const {
+    std::vector<uint64_t> ids;
+    ids.reserve(m_index.size());
+    for (const auto& [petId, location] : m_index) {
+        ids.push_back(petId);
+    }
+    return ids;
+}
+
+bool PetStore::flush() noexcept {
+    m_file.flush();
+    if (!m_file) {
+        return false;
+    }
+
+    // The records are on their way to disk; now the leaderboard can match them
+    if (isOpen() && !(m_flags & STORE_LEADERBOARD_CURRENT) && m_leaderboard.save(leaderboardPathFor(m_path))) {
+        m_flags |= STORE_LEADERBOARD_CURRENT;
+        if (!writeHeader()) {
+            return false;
+        }
+        m_file.flush();
+    }
+    return static_cast<bool>(m_file);
+}
+
+void PetStore::close() noexcept {
+    if (isOpen()) {
+        flush();
+        m_file.close();
+    }
+    unlockFile();
+}
+
+bool PetStore::lockFile() noexcept {
+    bool locked = false;
+#ifdef _WIN32
+    HANDLE handle = CreateFileW(m_path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        std::cerr << "Cannot open pet store for locking: " << m_path.string() << std::endl;
+        return false;
+    }
+    m_lockHandle = handle;
+
+    // Windows locks are mandatory, so lock a byte far past any page to keep our own I/O unaffected
+    OVERLAPPED overlapped{};
+    overlapped.Offset = 0xFFFFFFFF;
+    overlapped.OffsetHigh = 0x7FFFFFFF;
+    locked = LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped) != 0;
+#else
+    m_lockFd = ::open(m_path.c_str(), O_RDWR | O_CLOEXEC);
+    if (m_lockFd < 0) {
+        std::cerr << "Cannot open pet store for locking: " << m_path.string() << std::endl;
+        return false;
+    }
+    int result;
+    do {
+        result = ::flock(m_lockFd, LOCK_EX);
+    } while (result != 0 && errno == EINTR);
+    locked = result == 0;
+#endif
+    if (!locked) {
+        std::cerr << "Cannot lock pet store: " << m_path.string() << std::endl;
+        unlockFile();
+    }
+    return locked;
+}
+
+void PetStore::unlockFile() noexcept {
+    // Closing the handle releases the lock
+#ifdef _WIN32
+    if (m_lockHandle) {
+        CloseHandle(static_cast<HANDLE>(m_lockHandle));
+        m_lockHandle = nullptr;
+    }
+#else
+    if (m_lockFd >= 0) {
+        ::close(m_lockFd);
+        m_lockFd = -1;
+    }
+#endif
+}
+
+bool PetStore::markLeaderboardStale() noexcept {
+    if (!(m_flags & STORE_LEADERBOARD_CURRENT)) {
+        return true;
+    }
+
+    // Reach the file before any record changes, so a crash leaves the flag clear
+    m_flags &= ~STORE_LEADERBOARD_CURRENT;
+    if (!writeHeader()) {
+        return false;
+    }
+    m_file.flush();
+    return static_cast<bool>(m_file);
+}
+
+void PetStore::openLeaderboard() noexcept {
+    try {
+        if ((m_flags & STORE_LEADERBOARD_CURRENT) && m_leaderboard.load(leaderboardPathFor(m_path)) &&
+            m_leaderboard.size() == m_index.size() &&
+            std::all_of(m_index.begin(), m_index.end(), [this](const auto& item) {
+                return m_leaderboard.contains(item.first);
+            })) {
+            return;
+        }
+
+        // Stale or missing: rank every stored pet again, and save the result on the next flush
+        m_leaderboard.clear();
+        PetState petState;
+        for (const auto& [petId, location] : m_index) {
+            if (petState.loadFromStore(*this, petId)) {
+                auto birthSeconds = std::chrono::duration_cast<std::chrono::seconds>(
+                    petState.getBirthDate().time_since_epoch()).count();
+                m_leaderboard.update({ petId, petState.getXP(), birthSeconds });
+            }
+        }
+        markLeaderboardStale();
+    } catch (const std::exception& e) {
+        std::cerr << "Exception while rebuilding leaderboard: " << e.what() << std::endl;
+    }
+}
+
+bool PetStore::readPage(uint32_t page, std::vector<std::byte>& buffer) noexcept {
+    buffer.resize(PAGE_SIZE);
+    m_file.seekg(static_cast<std::streamoff>(static_cast<uint64_t>(page) * PAGE_SIZE));
+    m_file.read(reinterpret_cast<char*>(buffer.data()), PAGE_SIZE);
+
+    if (!m_file) {
+        std::cerr << "Error reading pet store page " << page << ": " << m_path.string() << std::endl;
+        m_file.clear();
+        return false;
+    }
+    return true;
+}
+
+bool PetStore::writePage(uint32_t page, std::span<const std::byte> buffer) noexcept {
+    return writeAt(static_cast<uint64_t>(page) * PAGE_SIZE, buffer.data(), buffer.size());
+}
+
+bool PetStore::writeAt(uint64_t offset, const void* data, size_t size) noexcept {
+    m_file.seekp(static_cast<std::streamoff>(offset));
+    m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+
+    if (!m_file) {
+        std::cerr << "Error writing pet store: " << m_path.string() << std::endl;
+        m_file.clear();
+        return false;
+    }
+    return true;
+}
+
+bool PetStore::writeHeader() noexcept {
+    StoreHeader header{};
+    std::memcpy(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    header.formatVersion = STORE_FORMAT_VERSION;
+    header.pageSize = PAGE_SIZE;
+    header.pageCount = m_pageCount;
+    header.flags = m_flags;
+    return writeAt(0, &header, sizeof(header));
+}
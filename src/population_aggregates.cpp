@@ -0,0 +1,53 @@
+#include "../include/population_aggregates.h"
+
+PopulationAggregates::LevelStats& PopulationAggregates::LevelStats::operator+=(const LevelStats& other) noexcept {
+    count += other.count;
+    xpSum += other.xpSum;
+    hungerSum += other.hungerSum;
+    happinessSum += other.happinessSum;
+    energySum += other.energySum;
+    hungerWarnings += other.hungerWarnings;
+    happinessWarnings += other.happinessWarnings;
+    for (size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket) {
+        hungerHistogram[bucket] += other.hungerHistogram[bucket];
+        happinessHistogram[bucket] += other.happinessHistogram[bucket];
+        energyHistogram[bucket] += other.energyHistogram[bucket];
+    }
+    return *this;
+}
+
+double PopulationAggregates::LevelStats::fromFixedSum(int64_t sum) noexcept {
+    return static_cast<double>(sum) / static_cast<double>(PetRecord::STAT_ONE);
+}
+
+void PopulationAggregates::merge(const PopulationAggregates& delta) noexcept {
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        m_levels[level] += delta.m_levels[level];
+    }
+}
+
+PopulationAggregates::LevelStats PopulationAggregates::getTotalStats() const noexcept {
+    LevelStats total;
+    for (const auto& level : m_levels) {
+        total += level;
+    }
+    return total;
+}
+
+void PopulationAggregates::apply(const PetSample& pet, int64_t sign) noexcept {
+    size_t level = levelIndex(pet.evolutionLevel);
+    auto& stats = m_levels[level];
+    float scale = HISTOGRAM_SCALES[level];
+
+    stats.count += sign;
+    stats.xpSum += sign * static_cast<int64_t>(pet.xp);
+    stats.hungerSum += sign * PetRecord::toFixed(pet.hunger);
+    stats.happinessSum += sign * PetRecord::toFixed(pet.happiness);
+    stats.energySum += sign * PetRecord::toFixed(pet.energy);
+    stats.hungerWarnings += sign * isHungerWarning(pet.hunger);
+    stats.happinessWarnings += sign * isHappinessWarning(pet.happiness);
+
+    stats.hungerHistogram[histogramBucket(pet.hunger, scale)] += sign;
+    stats.happinessHistogram[histogramBucket(pet.happiness, scale)] += sign;
+    stats.energyHistogram[histogramBucket(pet.energy, scale)] += sign;
+}
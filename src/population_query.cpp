@@ -0,0 +1,733 @@
+#include "../include/population_query.h"
+#include "../include/time_decay.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PET_QUERY_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    using Comparison = PopulationQuery::Comparison;
+
+    constexpr std::array<std::string_view, 7> LEVEL_NAMES = {
+        "Egg", "Baby", "Child", "Teen", "Adult", "Master", "Ancient"
+    };
+
+    // Longest idle time a predicate may use, about 30000 years
+    constexpr double MAX_IDLE_SECONDS = 1e12;
+
+    /**
+     * @brief Compare names ignoring case and spaces
+     */
+    bool namesMatch(std::string_view a, std::string_view b) noexcept {
+        auto skipSpaces = [](std::string_view text, size_t i) {
+            while (i < text.size() && text[i] == ' ') {
+                ++i;
+            }
+            return i;
+        };
+        size_t i = skipSpaces(a, 0);
+        size_t j = skipSpaces(b, 0);
+        while (i < a.size() && j < b.size()) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[j]))) {
+                return false;
+            }
+            i = skipSpaces(a, i + 1);
+            j = skipSpaces(b, j + 1);
+        }
+        return i == a.size() && j == b.size();
+    }
+
+    bool parseNumber(std::string_view text, double& value) noexcept {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size() && std::isfinite(value);
+    }
+
+    /**
+     * @brief Splits a predicate into words, operators and parentheses
+     */
+    class Tokenizer {
+    public:
+        explicit Tokenizer(std::string_view text) noexcept : m_text(text) { advance(); }
+
+        std::string_view peek() const noexcept { return m_token; }
+        bool atEnd() const noexcept { return m_token.empty(); }
+
+        std::string_view next() noexcept {
+            auto token = m_token;
+            advance();
+            return token;
+        }
+
+    private:
+        static bool isWordChar(char c) noexcept {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '-' || c == '+';
+        }
+
+        void advance() noexcept {
+            while (m_position < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_position]))) {
+                ++m_position;
+            }
+            size_t start = m_position;
+            if (m_position == m_text.size()) {
+                m_token = {};
+                return;
+            }
+
+            char c = m_text[m_position];
+            if (isWordChar(c)) {
+                while (m_position < m_text.size() && isWordChar(m_text[m_position])) {
+                    ++m_position;
+                }
+            } else if (m_position + 1 < m_text.size() &&
+                       ((c == '&' && m_text[m_position + 1] == '&') || (c == '|' && m_text[m_position + 1] == '|') ||
+                        ((c == '<' || c == '>' || c == '=' || c == '!') && m_text[m_position + 1] == '='))) {
+                m_position += 2;
+            } else {
+                ++m_position;
+            }
+            m_token = m_text.substr(start, m_position - start);
+        }
+
+        std::string_view m_text;
+        size_t m_position = 0;
+        std::string_view m_token;
+    };
+
+    /**
+     * @brief Recursive descent parser emitting postfix instructions
+     */
+    class Parser {
+    public:
+        using Instruction = PopulationQuery::Instruction;
+
+        Parser(std::string_view text, std::vector<Instruction>& output, std::string& error) noexcept
+            : m_tokens(text), m_output(output), m_error(error) {}
+
+        bool parse() {
+            if (m_tokens.atEnd()) {
+                return true;
+            }
+            if (!parseOr()) {
+                return false;
+            }
+            if (!m_tokens.atEnd()) {
+                return fail("Unexpected '" + std::string(m_tokens.peek()) + "'");
+            }
+            return true;
+        }
+
+    private:
+        bool parseOr() {
+            if (!parseAnd()) {
+                return false;
+            }
+            while (m_tokens.peek() == "or" || m_tokens.peek() == "||") {
+                m_tokens.next();
+                if (!parseAnd()) {
+                    return false;
+                }
+                m_output.push_back({Instruction::Kind::Or});
+            }
+            return true;
+        }
+
+        bool parseAnd() {
+            if (!parseUnary()) {
+                return false;
+            }
+            while (m_tokens.peek() == "and" || m_tokens.peek() == "&&") {
+                m_tokens.next();
+                if (!parseUnary()) {
+                    return false;
+                }
+                m_output.push_back({Instruction::Kind::And});
+            }
+            return true;
+        }
+
+        bool parseUnary() {
+            auto token = m_tokens.next();
+            if (token == "not" || token == "!") {
+                if (!parseUnary()) {
+                    return false;
+                }
+                m_output.push_back({Instruction::Kind::Not});
+                return true;
+            }
+            if (token == "(") {
+                if (!parseOr()) {
+                    return false;
+                }
+                if (m_tokens.next() != ")") {
+                    return fail("Missing ')'");
+                }
+                return true;
+            }
+            if (token == "has") {
+                return parseAchievement();
+            }
+            if (token.empty()) {
+                return fail("Unexpected end of predicate");
+            }
+            return parseComparison(token);
+        }
+
+        bool parseAchievement() {
+            auto name = m_tokens.next();
+            for (size_t i = 0; i < static_cast<size_t>(AchievementType::Count); ++i) {
+                auto type = static_cast<AchievementType>(i);
+                if (namesMatch(name, AchievementSystem::getName(type))) {
+                    Instruction instruction{Instruction::Kind::HasAchievement};
+                    instruction.achievement = type;
+                    m_output.push_back(instruction);
+                    return true;
+                }
+            }
+            return fail("Unknown achievement '" + std::string(name) + "'");
+        }
+
+        bool parseComparison(std::string_view fieldName) {
+            auto field = PopulationQuery::findField(fieldName);
+            if (!field) {
+                return fail("Unknown field '" + std::string(fieldName) + "'");
+            }
+
+            Instruction instruction{Instruction::Kind::Compare};
+            instruction.field = *field;
+            auto op = m_tokens.next();
+            if (op == "<") {
+                instruction.comparison = Comparison::Less;
+            } else if (op == ">") {
+                instruction.comparison = Comparison::Greater;
+            } else if (op == "==" || op == "=") {
+                instruction.comparison = Comparison::Equal;
+            } else if (op == ">=") {
+                instruction.comparison = Comparison::Less;
+                instruction.negate = true;
+            } else if (op == "<=") {
+                instruction.comparison = Comparison::Greater;
+                instruction.negate = true;
+            } else if (op == "!=") {
+                instruction.comparison = Comparison::Equal;
+                instruction.negate = true;
+            } else {
+                return fail("Expected a comparison after '" + std::string(fieldName) + "'");
+            }
+
+            auto value = m_tokens.next();
+            if (value.empty()) {
+                return fail("Missing value after '" + std::string(fieldName) + " " + std::string(op) + "'");
+            }
+            if (!parseValue(*field, value, instruction.value)) {
+                return fail("Invalid value '" + std::string(value) + "' for " + std::string(fieldName));
+            }
+            m_output.push_back(instruction);
+            return true;
+        }
+
+        static bool parseValue(PopulationQuery::Field field, std::string_view text, double& value) noexcept {
+            using Field = PopulationQuery::Field;
+            switch (field) {
+                case Field::Level:
+                    for (size_t level = 0; level < LEVEL_NAMES.size(); ++level) {
+                        if (namesMatch(text, LEVEL_NAMES[level])) {
+                            value = static_cast<double>(level);
+                            return true;
+                        }
+                    }
+                    return parseNumber(text, value) && value >= 0.0 && value < LEVEL_NAMES.size() &&
+                           value == std::floor(value);
+                case Field::XP:
+                    return parseNumber(text, value) && value >= 0.0 &&
+                           value <= std::numeric_limits<uint32_t>::max() && value == std::floor(value);
+                case Field::Hunger:
+                case Field::Happiness:
+                case Field::Energy:
+                    return parseNumber(text, value);
+                case Field::Idle: {
+                    // Hours unless a unit is given
+                    double scale = 3600.0;
+                    if (!text.empty() && std::isalpha(static_cast<unsigned char>(text.back()))) {
+                        switch (text.back()) {
+                            case 's': scale = 1.0; break;
+                            case 'm': scale = 60.0; break;
+                            case 'h': scale = 3600.0; break;
+                            case 'd': scale = 86400.0; break;
+                            default: return false;
+                        }
+                        text.remove_suffix(1);
+                    }
+                    if (!parseNumber(text, value)) {
+                        return false;
+                    }
+                    value = std::round(value * scale);
+                    return std::fabs(value) <= MAX_IDLE_SECONDS;
+                }
+            }
+            return false;
+        }
+
+        bool fail(std::string message) {
+            if (m_error.empty()) {
+                m_error = std::move(message);
+            }
+            return false;
+        }
+
+        Tokenizer m_tokens;
+        std::vector<Instruction>& m_output;
+        std::string& m_error;
+    };
+
+    /**
+     * @brief Set one bit per pet in 64-pet mask words
+     */
+    template <typename T, typename Predicate>
+    void buildMasks(const T* values, size_t count, uint64_t* masks, Predicate predicate) noexcept {
+        for (size_t begin = 0; begin < count; begin += 64) {
+            size_t length = std::min<size_t>(64, count - begin);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < length; ++j) {
+                bits |= static_cast<uint64_t>(predicate(values[begin + j])) << j;
+            }
+            masks[begin / 64] = bits;
+        }
+    }
+
+    template <typename T>
+    void comparePortable(const T* values, size_t count, T constant, Comparison comparison, uint64_t* masks) noexcept {
+        switch (comparison) {
+            case Comparison::Less:
+                buildMasks(values, count, masks, [constant](T value) { return value < constant; });
+                break;
+            case Comparison::Greater:
+                buildMasks(values, count, masks, [constant](T value) { return value > constant; });
+                break;
+            case Comparison::Equal:
+                buildMasks(values, count, masks, [constant](T value) { return value == constant; });
+                break;
+        }
+    }
+
+    void testBitsPortable(const uint64_t* values, size_t count, uint64_t bits, uint64_t* masks) noexcept {
+        buildMasks(values, count, masks, [bits](uint64_t value) { return (value & bits) != 0; });
+    }
+
+    /**
+     * @brief Comparison kernels; each writes ceil(count / 64) mask words
+     */
+    struct Kernels {
+        void (*compareFloat)(const float*, size_t, float, Comparison, uint64_t*) noexcept;
+        void (*compareUInt32)(const uint32_t*, size_t, uint32_t, Comparison, uint64_t*) noexcept;
+        void (*compareUInt8)(const uint8_t*, size_t, uint8_t, Comparison, uint64_t*) noexcept;
+        void (*compareInt64)(const int64_t*, size_t, int64_t, Comparison, uint64_t*) noexcept;
+        void (*testBits)(const uint64_t*, size_t, uint64_t, uint64_t*) noexcept;
+        const char* name;
+    };
+
+    constexpr Kernels PORTABLE_KERNELS = {
+        comparePortable<float>, comparePortable<uint32_t>, comparePortable<uint8_t>, comparePortable<int64_t>,
+        testBitsPortable, "portable"
+    };
+
+#ifdef PET_QUERY_X86
+    // Whole mask words use AVX2; the partial last word of a chunk uses the portable loop
+
+    template <Comparison C>
+    __attribute__((target("avx2")))
+    void compareFloatWordsAvx2(const float* values, size_t words, float constant, uint64_t* masks) noexcept {
+        const __m256 constants = _mm256_set1_ps(constant);
+        for (size_t word = 0; word < words; ++word) {
+            const float* block = values + word * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 8; ++k) {
+                __m256 lanes = _mm256_loadu_ps(block + k * 8);
+                __m256 result;
+                if constexpr (C == Comparison::Less) {
+                    result = _mm256_cmp_ps(lanes, constants, _CMP_LT_OQ);
+                } else if constexpr (C == Comparison::Greater) {
+                    result = _mm256_cmp_ps(lanes, constants, _CMP_GT_OQ);
+                } else {
+                    result = _mm256_cmp_ps(lanes, constants, _CMP_EQ_OQ);
+                }
+                bits |= static_cast<uint64_t>(static_cast<unsigned>(_mm256_movemask_ps(result))) << (k * 8);
+            }
+            masks[word] = bits;
+        }
+    }
+
+    // Signed 32-bit lanes; unsigned values have their sign bit flipped before comparing
+    template <Comparison C>
+    __attribute__((target("avx2")))
+    int compareInt32Avx2(__m256i lanes, __m256i constants) noexcept {
+        __m256i result;
+        if constexpr (C == Comparison::Less) {
+            result = _mm256_cmpgt_epi32(constants, lanes);
+        } else if constexpr (C == Comparison::Greater) {
+            result = _mm256_cmpgt_epi32(lanes, constants);
+        } else {
+            result = _mm256_cmpeq_epi32(lanes, constants);
+        }
+        return _mm256_movemask_ps(_mm256_castsi256_ps(result));
+    }
+
+    template <Comparison C>
+    __attribute__((target("avx2")))
+    void compareUInt32WordsAvx2(const uint32_t* values, size_t words, uint32_t constant, uint64_t* masks) noexcept {
+        const __m256i signBit = _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+        const __m256i constants = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(constant)), signBit);
+        for (size_t word = 0; word < words; ++word) {
+            const uint32_t* block = values + word * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 8; ++k) {
+                __m256i lanes = _mm256_xor_si256(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + k * 8)), signBit);
+                bits |= static_cast<uint64_t>(static_cast<unsigned>(compareInt32Avx2<C>(lanes, constants))) << (k * 8);
+            }
+            masks[word] = bits;
+        }
+    }
+
+    template <Comparison C>
+    __attribute__((target("avx2")))
+    void compareUInt8WordsAvx2(const uint8_t* values, size_t words, uint8_t constant, uint64_t* masks) noexcept {
+        const __m256i constants = _mm256_set1_epi32(constant);
+        for (size_t word = 0; word < words; ++word) {
+            const uint8_t* block = values + word * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 8; ++k) {
+                __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(block + k * 8)));
+                bits |= static_cast<uint64_t>(static_cast<unsigned>(compareInt32Avx2<C>(lanes, constants))) << (k * 8);
+            }
+            masks[word] = bits;
+        }
+    }
+
+    template <Comparison C>
+    __attribute__((target("avx2")))
+    void compareInt64WordsAvx2(const int64_t* values, size_t words, int64_t constant, uint64_t* masks) noexcept {
+        const __m256i constants = _mm256_set1_epi64x(constant);
+        for (size_t word = 0; word < words; ++word) {
+            const int64_t* block = values + word * 64;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 16; ++k) {
+                __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + k * 4));
+                __m256i result;
+                if constexpr (C == Comparison::Less) {
+                    result = _mm256_cmpgt_epi64(constants, lanes);
+                } else if constexpr (C == Comparison::Greater) {
+                    result = _mm256_cmpgt_epi64(lanes, constants);
+                } else {
+                    result = _mm256_cmpeq_epi64(lanes, constants);
+                }
+                bits |= static_cast<uint64_t>(static_cast<unsigned>(
+                    _mm256_movemask_pd(_mm256_castsi256_pd(result)))) << (k * 4);
+            }
+            masks[word] = bits;
+        }
+    }
+
+    /**
+     * @brief Run a word kernel over whole words and the portable loop over the rest
+     */
+    template <typename T, void (*Less)(const T*, size_t, T, uint64_t*) noexcept,
+              void (*Greater)(const T*, size_t, T, uint64_t*) noexcept,
+              void (*Equal)(const T*, size_t, T, uint64_t*) noexcept>
+    void compareAvx2(const T* values, size_t count, T constant, Comparison comparison, uint64_t* masks) noexcept {
+        size_t words = count / 64;
+        switch (comparison) {
+            case Comparison::Less: Less(values, words, constant, masks); break;
+            case Comparison::Greater: Greater(values, words, constant, masks); break;
+            case Comparison::Equal: Equal(values, words, constant, masks); break;
+        }
+        comparePortable(values + words * 64, count - words * 64, constant, comparison, masks + words);
+    }
+
+    __attribute__((target("avx2")))
+    void testBitsAvx2(const uint64_t* values, size_t count, uint64_t bits, uint64_t* masks) noexcept {
+        const __m256i tested = _mm256_set1_epi64x(static_cast<int64_t>(bits));
+        const __m256i zero = _mm256_setzero_si256();
+        size_t words = count / 64;
+        for (size_t word = 0; word < words; ++word) {
+            const uint64_t* block = values + word * 64;
+            uint64_t result = 0;
+            for (size_t k = 0; k < 16; ++k) {
+                __m256i lanes = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + k * 4)), tested);
+                unsigned clear = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lanes, zero))));
+                result |= static_cast<uint64_t>(~clear & 0xFu) << (k * 4);
+            }
+            masks[word] = result;
+        }
+        testBitsPortable(values + words * 64, count - words * 64, bits, masks + words);
+    }
+
+    constexpr Kernels AVX2_KERNELS = {
+        compareAvx2<float, compareFloatWordsAvx2<Comparison::Less>, compareFloatWordsAvx2<Comparison::Greater>,
+                    compareFloatWordsAvx2<Comparison::Equal>>,
+        compareAvx2<uint32_t, compareUInt32WordsAvx2<Comparison::Less>, compareUInt32WordsAvx2<Comparison::Greater>,
+                    compareUInt32WordsAvx2<Comparison::Equal>>,
+        compareAvx2<uint8_t, compareUInt8WordsAvx2<Comparison::Less>, compareUInt8WordsAvx2<Comparison::Greater>,
+                    compareUInt8WordsAvx2<Comparison::Equal>>,
+        compareAvx2<int64_t, compareInt64WordsAvx2<Comparison::Less>, compareInt64WordsAvx2<Comparison::Greater>,
+                    compareInt64WordsAvx2<Comparison::Equal>>,
+        testBitsAvx2, "avx2"
+    };
+#endif
+
+    const Kernels& selectKernels() noexcept {
+#ifdef PET_QUERY_X86
+        if (__builtin_cpu_supports("avx2")) {
+            return AVX2_KERNELS;
+        }
+#endif
+        return PORTABLE_KERNELS;
+    }
+
+    // Chosen once at startup from the CPU features
+    const Kernels& KERNELS = selectKernels();
+
+    void invert(uint64_t* masks, size_t words) noexcept {
+        for (size_t word = 0; word < words; ++word) {
+            masks[word] = ~masks[word];
+        }
+    }
+}
+
+std::optional<PopulationQuery> PopulationQuery::compile(std::string_view predicate, std::string& error) {
+    PopulationQuery query;
+    error.clear();
+    Parser parser(predicate, query.m_instructions, error);
+    if (!parser.parse()) {
+        return std::nullopt;
+    }
+
+    size_t depth = 0;
+    for (const auto& instruction : query.m_instructions) {
+        switch (instruction.kind) {
+            case Instruction::Kind::Compare:
+            case Instruction::Kind::HasAchievement:
+                ++depth;
+                break;
+            case Instruction::Kind::And:
+            case Instruction::Kind::Or:
+                --depth;
+                break;
+            case Instruction::Kind::Not:
+                break;
+        }
+        query.m_stackDepth = std::max(query.m_stackDepth, depth);
+
+        if (instruction.kind == Instruction::Kind::Compare &&
+            (instruction.field == Field::Hunger || instruction.field == Field::Happiness ||
+             instruction.field == Field::Energy)) {
+            query.m_usesStats = true;
+        }
+    }
+    return query;
+}
+
+std::optional<PopulationQuery::Field> PopulationQuery::findField(std::string_view name) noexcept {
+    static constexpr std::array<std::pair<std::string_view, Field>, 6> FIELDS = {{
+        {"level", Field::Level},
+        {"xp", Field::XP},
+        {"hunger", Field::Hunger},
+        {"happiness", Field::Happiness},
+        {"energy", Field::Energy},
+        {"idle", Field::Idle}
+    }};
+    for (const auto& [fieldName, field] : FIELDS) {
+        if (namesMatch(name, fieldName)) {
+            return field;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view PopulationQuery::getLevelName(uint8_t level) noexcept {
+    return level < LEVEL_NAMES.size() ? LEVEL_NAMES[level] : std::string_view("Unknown");
+}
+
+QueryEngine::QueryEngine(size_t threadCount)
+    : m_pool(threadCount)
+    , m_states(m_pool.getThreadCount())
+{
+}
+
+QueryResult QueryEngine::run(const PopulationQuery& query, const PetPopulation& population,
+                             std::chrono::system_clock::time_point now, bool collectIndices) {
+    auto start = std::chrono::steady_clock::now();
+    int64_t nowSeconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+
+    for (auto& state : m_states) {
+        state.matched = 0;
+        state.indices.clear();
+        state.masks.resize(std::max<size_t>(1, query.getStackDepth()) * CHUNK_WORDS);
+        if (query.usesStats()) {
+            state.hunger.resize(CHUNK_SIZE);
+            state.happiness.resize(CHUNK_SIZE);
+            state.energy.resize(CHUNK_SIZE);
+            state.lastInteraction.resize(CHUNK_SIZE);
+        }
+    }
+
+    size_t petCount = population.size();
+    size_t chunkCount = (petCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_pool.parallelFor(chunkCount, [&](size_t chunk, size_t worker) {
+        size_t begin = chunk * CHUNK_SIZE;
+        runChunk(query, population, begin, std::min(begin + CHUNK_SIZE, petCount), nowSeconds, collectIndices,
+                 m_states[worker]);
+    });
+
+    QueryResult result;
+    result.scanned = petCount;
+    for (const auto& state : m_states) {
+        result.matched += state.matched;
+    }
+    if (collectIndices) {
+        result.indices.reserve(result.matched);
+        for (const auto& state : m_states) {
+            result.indices.insert(result.indices.end(), state.indices.begin(), state.indices.end());
+        }
+        // Each chunk's indices are ascending, but stolen chunks leave the buffers out of order
+        std::sort(result.indices.begin(), result.indices.end());
+    }
+
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+const char* QueryEngine::getImplementationName() noexcept {
+    return KERNELS.name;
+}
+
+void QueryEngine::runChunk(const PopulationQuery& query, const PetPopulation& population, size_t begin, size_t end,
+                           int64_t nowSeconds, bool collectIndices, WorkerState& state) {
+    using Instruction = PopulationQuery::Instruction;
+    using Field = PopulationQuery::Field;
+
+    size_t count = end - begin;
+    size_t words = (count + 63) / 64;
+    auto levels = population.getEvolutionLevelColumn().subspan(begin, count);
+    auto lastInteraction = population.getLastInteractionColumn().subspan(begin, count);
+
+    // Decay a copy of the chunk's stats to the query time, as reading them from a PetState would
+    if (query.usesStats()) {
+        auto hunger = population.getHungerColumn().subspan(begin, count);
+        auto happiness = population.getHappinessColumn().subspan(begin, count);
+        auto energy = population.getEnergyColumn().subspan(begin, count);
+        std::copy(hunger.begin(), hunger.end(), state.hunger.begin());
+        std::copy(happiness.begin(), happiness.end(), state.happiness.begin());
+        std::copy(energy.begin(), energy.end(), state.energy.begin());
+        std::copy(lastInteraction.begin(), lastInteraction.end(), state.lastInteraction.begin());
+
+        TimeDecay::Columns columns{
+            std::span<float>(state.hunger.data(), count),
+            std::span<float>(state.happiness.data(), count),
+            std::span<float>(state.energy.data(), count),
+            levels,
+            std::span<int64_t>(state.lastInteraction.data(), count)
+        };
+        TimeDecay::applyTimeEffectsBatch(columns, nowSeconds);
+    }
+
+    uint64_t* stack = state.masks.data();
+    size_t depth = 0;
+    for (const auto& instruction : query.getInstructions()) {
+        uint64_t* top = stack + depth * CHUNK_WORDS;
+        switch (instruction.kind) {
+            case Instruction::Kind::Compare: {
+                switch (instruction.field) {
+                    case Field::Level:
+                        KERNELS.compareUInt8(levels.data(), count, static_cast<uint8_t>(instruction.value),
+                                             instruction.comparison, top);
+                        break;
+                    case Field::XP:
+                        KERNELS.compareUInt32(population.getXPColumn().data() + begin, count,
+                                              static_cast<uint32_t>(instruction.value), instruction.comparison, top);
+                        break;
+                    case Field::Hunger:
+                        KERNELS.compareFloat(state.hunger.data(), count, static_cast<float>(instruction.value),
+                                             instruction.comparison, top);
+                        break;
+                    case Field::Happiness:
+                        KERNELS.compareFloat(state.happiness.data(), count, static_cast<float>(instruction.value),
+                                             instruction.comparison, top);
+                        break;
+                    case Field::Energy:
+                        KERNELS.compareFloat(state.energy.data(), count, static_cast<float>(instruction.value),
+                                             instruction.comparison, top);
+                        break;
+                    case Field::Idle: {
+                        // A longer idle time is an earlier interaction
+                        auto comparison = instruction.comparison;
+                        if (comparison == PopulationQuery::Comparison::Less) {
+                            comparison = PopulationQuery::Comparison::Greater;
+                        } else if (comparison == PopulationQuery::Comparison::Greater) {
+                            comparison = PopulationQuery::Comparison::Less;
+                        }
+                        KERNELS.compareInt64(lastInteraction.data(), count,
+                                             nowSeconds - static_cast<int64_t>(instruction.value), comparison, top);
+                        break;
+                    }
+                }
+                if (instruction.negate) {
+                    invert(top, words);
+                }
+                ++depth;
+                break;
+            }
+            case Instruction::Kind::HasAchievement:
+                KERNELS.testBits(population.getAchievementColumn().data() + begin, count,
+                                 uint64_t{1} << static_cast<size_t>(instruction.achievement), top);
+                ++depth;
+                break;
+            case Instruction::Kind::And:
+            case Instruction::Kind::Or: {
+                --depth;
+                uint64_t* left = stack + (depth - 1) * CHUNK_WORDS;
+                const uint64_t* right = stack + depth * CHUNK_WORDS;
+                if (instruction.kind == Instruction::Kind::And) {
+                    for (size_t word = 0; word < words; ++word) {
+                        left[word] &= right[word];
+                    }
+                } else {
+                    for (size_t word = 0; word < words; ++word) {
+                        left[word] |= right[word];
+                    }
+                }
+                break;
+            }
+            case Instruction::Kind::Not:
+                invert(stack + (depth - 1) * CHUNK_WORDS, words);
+                break;
+        }
+    }
+
+    if (query.getInstructions().empty()) {
+        std::fill(stack, stack + words, ~uint64_t{0});
+    }
+
+    // Negation sets the bits past the last pet as well
+    if (count % 64 != 0) {
+        stack[words - 1] &= (uint64_t{1} << (count % 64)) - 1;
+    }
+
+    for (size_t word = 0; word < words; ++word) {
+        uint64_t bits = stack[word];
+        state.matched += static_cast<size_t>(std::popcount(bits));
+        if (collectIndices) {
+            while (bits != 0) {
+                state.indices.push_back(static_cast<uint32_t>(begin + word * 64 + std::countr_zero(bits)));
+                bits &= bits - 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,123 @@
+#include "../include/shard_runtime.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    // The runtime and shard the calling thread belongs to
+    thread_local const ShardRuntime* t_runtime = nullptr;
+    thread_local size_t t_shard = 0;
+}
+
+ShardRuntime::ShardRuntime(size_t shardCount, bool pinThreads) {
+    if (shardCount == 0) {
+        shardCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Every queue starts with an empty node, so producers never see a null head
+    m_shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->tail = new Node;
+        shard->head.store(shard->tail, std::memory_order_relaxed);
+        m_shards.push_back(std::move(shard));
+    }
+
+    m_threads.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        m_threads.emplace_back([this, i]() { shardLoop(i); });
+#ifdef __linux__
+        if (pinThreads) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+            pthread_setaffinity_np(m_threads.back().native_handle(), sizeof(cpus), &cpus);
+        }
+#else
+        (void)pinThreads;
+#endif
+    }
+}
+
+ShardRuntime::~ShardRuntime() {
+    for (auto& shard : m_shards) {
+        shard->stopping.store(true, std::memory_order_seq_cst);
+        shard->wakeups.fetch_add(1, std::memory_order_release);
+        shard->wakeups.notify_one();
+    }
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+
+    // Only the empty node is left in each queue
+    for (auto& shard : m_shards) {
+        delete shard->tail;
+    }
+}
+
+void ShardRuntime::post(size_t shard, Task task) {
+    Shard& target = *m_shards[shard];
+    auto* node = new Node;
+    node->task = std::move(task);
+
+    // Linking after the exchange leaves a short window in which the shard
+    // sees the queue as empty; the wakeup check below covers it
+    Node* previous = target.head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+
+    // Pairs with the fence in shardLoop(): either we see it sleeping or it sees the node
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (target.sleeping.load(std::memory_order_relaxed)) {
+        target.wakeups.fetch_add(1, std::memory_order_release);
+        target.wakeups.notify_one();
+    }
+}
+
+size_t ShardRuntime::getCurrentShard() const noexcept {
+    return t_runtime == this ? t_shard : m_shards.size();
+}
+
+void ShardRuntime::shardLoop(size_t index) {
+    t_runtime = this;
+    t_shard = index;
+    Shard& shard = *m_shards[index];
+
+    Task task;
+    while (true) {
+        while (pop(shard, task)) {
+            task();
+            task = nullptr;
+        }
+
+        uint32_t seen = shard.wakeups.load(std::memory_order_acquire);
+        shard.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool idle = shard.tail->next.load(std::memory_order_acquire) == nullptr;
+        if (idle && shard.stopping.load(std::memory_order_relaxed)) {
+            shard.sleeping.store(false, std::memory_order_relaxed);
+            return;
+        }
+        if (idle) {
+            shard.wakeups.wait(seen, std::memory_order_acquire);
+        }
+        shard.sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+bool ShardRuntime::pop(Shard& shard, Task& task) {
+    Node* tail = shard.tail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (!next) {
+        return false;
+    }
+
+    // The taken node becomes the new empty node
+    task = std::move(next->task);
+    shard.tail = next;
+    delete tail;
+    return true;
+}
@@ -0,0 +1,379 @@
+#include "../include/shared_ring.h"
+#include "../include/binary_schema.h"
+#include "../include/game_config.h"
+#include <bit>
+#include <climits>
+#include <new>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Ring state shared by both sides, followed by the data
+ *
+ * Each side's position and wakeup words sit in their own cache line, so
+ * the producer and consumer do not invalidate each other's line on every
+ * record. A signal word is bumped before every wake; a sleeper passes the
+ * value it last saw to the futex, so a wake between its check and its
+ * sleep is not lost.
+ */
+struct SharedRing::Control {
+    // Producer side: bytes published, and the consumer's sleep word
+    alignas(64) std::atomic<uint64_t> writePos;
+    std::atomic<uint32_t> dataSignal;
+    std::atomic<uint32_t> readerWaiting;
+
+    // Consumer side: bytes released, and the producer's sleep word
+    alignas(64) std::atomic<uint64_t> readPos;
+    std::atomic<uint32_t> spaceSignal;
+    std::atomic<uint32_t> writerWaiting;
+
+    // Fixed at initialization
+    alignas(64) uint32_t magic;
+    uint32_t capacity;
+    std::atomic<uint32_t> closed;
+};
+
+namespace {
+    // "PRNG" in little-endian order
+    constexpr uint32_t RING_MAGIC = 0x474E5250;
+
+    // Record length of the padding that skips to the start of the ring
+    constexpr uint32_t WRAP_MARKER = UINT32_MAX;
+
+    // Records start on this boundary, so a wrap marker always fits before the end
+    constexpr size_t RECORD_ALIGNMENT = 8;
+
+    // Smallest ring capacity
+    constexpr uint32_t MIN_CAPACITY = 64;
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+                  "Shared ring positions must be lock-free to work across processes");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex words must be plain 32-bit integers");
+
+    constexpr size_t recordSpace(size_t size) noexcept {
+        return (sizeof(uint32_t) + size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+    }
+
+    inline void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    void futexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+#ifdef __linux__
+        timespec relative{ static_cast<time_t>(timeout.count() / 1000000000),
+                           static_cast<long>(timeout.count() % 1000000000) };
+        // Not FUTEX_PRIVATE_FLAG: the other side is another process
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+#else
+        (void)word; (void)expected;
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+#endif
+    }
+
+    void futexWakeAll(std::atomic<uint32_t>& word) noexcept {
+#ifdef __linux__
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+        (void)word;
+#endif
+    }
+
+    /**
+     * @brief Wake the other side if it announced that it sleeps
+     */
+    void notify(std::atomic<uint32_t>& signal, std::atomic<uint32_t>& waiting) noexcept {
+        // Orders the position just published before reading the flag; pairs with the fence in waitFor()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed)) {
+            signal.fetch_add(1, std::memory_order_release);
+            futexWakeAll(signal);
+        }
+    }
+}
+
+size_t SharedRing::getRegionSize(uint32_t capacity) noexcept {
+    return sizeof(Control) + capacity;
+}
+
+void SharedRing::initialize(std::span<std::byte> region, uint32_t capacity) noexcept {
+    auto* control = new (region.data()) Control{};
+    control->capacity = capacity;
+    control->magic = RING_MAGIC;
+}
+
+bool SharedRing::attach(std::span<std::byte> region) noexcept {
+    if (region.size() < sizeof(Control) || reinterpret_cast<uintptr_t>(region.data()) % alignof(Control) != 0) {
+        return false;
+    }
+
+    // The capacity is read once: the other side cannot move our bounds later
+    auto* control = reinterpret_cast<Control*>(region.data());
+    uint32_t capacity = control->capacity;
+    if (control->magic != RING_MAGIC || capacity < MIN_CAPACITY || !std::has_single_bit(capacity) ||
+        getRegionSize(capacity) > region.size()) {
+        return false;
+    }
+
+    m_control = control;
+    m_data = region.data() + sizeof(Control);
+    m_capacity = capacity;
+    return true;
+}
+
+size_t SharedRing::getMaxRecordSize() const noexcept {
+    // A record of half the ring always fits after padding to the end
+    return m_capacity / 2 - RECORD_ALIGNMENT;
+}
+
+template <typename Condition>
+bool SharedRing::waitFor(Condition condition, std::atomic<uint32_t>& signal, std::atomic<uint32_t>& waiting,
+                         std::chrono::milliseconds timeout) noexcept {
+    if (condition()) {
+        return true;
+    }
+    if (timeout.count() <= 0) {
+        return false;
+    }
+
+    // The other side is usually about to act; a short spin saves two system calls.
+    // With one CPU the other side cannot act while we spin, so go straight to sleep
+    static const uint32_t spinCount = std::thread::hardware_concurrency() > 1 ? GameConfig::Daemon::SHARED_RING_SPIN_COUNT : 0;
+    for (uint32_t spin = 0; spin < spinCount; ++spin) {
+        cpuRelax();
+        if (condition()) {
+            return true;
+        }
+        if (isClosed()) {
+            return false;
+        }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        uint32_t seen = signal.load(std::memory_order_acquire);
+        waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool ready = condition();
+        auto now = std::chrono::steady_clock::now();
+        if (ready || isClosed() || now >= deadline) {
+            waiting.store(0, std::memory_order_relaxed);
+            return ready;
+        }
+
+        futexWait(signal, seen, deadline - now);
+        waiting.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::span<std::byte> SharedRing::beginWrite(size_t maxSize, std::chrono::milliseconds timeout) noexcept {
+    if (!m_control || maxSize > getMaxRecordSize()) {
+        return {};
+    }
+
+    uint64_t writePos = m_control->writePos.load(std::memory_order_relaxed);
+    size_t offset = writePos & (m_capacity - 1);
+    size_t untilEnd = m_capacity - offset;
+    size_t space = recordSpace(maxSize);
+    size_t required = space <= untilEnd ? space : untilEnd + space;
+
+    auto hasSpace = [&]() {
+        return m_capacity - (writePos - m_control->readPos.load(std::memory_order_acquire)) >= required;
+    };
+    if (isClosed() || !waitFor(hasSpace, m_control->spaceSignal, m_control->writerWaiting, timeout)) {
+        return {};
+    }
+
+    // Records never wrap: pad to the end and start over
+    if (space > untilEnd) {
+        BinarySchema::storeLE(m_data + offset, WRAP_MARKER);
+        writePos += untilEnd;
+        offset = 0;
+    }
+    m_writeStart = writePos;
+    return { m_data + offset + sizeof(uint32_t), maxSize };
+}
+
+void SharedRing::endWrite(size_t size) noexcept {
+    BinarySchema::storeLE(m_data + (m_writeStart & (m_capacity - 1)), static_cast<uint32_t>(size));
+    m_control->writePos.store(m_writeStart + recordSpace(size), std::memory_order_release);
+    notify(m_control->dataSignal, m_control->readerWaiting);
+}
+
+std::span<const std::byte> SharedRing::beginRead(std::chrono::milliseconds timeout) noexcept {
+    if (!m_control) {
+        return {};
+    }
+
+    uint64_t readPos = m_control->readPos.load(std::memory_order_relaxed);
+    auto hasData = [&]() {
+        return m_control->writePos.load(std::memory_order_acquire) != readPos;
+    };
+    if (!waitFor(hasData, m_control->dataSignal, m_control->readerWaiting, timeout)) {
+        return {};
+    }
+
+    uint64_t writePos = m_control->writePos.load(std::memory_order_acquire);
+    size_t offset = readPos & (m_capacity - 1);
+    uint32_t size = BinarySchema::loadLE<uint32_t>(m_data + offset);
+    if (size == WRAP_MARKER) {
+        readPos += m_capacity - offset;
+        offset = 0;
+        size = readPos == writePos ? WRAP_MARKER : BinarySchema::loadLE<uint32_t>(m_data);
+    }
+
+    // Positions come from the other process; never trust them past our own bounds
+    if (size > getMaxRecordSize() || offset + recordSpace(size) > m_capacity ||
+        writePos - readPos > m_capacity || writePos - readPos < recordSpace(size)) {
+        close();
+        return {};
+    }
+
+    m_readEnd = readPos + recordSpace(size);
+    return { m_data + offset + sizeof(uint32_t), size };
+}
+
+void SharedRing::endRead() noexcept {
+    m_control->readPos.store(m_readEnd, std::memory_order_release);
+    notify(m_control->spaceSignal, m_control->writerWaiting);
+}
+
+void SharedRing::close() noexcept {
+    if (!m_control) {
+        return;
+    }
+    m_control->closed.store(1, std::memory_order_release);
+    m_control->dataSignal.fetch_add(1, std::memory_order_release);
+    m_control->spaceSignal.fetch_add(1, std::memory_order_release);
+    futexWakeAll(m_control->dataSignal);
+    futexWakeAll(m_control->spaceSignal);
+}
+
+bool SharedRing::isClosed() const noexcept {
+    return m_control && m_control->closed.load(std::memory_order_acquire) != 0;
+}
+
+std::unique_ptr<SharedChannel> SharedChannel::create(uint32_t ringCapacity) noexcept {
+#ifdef __linux__
+    if (ringCapacity < MIN_CAPACITY || !std::has_single_bit(ringCapacity)) {
+        return nullptr;
+    }
+
+    int fd = ::memfd_create("pet-daemon-channel", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    // Sealed at its final size: the daemon refuses memory that could shrink under its mapping
+    size_t regionSize = SharedRing::getRegionSize(ringCapacity);
+    if (::ftruncate(fd, static_cast<off_t>(2 * regionSize)) != 0 ||
+        ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // New memory is zeroed, which is most of an empty ring
+    void* memory = ::mmap(nullptr, 2 * regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<SharedChannel> channel(new (std::nothrow) SharedChannel);
+    if (!channel) {
+        ::munmap(memory, 2 * regionSize);
+        ::close(fd);
+        return nullptr;
+    }
+    channel->m_fd = fd;
+    channel->m_memory = static_cast<std::byte*>(memory);
+    channel->m_size = 2 * regionSize;
+
+    std::span<std::byte> requests(channel->m_memory, regionSize);
+    std::span<std::byte> responses(channel->m_memory + regionSize, regionSize);
+    SharedRing::initialize(requests, ringCapacity);
+    SharedRing::initialize(responses, ringCapacity);
+    channel->m_requests.attach(requests);
+    channel->m_responses.attach(responses);
+    return channel;
+#else
+    (void)ringCapacity;
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<SharedChannel> SharedChannel::attach(int fd) noexcept {
+#ifdef __linux__
+    // Truncating mapped memory would fault on our next access, so the size must be sealed
+    int seals = ::fcntl(fd, F_GET_SEALS);
+    struct stat fileStat;
+    if (seals < 0 || !(seals & F_SEAL_SHRINK) || ::fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<SharedChannel> channel(new (std::nothrow) SharedChannel);
+    if (!channel) {
+        ::munmap(memory, size);
+        ::close(fd);
+        return nullptr;
+    }
+    channel->m_fd = fd;
+    channel->m_memory = static_cast<std::byte*>(memory);
+    channel->m_size = size;
+
+    // Both rings must have the capacity of the first and fill the memory exactly
+    if (!channel->m_requests.attach({ channel->m_memory, size })) {
+        return nullptr;
+    }
+    size_t regionSize = SharedRing::getRegionSize(channel->m_requests.getCapacity());
+    if (size != 2 * regionSize || !channel->m_responses.attach({ channel->m_memory + regionSize, regionSize })) {
+        return nullptr;
+    }
+    return channel;
+#else
+    (void)fd;
+    return nullptr;
+#endif
+}
+
+SharedChannel::~SharedChannel() {
+    close();
+#ifdef __linux__
+    if (m_memory) {
+        ::munmap(m_memory, m_size);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+#endif
+}
+
+void SharedChannel::close() noexcept {
+    m_requests.close();
+    m_responses.close();
+}
@@ -0,0 +1,158 @@
+#include "../include/stat_event_scheduler.h"
+#include "../include/game_config.h"
+#include "../include/pet_state.h"
+#include "../include/pet_population.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    int64_t toSeconds(std::chrono::system_clock::time_point time) noexcept {
+        return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+    }
+
+    float statFor(const TimeDecay::Stats& stats, StatEvent event) noexcept {
+        switch (event) {
+            case StatEvent::HungerWarning:
+            case StatEvent::HungerDepleted:
+                return stats.hunger;
+            case StatEvent::HappinessWarning:
+            case StatEvent::HappinessDepleted:
+            default:
+                return stats.happiness;
+        }
+    }
+
+    float thresholdFor(StatEvent event) noexcept {
+        switch (event) {
+            case StatEvent::HungerWarning:
+                return GameConfig::Warnings::HUNGER_WARNING_THRESHOLD;
+            case StatEvent::HappinessWarning:
+                return GameConfig::Warnings::HAPPINESS_WARNING_THRESHOLD;
+            case StatEvent::HungerDepleted:
+            case StatEvent::HappinessDepleted:
+            default:
+                return 0.0f;
+        }
+    }
+
+    double rateFor(StatEvent event) noexcept {
+        switch (event) {
+            case StatEvent::HungerWarning:
+            case StatEvent::HungerDepleted:
+                return GameConfig::getHungerDecreaseRate();
+            case StatEvent::HappinessWarning:
+            case StatEvent::HappinessDepleted:
+            default:
+                return GameConfig::getHappinessDecreaseRate();
+        }
+    }
+}
+
+StatEventScheduler::StatEventScheduler(int64_t nowSeconds) noexcept
+    : m_wheel(nowSeconds)
+{
+}
+
+void StatEventScheduler::reschedule(uint32_t petId, const TimeDecay::Stats& anchor, float maxStat, int64_t anchorSeconds) {
+    if (petId >= m_eventTimes.size()) {
+        m_eventTimes.resize(static_cast<size_t>(petId) + 1);
+    }
+
+    auto& times = m_eventTimes[petId];
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        auto when = predictCrossing(anchor, maxStat, anchorSeconds, static_cast<StatEvent>(i));
+        times[i] = (when && *when > getCurrentTime()) ? *when : NEVER;
+    }
+    scheduleNext(petId);
+}
+
+void StatEventScheduler::reschedule(uint32_t petId, const PetState& petState) {
+    reschedule(petId, petState.getAnchorStats(), petState.getMaxStatValue(), toSeconds(petState.getLastInteractionTime()));
+}
+
+void StatEventScheduler::rescheduleAll(const PetPopulation& population) {
+    for (size_t i = 0; i < population.size(); ++i) {
+        auto pet = population[i];
+        reschedule(static_cast<uint32_t>(i), pet.getAnchorStats(), pet.getMaxStatValue(), toSeconds(pet.getLastInteractionTime()));
+    }
+}
+
+void StatEventScheduler::remove(uint32_t petId) noexcept {
+    if (petId < m_eventTimes.size()) {
+        m_eventTimes[petId].fill(NEVER);
+    }
+    m_wheel.cancel(petId);
+}
+
+size_t StatEventScheduler::advance(int64_t nowSeconds, const Callback& fire) {
+    size_t fired = 0;
+    m_wheel.advance(nowSeconds, [&](uint32_t petId, int64_t when) {
+        // Fire every event of the pet due this second, then wait for its next one
+        auto& times = m_eventTimes[petId];
+        for (size_t i = 0; i < EVENT_COUNT; ++i) {
+            if (times[i] <= when) {
+                times[i] = NEVER;
+                ++fired;
+                fire(petId, static_cast<StatEvent>(i), when);
+            }
+        }
+        scheduleNext(petId);
+    });
+    return fired;
+}
+
+std::optional<int64_t> StatEventScheduler::predictCrossing(const TimeDecay::Stats& anchor, float maxStat,
+                                                           int64_t anchorSeconds, StatEvent event) noexcept {
+    float threshold = thresholdFor(event);
+    double rate = rateFor(event);
+    if (anchorSeconds == 0 || statFor(anchor, event) <= threshold || rate <= 0.0) {
+        // A new pet does not decay, and stats never rise on their own
+        return std::nullopt;
+    }
+
+    // The stat as PetState::getStatsAt() reports it after some seconds
+    auto statAfter = [&](int64_t elapsedSeconds) {
+        double hoursPassed = std::chrono::duration<double, std::ratio<3600, 1>>(std::chrono::seconds(elapsedSeconds)).count();
+        if (hoursPassed < GameConfig::Time::MIN_TIME_THRESHOLD) {
+            return statFor(anchor, event);
+        }
+        return statFor(TimeDecay::applyHours(anchor, maxStat, hoursPassed), event);
+    };
+
+    // Closed-form estimate, then settle on the exact second float rounding gives
+    double hoursToCross = (static_cast<double>(statFor(anchor, event)) - threshold) / rate;
+    auto elapsed = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(hoursToCross * 3600.0)));
+    while (elapsed > 1 && statAfter(elapsed - 1) <= threshold) {
+        --elapsed;
+    }
+    while (statAfter(elapsed) > threshold) {
+        ++elapsed;
+    }
+    return anchorSeconds + elapsed;
+}
+
+std::string_view StatEventScheduler::getEventMessage(StatEvent event) noexcept {
+    switch (event) {
+        case StatEvent::HungerWarning:
+            return "Your pet is very hungry!";
+        case StatEvent::HappinessWarning:
+            return "Your pet is sad and needs attention!";
+        case StatEvent::HungerDepleted:
+            return "Your pet is starving!";
+        case StatEvent::HappinessDepleted:
+            return "Your pet is miserable and lonely!";
+        default:
+            return "";
+    }
+}
+
+void StatEventScheduler::scheduleNext(uint32_t petId) {
+    const auto& times = m_eventTimes[petId];
+    int64_t next = *std::min_element(times.begin(), times.end());
+    if (next == NEVER) {
+        m_wheel.cancel(petId);
+    } else {
+        m_wheel.schedule(petId, next);
+    }
+}
@@ -0,0 +1,233 @@
+#include "../include/state_archiver.h"
+#include "../include/file_tree_scanner.h"
+#include "../include/thread_pool.h"
+#include "../include/pet_archive.h"
+#include "../include/pet_state.h"
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+    /**
+     * @brief Get the size of a file, or 0 if it does not exist
+     */
+    uint64_t fileSizeOrZero(const std::filesystem::path& path) noexcept {
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        return error ? 0 : size;
+    }
+
+    std::filesystem::path journalPathFor(const std::filesystem::path& statePath) {
+        auto journalPath = statePath;
+        journalPath += ".journal";
+        return journalPath;
+    }
+
+    /**
+     * @brief Sizes and modification times of a state file and its journal
+     */
+    struct FileStamp {
+        std::filesystem::file_time_type stateTime;
+        std::filesystem::file_time_type journalTime;
+        uintmax_t stateSize = 0;
+        uintmax_t journalSize = 0;
+
+        bool operator==(const FileStamp&) const = default;
+    };
+
+    FileStamp readStamp(const std::filesystem::path& statePath) noexcept {
+        FileStamp stamp;
+        std::error_code error;
+        stamp.stateTime = std::filesystem::last_write_time(statePath, error);
+        stamp.stateSize = fileSizeOrZero(statePath);
+
+        auto journalPath = journalPathFor(statePath);
+        stamp.journalTime = std::filesystem::last_write_time(journalPath, error);
+        stamp.journalSize = fileSizeOrZero(journalPath);
+        return stamp;
+    }
+}
+
+StateArchiver::StateArchiver(std::chrono::seconds idleThreshold, size_t threadCount) noexcept
+    : m_idleThreshold(idleThreshold)
+    , m_threadCount(threadCount)
+{
+}
+
+ArchiveReport StateArchiver::archive(const std::filesystem::path& root) const noexcept {
+    ArchiveReport report;
+    auto startTime = std::chrono::steady_clock::now();
+    auto now = std::chrono::system_clock::now();
+
+    std::atomic<size_t> active{0};
+    std::atomic<size_t> ignored{0};
+    std::mutex reportMutex;
+
+    // Idle pets grouped by directory, since each directory has its own archive
+    std::unordered_map<std::string, std::vector<std::filesystem::path>> idlePets;
+
+    auto addFailure = [&](const std::filesystem::path& path, std::string reason) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        report.failures.emplace_back(path, std::move(reason));
+    };
+
+    auto visit = [&](const std::filesystem::path& path) {
+        uint8_t version = 0;
+        if (FileTreeScanner::isAuxiliaryFile(path) || !PetState::peekFileVersion(path, version)) {
+            ++ignored;
+            return;
+        }
+
+        PetState petState;
+        if (!petState.loadFromFile(path)) {
+            addFailure(path, "cannot read state");
+            return;
+        }
+        if (now - petState.getLastInteractionTime() < m_idleThreshold) {
+            ++active;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(reportMutex);
+        idlePets[path.parent_path().string()].push_back(path);
+    };
+
+    FileTreeScanner scanner(m_threadCount);
+    report.scanned = scanner.scan(root, visit, addFailure);
+    report.active = active;
+    report.ignored = ignored;
+
+    // Archives are independent, so directories are packed in parallel
+    try {
+        ThreadPool pool(m_threadCount);
+        for (const auto& [directory, paths] : idlePets) {
+            pool.submit([&, directory = std::filesystem::path(directory), &paths = paths]() {
+                ArchiveReport result;
+                try {
+                    result = archiveDirectory(directory, paths, now);
+                } catch (const std::exception& e) {
+                    result.failures.emplace_back(directory, e.what());
+                }
+
+                std::lock_guard<std::mutex> lock(reportMutex);
+                report.archived += result.archived;
+                report.active += result.active;
+                report.bytesRemoved += result.bytesRemoved;
+                report.archiveBytesAdded += result.archiveBytesAdded;
+                report.failures.insert(report.failures.end(), result.failures.begin(), result.failures.end());
+            });
+        }
+        pool.wait();
+    } catch (const std::exception& e) {
+        addFailure(root, e.what());
+    }
+
+    report.failed = report.failures.size();
+    report.elapsed = std::chrono::steady_clock::now() - startTime;
+    return report;
+}
+
+ArchiveReport StateArchiver::archiveDirectory(const std::filesystem::path& directory, const std::vector<std::filesystem::path>& paths,
+                                              std::chrono::system_clock::time_point now) const {
+    ArchiveReport result;
+    auto archivePath = directory / PetArchive::FILE_NAME;
+
+    // Held until the state files are removed, so restores and other runs cannot commit in between
+    PetArchive::Lock lock(archivePath);
+    if (!lock.isLocked()) {
+        for (const auto& path : paths) {
+            result.failures.emplace_back(path, "cannot lock archive " + archivePath.string());
+        }
+        return result;
+    }
+    auto archiveSizeBefore = fileSizeOrZero(archivePath);
+
+    PetArchive archive;
+    if (!archive.open(archivePath)) {
+        for (const auto& path : paths) {
+            result.failures.emplace_back(path, "unreadable archive " + archivePath.string());
+        }
+        return result;
+    }
+
+    std::vector<std::pair<std::filesystem::path, FileStamp>> packed;
+    for (const auto& path : paths) {
+        // Reload: the pet may have been used since the scan
+        auto stamp = readStamp(path);
+        PetState petState;
+        if (!petState.loadFromFile(path)) {
+            result.failures.emplace_back(path, "cannot read state");
+            continue;
+        }
+        if (now - petState.getLastInteractionTime() < m_idleThreshold) {
+            ++result.active;
+            continue;
+        }
+        if (!petState.saveToArchive(archive, path.filename().string())) {
+            result.failures.emplace_back(path, "cannot compress state");
+            continue;
+        }
+        packed.emplace_back(path, stamp);
+    }
+
+    if (packed.empty()) {
+        return result;
+    }
+
+    // The archive must be durable before any state file is removed
+    if (!archive.trainDictionary() || !archive.commit()) {
+        for (const auto& [path, stamp] : packed) {
+            result.failures.emplace_back(path, "cannot write archive " + archivePath.string());
+        }
+        return result;
+    }
+
+    bool changed = false;
+    for (const auto& [path, stamp] : packed) {
+        // A command that ran since the reload is not in the archive, so the file stays
+        if (readStamp(path) != stamp) {
+            archive.erase(path.filename().string());
+            changed = true;
+            ++result.active;
+            continue;
+        }
+
+        auto journalPath = journalPathFor(path);
+        result.bytesRemoved += fileSizeOrZero(path) + fileSizeOrZero(journalPath);
+
+        std::error_code error;
+        std::filesystem::remove(journalPath, error);
+        std::filesystem::remove(path, error);
+        ++result.archived;
+    }
+
+    // If this fails the outdated entries stay, shadowed by their state files
+    if (changed) {
+        archive.commit();
+    }
+
+    result.archiveBytesAdded = static_cast<int64_t>(fileSizeOrZero(archivePath)) - static_cast<int64_t>(archiveSizeBefore);
+    return result;
+}
+
+void StateArchiver::printReport(const ArchiveReport& report) noexcept {
+    double ratio = report.archiveBytesAdded > 0 ?
+        static_cast<double>(report.bytesRemoved) / static_cast<double>(report.archiveBytesAdded) : 0.0;
+
+    std::cout << "Scanned:    " << report.scanned << " files\n"
+              << "Archived:   " << report.archived << "\n"
+              << "Active:     " << report.active << "\n"
+              << "Ignored:    " << report.ignored << "\n"
+              << "Failed:     " << report.failed << "\n"
+              << "Space:      " << report.bytesRemoved << " bytes in " << report.archived << " files -> "
+              << report.archiveBytesAdded << " bytes of archive"
+              << std::fixed << std::setprecision(2) << " (" << ratio << "x)\n"
+              << "Elapsed:    " << report.elapsed.count() << " s" << std::endl;
+
+    for (const auto& [path, reason] : report.failures) {
+        std::cerr << "Failed: " << path.string() << ": " << reason << std::endl;
+    }
+}
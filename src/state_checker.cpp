@@ -0,0 +1,188 @@
+#include "../include/state_checker.h"
+#include "../include/file_tree_scanner.h"
+#include "../include/mapped_file.h"
+#include "../include/pet_state.h"
+#include "../include/state_file_format.h"
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+
+StateChecker::StateChecker(size_t threadCount) noexcept
+    : m_threadCount(threadCount)
+{
+}
+
+CheckReport StateChecker::check(const std::filesystem::path& root) const noexcept {
+    CheckReport report;
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> intact{0};
+    std::atomic<size_t> unverified{0};
+    std::atomic<size_t> corrupt{0};
+    std::atomic<size_t> ignored{0};
+    std::atomic<size_t> sectionsVerified{0};
+    std::atomic<int64_t> verifyNanoseconds{0};
+    std::mutex problemsMutex;
+
+    auto addProblem = [&](const std::filesystem::path& path, std::string problem) {
+        std::lock_guard<std::mutex> lock(problemsMutex);
+        report.problems.emplace_back(path, std::move(problem));
+    };
+
+    auto visit = [&](const std::filesystem::path& path) {
+        if (FileTreeScanner::isAuxiliaryFile(path)) {
+            ++ignored;
+            return;
+        }
+
+        std::string problem;
+        size_t fileSections = 0;
+        std::chrono::nanoseconds fileVerifyTime{0};
+        auto status = checkFile(path, problem, fileSections, fileVerifyTime);
+
+        switch (status) {
+            case Status::Intact:
+                verifyNanoseconds += fileVerifyTime.count();
+                sectionsVerified += fileSections;
+                ++intact;
+                break;
+            case Status::Unverified:
+                ++unverified;
+                break;
+            case Status::Corrupt:
+                ++corrupt;
+                addProblem(path, problem);
+                break;
+            case Status::NotStateFile:
+                ++ignored;
+                break;
+        }
+    };
+
+    FileTreeScanner scanner(m_threadCount);
+    report.scanned = scanner.scan(root, visit, addProblem);
+
+    report.intact = intact;
+    report.unverified = unverified;
+    report.corrupt = corrupt;
+    report.ignored = ignored;
+    report.sectionsVerified = sectionsVerified;
+    report.verifyTime = std::chrono::nanoseconds(verifyNanoseconds.load());
+    report.elapsed = std::chrono::steady_clock::now() - startTime;
+    return report;
+}
+
+StateChecker::Status StateChecker::checkFile(const std::filesystem::path& path, std::string& problem,
+                                             size_t& sectionsVerified, std::chrono::nanoseconds& verifyTime) noexcept {
+    uint8_t version = 0;
+    {
+        MappedFile mappedFile(path);
+        if (!mappedFile.isOpen()) {
+            problem = "cannot open file";
+            return Status::Corrupt;
+        }
+
+        auto bytes = mappedFile.data();
+        if (bytes.empty()) {
+            return Status::NotStateFile;
+        }
+
+        version = static_cast<uint8_t>(bytes[0]);
+        if (version == 0 || version > StateFileFormat::CURRENT_VERSION) {
+            return Status::NotStateFile;
+        }
+        if (version >= StateFileFormat::FIRST_SECTIONED_VERSION) {
+            // Page faults on the first touch of the mapping are I/O, not verification
+            volatile auto lastByte = bytes[bytes.size() - 1];
+            (void)lastByte;
+            
+            auto verifyStart = std::chrono::steady_clock::now();
+            auto status = checkSectionedImage(bytes, problem, sectionsVerified);
+            verifyTime = std::chrono::steady_clock::now() - verifyStart;
+            return status;
+        }
+    }
+
+    // Older versions have no checksums; a full load is the only check there is
+    PetState petState;
+    if (!petState.loadFromFile(path)) {
+        problem = "version " + std::to_string(version) + " state is truncated or corrupt";
+        return Status::Corrupt;
+    }
+    return Status::Unverified;
+}
+
+StateChecker::Status StateChecker::checkSectionedImage(std::span<const std::byte> bytes, std::string& problem, size_t& sectionsVerified) noexcept {
+    using namespace StateFileFormat;
+
+    try {
+        auto version = static_cast<uint8_t>(bytes[0]);
+        ContainerHeader header;
+        if (!CONTAINER_HEADER_SCHEMA.decode(bytes, version, header)) {
+            problem = "truncated container header";
+            return Status::Corrupt;
+        }
+
+        size_t tableEnd = CONTAINER_HEADER_SCHEMA.encodedSize(version) +
+                          SECTION_ENTRY_SCHEMA.encodedSize(version) * header.sectionCount;
+        if (bytes.size() < tableEnd) {
+            problem = "truncated section table";
+            return Status::Corrupt;
+        }
+
+        bool checksummed = version >= FIRST_CHECKSUMMED_VERSION;
+        if (checksummed && computeTableChecksum(bytes, tableEnd) != header.tableChecksum) {
+            problem = "section table checksum mismatch";
+            return Status::Corrupt;
+        }
+
+        std::vector<SectionEntry> entries;
+        if (!decodeSectionTable(bytes, entries)) {
+            problem = "section extends past the end of the file";
+            return Status::Corrupt;
+        }
+
+        for (const auto& entry : entries) {
+            if (!verifySection(bytes, entry, version)) {
+                problem = "section " + std::to_string(entry.type) + " checksum mismatch";
+                return Status::Corrupt;
+            }
+        }
+
+        if (!findSection(entries, SectionType::Core)) {
+            problem = "missing core section";
+            return Status::Corrupt;
+        }
+
+        if (!checksummed) {
+            return Status::Unverified;
+        }
+        sectionsVerified += entries.size();
+        return Status::Intact;
+    } catch (const std::exception& e) {
+        problem = e.what();
+        return Status::Corrupt;
+    }
+}
+
+void StateChecker::printReport(const CheckReport& report) noexcept {
+    double seconds = std::max(report.elapsed.count(), 1e-9);
+    double nanosecondsPerSection = report.sectionsVerified == 0 ? 0.0 :
+        static_cast<double>(report.verifyTime.count()) / static_cast<double>(report.sectionsVerified);
+
+    std::cout << "Scanned:    " << report.scanned << " files\n"
+              << "Intact:     " << report.intact << "\n"
+              << "Unverified: " << report.unverified << " (no checksums, run 'pet migrate' to add them)\n"
+              << "Corrupt:    " << report.corrupt << "\n"
+              << "Ignored:    " << report.ignored << "\n"
+              << std::fixed << std::setprecision(2)
+              << "Elapsed:    " << report.elapsed.count() << " s ("
+              << static_cast<double>(report.scanned) / seconds << " files/s, "
+              << nanosecondsPerSection << " ns per verified section)" << std::endl;
+
+    for (const auto& [path, problem] : report.problems) {
+        std::cerr << "Corrupt: " << path.string() << ": " << problem << std::endl;
+    }
+}
@@ -0,0 +1,114 @@
+#include "../include/state_migrator.h"
+#include "../include/file_tree_scanner.h"
+#include "../include/pet_state.h"
+#include "../include/state_file_format.h"
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+StateMigrator::StateMigrator(size_t threadCount, DurabilityPolicy policy) noexcept
+    : m_threadCount(threadCount)
+    , m_policy(policy)
+{
+}
+
+MigrationReport StateMigrator::migrate(const std::filesystem::path& root) const noexcept {
+    MigrationReport report;
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> migrated{0};
+    std::atomic<size_t> upToDate{0};
+    std::atomic<size_t> ignored{0};
+    std::atomic<uint64_t> bytesMigrated{0};
+    std::mutex failuresMutex;
+
+    auto addFailure = [&](const std::filesystem::path& path, std::string reason) {
+        std::lock_guard<std::mutex> lock(failuresMutex);
+        report.failures.emplace_back(path, std::move(reason));
+    };
+
+    // One writer per worker thread, so a batched policy syncs each worker's files together
+    std::mutex writersMutex;
+    std::unordered_map<std::thread::id, AtomicFileWriter> writers;
+    auto getWriter = [&]() -> AtomicFileWriter& {
+        std::lock_guard<std::mutex> lock(writersMutex);
+        return writers.try_emplace(std::this_thread::get_id(), m_policy).first->second;
+    };
+
+    auto migrateFile = [&](const std::filesystem::path& path) {
+        uint8_t version = 0;
+        if (!PetState::peekFileVersion(path, version)) {
+            ++ignored;
+            return;
+        }
+        if (version == StateFileFormat::CURRENT_VERSION) {
+            ++upToDate;
+            return;
+        }
+
+        std::error_code error;
+        auto fileSize = std::filesystem::file_size(path, error);
+
+        PetState petState;
+        if (!petState.loadFromFile(path)) {
+            addFailure(path, "cannot read version " + std::to_string(version) + " state");
+            return;
+        }
+        if (!petState.saveToFile(path, getWriter())) {
+            addFailure(path, "cannot write upgraded state");
+            return;
+        }
+
+        ++migrated;
+        bytesMigrated += error ? 0 : fileSize;
+    };
+
+    auto visit = [&](const std::filesystem::path& path) {
+        if (FileTreeScanner::isAuxiliaryFile(path)) {
+            ++ignored;
+            return;
+        }
+        migrateFile(path);
+    };
+
+    FileTreeScanner scanner(m_threadCount);
+    report.scanned = scanner.scan(root, visit, addFailure);
+
+    // Sync what the last batches left pending before reporting success
+    for (auto& [thread, writer] : writers) {
+        if (!writer.flush()) {
+            addFailure(root, "cannot sync migrated files");
+        }
+    }
+
+    report.migrated = migrated;
+    report.upToDate = upToDate;
+    report.ignored = ignored;
+    report.failed = report.failures.size();
+    report.bytesMigrated = bytesMigrated;
+    report.elapsed = std::chrono::steady_clock::now() - startTime;
+    return report;
+}
+
+void StateMigrator::printReport(const MigrationReport& report) noexcept {
+    double seconds = std::max(report.elapsed.count(), 1e-9);
+    double megabytes = static_cast<double>(report.bytesMigrated) / (1024.0 * 1024.0);
+
+    std::cout << "Scanned:    " << report.scanned << " files\n"
+              << "Migrated:   " << report.migrated << "\n"
+              << "Up to date: " << report.upToDate << "\n"
+              << "Ignored:    " << report.ignored << "\n"
+              << "Failed:     " << report.failed << "\n"
+              << std::fixed << std::setprecision(2)
+              << "Elapsed:    " << report.elapsed.count() << " s ("
+              << static_cast<double>(report.migrated) / seconds << " files/s, "
+              << megabytes / seconds << " MB/s)" << std::endl;
+
+    for (const auto& [path, reason] : report.failures) {
+        std::cerr << "Failed: " << path.string() << ": " << reason << std::endl;
+    }
+}
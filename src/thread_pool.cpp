@@ -0,0 +1,63 @@
+#include "../include/thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_tasks.empty() && m_running == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_taskAvailable.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+        // Drain the queue before stopping
+        if (m_tasks.empty()) {
+            return;
+        }
+
+        auto task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        ++m_running;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        --m_running;
+        if (m_tasks.empty() && m_running == 0) {
+            m_idle.notify_all();
+        }
+    }
+}
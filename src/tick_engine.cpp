@@ -0,0 +1,102 @@
+#include "../include/tick_engine.h"
+#include "../include/game_config.h"
+#include <algorithm>
+
+TickEngine::TickEngine(size_t threadCount, size_t chunkSize)
+    : m_pool(threadCount)
+    , m_chunkSize(std::max<size_t>(1, (chunkSize + CHUNK_GRANULE - 1) / CHUNK_GRANULE) * CHUNK_GRANULE)
+    , m_outputs(m_pool.getThreadCount())
+{
+}
+
+TickReport TickEngine::tick(PetPopulation& population, std::chrono::system_clock::time_point now) {
+    auto start = std::chrono::steady_clock::now();
+    int64_t nowSeconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+
+    for (auto& output : m_outputs) {
+        output.updated = 0;
+        output.events.clear();
+        output.aggregates.clear();
+    }
+
+    size_t petCount = population.size();
+    size_t chunkCount = (petCount + m_chunkSize - 1) / m_chunkSize;
+    m_pool.parallelFor(chunkCount, [&](size_t chunk, size_t worker) {
+        size_t begin = chunk * m_chunkSize;
+        tickChunk(population, begin, std::min(begin + m_chunkSize, petCount), nowSeconds, m_outputs[worker]);
+    });
+
+    // Workers only ever appended to their own buffers; merge them now that all are done
+    TickReport report;
+    size_t eventCount = 0;
+    for (const auto& output : m_outputs) {
+        report.updated += output.updated;
+        eventCount += output.events.size();
+        population.getAggregates().merge(output.aggregates);
+    }
+    report.events.reserve(eventCount);
+    for (const auto& output : m_outputs) {
+        report.events.insert(report.events.end(), output.events.begin(), output.events.end());
+    }
+
+    // Stolen chunks leave buffers out of order; a pet's own events keep theirs
+    std::stable_sort(report.events.begin(), report.events.end(), [](const TickEvent& a, const TickEvent& b) {
+        return a.petIndex < b.petIndex;
+    });
+
+    report.elapsed = std::chrono::steady_clock::now() - start;
+    return report;
+}
+
+void TickEngine::tickChunk(PetPopulation& population, size_t begin, size_t end, int64_t nowSeconds,
+                           WorkerOutput& output) {
+    size_t count = end - begin;
+    auto energy = population.getEnergyColumn().subspan(begin, count);
+    auto xp = population.getXPColumn().subspan(begin, count);
+    auto levels = population.getEvolutionLevelColumn().subspan(begin, count);
+    auto lastInteraction = population.getLastInteractionColumn().subspan(begin, count);
+    auto achievements = population.getAchievementColumn().subspan(begin, count);
+
+    output.updated += population.applyTimeEffectsRange(begin, end, nowSeconds, output.aggregates);
+
+    auto unlock = [&](size_t i, AchievementType type) {
+        uint64_t bit = uint64_t{1} << static_cast<size_t>(type);
+        if ((achievements[i] & bit) == 0) {
+            achievements[i] |= bit;
+            output.events.push_back({static_cast<uint32_t>(begin + i), TickEvent::Type::AchievementUnlocked,
+                                     static_cast<uint8_t>(type)});
+        }
+    };
+
+    const uint32_t restedProgress = AchievementSystem::getRequiredProgress(AchievementType::FullyRested);
+    const uint64_t restedBit = uint64_t{1} << static_cast<size_t>(AchievementType::FullyRested);
+    for (size_t i = 0; i < count; ++i) {
+        // Pets the kernel updated carry now as their interaction time; resting
+        // only raises energy, so FullyRested is the one stat achievement a tick can reach
+        if (lastInteraction[i] == nowSeconds && (achievements[i] & restedBit) == 0) {
+            float percentage = (energy[i] / GameConfig::getMaxStatForEvolutionLevel(levels[i])) * 100.0f;
+            if (static_cast<uint32_t>(percentage) >= restedProgress) {
+                unlock(i, AchievementType::FullyRested);
+            }
+        }
+
+        // Evolve through every level the XP covers, as PetState::addXP() does
+        if (levels[i] >= static_cast<uint8_t>(EvolutionLevel::Ancient) ||
+            xp[i] < GameConfig::getEvolutionXPRequirement(levels[i])) {
+            continue;
+        }
+        auto before = population.sample(begin + i);
+        while (levels[i] < static_cast<uint8_t>(EvolutionLevel::Ancient) &&
+               xp[i] >= GameConfig::getEvolutionXPRequirement(levels[i])) {
+            ++levels[i];
+            output.events.push_back({static_cast<uint32_t>(begin + i), TickEvent::Type::Evolved, levels[i]});
+            unlock(i, AchievementType::Evolution);
+            if (levels[i] == static_cast<uint8_t>(EvolutionLevel::Master)) {
+                unlock(i, AchievementType::Master);
+            } else if (levels[i] == static_cast<uint8_t>(EvolutionLevel::Ancient)) {
+                unlock(i, AchievementType::Eternal);
+            }
+        }
+        output.aggregates.update(before, population.sample(begin + i));
+    }
+}
@@ -0,0 +1,364 @@
+#include "../include/time_decay.h"
+#include "../include/game_config.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PET_TIME_DECAY_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Per-hour rates, widened to double as PetState::applyElapsedTime() does
+    constexpr double HUNGER_RATE = GameConfig::getHungerDecreaseRate();
+    constexpr double HAPPINESS_RATE = GameConfig::getHappinessDecreaseRate();
+    constexpr double ENERGY_RATE = GameConfig::getEnergyIncreaseRate();
+
+    // Maximum stat by evolution level; levels past the table use the last entry
+    constexpr auto MAX_STATS = []() {
+        std::array<float, 8> maxStats{};
+        for (size_t level = 0; level < maxStats.size(); ++level) {
+            maxStats[level] = GameConfig::getMaxStatForEvolutionLevel(static_cast<uint8_t>(level));
+        }
+        return maxStats;
+    }();
+
+    constexpr uint8_t MAX_STAT_INDEX = static_cast<uint8_t>(MAX_STATS.size() - 1);
+
+    size_t applyRange(const TimeDecay::Columns& columns, int64_t nowSeconds, size_t begin, size_t end) noexcept {
+        size_t applied = 0;
+        for (size_t i = begin; i < end; ++i) {
+            int64_t lastSeconds = columns.lastInteractionSeconds[i];
+            if (lastSeconds == 0) {
+                // First interaction, no effects to apply
+                continue;
+            }
+
+            double hoursPassed = std::chrono::duration<double, std::ratio<3600, 1>>(
+                std::chrono::seconds(nowSeconds - lastSeconds)).count();
+            if (hoursPassed < GameConfig::Time::MIN_TIME_THRESHOLD) {
+                continue;
+            }
+
+            float maxStat = GameConfig::getMaxStatForEvolutionLevel(columns.evolutionLevels[i]);
+            auto stats = TimeDecay::applyHours({columns.hunger[i], columns.happiness[i], columns.energy[i]}, maxStat, hoursPassed);
+            columns.hunger[i] = stats.hunger;
+            columns.happiness[i] = stats.happiness;
+            columns.energy[i] = stats.energy;
+
+            columns.lastInteractionSeconds[i] = nowSeconds;
+            ++applied;
+        }
+        return applied;
+    }
+
+    size_t applyPortable(const TimeDecay::Columns& columns, int64_t nowSeconds) noexcept {
+        return applyRange(columns, nowSeconds, 0, columns.hunger.size());
+    }
+
+#ifdef PET_TIME_DECAY_X86
+    // Elapsed seconds are converted to double exactly by adding them to the bits
+    // of 1.5 * 2^52, which is valid while they stay within +-2^51
+    constexpr double CONVERSION_BIAS = 6755399441055744.0;
+    constexpr int64_t MAX_EXACT_SECONDS = (int64_t{1} << 51) - 1;
+    constexpr int64_t MIN_EXACT_SECONDS = -(int64_t{1} << 51);
+
+    __attribute__((target("avx2")))
+    __m256d hoursPassedAvx2(__m256i elapsedSeconds) noexcept {
+        const __m256d bias = _mm256_set1_pd(CONVERSION_BIAS);
+        __m256d seconds = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(elapsedSeconds, _mm256_castpd_si256(bias))), bias);
+        return _mm256_div_pd(seconds, _mm256_set1_pd(3600.0));
+    }
+
+    __attribute__((target("avx2")))
+    __m256 narrowAvx2(__m256d low, __m256d high) noexcept {
+        return _mm256_set_m128(_mm256_cvtpd_ps(high), _mm256_cvtpd_ps(low));
+    }
+
+    __attribute__((target("avx2")))
+    __m256 decreaseAvx2(__m256 stat, __m256 amount) noexcept {
+        // stat > amount ? stat - amount : 0
+        return _mm256_and_ps(_mm256_cmp_ps(stat, amount, _CMP_GT_OQ), _mm256_sub_ps(stat, amount));
+    }
+
+    // Eight pets per iteration: four per double-precision register
+    __attribute__((target("avx2")))
+    size_t applyAvx2(const TimeDecay::Columns& columns, int64_t nowSeconds) noexcept {
+        const size_t count = columns.hunger.size();
+        const __m256i now = _mm256_set1_epi64x(nowSeconds);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i maxExact = _mm256_set1_epi64x(MAX_EXACT_SECONDS);
+        const __m256i minExact = _mm256_set1_epi64x(MIN_EXACT_SECONDS);
+        const __m256d threshold = _mm256_set1_pd(GameConfig::Time::MIN_TIME_THRESHOLD);
+        const __m256d hungerRate = _mm256_set1_pd(HUNGER_RATE);
+        const __m256d happinessRate = _mm256_set1_pd(HAPPINESS_RATE);
+        const __m256d energyRate = _mm256_set1_pd(ENERGY_RATE);
+        const __m256 maxStats = _mm256_loadu_ps(MAX_STATS.data());
+        const __m256i maxStatIndex = _mm256_set1_epi32(MAX_STAT_INDEX);
+        const __m256i evenLanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+        float* hunger = columns.hunger.data();
+        float* happiness = columns.happiness.data();
+        float* energy = columns.energy.data();
+        const uint8_t* levels = columns.evolutionLevels.data();
+        int64_t* lastSeconds = columns.lastInteractionSeconds.data();
+
+        size_t applied = 0;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i lastLow = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lastSeconds + i));
+            __m256i lastHigh = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lastSeconds + i + 4));
+            __m256i elapsedLow = _mm256_sub_epi64(now, lastLow);
+            __m256i elapsedHigh = _mm256_sub_epi64(now, lastHigh);
+
+            __m256i outOfRange = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpgt_epi64(elapsedLow, maxExact), _mm256_cmpgt_epi64(minExact, elapsedLow)),
+                _mm256_or_si256(_mm256_cmpgt_epi64(elapsedHigh, maxExact), _mm256_cmpgt_epi64(minExact, elapsedHigh)));
+            if (!_mm256_testz_si256(outOfRange, outOfRange)) {
+                applied += applyRange(columns, nowSeconds, i, i + 8);
+                continue;
+            }
+
+            __m256d hoursLow = hoursPassedAvx2(elapsedLow);
+            __m256d hoursHigh = hoursPassedAvx2(elapsedHigh);
+
+            // Apply where the pet has interacted before and enough time has passed
+            __m256d applyLow = _mm256_andnot_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lastLow, zero)),
+                                                _mm256_cmp_pd(hoursLow, threshold, _CMP_GE_OQ));
+            __m256d applyHigh = _mm256_andnot_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lastHigh, zero)),
+                                                 _mm256_cmp_pd(hoursHigh, threshold, _CMP_GE_OQ));
+
+            // Narrow the 64-bit lane masks to one 32-bit mask for the float stats
+            __m256 apply = _mm256_castsi256_ps(_mm256_set_m128i(
+                _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(applyHigh), evenLanes)),
+                _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(applyLow), evenLanes))));
+            int applyBits = _mm256_movemask_ps(apply);
+            if (applyBits == 0) {
+                continue;
+            }
+            applied += static_cast<size_t>(std::popcount(static_cast<unsigned>(applyBits)));
+
+            __m256 hungerAmount = narrowAvx2(_mm256_mul_pd(hungerRate, hoursLow), _mm256_mul_pd(hungerRate, hoursHigh));
+            __m256 happinessAmount = narrowAvx2(_mm256_mul_pd(happinessRate, hoursLow), _mm256_mul_pd(happinessRate, hoursHigh));
+            __m256 energyAmount = narrowAvx2(_mm256_mul_pd(energyRate, hoursLow), _mm256_mul_pd(energyRate, hoursHigh));
+
+            __m256 hungerValues = _mm256_loadu_ps(hunger + i);
+            __m256 happinessValues = _mm256_loadu_ps(happiness + i);
+            __m256 energyValues = _mm256_loadu_ps(energy + i);
+
+            // Look up each pet's maximum stat from its evolution level
+            __m256i levelIndex = _mm256_min_epu32(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(levels + i))), maxStatIndex);
+            __m256 maxStat = _mm256_permutevar8x32_ps(maxStats, levelIndex);
+
+            __m256 energySum = _mm256_add_ps(energyValues, energyAmount);
+            __m256 energyCapped = _mm256_blendv_ps(energySum, maxStat, _mm256_cmp_ps(energySum, maxStat, _CMP_GT_OQ));
+
+            _mm256_storeu_ps(hunger + i, _mm256_blendv_ps(hungerValues, decreaseAvx2(hungerValues, hungerAmount), apply));
+            _mm256_storeu_ps(happiness + i, _mm256_blendv_ps(happinessValues, decreaseAvx2(happinessValues, happinessAmount), apply));
+            _mm256_storeu_ps(energy + i, _mm256_blendv_ps(energyValues, energyCapped, apply));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lastSeconds + i),
+                                _mm256_blendv_epi8(lastLow, now, _mm256_castpd_si256(applyLow)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lastSeconds + i + 4),
+                                _mm256_blendv_epi8(lastHigh, now, _mm256_castpd_si256(applyHigh)));
+        }
+
+        return applied + applyRange(columns, nowSeconds, i, count);
+    }
+
+    __attribute__((target("sse4.2")))
+    __m128d hoursPassedSse42(__m128i elapsedSeconds) noexcept {
+        const __m128d bias = _mm_set1_pd(CONVERSION_BIAS);
+        __m128d seconds = _mm_sub_pd(_mm_castsi128_pd(_mm_add_epi64(elapsedSeconds, _mm_castpd_si128(bias))), bias);
+        return _mm_div_pd(seconds, _mm_set1_pd(3600.0));
+    }
+
+    __attribute__((target("sse4.2")))
+    __m128 narrowSse42(__m128d low, __m128d high) noexcept {
+        return _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high));
+    }
+
+    __attribute__((target("sse4.2")))
+    __m128 decreaseSse42(__m128 stat, __m128 amount) noexcept {
+        // stat > amount ? stat - amount : 0
+        return _mm_and_ps(_mm_cmpgt_ps(stat, amount), _mm_sub_ps(stat, amount));
+    }
+
+    // Four pets per iteration: two per double-precision register
+    __attribute__((target("sse4.2")))
+    size_t applySse42(const TimeDecay::Columns& columns, int64_t nowSeconds) noexcept {
+        const size_t count = columns.hunger.size();
+        const __m128i now = _mm_set1_epi64x(nowSeconds);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i maxExact = _mm_set1_epi64x(MAX_EXACT_SECONDS);
+        const __m128i minExact = _mm_set1_epi64x(MIN_EXACT_SECONDS);
+        const __m128d threshold = _mm_set1_pd(GameConfig::Time::MIN_TIME_THRESHOLD);
+        const __m128d hungerRate = _mm_set1_pd(HUNGER_RATE);
+        const __m128d happinessRate = _mm_set1_pd(HAPPINESS_RATE);
+        const __m128d energyRate = _mm_set1_pd(ENERGY_RATE);
+
+        float* hunger = columns.hunger.data();
+        float* happiness = columns.happiness.data();
+        float* energy = columns.energy.data();
+        const uint8_t* levels = columns.evolutionLevels.data();
+        int64_t* lastSeconds = columns.lastInteractionSeconds.data();
+
+        size_t applied = 0;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i lastLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lastSeconds + i));
+            __m128i lastHigh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lastSeconds + i + 2));
+            __m128i elapsedLow = _mm_sub_epi64(now, lastLow);
+            __m128i elapsedHigh = _mm_sub_epi64(now, lastHigh);
+
+            __m128i outOfRange = _mm_or_si128(
+                _mm_or_si128(_mm_cmpgt_epi64(elapsedLow, maxExact), _mm_cmpgt_epi64(minExact, elapsedLow)),
+                _mm_or_si128(_mm_cmpgt_epi64(elapsedHigh, maxExact), _mm_cmpgt_epi64(minExact, elapsedHigh)));
+            if (!_mm_testz_si128(outOfRange, outOfRange)) {
+                applied += applyRange(columns, nowSeconds, i, i + 4);
+                continue;
+            }
+
+            __m128d hoursLow = hoursPassedSse42(elapsedLow);
+            __m128d hoursHigh = hoursPassedSse42(elapsedHigh);
+
+            // Apply where the pet has interacted before and enough time has passed
+            __m128d applyLow = _mm_andnot_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(lastLow, zero)), _mm_cmpge_pd(hoursLow, threshold));
+            __m128d applyHigh = _mm_andnot_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(lastHigh, zero)), _mm_cmpge_pd(hoursHigh, threshold));
+
+            // Narrow the 64-bit lane masks to one 32-bit mask for the float stats
+            __m128 apply = _mm_shuffle_ps(_mm_castpd_ps(applyLow), _mm_castpd_ps(applyHigh), _MM_SHUFFLE(2, 0, 2, 0));
+            int applyBits = _mm_movemask_ps(apply);
+            if (applyBits == 0) {
+                continue;
+            }
+            applied += static_cast<size_t>(std::popcount(static_cast<unsigned>(applyBits)));
+
+            __m128 hungerAmount = narrowSse42(_mm_mul_pd(hungerRate, hoursLow), _mm_mul_pd(hungerRate, hoursHigh));
+            __m128 happinessAmount = narrowSse42(_mm_mul_pd(happinessRate, hoursLow), _mm_mul_pd(happinessRate, hoursHigh));
+            __m128 energyAmount = narrowSse42(_mm_mul_pd(energyRate, hoursLow), _mm_mul_pd(energyRate, hoursHigh));
+
+            __m128 hungerValues = _mm_loadu_ps(hunger + i);
+            __m128 happinessValues = _mm_loadu_ps(happiness + i);
+            __m128 energyValues = _mm_loadu_ps(energy + i);
+
+            // No variable float permute before AVX, so the table is read per pet
+            __m128 maxStat = _mm_setr_ps(MAX_STATS[std::min(levels[i], MAX_STAT_INDEX)],
+                                         MAX_STATS[std::min(levels[i + 1], MAX_STAT_INDEX)],
+                                         MAX_STATS[std::min(levels[i + 2], MAX_STAT_INDEX)],
+                                         MAX_STATS[std::min(levels[i + 3], MAX_STAT_INDEX)]);
+
+            __m128 energySum = _mm_add_ps(energyValues, energyAmount);
+            __m128 energyCapped = _mm_blendv_ps(energySum, maxStat, _mm_cmpgt_ps(energySum, maxStat));
+
+            _mm_storeu_ps(hunger + i, _mm_blendv_ps(hungerValues, decreaseSse42(hungerValues, hungerAmount), apply));
+            _mm_storeu_ps(happiness + i, _mm_blendv_ps(happinessValues, decreaseSse42(happinessValues, happinessAmount), apply));
+            _mm_storeu_ps(energy + i, _mm_blendv_ps(energyValues, energyCapped, apply));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lastSeconds + i),
+                             _mm_blendv_epi8(lastLow, now, _mm_castpd_si128(applyLow)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lastSeconds + i + 2),
+                             _mm_blendv_epi8(lastHigh, now, _mm_castpd_si128(applyHigh)));
+        }
+
+        return applied + applyRange(columns, nowSeconds, i, count);
+    }
+#endif
+
+    using ApplyFunction = size_t (*)(const TimeDecay::Columns&, int64_t) noexcept;
+
+    ApplyFunction selectApply() noexcept {
+#ifdef PET_TIME_DECAY_X86
+        if (__builtin_cpu_supports("avx2")) {
+            return applyAvx2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return applySse42;
+        }
+#endif
+        return applyPortable;
+    }
+
+    // Chosen once at startup from the CPU features
+    const ApplyFunction APPLY = selectApply();
+}
+
+namespace TimeDecay {
+
+    Stats applyHours(const Stats& stats, float maxStat, double hoursPassed) noexcept {
+        float hungerAmount = static_cast<float>(HUNGER_RATE * hoursPassed);
+        float happinessAmount = static_cast<float>(HAPPINESS_RATE * hoursPassed);
+        float energyAmount = static_cast<float>(ENERGY_RATE * hoursPassed);
+
+        Stats result;
+        result.hunger = (stats.hunger > hungerAmount) ? (stats.hunger - hungerAmount) : 0.0f;
+        result.happiness = (stats.happiness > happinessAmount) ? (stats.happiness - happinessAmount) : 0.0f;
+
+        // Pet rests while away
+        float energy = stats.energy + energyAmount;
+        result.energy = (energy > maxStat) ? maxStat : energy;
+        return result;
+    }
+
+    size_t applyTimeEffectsBatch(const Columns& columns, int64_t nowSeconds) noexcept {
+        return APPLY(columns, nowSeconds);
+    }
+
+    bool isKernelSupported(Kernel kernel) noexcept {
+        switch (kernel) {
+#ifdef PET_TIME_DECAY_X86
+            case Kernel::Avx2:
+                return __builtin_cpu_supports("avx2");
+            case Kernel::Sse42:
+                return __builtin_cpu_supports("sse4.2");
+#endif
+            case Kernel::Portable:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    size_t applyTimeEffectsWith(Kernel kernel, const Columns& columns, int64_t nowSeconds) noexcept {
+        if (!isKernelSupported(kernel)) {
+            return applyPortable(columns, nowSeconds);
+        }
+        switch (kernel) {
+#ifdef PET_TIME_DECAY_X86
+            case Kernel::Avx2:
+                return applyAvx2(columns, nowSeconds);
+            case Kernel::Sse42:
+                return applySse42(columns, nowSeconds);
+#endif
+            default:
+                return applyPortable(columns, nowSeconds);
+        }
+    }
+
+    const char* getKernelName(Kernel kernel) noexcept {
+        switch (kernel) {
+            case Kernel::Avx2:
+                return "avx2";
+            case Kernel::Sse42:
+                return "sse4.2";
+            case Kernel::Portable:
+            default:
+                return "portable";
+        }
+    }
+
+    const char* getImplementationName() noexcept {
+#ifdef PET_TIME_DECAY_X86
+        if (APPLY == applyAvx2) {
+            return getKernelName(Kernel::Avx2);
+        }
+        if (APPLY == applySse42) {
+            return getKernelName(Kernel::Sse42);
+        }
+#endif
+        return getKernelName(Kernel::Portable);
+    }
+}
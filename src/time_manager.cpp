@@ -13,38 +13,30 @@ TimeManager::TimeManager(PetState& petState) noexcept
 }
 
 std::optional<std::string> TimeManager::applyTimeEffects() noexcept {
+    // Apply effects based on time passed; also updates the last interaction time
+    // ONLY if effects were actually applied. The message is built from the
+    // resulting stats, which are the same ones describeTimeEffects() reports
+    double hoursPassed = m_petState.applyElapsedTime(std::chrono::system_clock::now());
+    return formatTimeEffectsMessage(hoursPassed);
+}
+
+std::optional<std::string> TimeManager::describeTimeEffects() const noexcept {
     auto lastTime = m_petState.getLastInteractionTime();
     if (lastTime == std::chrono::system_clock::time_point{}) {
-        // First interaction, no effects to apply
         return std::nullopt;
     }
     
-    auto now = std::chrono::system_clock::now();
-    auto duration = now - lastTime;
-    
-    // Calculate hours passed
-    double hoursPassed = std::chrono::duration<double, std::ratio<3600, 1>>(duration).count();
-    
-    // For command-line mode, we need a higher threshold to avoid changes on frequent status checks
-    if (hoursPassed < GameConfig::Time::MIN_TIME_THRESHOLD) {  
-        // Less than threshold time, no significant effects
+    double hoursPassed = std::chrono::duration<double, std::ratio<3600, 1>>(
+        std::chrono::system_clock::now() - lastTime).count();
+    return formatTimeEffectsMessage(hoursPassed);
+}
+
+std::optional<std::string> TimeManager::formatTimeEffectsMessage(double hoursPassed) const noexcept {
+    if (hoursPassed <= 0.0) {
+        // First interaction or less than threshold time, no significant effects
         return std::nullopt;
     }
     
-    // Apply effects based on time passed
-    // Calculate raw decreases - rate is given per hour in config
-    float hungerDecrease = static_cast<float>(GameConfig::getHungerDecreaseRate() * hoursPassed);
-    float happinessDecrease = static_cast<float>(GameConfig::getHappinessDecreaseRate() * hoursPassed);
-    float energyIncrease = static_cast<float>(GameConfig::getEnergyIncreaseRate() * hoursPassed);
-    
-    // Apply the changes (these methods handle the capping at 0 or max)
-    m_petState.decreaseHunger(hungerDecrease);
-    m_petState.decreaseHappiness(happinessDecrease);
-    m_petState.increaseEnergy(energyIncrease); // Pet rests while away
-    
-    // Update last interaction time ONLY if we actually applied effects
-    m_petState.updateInteractionTime();
-    
     // Generate message if significant time has passed
     if (hoursPassed > GameConfig::Time::SIGNIFICANT_TIME_THRESHOLD) {
         std::string message;
@@ -0,0 +1,160 @@
+#include "../include/timing_wheel.h"
+#include <algorithm>
+#include <bit>
+
+TimingWheel::TimingWheel(int64_t now) noexcept
+    : m_now(now)
+{
+    m_heads.fill(NO_NODE);
+}
+
+void TimingWheel::schedule(uint32_t id, int64_t when) {
+    if (id >= m_nodes.size()) {
+        m_nodes.resize(static_cast<size_t>(id) + 1);
+    }
+
+    if (m_nodes[id].list != NO_LIST) {
+        unlink(id);
+    } else {
+        ++m_size;
+    }
+    m_nodes[id].when = when;
+    link(id, listFor(when));
+}
+
+bool TimingWheel::cancel(uint32_t id) noexcept {
+    if (!isScheduled(id)) {
+        return false;
+    }
+    unlink(id);
+    --m_size;
+    return true;
+}
+
+size_t TimingWheel::advance(int64_t now, const Callback& fire) {
+    // Timers scheduled in the past since the last advance
+    size_t fired = fireList(DUE_LIST, fire);
+
+    while (m_now < now) {
+        // Skip the seconds at which nothing fires or cascades
+        int64_t tick = nextEventTime();
+        if (tick > now) {
+            m_now = now;
+            break;
+        }
+        m_now = tick;
+        auto bits = static_cast<uint64_t>(tick);
+
+        // Bring down timers from every level whose slot starts at this tick, widest first
+        if ((bits & ((uint64_t{1} << (LEVEL_COUNT * SLOT_BITS)) - 1)) == 0) {
+            cascade(OVERFLOW_LIST);
+        }
+        for (size_t level = LEVEL_COUNT - 1; level > 0; --level) {
+            unsigned shift = static_cast<unsigned>(level) * SLOT_BITS;
+            if ((bits & ((uint64_t{1} << shift) - 1)) == 0) {
+                cascade(static_cast<uint32_t>(level * SLOT_COUNT + ((bits >> shift) & (SLOT_COUNT - 1))));
+            }
+        }
+
+        fired += fireList(static_cast<uint32_t>(bits & (SLOT_COUNT - 1)), fire);
+        fired += fireList(DUE_LIST, fire);
+    }
+    return fired;
+}
+
+int64_t TimingWheel::nextEventTime() const noexcept {
+    auto bits = static_cast<uint64_t>(m_now);
+    auto next = UINT64_MAX;
+
+    // Occupied slots of a level all lie ahead of the current one within its span,
+    // since earlier slots have already been fired or cascaded
+    for (size_t level = 0; level < LEVEL_COUNT; ++level) {
+        if (m_occupiedSlots[level] != 0) {
+            unsigned shift = static_cast<unsigned>(level) * SLOT_BITS;
+            uint64_t spanStart = bits & ~((uint64_t{1} << (shift + SLOT_BITS)) - 1);
+            uint64_t slot = static_cast<uint64_t>(std::countr_zero(m_occupiedSlots[level]));
+            next = std::min(next, spanStart + (slot << shift));
+        }
+    }
+    if (m_heads[OVERFLOW_LIST] != NO_NODE) {
+        unsigned shift = static_cast<unsigned>(LEVEL_COUNT) * SLOT_BITS;
+        next = std::min(next, (bits & ~((uint64_t{1} << shift) - 1)) + (uint64_t{1} << shift));
+    }
+    return next == UINT64_MAX ? INT64_MAX : static_cast<int64_t>(next);
+}
+
+uint32_t TimingWheel::listFor(int64_t when) const noexcept {
+    if (when <= m_now) {
+        return DUE_LIST;
+    }
+
+    // The highest bit in which the time differs from now selects the level
+    auto bits = static_cast<uint64_t>(when);
+    unsigned highestBit = static_cast<unsigned>(std::bit_width(bits ^ static_cast<uint64_t>(m_now))) - 1;
+    size_t level = highestBit / SLOT_BITS;
+    if (level >= LEVEL_COUNT) {
+        return OVERFLOW_LIST;
+    }
+
+    unsigned shift = static_cast<unsigned>(level) * SLOT_BITS;
+    return static_cast<uint32_t>(level * SLOT_COUNT + ((bits >> shift) & (SLOT_COUNT - 1)));
+}
+
+void TimingWheel::link(uint32_t id, uint32_t list) noexcept {
+    Node& node = m_nodes[id];
+    node.list = list;
+    node.prev = NO_NODE;
+    node.next = m_heads[list];
+    if (node.next != NO_NODE) {
+        m_nodes[node.next].prev = id;
+    }
+    m_heads[list] = id;
+    if (list < OVERFLOW_LIST) {
+        m_occupiedSlots[list / SLOT_COUNT] |= uint64_t{1} << (list % SLOT_COUNT);
+    }
+}
+
+void TimingWheel::unlink(uint32_t id) noexcept {
+    Node& node = m_nodes[id];
+    if (node.prev != NO_NODE) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_heads[node.list] = node.next;
+        if (node.next == NO_NODE && node.list < OVERFLOW_LIST) {
+            m_occupiedSlots[node.list / SLOT_COUNT] &= ~(uint64_t{1} << (node.list % SLOT_COUNT));
+        }
+    }
+    if (node.next != NO_NODE) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    node.list = NO_LIST;
+    node.prev = NO_NODE;
+    node.next = NO_NODE;
+}
+
+void TimingWheel::cascade(uint32_t list) noexcept {
+    uint32_t id = m_heads[list];
+    m_heads[list] = NO_NODE;
+    if (list < OVERFLOW_LIST) {
+        m_occupiedSlots[list / SLOT_COUNT] &= ~(uint64_t{1} << (list % SLOT_COUNT));
+    }
+
+    while (id != NO_NODE) {
+        uint32_t next = m_nodes[id].next;
+        link(id, listFor(m_nodes[id].when));
+        id = next;
+    }
+}
+
+size_t TimingWheel::fireList(uint32_t list, const Callback& fire) {
+    size_t fired = 0;
+    while (m_heads[list] != NO_NODE) {
+        uint32_t id = m_heads[list];
+        int64_t when = m_nodes[id].when;
+        unlink(id);
+        --m_size;
+        ++fired;
+        fire(id, when);
+    }
+    return fired;
+}
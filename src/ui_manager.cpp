@@ -1,5 +1,6 @@
 #include "../include/ui_manager.h"
 #include "../include/game_logic.h"
+#include "../include/stat_event_scheduler.h"
 #include <iostream>
 #include <algorithm>
 #include <format>
@@ -12,8 +13,10 @@ UIManager::UIManager(
     DisplayManager& displayManager,
     AchievementManager& achievementManager,
     InteractionManager& interactionManager,
-    TimeManager& timeManager) noexcept
-    : m_petState(petState)
+    TimeManager& timeManager,
+    std::ostream& out) noexcept
+    : CommandHandlerBase(out)
+    , m_petState(petState)
     , m_displayManager(displayManager)
     , m_achievementManager(achievementManager)
     , m_interactionManager(interactionManager)
@@ -33,17 +36,17 @@ void UIManager::initializeCommandHandlers() noexcept {
     
     // Add specific handlers for UIManager
     // Add help command for interactive mode
-    m_commandHandlers["help"] = [this](GameLogic& /* gameLogic */) -> void {
+    m_commandHandlers["help"] = [this](GameLogic& /* gameLogic */, const std::vector<std::string_view>& /* args */) -> void {
         // Call showHelp method
         this->showHelp();
     };
 }
 
 void UIManager::runInteractiveMode() noexcept {
-    // Apply time effects first
-    auto message = m_timeManager.applyTimeEffects();
+    // Report time effects; stats are evaluated on read, so nothing is applied
+    auto message = m_timeManager.describeTimeEffects();
     if (message) {
-        std::cout << *message << std::endl;
+        m_out << *message << std::endl;
     }
     
     // Display newly unlocked achievements
@@ -53,25 +56,28 @@ void UIManager::runInteractiveMode() noexcept {
     m_displayManager.clearScreen();
     m_displayManager.displayPetHeader();
     
+    // Predicted stat warnings, announced when the player returns to the prompt.
+    // Crossings before now were already reported above
+    auto nowSeconds = []() {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    };
+    StatEventScheduler statEvents(nowSeconds());
+    statEvents.reschedule(0, m_petState);
+    
     // Interactive loop
     std::string command;
     bool running = true;
-    auto lastTimeCheck = std::chrono::system_clock::now();
     
     while (running) {
-        std::cout << "> ";
+        m_out << "> ";
         std::getline(std::cin, command);
         
-        // Check if we need to apply time effects (every 5 minutes)
-        auto now = std::chrono::system_clock::now();
-        auto timeSinceLastCheck = std::chrono::duration<double, std::ratio<60, 1>>(now - lastTimeCheck).count();
-        if (timeSinceLastCheck >= 5.0) {  // 5 minutes
-            auto timeMessage = m_timeManager.applyTimeEffects();
-            if (timeMessage) {
-                std::cout << *timeMessage << std::endl;
-            }
-            lastTimeCheck = now;
-        }
+        // Each turn of the loop is its own unit of work
+        m_petState.beginTransaction();
+        
+        statEvents.advance(nowSeconds(), [this](uint32_t /* petId */, StatEvent event, int64_t /* when */) {
+            m_out << StatEventScheduler::getEventMessage(event) << std::endl;
+        });
         
         // Convert to lowercase
         std::string lowerCommand = command;
@@ -106,13 +112,16 @@ void UIManager::runInteractiveMode() noexcept {
             
             if (!args.empty()) {
                 if (!processCommand(args)) {
-                    std::cout << "Unknown command. Type 'help' for usage information." << std::endl;
+                    m_out << "Unknown command. Type 'help' for usage information." << std::endl;
                 }
             }
-            
-            // Save the pet state after each command
-            m_petState.save();
         }
+        
+        // Persist the turn's changes; a command run above only nests in this transaction
+        m_petState.commitTransaction();
+        
+        // Interactions move the anchors the predictions are based on
+        statEvents.reschedule(0, m_petState);
     }
 }
 
@@ -123,8 +132,8 @@ bool UIManager::processCommand(const std::vector<std::string_view>& args) noexce
     
     // Check if the command is "new" - we don't allow it in interactive mode
     if (args[0] == "new") {
-        std::cout << "The 'new' command is not available in interactive mode.\n";
-        std::cout << "Please exit the application and use 'pet new' from the command line." << std::endl;
+        m_out << "The 'new' command is not available in interactive mode.\n";
+        m_out << "Please exit the application and use 'pet new' from the command line." << std::endl;
         return true; // Return true to indicate the command was processed (even though rejected)
     }
     
@@ -138,19 +147,21 @@ bool UIManager::processCommand(const std::vector<std::string_view>& args) noexce
 }
 
 void UIManager::showHelp() const noexcept {
-    std::cout << "Virtual Pet Application\n"
+    m_out << "Virtual Pet Application\n"
               << "----------------------\n\n";
               
     // Category 1: Pet Interaction
-    std::cout << "Pet Interaction:\n"
+    m_out << "Pet Interaction:\n"
               << "  status       - Show pet status\n"
-              << "  feed         - Feed your pet\n"
-              << "  play         - Play with your pet\n"
+              << "  feed [--times N]\n"
+              << "               - Feed your pet, N times at once\n"
+              << "  play [--times N]\n"
+              << "               - Play with your pet, N times at once\n"
               << "  evolve       - Show evolution progress\n"
               << "  achievements - Show all achievements and progress\n\n";
               
     // Category 2: Interface Management
-    std::cout << "Interface Management:\n"
+    m_out << "Interface Management:\n"
               << "  clear        - Clear the screen\n"
               << "  help         - Show this help message\n"
               << "  exit         - Exit the application\n\n";
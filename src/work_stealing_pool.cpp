@@ -0,0 +1,123 @@
+#include "../include/work_stealing_pool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(size_t threadCount)
+    : m_ranges(threadCount == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threadCount)
+{
+    // Worker 0 is the thread calling parallelFor()
+    m_threads.reserve(m_ranges.size() - 1);
+    for (size_t worker = 1; worker < m_ranges.size(); ++worker) {
+        m_threads.emplace_back([this, worker]() { workerLoop(worker); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_started.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t taskCount, const Task& task) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    // Contiguous ranges, so each worker starts on its own part of the data
+    size_t workers = m_ranges.size();
+    for (size_t worker = 0; worker < workers; ++worker) {
+        auto begin = static_cast<uint32_t>(taskCount * worker / workers);
+        auto end = static_cast<uint32_t>(taskCount * (worker + 1) / workers);
+        m_ranges[worker].bounds.store(pack(begin, end), std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_active = m_threads.size();
+        ++m_generation;
+    }
+    m_started.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this]() { return m_active == 0; });
+    m_task = nullptr;
+}
+
+void WorkStealingPool::workerLoop(size_t worker) {
+    uint64_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_started.wait(lock, [&]() { return m_stopping || m_generation != seenGeneration; });
+        if (m_stopping) {
+            return;
+        }
+        seenGeneration = m_generation;
+
+        lock.unlock();
+        runTasks(worker);
+        lock.lock();
+
+        if (--m_active == 0) {
+            m_finished.notify_one();
+        }
+    }
+}
+
+void WorkStealingPool::runTasks(size_t worker) {
+    // Ranges only shrink or move between workers, so once every range is
+    // seen empty the remaining tasks all belong to running workers
+    do {
+        uint32_t task;
+        while (takeOwn(worker, task)) {
+            (*m_task)(task, worker);
+        }
+    } while (steal(worker));
+}
+
+bool WorkStealingPool::takeOwn(size_t worker, uint32_t& task) noexcept {
+    auto& bounds = m_ranges[worker].bounds;
+    uint64_t current = bounds.load(std::memory_order_acquire);
+    while (true) {
+        auto begin = static_cast<uint32_t>(current >> 32);
+        auto end = static_cast<uint32_t>(current);
+        if (begin >= end) {
+            return false;
+        }
+        if (bounds.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel)) {
+            task = begin;
+            return true;
+        }
+    }
+}
+
+bool WorkStealingPool::steal(size_t worker) noexcept {
+    size_t workers = m_ranges.size();
+    for (size_t offset = 1; offset < workers; ++offset) {
+        auto& bounds = m_ranges[(worker + offset) % workers].bounds;
+        uint64_t current = bounds.load(std::memory_order_acquire);
+        while (true) {
+            auto begin = static_cast<uint32_t>(current >> 32);
+            auto end = static_cast<uint32_t>(current);
+            if (begin >= end) {
+                break;
+            }
+
+            // Take the back half, rounded up so a single task can be stolen
+            uint32_t middle = begin + (end - begin) / 2;
+            if (bounds.compare_exchange_weak(current, pack(begin, middle), std::memory_order_acq_rel)) {
+                m_ranges[worker].bounds.store(pack(middle, end), std::memory_order_release);
+                m_steals.fetch_add(end - middle, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
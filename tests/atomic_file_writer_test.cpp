@@ -0,0 +1,63 @@
+#include "../include/atomic_file_writer.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <filesystem>
+
+// Writers in one process saving the same path at the same time must each
+// replace the file whole: no failed save, no mixed contents, no leftovers.
+
+int main() {
+    constexpr size_t THREAD_COUNT = 4;
+    constexpr size_t WRITES_PER_THREAD = 200;
+    constexpr size_t FILE_SIZE = 64 * 1024;
+
+    auto directory = std::filesystem::temp_directory_path() / "pet_atomic_file_writer_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    auto path = directory / "state";
+
+    std::atomic<size_t> failedWrites{0};
+    std::atomic<size_t> badReads{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t]() {
+            AtomicFileWriter writer(DurabilityPolicy::never());
+            std::vector<std::byte> data(FILE_SIZE, static_cast<std::byte>('A' + t));
+            for (size_t i = 0; i < WRITES_PER_THREAD; ++i) {
+                if (!writer.write(path, data)) {
+                    ++failedWrites;
+                }
+
+                // Whatever is in place must be one writer's complete contents
+                std::ifstream file(path, std::ios::binary);
+                std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                if (contents.size() != FILE_SIZE || std::count(contents.begin(), contents.end(), contents[0]) != static_cast<std::ptrdiff_t>(FILE_SIZE)) {
+                    ++badReads;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    size_t leftovers = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path() != path) {
+            ++leftovers;
+        }
+    }
+    std::filesystem::remove_all(directory);
+
+    if (failedWrites != 0 || badReads != 0 || leftovers != 0) {
+        std::cerr << failedWrites << " failed writes, " << badReads << " torn reads, "
+                  << leftovers << " leftover temporary files" << std::endl;
+        return 1;
+    }
+    return 0;
+}
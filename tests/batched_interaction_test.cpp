@@ -0,0 +1,129 @@
+#include "../include/pet_state.h"
+#include "../include/pet_record.h"
+#include "../include/name_table.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+
+// Feeding or playing N times at once must leave the pet exactly as N
+// single interactions do, even when the XP evolves it through several
+// levels or saturates, and must unlock the same achievements.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    void checkSameState(const PetState& expected, const PetState& actual, std::chrono::system_clock::time_point at,
+                        const std::string& what) {
+        check(actual.getXP() == expected.getXP(), what + ": XP");
+        check(actual.getEvolutionLevel() == expected.getEvolutionLevel(), what + ": evolution level");
+        auto expectedStats = expected.getStatsAt(at);
+        auto actualStats = actual.getStatsAt(at);
+        check(actualStats.hunger == expectedStats.hunger && actualStats.happiness == expectedStats.happiness &&
+              actualStats.energy == expectedStats.energy, what + ": stats");
+
+        const auto& expectedAchievements = expected.getAchievementSystem();
+        const auto& actualAchievements = actual.getAchievementSystem();
+        check(actualAchievements.getUnlockedBits() == expectedAchievements.getUnlockedBits(), what + ": unlocked achievements");
+        check(actualAchievements.getNewlyUnlockedBits() == expectedAchievements.getNewlyUnlockedBits(),
+              what + ": newly unlocked achievements");
+        for (size_t i = 0; i < AchievementSystem::getAchievementCount(); ++i) {
+            auto type = static_cast<AchievementType>(i);
+            check(actualAchievements.getProgress(type) == expectedAchievements.getProgress(type),
+                  what + ": progress of " + std::string(AchievementSystem::getName(type)));
+        }
+    }
+
+    /**
+     * @brief Start two identical pets from a record, so XP and level can be set independently
+     */
+    bool makePets(PetState& single, PetState& batched, uint32_t xp, EvolutionLevel level,
+                  std::chrono::system_clock::time_point last) {
+        NameTable names;
+        PetState initial;
+        initial.initialize("Rex");
+        PetRecord record = initial.toRecord(names);
+        record.xp = xp;
+        record.evolutionLevel = static_cast<uint8_t>(level);
+        record.lastInteractionMinutes = PetRecord::toMinutes(last);
+        record.hunger = 0;
+        record.happiness = PetRecord::STAT_ONE * 10;
+        return single.loadFromRecord(record, names) && batched.loadFromRecord(record, names);
+    }
+
+    void testBatch(bool feeding, uint32_t times, uint32_t xp, EvolutionLevel level, const std::string& what) {
+        auto start = std::chrono::time_point_cast<std::chrono::minutes>(std::chrono::system_clock::now());
+        auto now = start + std::chrono::hours(3);
+        PetState single;
+        PetState batched;
+        if (!makePets(single, batched, xp, level, start)) {
+            check(false, what + ": pets load");
+            return;
+        }
+
+        bool evolvedSingle = false;
+        for (uint32_t i = 0; i < times; ++i) {
+            evolvedSingle |= feeding ? single.applyFeeding(now) : single.applyPlaying(now);
+        }
+        bool evolvedBatched = feeding ? batched.applyFeeding(now, times) : batched.applyPlaying(now, times);
+
+        check(evolvedBatched == evolvedSingle, what + ": reports the same evolution");
+        checkSameState(single, batched, now + std::chrono::hours(1), what);
+    }
+
+    void testSaturation() {
+        auto start = std::chrono::time_point_cast<std::chrono::minutes>(std::chrono::system_clock::now());
+        auto now = start + std::chrono::hours(1);
+        PetState single;
+        PetState batched;
+        if (!makePets(single, batched, UINT32_MAX - 1000, EvolutionLevel::Egg, start)) {
+            check(false, "saturating pets load");
+            return;
+        }
+
+        // One batch crosses every level and runs past the top of the XP range
+        check(batched.applyFeeding(now, 100000), "saturating batch evolves the pet");
+        check(batched.getXP() == UINT32_MAX, "XP saturates");
+        check(batched.getEvolutionLevel() == EvolutionLevel::Ancient, "saturated pet is Ancient");
+        for (auto type : { AchievementType::Evolution, AchievementType::Master, AchievementType::Eternal }) {
+            check(batched.getAchievementSystem().isUnlocked(type),
+                  std::string(AchievementSystem::getName(type)) + " unlocks on the way");
+        }
+
+        for (int i = 0; i < 100000; ++i) {
+            single.applyFeeding(now);
+        }
+        checkSameState(single, batched, now + std::chrono::hours(1), "saturating batch");
+
+        // The largest batch is clamped rather than wrapping
+        batched.applyPlaying(now, UINT32_MAX);
+        check(batched.getXP() == UINT32_MAX, "XP stays saturated");
+        check(batched.getAchievementSystem().isUnlocked(AchievementType::Playful), "huge batch counts as play");
+    }
+}
+
+int main() {
+    for (bool feeding : { true, false }) {
+        std::string kind = feeding ? "feed" : "play";
+        testBatch(feeding, 1, 0, EvolutionLevel::Egg, kind + " once");
+        testBatch(feeding, 7, 0, EvolutionLevel::Egg, kind + " within a level");
+        testBatch(feeding, 500, 0, EvolutionLevel::Egg, kind + " through several levels");
+        testBatch(feeding, 5000, 0, EvolutionLevel::Egg, kind + " to the top level");
+        testBatch(feeding, 40, 100000, EvolutionLevel::Egg, kind + " with XP already past several levels");
+        testBatch(feeding, 300, 0, EvolutionLevel::Ancient, kind + " at the top level");
+    }
+    testSaturation();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Batched interaction checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "../include/pet_state.h"
+#include "../include/game_logic.h"
+#include "../include/ui_manager.h"
+#include "../include/command_parser.h"
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+
+// Every command runs as one PetState transaction: a command that changes
+// the pet writes exactly once, and repeating a read-only command writes nothing.
+// Interactive mode runs each of its commands the same way.
+
+namespace {
+    int failures = 0;
+
+    /**
+     * @brief Run one command and return the number of writes it made
+     */
+    uint64_t countWrites(CommandParser& parser, GameLogic& gameLogic, std::string_view command) {
+        auto& petState = gameLogic.getPetState();
+        uint64_t before = petState.getWriteCount();
+        std::vector<std::string_view> args{ command };
+        if (!parser.processCommand(args, gameLogic)) {
+            std::cerr << "Command not recognized: " << command << std::endl;
+            ++failures;
+        }
+        return petState.getWriteCount() - before;
+    }
+
+    void expectWrites(CommandParser& parser, GameLogic& gameLogic, std::string_view command, uint64_t expected) {
+        uint64_t writes = countWrites(parser, gameLogic, command);
+        if (writes != expected) {
+            std::cerr << "'" << command << "' made " << writes << " writes, expected " << expected << std::endl;
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "pet_command_write_count_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    auto statePath = directory / ".pet_state";
+
+    {
+        PetState initial;
+        initial.initialize("Rex");
+        if (!initial.saveToFile(statePath)) {
+            std::cerr << "Failed to create the test pet" << std::endl;
+            return 1;
+        }
+    }
+
+    PetState petState;
+    if (!petState.loadFromFile(statePath)) {
+        std::cerr << "Failed to load the test pet" << std::endl;
+        return 1;
+    }
+
+    std::ostringstream output;
+    auto gameLogic = std::make_shared<GameLogic>(petState, output);
+    gameLogic->initializeUIManager();
+    CommandParser parser(output, output);
+
+    // The first use of a command may record it for the Explorer achievement
+    for (std::string_view command : { "status", "evolve", "achievements", "help" }) {
+        countWrites(parser, *gameLogic, command);
+        expectWrites(parser, *gameLogic, command, 0);
+    }
+
+    // Interactions change the pet every time
+    for (std::string_view command : { "feed", "play", "feed", "play" }) {
+        expectWrites(parser, *gameLogic, command, 1);
+    }
+
+    expectWrites(parser, *gameLogic, "status", 0);
+
+    // The interactive loop commits each turn on its own, and leaves no transaction open
+    std::istringstream input("feed\nstatus\nplay\nexit\n");
+    auto* previousInput = std::cin.rdbuf(input.rdbuf());
+    expectWrites(parser, *gameLogic, "interactive", 2);
+    std::cin.rdbuf(previousInput);
+    if (gameLogic->getPetState().isInTransaction()) {
+        std::cerr << "Interactive mode left a transaction open" << std::endl;
+        ++failures;
+    }
+
+    std::filesystem::remove_all(directory);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+#include "../include/daemon_protocol.h"
+#include "../include/binary_schema.h"
+#include "../include/game_config.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Every message must decode to what was encoded, and a frame or payload
+// cut short at any byte must be reported as incomplete or rejected,
+// never decoded into something else.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    using namespace DaemonProtocol;
+
+    std::span<const std::byte> bytesOf(std::string_view text) {
+        return std::as_bytes(std::span(text.data(), text.size()));
+    }
+
+    /**
+     * @brief Parse a single message that fills the buffer, checking every shorter prefix is incomplete
+     */
+    bool parseWhole(const std::vector<std::byte>& buffer, MessageType expectedType, std::span<const std::byte>& payload,
+                    const std::string& what) {
+        bool prefixesIncomplete = true;
+        for (size_t length = 0; length < buffer.size(); ++length) {
+            MessageType type;
+            std::span<const std::byte> partial;
+            prefixesIncomplete &= parseMessage(std::span(buffer.data(), length), type, partial) == ParseResult::Incomplete;
+        }
+        check(prefixesIncomplete, what + ": truncated frames are incomplete");
+
+        MessageType type;
+        bool complete = parseMessage(buffer, type, payload) == ParseResult::Complete;
+        check(complete && type == expectedType && payload.size() + HEADER_SIZE == buffer.size(), what + ": frame parses");
+        return complete;
+    }
+
+    void testCommand() {
+        CommandRequest request{ 0x01020304, 77, CommandId::Play, COMMAND_WANT_TEXT, 0, 123456 };
+        std::vector<std::byte> buffer;
+        appendCommand(buffer, request);
+        check(buffer.size() == COMMAND_MESSAGE_SIZE, "command message size");
+
+        std::span<const std::byte> payload;
+        if (!parseWhole(buffer, MessageType::Command, payload, "command")) {
+            return;
+        }
+        CommandRequest decoded{};
+        check(decodeCommand(payload, decoded) && decoded.sequence == request.sequence && decoded.petId == request.petId &&
+              decoded.command == request.command && decoded.flags == request.flags && decoded.count == request.count,
+              "command round trip");
+        for (size_t length = 0; length < payload.size(); ++length) {
+            check(!decodeCommand(payload.first(length), decoded), "command payload of " + std::to_string(length) + " bytes is rejected");
+        }
+
+        // writeCommand() produces the same bytes in place
+        std::vector<std::byte> inPlace(COMMAND_MESSAGE_SIZE);
+        writeCommand(inPlace, request);
+        check(inPlace == buffer, "command written in place matches");
+    }
+
+    void testCommandResult() {
+        CommandResult result{ 42, Status::Ok, 5, 1, 0, 987654, 12.5f, 99.75f, 0.125f };
+        std::string_view text = "Rex is happy\n";
+        std::vector<std::byte> buffer;
+        appendCommandResult(buffer, result, text);
+        check(buffer.size() == COMMAND_RESULT_MESSAGE_SIZE + text.size(), "command result message size");
+
+        std::span<const std::byte> payload;
+        if (!parseWhole(buffer, MessageType::CommandResult, payload, "command result")) {
+            return;
+        }
+        CommandResult decoded{};
+        std::string_view decodedText;
+        check(decodeCommandResult(payload, decoded, decodedText) && decoded.sequence == result.sequence &&
+              decoded.status == result.status && decoded.evolutionLevel == result.evolutionLevel &&
+              decoded.evolved == result.evolved && decoded.xp == result.xp && decoded.hunger == result.hunger &&
+              decoded.happiness == result.happiness && decoded.energy == result.energy && decodedText == text,
+              "command result round trip");
+        for (size_t length = 0; length < COMMAND_RESULT_MESSAGE_SIZE - HEADER_SIZE; ++length) {
+            check(!decodeCommandResult(payload.first(length), decoded, decodedText),
+                  "command result payload of " + std::to_string(length) + " bytes is rejected");
+        }
+    }
+
+    void testOpenPet() {
+        std::vector<std::byte> buffer;
+        appendOpenPet(buffer, 9, "/tmp/some pet/rex.pet");
+        std::span<const std::byte> payload;
+        if (parseWhole(buffer, MessageType::OpenPet, payload, "open pet")) {
+            uint32_t sequence = 0;
+            std::string statePath;
+            check(decodeOpenPet(payload, sequence, statePath) && sequence == 9 && statePath == "/tmp/some pet/rex.pet",
+                  "open pet round trip");
+            for (size_t length = 0; length < payload.size(); ++length) {
+                check(!decodeOpenPet(payload.first(length), sequence, statePath),
+                      "open pet payload of " + std::to_string(length) + " bytes is rejected");
+            }
+        }
+
+        OpenPetResult result{ 10, Status::LoadFailed, 31337 };
+        buffer.clear();
+        appendPetOpened(buffer, result);
+        if (parseWhole(buffer, MessageType::PetOpened, payload, "pet opened")) {
+            OpenPetResult decoded{};
+            check(decodePetOpened(payload, decoded) && decoded.sequence == result.sequence &&
+                  decoded.status == result.status && decoded.petId == result.petId, "pet opened round trip");
+            for (size_t length = 0; length < payload.size(); ++length) {
+                check(!decodePetOpened(payload.first(length), decoded), "pet opened payload of " + std::to_string(length) + " bytes is rejected");
+            }
+        }
+    }
+
+    void testRequest() {
+        std::vector<std::string_view> args = { "feed", "--times", "", "3" };
+        auto payload = encodeRequest("/home/user/.pet state", args);
+        std::string statePath;
+        std::vector<std::string> decodedArgs;
+        check(decodeRequest(payload, statePath, decodedArgs) && statePath == "/home/user/.pet state" &&
+              decodedArgs == std::vector<std::string>{ "feed", "--times", "", "3" }, "request round trip");
+
+        // Cutting between arguments drops them; cutting inside one is an error
+        auto empty = encodeRequest("/pet", {});
+        size_t boundary = empty.size();
+        for (size_t length = 0; length < payload.size(); ++length) {
+            bool decoded = decodeRequest(std::span(payload.data(), length), statePath, decodedArgs);
+            if (decoded) {
+                check(length >= boundary, "truncated state path is rejected");
+            }
+        }
+        check(!decodeRequest(std::span(payload.data(), payload.size() - 1), statePath, decodedArgs),
+              "request cut inside its last argument is rejected");
+    }
+
+    void testFraming() {
+        // Several messages back to back parse one after another
+        std::vector<std::byte> buffer;
+        appendMessage(buffer, MessageType::Stdout, bytesOf("hello"));
+        appendMessage(buffer, MessageType::Exit, {});
+        appendMessage(buffer, MessageType::Stderr, bytesOf("oops"));
+
+        std::span<const std::byte> rest(buffer);
+        std::vector<MessageType> types;
+        MessageType type;
+        std::span<const std::byte> payload;
+        while (parseMessage(rest, type, payload) == ParseResult::Complete) {
+            types.push_back(type);
+            rest = rest.subspan(HEADER_SIZE + payload.size());
+        }
+        check((types == std::vector<MessageType>{ MessageType::Stdout, MessageType::Exit, MessageType::Stderr }) && rest.empty(),
+              "pipelined messages parse in order");
+
+        // A length over the limit is invalid as soon as the header is in
+        std::vector<std::byte> oversized(HEADER_SIZE);
+        BinarySchema::storeLE(oversized.data(), static_cast<uint32_t>(GameConfig::Daemon::MAX_MESSAGE_SIZE + 1));
+        check(parseMessage(oversized, type, payload) == ParseResult::Invalid, "oversized frame is invalid");
+    }
+
+    void testSocket() {
+#ifndef _WIN32
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            check(false, "socket pair");
+            return;
+        }
+
+        // Small messages go out in one write, larger ones in two
+        std::string large(5000, 'x');
+        check(sendMessage(fds[0], MessageType::Stdout, bytesOf("short")) &&
+              sendMessage(fds[0], MessageType::Stderr, bytesOf(large)), "messages are sent");
+        MessageType type;
+        std::vector<std::byte> payload;
+        check(receiveMessage(fds[1], type, payload) && type == MessageType::Stdout && payload.size() == 5,
+              "short message is received");
+        check(receiveMessage(fds[1], type, payload) && type == MessageType::Stderr && payload.size() == large.size(),
+              "large message is received");
+
+        // A frame cut short by the peer closing
+        std::vector<std::byte> frame;
+        appendMessage(frame, MessageType::Stdout, bytesOf("truncated"));
+        check(::send(fds[0], frame.data(), frame.size() - 3, 0) > 0, "partial frame is sent");
+        ::close(fds[0]);
+        check(!receiveMessage(fds[1], type, payload), "truncated frame is not received");
+        ::close(fds[1]);
+#endif
+    }
+}
+
+int main() {
+    testCommand();
+    testCommandResult();
+    testOpenPet();
+    testRequest();
+    testFraming();
+    testSocket();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Daemon protocol checks passed" << std::endl;
+    return 0;
+}
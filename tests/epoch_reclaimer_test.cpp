@@ -0,0 +1,167 @@
+#include "../include/epoch_reclaimer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <memory>
+
+// A retired object must not be freed while a guard that could have loaded
+// it is open, must be freed once no such guard is left, and readers
+// racing a writer must never see an object that was freed.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    constexpr uint64_t ALIVE = 0x0A11FE;
+
+    /**
+     * @brief Object that records its destruction
+     */
+    struct Tracked {
+        explicit Tracked(std::atomic<int>* freed, uint64_t value = 0) noexcept : freed(freed), value(value) {}
+        ~Tracked() {
+            state.store(0, std::memory_order_relaxed);
+            if (freed) {
+                freed->fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<int>* freed;
+        uint64_t value;
+        std::atomic<uint64_t> state{ ALIVE };
+    };
+
+    void testGuardBlocksReclaim() {
+        EpochReclaimer reclaimer(4);
+        EpochReclaimer::RetireList retired(reclaimer);
+        auto reader = reclaimer.registerReader();
+        check(reader.isValid(), "reader registers");
+
+        std::atomic<int> freed{0};
+        std::atomic<Tracked*> published{ new Tracked(&freed) };
+        {
+            EpochReclaimer::ReadGuard guard(reader);
+            Tracked* held = published.load();
+
+            // Unpublish and retire it while the guard holds it
+            retired.retire(std::unique_ptr<Tracked>(published.exchange(new Tracked(&freed))));
+            for (int i = 0; i < 10; ++i) {
+                retired.reclaim();
+            }
+            check(freed.load() == 0 && held->state.load() == ALIVE, "object is not freed while a guard is open");
+            check(retired.size() == 1, "held object stays retired");
+        }
+        retired.reclaim();
+        check(freed.load() == 1 && retired.size() == 0, "object is freed once the guard ended");
+
+        // A guard of another reader blocks it as well, and an idle reader does not
+        auto other = reclaimer.registerReader();
+        {
+            EpochReclaimer::ReadGuard guard(other);
+            retired.retire(std::unique_ptr<Tracked>(published.exchange(nullptr)));
+            retired.reclaim();
+            check(freed.load() == 1, "any reader's open guard blocks reclaiming");
+        }
+        retired.reclaim();
+        check(freed.load() == 2, "object is freed once every guard ended");
+    }
+
+    void testReaderSlots() {
+        EpochReclaimer reclaimer(2);
+        std::atomic<int> freed{0};
+        {
+            auto first = reclaimer.registerReader();
+            auto second = reclaimer.registerReader();
+            check(first.isValid() && second.isValid(), "readers up to the limit register");
+            check(!reclaimer.registerReader().isValid(), "reader over the limit is refused");
+        }
+        check(reclaimer.registerReader().isValid(), "slots of destroyed readers are reused");
+
+        // Destroying a list frees what it still holds
+        {
+            auto reader = reclaimer.registerReader();
+            EpochReclaimer::RetireList retired(reclaimer);
+            retired.retire(std::make_unique<Tracked>(&freed));
+            retired.retire(std::unique_ptr<Tracked>());
+            check(retired.size() == 1, "null objects are not retired");
+        }
+        check(freed.load() == 1, "destroyed list frees its objects");
+    }
+
+    void testConcurrentReaders() {
+        constexpr int READER_COUNT = 3;
+        constexpr uint64_t REPLACEMENTS = 20000;
+        EpochReclaimer reclaimer(READER_COUNT);
+        std::atomic<int> freed{0};
+        std::atomic<Tracked*> published{ new Tracked(&freed, 0) };
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> deadReads{0};
+        std::atomic<uint64_t> reads{0};
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < READER_COUNT; ++i) {
+            readers.emplace_back([&]() {
+                auto reader = reclaimer.registerReader();
+                uint64_t lastValue = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    EpochReclaimer::ReadGuard guard(reader);
+                    Tracked* object = published.load(std::memory_order_acquire);
+                    // Read twice with a pause, so a premature free has a window to show
+                    bool alive = object->state.load(std::memory_order_relaxed) == ALIVE;
+                    std::this_thread::yield();
+                    alive &= object->state.load(std::memory_order_relaxed) == ALIVE;
+                    if (!alive || object->value < lastValue) {
+                        deadReads.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    lastValue = object->value;
+                    reads.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        {
+            EpochReclaimer::RetireList retired(reclaimer);
+            for (uint64_t value = 1; value <= REPLACEMENTS; ++value) {
+                Tracked* old = published.exchange(new Tracked(&freed, value), std::memory_order_acq_rel);
+                retired.retire(std::unique_ptr<Tracked>(old));
+                if (value % 256 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            while (reads.load() < 1000) {
+                std::this_thread::yield();
+            }
+            stop.store(true);
+            for (auto& reader : readers) {
+                reader.join();
+            }
+            retired.reclaim();
+            check(retired.size() == 0, "everything is freed once the readers left");
+        }
+        delete published.load();
+
+        check(deadReads.load() == 0, "readers never see a freed object");
+        check(freed.load() == static_cast<int>(REPLACEMENTS + 1), "every object is freed exactly once");
+    }
+}
+
+int main() {
+    testGuardBlocksReclaim();
+    testReaderSlots();
+    testConcurrentReaders();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Epoch reclaimer checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "../include/pet_state.h"
+#include "../include/interaction_journal.h"
+#include "../include/binary_schema.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+// Replaying the journal must rebuild exactly the state the live
+// interactions produced, including their sub-second timing, and
+// journals written in the older whole-second format must still replay.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    void checkSameState(const PetState& expected, const PetState& actual, const std::string& what) {
+        check(actual.getXP() == expected.getXP(), what + ": XP");
+        check(actual.getEvolutionLevel() == expected.getEvolutionLevel(), what + ": evolution level");
+        check(actual.getHunger() == expected.getHunger(), what + ": hunger");
+        check(actual.getHappiness() == expected.getHappiness(), what + ": happiness");
+        check(actual.getEnergy() == expected.getEnergy(), what + ": energy");
+        check(actual.getLastInteractionTime() == expected.getLastInteractionTime(), what + ": last interaction time");
+    }
+
+    std::vector<std::byte> readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> chars((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::vector<std::byte> bytes(chars.size());
+        std::memcpy(bytes.data(), chars.data(), chars.size());
+        return bytes;
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::vector<std::byte>& bytes) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    bool hasMagic(const std::vector<std::byte>& bytes, const char (&magic)[9]) {
+        return bytes.size() >= 16 && std::memcmp(bytes.data(), magic, 8) == 0;
+    }
+
+    /**
+     * @brief Create a pet on disk and load it, as every session starts from the snapshot
+     */
+    bool createPet(const std::filesystem::path& statePath, PetState& petState) {
+        PetState initial;
+        initial.initialize("Rex");
+        initial.setDurabilityPolicy(DurabilityPolicy::never());
+        if (!initial.saveToFile(statePath) || !petState.loadFromFile(statePath)) {
+            std::cerr << "Failed to create the test pet" << std::endl;
+            return false;
+        }
+        petState.setDurabilityPolicy(DurabilityPolicy::never());
+        return true;
+    }
+
+    void testSubSecondReplay(const std::filesystem::path& directory) {
+        auto statePath = directory / "subsecond";
+        PetState live;
+        if (!createPet(statePath, live)) {
+            ++failures;
+            return;
+        }
+
+        using namespace std::chrono_literals;
+        auto now = live.getLastInteractionTime();
+        for (auto step : { 2h + 317ms, 5h + 901ms, 1h + 3ms }) {
+            now += step;
+            live.applyFeeding(now);
+            now += 1h + 250ms;
+            live.applyPlaying(now, 3);
+            now += 45min + 777ms;
+            live.applyElapsedTime(now);
+        }
+        check(live.commitInteractions(), "interactions are journaled");
+
+        auto journal = readFile(std::filesystem::path(statePath).concat(".journal"));
+        check(hasMagic(journal, "PETJRNL2"), "journal is written in the current format");
+
+        PetState replayed;
+        check(replayed.loadFromFile(statePath), "pet with a journal loads");
+        checkSameState(live, replayed, "sub-second replay");
+    }
+
+    void testLegacyJournal(const std::filesystem::path& directory) {
+        auto statePath = directory / "legacy";
+        auto journalPath = std::filesystem::path(statePath).concat(".journal");
+        PetState live;
+        if (!createPet(statePath, live)) {
+            ++failures;
+            return;
+        }
+
+        // Whole seconds, which the legacy format can hold exactly
+        auto base = std::chrono::time_point_cast<std::chrono::seconds>(live.getLastInteractionTime());
+        auto feedTime = base + std::chrono::hours(3);
+        auto playTime = base + std::chrono::hours(7);
+        live.applyFeeding(feedTime);
+        live.applyPlaying(playTime, 3);
+        check(live.commitInteractions(), "interactions are journaled");
+
+        // The same records as a legacy journal: host-order sequence, times in
+        // seconds and the batch count packed above the time
+        auto current = readFile(journalPath);
+        if (!hasMagic(current, "PETJRNL2")) {
+            check(false, "journal is written in the current format");
+            return;
+        }
+        uint64_t firstSequence = BinarySchema::loadLE<uint64_t>(current.data() + 8);
+        auto seconds = [](auto time) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count());
+        };
+
+        std::vector<std::byte> legacy(16);
+        std::memcpy(legacy.data(), "PETJRNL1", 8);
+        std::memcpy(legacy.data() + 8, &firstSequence, sizeof(firstSequence));
+        InteractionJournal::encodeRecord(legacy, { JournalRecordType::Feed, seconds(feedTime) });
+        InteractionJournal::encodeRecord(legacy, { JournalRecordType::PlayBatch, (uint64_t{3} << 40) | seconds(playTime) });
+        writeFile(journalPath, legacy);
+
+        PetState replayed;
+        check(replayed.loadFromFile(statePath), "pet with a legacy journal loads");
+        checkSameState(live, replayed, "legacy replay");
+
+        // The next append converts the journal, keeping the legacy records
+        replayed.setDurabilityPolicy(DurabilityPolicy::never());
+        replayed.applyFeeding(playTime + std::chrono::hours(2) + std::chrono::milliseconds(640));
+        check(replayed.commitInteractions(), "interaction after a legacy journal is journaled");
+        check(hasMagic(readFile(journalPath), "PETJRNL2"), "legacy journal is converted on append");
+
+        PetState reloaded;
+        check(reloaded.loadFromFile(statePath), "pet with a converted journal loads");
+        checkSameState(replayed, reloaded, "converted journal replay");
+    }
+}
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "pet_interaction_journal_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    testSubSecondReplay(directory);
+    testLegacyJournal(directory);
+
+    std::filesystem::remove_all(directory);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Interaction journal checks passed" << std::endl;
+    return 0;
+}
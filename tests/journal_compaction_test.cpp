@@ -0,0 +1,64 @@
+#include "../include/pet_state.h"
+#include "../include/game_config.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+
+// A save made while the journal is being compacted must win: the compactor's
+// older snapshot may not replace it, and no committed interaction may be lost.
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "pet_journal_compaction_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    auto statePath = directory / ".pet_state";
+    auto journalPath = statePath;
+    journalPath += ".journal";
+
+    int failures = 0;
+
+    PetState petState;
+    petState.initialize("Rex");
+    petState.setDurabilityPolicy(DurabilityPolicy::never());
+    if (!petState.saveToFile(statePath)) {
+        std::cerr << "Failed to create the test pet" << std::endl;
+        return 1;
+    }
+
+    auto now = std::chrono::system_clock::now();
+    for (int round = 0; round < 3; ++round) {
+        // Commit interactions until one of them starts a compaction
+        std::error_code error;
+        do {
+            now += std::chrono::seconds(1);
+            petState.applyFeeding(now);
+            if (!petState.commitInteractions()) {
+                std::cerr << "Commit failed" << std::endl;
+                return 1;
+            }
+        } while (std::filesystem::file_size(journalPath, error) < GameConfig::Persistence::JOURNAL_COMPACTION_THRESHOLD);
+
+        // Save a change the compactor's snapshot does not have while it runs
+        std::string name = "Round " + std::to_string(round);
+        petState.setName(name);
+        if (!petState.save()) {
+            std::cerr << "Save failed" << std::endl;
+            return 1;
+        }
+
+        PetState reloaded;
+        if (!reloaded.loadFromFile(statePath)) {
+            std::cerr << "Failed to reload the pet" << std::endl;
+            return 1;
+        }
+        if (reloaded.getName() != name || reloaded.getXP() != petState.getXP()) {
+            std::cerr << "Round " << round << ": reloaded '" << reloaded.getName() << "' with " << reloaded.getXP()
+                      << " XP, expected '" << name << "' with " << petState.getXP() << " XP" << std::endl;
+            ++failures;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+    return failures == 0 ? 0 : 1;
+}
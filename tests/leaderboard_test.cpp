@@ -0,0 +1,133 @@
+#include "../include/leaderboard.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+// Rankings, pages and ranks must equal those of sorting every pet from
+// scratch, ties broken by pet ID, through updates, removals and a save
+// and load. A damaged leaderboard file must be rejected.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    using Entry = Leaderboard::Entry;
+
+    std::vector<uint64_t> ids(const std::vector<Entry>& entries) {
+        std::vector<uint64_t> result;
+        for (const auto& entry : entries) {
+            result.push_back(entry.petId);
+        }
+        return result;
+    }
+
+    void checkRankings(const Leaderboard& leaderboard, const std::map<uint64_t, Entry>& reference, const std::string& what) {
+        std::vector<Entry> byXP;
+        for (const auto& [petId, entry] : reference) {
+            byXP.push_back(entry);
+        }
+        std::vector<Entry> byAge = byXP;
+        std::sort(byXP.begin(), byXP.end(), [](const Entry& a, const Entry& b) {
+            return a.xp != b.xp ? a.xp > b.xp : a.petId < b.petId;
+        });
+        std::sort(byAge.begin(), byAge.end(), [](const Entry& a, const Entry& b) {
+            return a.birthSeconds != b.birthSeconds ? a.birthSeconds < b.birthSeconds : a.petId < b.petId;
+        });
+
+        check(leaderboard.size() == reference.size(), what + ": size");
+        check(ids(leaderboard.getTopXP(byXP.size())) == ids(byXP), what + ": XP ranking");
+        check(ids(leaderboard.getOldest(byAge.size())) == ids(byAge), what + ": age ranking");
+
+        // Pages, including one that runs past the end
+        for (size_t offset : { size_t{0}, size_t{7}, byXP.size() / 2, byXP.size() - std::min<size_t>(byXP.size(), 3) }) {
+            size_t end = std::min(byXP.size(), offset + 10);
+            std::vector<Entry> page(byXP.begin() + static_cast<std::ptrdiff_t>(std::min(offset, end)),
+                                    byXP.begin() + static_cast<std::ptrdiff_t>(end));
+            check(ids(leaderboard.getTopXP(10, offset)) == ids(page), what + ": XP page at " + std::to_string(offset));
+        }
+        check(leaderboard.getTopXP(10, byXP.size() + 5).empty(), what + ": page past the end is empty");
+
+        bool ranksMatch = true;
+        for (size_t i = 0; i < byXP.size(); ++i) {
+            ranksMatch &= leaderboard.getXPRank(byXP[i].petId) == i + 1;
+            ranksMatch &= leaderboard.getAgeRank(byAge[i].petId) == i + 1;
+        }
+        check(ranksMatch, what + ": ranks");
+
+        // Values are reported as last updated
+        auto top = leaderboard.getTopXP(1);
+        check(top.empty() || (top[0].xp == byXP[0].xp && top[0].birthSeconds == byXP[0].birthSeconds),
+              what + ": entry values");
+    }
+}
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "pet_leaderboard_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    std::mt19937_64 random(20);
+    Leaderboard leaderboard;
+    std::map<uint64_t, Entry> reference;
+
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 500; ++i) {
+            // Few distinct values, so ties are common; birth dates on both sides of the epoch
+            uint64_t petId = random() % 800;
+            if (random() % 5 == 0) {
+                check(leaderboard.remove(petId) == (reference.erase(petId) != 0), "remove reports whether the pet was ranked");
+                continue;
+            }
+            Entry entry{ petId, static_cast<uint32_t>(random() % 50) * 1000, static_cast<int64_t>(random() % 200) - 100 };
+            if (random() % 50 == 0) {
+                entry.xp = UINT32_MAX;
+            }
+            leaderboard.update(entry);
+            reference[petId] = entry;
+        }
+        checkRankings(leaderboard, reference, "round " + std::to_string(round));
+        check(!leaderboard.getXPRank(1000) && !leaderboard.contains(1000), "unknown pet has no rank");
+    }
+
+    auto path = directory / "leaderboard";
+    check(leaderboard.save(path), "leaderboard saves");
+    Leaderboard loaded;
+    check(loaded.load(path), "leaderboard loads");
+    checkRankings(loaded, reference, "loaded");
+
+    // Flip one byte of the entries
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(40);
+        char byte = 0;
+        file.read(&byte, 1);
+        byte = static_cast<char>(byte ^ 0x10);
+        file.seekp(40);
+        file.write(&byte, 1);
+    }
+    check(!loaded.load(path) && loaded.size() == 0, "damaged leaderboard is rejected and left empty");
+
+    leaderboard.clear();
+    reference.clear();
+    checkRankings(leaderboard, reference, "cleared");
+
+    std::filesystem::remove_all(directory);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Leaderboard checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include "../include/pet_daemon.h"
+#include "../include/daemon_client.h"
+#include "../include/daemon_protocol.h"
+#include "../include/binary_schema.h"
+#include "../include/pet_state.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// A resident daemon must run forwarded command lines and pipelined binary
+// commands on its loaded pets, answer in request order, and leave the
+// state file holding what its last command reported. Reads answered from
+// a pet's snapshot must report what running them on its shard reports.
+
+#ifndef _WIN32
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    bool createPet(const std::filesystem::path& statePath) {
+        PetState petState;
+        petState.initialize("Rex");
+        petState.setDurabilityPolicy(DurabilityPolicy::never());
+        return petState.saveToFile(statePath);
+    }
+
+    /**
+     * @brief Run a command line through the daemon as `pet` forwards it
+     * @return Exit code, -1 if the command has to run locally, -2 if the connection failed
+     */
+    int forward(const std::filesystem::path& socketPath, const std::filesystem::path& statePath,
+                const std::vector<std::string_view>& args, std::string& out) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::string path = socketPath.string();
+        std::copy(path.begin(), path.end(), address.sun_path);
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            !DaemonProtocol::sendMessage(fd, DaemonProtocol::MessageType::Request, DaemonProtocol::encodeRequest(statePath, args))) {
+            ::close(fd);
+            return -2;
+        }
+
+        int exitCode = -2;
+        DaemonProtocol::MessageType type;
+        std::vector<std::byte> payload;
+        while (exitCode == -2 && DaemonProtocol::receiveMessage(fd, type, payload)) {
+            if (type == DaemonProtocol::MessageType::Stdout) {
+                out.append(reinterpret_cast<const char*>(payload.data()), payload.size());
+            } else if (type == DaemonProtocol::MessageType::Exit && payload.size() == sizeof(int32_t)) {
+                exitCode = BinarySchema::loadLE<int32_t>(payload.data());
+            } else if (type == DaemonProtocol::MessageType::RunLocally) {
+                exitCode = -1;
+            }
+        }
+        ::close(fd);
+        return exitCode;
+    }
+
+    void testForwarding(const std::filesystem::path& socketPath, const std::filesystem::path& directory) {
+        std::string out;
+        check(forward(socketPath, directory / "rex.pet", { "status" }, out) == 0, "forwarded status succeeds");
+        check(out.find("Rex") != std::string::npos, "forwarded status prints the pet");
+
+        out.clear();
+        check(forward(socketPath, directory / "missing.pet", { "status" }, out) == -1,
+              "command for a pet that does not exist runs locally");
+    }
+
+    void testPipelinedCommands(const std::filesystem::path& socketPath, const std::filesystem::path& statePath,
+                               DaemonProtocol::CommandResult& last) {
+        DaemonConnection connection;
+        if (!connection.connect(socketPath)) {
+            check(false, "client connects");
+            return;
+        }
+        auto petId = connection.openPet(statePath);
+        check(petId.has_value(), "pet opens");
+        check(connection.openPet(statePath) == petId, "opening a pet again gives the same ID");
+        check(!connection.openPet(statePath.parent_path() / "missing.pet"), "missing pet does not open");
+        if (!petId) {
+            return;
+        }
+
+        // Every request goes out before any result is read
+        std::vector<uint32_t> sequences;
+        for (int i = 0; i < 60; ++i) {
+            auto command = i % 3 == 0 ? DaemonProtocol::CommandId::Play :
+                           i % 3 == 1 ? DaemonProtocol::CommandId::Feed : DaemonProtocol::CommandId::Status;
+            sequences.push_back(connection.sendCommand(*petId, command, 1 + i % 4));
+        }
+        uint32_t unknown = connection.sendCommand(*petId + 1000, DaemonProtocol::CommandId::Status);
+        check(connection.getPendingCount() == sequences.size() + 1, "requests are in flight");
+
+        uint32_t previousXP = 0;
+        bool inOrder = true;
+        bool allOk = true;
+        bool xpRises = true;
+        for (uint32_t sequence : sequences) {
+            DaemonProtocol::CommandResult result{};
+            if (!connection.receive(result)) {
+                check(false, "result arrives");
+                return;
+            }
+            inOrder &= result.sequence == sequence;
+            allOk &= result.status == DaemonProtocol::Status::Ok;
+            xpRises &= result.xp >= previousXP;
+            previousXP = result.xp;
+            last = result;
+        }
+        check(inOrder, "results come back in request order");
+        check(allOk, "commands succeed");
+        check(xpRises && previousXP > 0, "XP grows with the commands");
+
+        DaemonProtocol::CommandResult result{};
+        check(connection.receive(result) && result.sequence == unknown && result.status == DaemonProtocol::Status::UnknownPet,
+              "command for an unknown pet ID fails alone");
+        check(connection.getPendingCount() == 0, "every result is received");
+    }
+
+    bool sameResult(const DaemonProtocol::CommandResult& a, const DaemonProtocol::CommandResult& b) {
+        return a.status == b.status && a.evolutionLevel == b.evolutionLevel && a.evolved == b.evolved && a.xp == b.xp &&
+               a.hunger == b.hunger && a.happiness == b.happiness && a.energy == b.energy;
+    }
+
+    void testSnapshotReads(PetDaemon& daemon, const std::filesystem::path& socketPath, const std::filesystem::path& statePath) {
+        DaemonConnection connection;
+        auto petId = connection.connect(socketPath) ? connection.openPet(statePath) : std::nullopt;
+        if (!petId) {
+            check(false, "pet opens for snapshot reads");
+            return;
+        }
+
+        for (auto command : { DaemonProtocol::CommandId::Status, DaemonProtocol::CommandId::Evolve,
+                              DaemonProtocol::CommandId::Achievements }) {
+            // A command that changes the pet runs on the shard and publishes a new snapshot
+            DaemonProtocol::CommandResult fed{};
+            connection.sendCommand(*petId, DaemonProtocol::CommandId::Feed, 2);
+            check(connection.receive(fed) && fed.status == DaemonProtocol::Status::Ok, "feed succeeds");
+
+            // A command's first use and status announcing achievements write the pet, so run it once on the shard
+            DaemonProtocol::CommandResult first{};
+            std::string_view text;
+            connection.sendCommand(*petId, command, 1, DaemonProtocol::COMMAND_WANT_TEXT);
+            check(connection.receive(first, &text) && !text.empty(), "shard read arrives with its text");
+
+            // Without text the read is answered from the snapshot; asking for text runs it on the shard
+            uint64_t snapshotReads = daemon.getSnapshotReadCount();
+            DaemonProtocol::CommandResult fromSnapshot{};
+            connection.sendCommand(*petId, command);
+            check(connection.receive(fromSnapshot), "snapshot read arrives");
+            check(daemon.getSnapshotReadCount() == snapshotReads + 1, "read-only command is answered from the snapshot");
+
+            DaemonProtocol::CommandResult fromShard{};
+            connection.sendCommand(*petId, command, 1, DaemonProtocol::COMMAND_WANT_TEXT);
+            check(connection.receive(fromShard, &text) && !text.empty(), "shard read arrives with its text");
+            check(daemon.getSnapshotReadCount() == snapshotReads + 1, "command wanting text runs on the shard");
+
+            check(sameResult(fromSnapshot, fromShard), "snapshot and shard report the same values");
+            check(fromSnapshot.xp >= fed.xp && fromSnapshot.hunger == fed.hunger, "snapshot holds the last command's state");
+        }
+    }
+}
+#endif
+
+int main() {
+#ifdef _WIN32
+    std::cout << "Pet daemon checks skipped: no Unix domain sockets" << std::endl;
+    return 0;
+#else
+    auto directory = std::filesystem::temp_directory_path() / "pet_daemon_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    auto socketPath = directory / "daemon.sock";
+    auto statePath = directory / "rex.pet";
+
+    if (!createPet(statePath) || !createPet(directory / "snapshot.pet")) {
+        std::cerr << "Failed to create the test pet" << std::endl;
+        return 1;
+    }
+
+    PetDaemon daemon(socketPath, 2);
+    if (!daemon.start()) {
+        std::cerr << "Failed to start the daemon" << std::endl;
+        return 1;
+    }
+    std::thread server([&daemon]() { daemon.serve(); });
+
+    DaemonProtocol::CommandResult last{};
+    testForwarding(socketPath, directory);
+    testPipelinedCommands(socketPath, statePath, last);
+    testSnapshotReads(daemon, socketPath, directory / "snapshot.pet");
+
+    daemon.stop();
+    server.join();
+    check(!std::filesystem::exists(socketPath), "stopped daemon removes its socket");
+
+    // Commands commit as they run, so the file holds the last reported state
+    PetState reloaded;
+    check(reloaded.loadFromFile(statePath), "pet loads after the daemon stopped");
+    check(reloaded.getXP() == last.xp && static_cast<uint8_t>(reloaded.getEvolutionLevel()) == last.evolutionLevel,
+          "state file holds the daemon's last XP and level");
+    auto stats = reloaded.getStatsAt(reloaded.getLastInteractionTime());
+    check(stats.hunger == last.hunger && stats.happiness == last.happiness && stats.energy == last.energy,
+          "state file holds the daemon's last stats");
+
+    std::filesystem::remove_all(directory);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Pet daemon checks passed" << std::endl;
+    return 0;
+#endif
+}
@@ -0,0 +1,102 @@
+#include "../include/pet_population.h"
+#include "../include/pet_state.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// A pet copied into a PetPopulation must read the same through its view
+// as through PetState, and the view's mutators must follow PetState's
+// rules, evolving through several levels at once where XP allows.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    // Achievements addXP() unlocks; others also depend on progress PetPopulation does not keep
+    uint64_t evolutionBits(uint64_t bits) {
+        uint64_t mask = 0;
+        for (auto type : { AchievementType::Evolution, AchievementType::Master, AchievementType::Eternal }) {
+            mask |= uint64_t{1} << static_cast<size_t>(type);
+        }
+        return bits & mask;
+    }
+
+    void checkSame(const PetState& petState, const PetPopulation::ConstPetView& view, std::chrono::system_clock::time_point at,
+                   const std::string& what) {
+        check(view.getName() == petState.getName(), what + ": name");
+        check(view.getXP() == petState.getXP(), what + ": XP");
+        check(view.getEvolutionLevel() == petState.getEvolutionLevel(), what + ": evolution level");
+        check(view.getXPForNextLevel() == petState.getXPForNextLevel(), what + ": XP for next level");
+        check(view.getMaxStatValue() == petState.getMaxStatValue(), what + ": max stat");
+        check(view.getLastInteractionTime() == petState.getLastInteractionTime(), what + ": last interaction");
+
+        auto expected = petState.getStatsAt(at);
+        auto actual = view.getStatsAt(at);
+        check(actual.hunger == expected.hunger && actual.happiness == expected.happiness && actual.energy == expected.energy,
+              what + ": stats");
+        check(evolutionBits(view.getUnlockedAchievementBits()) ==
+              evolutionBits(petState.getAchievementSystem().getUnlockedBits()), what + ": evolution achievements");
+    }
+}
+
+int main() {
+    // Whole seconds, which is the resolution of the population's time column
+    auto start = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()) + std::chrono::hours(1);
+    auto later = start + std::chrono::hours(5) + std::chrono::minutes(17);
+
+    std::vector<PetState> pets(6);
+    PetPopulation population;
+    const uint32_t xpGains[] = { 0, 150, 1200, 5000, 40000, UINT32_MAX };
+    for (size_t i = 0; i < pets.size(); ++i) {
+        pets[i].initialize("Pet " + std::to_string(i));
+        pets[i].addXP(xpGains[i]);
+        pets[i].applyElapsedTime(start);
+        population.add(pets[i]);
+    }
+
+    const PetPopulation& constPopulation = population;
+    check(population.size() == pets.size(), "every pet is added");
+    for (size_t i = 0; i < pets.size(); ++i) {
+        checkSame(pets[i], constPopulation[i], later, "added pet " + std::to_string(i));
+    }
+
+    // The same changes through both interfaces, including XP that skips levels and saturates
+    const uint32_t xpSteps[] = { 99, 1, 800, 30000, UINT32_MAX / 2, UINT32_MAX };
+    for (uint32_t step : xpSteps) {
+        for (size_t i = 0; i < pets.size(); ++i) {
+            bool evolvedState = pets[i].addXP(step);
+            bool evolvedView = population[i].addXP(step);
+            check(evolvedState == evolvedView, "addXP(" + std::to_string(step) + ") reports the same evolution");
+        }
+    }
+    for (size_t i = 0; i < pets.size(); ++i) {
+        auto view = population[i];
+        float amount = static_cast<float>(i) * 7.5f;
+        pets[i].increaseHunger(amount);
+        view.increaseHunger(amount);
+        pets[i].decreaseHappiness(amount * 3.0f);
+        view.decreaseHappiness(amount * 3.0f);
+        pets[i].decreaseEnergy(1000.0f);
+        view.decreaseEnergy(1000.0f);
+        pets[i].increaseEnergy(amount);
+        view.increaseEnergy(amount);
+        checkSame(pets[i], constPopulation[i], later, "changed pet " + std::to_string(i));
+    }
+
+    check(population[pets.size() - 1].getXP() == UINT32_MAX, "XP saturates");
+    check(population[pets.size() - 1].getEvolutionLevel() == EvolutionLevel::Ancient, "saturated pet is Ancient");
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Pet population checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "../include/pet_record.h"
+#include "../include/pet_state.h"
+#include "../include/name_table.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+// A record converted to a PetState and back must come out byte for byte
+// the same. Converting a PetState rounds stats to the nearest 1/256 and
+// times down to the minute, and the record's integer time effects must
+// stay within that rounding of PetState's.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    bool sameRecord(const PetRecord& a, const PetRecord& b) {
+        return std::memcmp(&a, &b, sizeof(PetRecord)) == 0;
+    }
+
+    // A pet with achievements in every state: unlocked, newly unlocked, partly progressed
+    void makePet(PetState& petState, std::mt19937& random, std::chrono::system_clock::time_point start) {
+        petState.initialize("Pet " + std::to_string(random() % 50));
+        auto now = start;
+        for (uint32_t i = random() % 12; i > 0; --i) {
+            now += std::chrono::minutes(30 + random() % 600);
+            if (random() % 2 == 0) {
+                petState.applyFeeding(now, 1 + random() % 3);
+            } else {
+                petState.applyPlaying(now, 1 + random() % 3);
+            }
+        }
+        for (size_t i = 0; !AchievementSystem::getExplorerCommand(i).empty(); ++i) {
+            if (random() % 3 == 0) {
+                petState.trackCommand(std::string(AchievementSystem::getExplorerCommand(i)));
+            }
+        }
+        if (random() % 4 == 0) {
+            petState.unlockAchievement(AchievementType::Survivor);
+        }
+        petState.addXP(random() % 20000);
+    }
+
+    void testRecordRoundTrip() {
+        std::mt19937 random(16);
+        auto start = std::chrono::time_point_cast<std::chrono::minutes>(std::chrono::system_clock::now());
+        NameTable names;
+
+        for (int i = 0; i < 500; ++i) {
+            PetState source;
+            makePet(source, random, start);
+            PetRecord record = source.toRecord(names);
+
+            // Any fixed-point stat and minute, not only ones a PetState produces
+            record.hunger = static_cast<uint16_t>(random());
+            record.happiness = static_cast<uint16_t>(random());
+            record.energy = static_cast<uint16_t>(random());
+            record.lastInteractionMinutes = static_cast<uint32_t>(random() % (uint64_t{PetRecord::MAX_MINUTES} + 1));
+            record.birthDateMinutes = static_cast<uint32_t>(random() % (uint64_t{PetRecord::MAX_MINUTES} + 1));
+
+            PetState petState;
+            if (!petState.loadFromRecord(record, names)) {
+                check(false, "record loads");
+                continue;
+            }
+            check(sameRecord(petState.toRecord(names), record), "record round trip " + std::to_string(i));
+        }
+
+        // Later minutes than a time can hold clamp instead of overflowing
+        PetRecord late{};
+        late.lastInteractionMinutes = UINT32_MAX;
+        PetState latePet;
+        check(latePet.loadFromRecord(late, names) &&
+              latePet.toRecord(names).lastInteractionMinutes == PetRecord::MAX_MINUTES, "late minutes clamp");
+
+        PetRecord invalid{};
+        invalid.evolutionLevel = static_cast<uint8_t>(EvolutionLevel::Ancient) + 1;
+        PetState petState;
+        check(!petState.loadFromRecord(invalid, names), "record with an unknown evolution level is rejected");
+    }
+
+    void testStateRounding() {
+        std::mt19937 random(160);
+        auto start = std::chrono::system_clock::now();
+        NameTable names;
+
+        for (int i = 0; i < 500; ++i) {
+            PetState petState;
+            makePet(petState, random, start);
+            petState.decreaseHunger(static_cast<float>(random() % 10000) / 97.0f);
+            petState.decreaseEnergy(static_cast<float>(random() % 10000) / 89.0f);
+            auto at = petState.getLastInteractionTime();
+            auto stats = petState.getStatsAt(at);
+
+            PetRecord record = petState.toRecord(names);
+            auto near = [](uint16_t fixed, float value) {
+                return std::fabs(PetRecord::fromFixed(fixed) - value) <= 0.5f / PetRecord::STAT_ONE;
+            };
+            check(near(record.hunger, stats.hunger) && near(record.happiness, stats.happiness) &&
+                  near(record.energy, stats.energy), "stats round to the nearest 1/256");
+            check(PetRecord::fromMinutes(record.lastInteractionMinutes) ==
+                  std::chrono::floor<std::chrono::minutes>(at), "interaction time rounds down to the minute");
+            check(names.get(record.nameId) == petState.getName(), "name is interned");
+            check(record.xp == petState.getXP() &&
+                  record.evolutionLevel == static_cast<uint8_t>(petState.getEvolutionLevel()), "XP and level are kept");
+
+            for (size_t type = 0; type < AchievementSystem::getAchievementCount(); ++type) {
+                auto achievement = static_cast<AchievementType>(type);
+                uint32_t expected = std::min(petState.getAchievementSystem().getProgress(achievement),
+                                             AchievementSystem::getRequiredProgress(achievement));
+                if (petState.getAchievementSystem().isUnlocked(achievement)) {
+                    expected = AchievementSystem::getRequiredProgress(achievement);
+                }
+                check(record.getProgress(achievement) == expected, "progress of achievement " + std::to_string(type));
+            }
+        }
+    }
+
+    void testElapsedTime() {
+        std::mt19937 random(1600);
+        auto start = std::chrono::time_point_cast<std::chrono::minutes>(std::chrono::system_clock::now());
+        NameTable names;
+
+        for (int i = 0; i < 500; ++i) {
+            PetState petState;
+            makePet(petState, random, start);
+            auto last = std::chrono::time_point_cast<std::chrono::minutes>(petState.getLastInteractionTime());
+            petState.applyElapsedTime(last);
+
+            PetRecord record = petState.toRecord(names);
+            auto minutes = static_cast<uint32_t>(random() % (60 * 24 * 30));
+            bool changed = record.applyElapsedTime(record.lastInteractionMinutes + minutes);
+            check(changed == (minutes >= PetRecord::MIN_ELAPSED_MINUTES), "short absences leave the record alone");
+            if (!changed) {
+                continue;
+            }
+
+            // Half a step from converting the start, under one step from the integer decay
+            auto expected = petState.getStatsAt(last + std::chrono::minutes(minutes));
+            auto near = [](uint16_t fixed, float value) {
+                return std::fabs(PetRecord::fromFixed(fixed) - value) <= 1.5f / PetRecord::STAT_ONE;
+            };
+            check(near(record.hunger, expected.hunger) && near(record.happiness, expected.happiness) &&
+                  near(record.energy, expected.energy), "record decays like PetState over " + std::to_string(minutes) + " minutes");
+        }
+
+        PetRecord never{};
+        check(!never.applyElapsedTime(1'000'000), "record that never interacted is left alone");
+    }
+}
+
+int main() {
+    testRecordRoundTrip();
+    testStateRounding();
+    testElapsedTime();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Pet record checks passed" << std::endl;
+    return 0;
+}
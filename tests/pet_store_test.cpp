@@ -0,0 +1,145 @@
+#include "../include/pet_store.h"
+#include "../include/pet_state.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+// A record that outgrows its slot must never be lost: the new copy is
+// written first, and a store reopened after a crash between the two
+// writes keeps the moved copy only. The store is locked while open.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    constexpr uint64_t PET_ID = 7;
+
+    bool savePet(PetStore& store, const std::string& name) {
+        PetState petState;
+        petState.initialize(name);
+        return petState.saveToStore(store, PET_ID);
+    }
+
+    std::string loadName(PetStore& store) {
+        PetState petState;
+        return petState.loadFromStore(store, PET_ID) ? std::string(petState.getName()) : std::string();
+    }
+
+    PetStore::Slot readSlot(std::fstream& file, uint16_t index) {
+        PetStore::Slot slot{};
+        file.seekg(PetStore::PAGE_SIZE + sizeof(PetStore::PageHeader) + index * sizeof(PetStore::Slot));
+        file.read(reinterpret_cast<char*>(&slot), sizeof(slot));
+        return slot;
+    }
+
+    void writeSlot(std::fstream& file, uint16_t index, const PetStore::Slot& slot) {
+        file.seekp(PetStore::PAGE_SIZE + sizeof(PetStore::PageHeader) + index * sizeof(PetStore::Slot));
+        file.write(reinterpret_cast<const char*>(&slot), sizeof(slot));
+    }
+
+    void testRelocation(const std::filesystem::path& path) {
+        PetStore store;
+        check(store.open(path), "store opens");
+        std::string name = "Rex";
+        for (int i = 0; i < 20; ++i) {
+            name += "x";
+            check(savePet(store, name), "growing record is stored");
+        }
+        store.close();
+
+        check(store.open(path), "store reopens");
+        check(store.size() == 1, "relocations leave one record");
+        check(loadName(store) == name, "latest copy survives relocations");
+    }
+
+    void testInterruptedRelocation(const std::filesystem::path& path) {
+        {
+            PetStore store;
+            store.open(path);
+            savePet(store, "Rex");
+            savePet(store, "Rex the Second");
+        }
+
+        // Recreate the state a crash between writing the new copy and clearing
+        // the old one leaves: both slots live, the new one still flagged moved
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            auto oldSlot = readSlot(file, 0);
+            auto newSlot = readSlot(file, 1);
+            check(!(oldSlot.flags & PetStore::SLOT_LIVE) && (newSlot.flags & PetStore::SLOT_LIVE) &&
+                  !(newSlot.flags & PetStore::SLOT_MOVED), "completed move leaves only the new slot live");
+
+            oldSlot.petId = PET_ID;
+            oldSlot.length = oldSlot.capacity;
+            oldSlot.flags = PetStore::SLOT_LIVE;
+            newSlot.flags |= PetStore::SLOT_MOVED;
+            writeSlot(file, 0, oldSlot);
+            writeSlot(file, 1, newSlot);
+        }
+
+        for (int round = 0; round < 2; ++round) {
+            PetStore store;
+            check(store.open(path), "store with an interrupted move opens");
+            check(store.size() == 1, "interrupted move leaves one record");
+            check(loadName(store) == "Rex the Second", "interrupted move keeps the moved copy");
+        }
+
+        // Opening finished the move on disk
+        std::fstream file(path, std::ios::binary | std::ios::in);
+        auto oldSlot = readSlot(file, 0);
+        auto newSlot = readSlot(file, 1);
+        check(!(oldSlot.flags & PetStore::SLOT_LIVE), "open clears the old copy of an interrupted move");
+        check(newSlot.flags == PetStore::SLOT_LIVE, "open clears the moved flag");
+    }
+
+    void testLock(const std::filesystem::path& path) {
+#ifndef _WIN32
+        auto tryLock = [&path]() {
+            int fd = ::open(path.c_str(), O_RDWR);
+            bool locked = fd >= 0 && ::flock(fd, LOCK_EX | LOCK_NB) == 0;
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return locked;
+        };
+
+        PetStore store;
+        check(store.open(path), "store opens for locking");
+        check(!tryLock(), "open store is locked");
+        store.close();
+        check(tryLock(), "closed store is unlocked");
+#endif
+    }
+}
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "pet_store_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    testRelocation(directory / "relocation.store");
+    testInterruptedRelocation(directory / "interrupted.store");
+    testLock(directory / "lock.store");
+
+    std::filesystem::remove_all(directory);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Pet store checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "../include/population_aggregates.h"
+#include "../include/pet_population.h"
+#include "../include/pet_state.h"
+#include "../include/tick_engine.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <random>
+
+// The aggregates PetPopulation keeps by deltas must always equal the
+// aggregates recomputed from scratch over every pet, after any mix of
+// additions, view mutations, evolutions, batch time effects and ticks.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    bool sameLevelStats(const PopulationAggregates::LevelStats& a, const PopulationAggregates::LevelStats& b) {
+        return a.count == b.count && a.xpSum == b.xpSum && a.hungerSum == b.hungerSum &&
+               a.happinessSum == b.happinessSum && a.energySum == b.energySum &&
+               a.hungerWarnings == b.hungerWarnings && a.happinessWarnings == b.happinessWarnings &&
+               a.hungerHistogram == b.hungerHistogram && a.happinessHistogram == b.happinessHistogram &&
+               a.energyHistogram == b.energyHistogram;
+    }
+
+    void checkAggregates(const PetPopulation& population, const std::string& what) {
+        PopulationAggregates expected;
+        for (size_t i = 0; i < population.size(); ++i) {
+            expected.add(population.sample(i));
+        }
+
+        const auto& actual = population.getAggregates();
+        PopulationAggregates::LevelStats levelSum;
+        for (size_t level = 0; level < PopulationAggregates::LEVEL_COUNT; ++level) {
+            auto evolutionLevel = static_cast<EvolutionLevel>(level);
+            check(sameLevelStats(actual.getLevelStats(evolutionLevel), expected.getLevelStats(evolutionLevel)),
+                  what + ": level " + std::to_string(level) + " matches a recomputation");
+            levelSum += actual.getLevelStats(evolutionLevel);
+        }
+        check(sameLevelStats(actual.getTotalStats(), levelSum), what + ": totals are the sum of the levels");
+        check(actual.getTotalStats().count == static_cast<int64_t>(population.size()), what + ": every pet is counted");
+    }
+
+    void mutate(PetPopulation& population, std::mt19937& random, size_t count) {
+        for (size_t n = 0; n < count; ++n) {
+            auto view = population[random() % population.size()];
+            auto amount = static_cast<float>(random() % 4000) / 40.0f;
+            switch (random() % 9) {
+                case 0: view.addXP(random() % 5000); break;
+                case 1: view.increaseHunger(amount); break;
+                case 2: view.decreaseHunger(amount); break;
+                case 3: view.increaseHappiness(amount); break;
+                case 4: view.decreaseHappiness(amount); break;
+                case 5: view.increaseEnergy(amount); break;
+                case 6: view.decreaseEnergy(amount); break;
+                case 7: view.unlockAchievement(static_cast<AchievementType>(random() % AchievementSystem::getAchievementCount())); break;
+                default: view.updateInteractionTime(); break;
+            }
+        }
+    }
+}
+
+int main() {
+    std::mt19937 random(19);
+    auto now = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+
+    PetPopulation population;
+    checkAggregates(population, "empty population");
+
+    for (size_t i = 0; i < 3000; ++i) {
+        if (i % 10 == 0) {
+            PetState petState;
+            petState.initialize("Pet " + std::to_string(i));
+            petState.addXP(random() % 60000);
+            petState.decreaseHunger(static_cast<float>(random() % 100));
+            population.add(petState);
+        } else {
+            population.add("Pet " + std::to_string(i), now - std::chrono::minutes(random() % (60 * 24 * 10)));
+        }
+    }
+    checkAggregates(population, "added pets");
+
+    TickEngine engine(2, TickEngine::CHUNK_GRANULE);
+    for (int round = 0; round < 20; ++round) {
+        mutate(population, random, 2000);
+        checkAggregates(population, "round " + std::to_string(round) + " mutations");
+
+        now += std::chrono::minutes(random() % (60 * 30));
+        switch (round % 3) {
+            case 0:
+                population.applyTimeEffectsBatch(now);
+                break;
+            case 1:
+                engine.tick(population, now);
+                break;
+            default: {
+                // Ranges reporting into separate deltas, merged afterwards
+                int64_t nowSeconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+                size_t middle = population.size() / 3;
+                PopulationAggregates first;
+                PopulationAggregates second;
+                population.applyTimeEffectsRange(0, middle, nowSeconds, first);
+                population.applyTimeEffectsRange(middle, population.size(), nowSeconds, second);
+                population.getAggregates().merge(first);
+                population.getAggregates().merge(second);
+                break;
+            }
+        }
+        checkAggregates(population, "round " + std::to_string(round) + " time effects");
+        if (failures > 20) {
+            break;
+        }
+    }
+
+    population.clear();
+    checkAggregates(population, "cleared population");
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Population aggregates checks passed" << std::endl;
+    return 0;
+}
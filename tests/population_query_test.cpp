@@ -0,0 +1,252 @@
+#include "../include/population_query.h"
+#include "../include/pet_population.h"
+#include "../include/pet_state.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <cctype>
+
+// A query must match exactly the pets a plain per-pet evaluation of the
+// same predicate picks, whatever the chunking, kernels and threads. The
+// reference reads each pet through PetPopulation's views.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    using Clock = std::chrono::system_clock;
+
+    /**
+     * @brief Predicate tree, rendered as text for the query and evaluated directly for the reference
+     */
+    struct Node {
+        enum class Kind { Compare, Has, And, Or, Not } kind;
+        std::string field;
+        std::string op;
+        double value = 0.0;
+        std::string valueText;
+        AchievementType achievement = AchievementType::Count;
+        std::unique_ptr<Node> left;
+        std::unique_ptr<Node> right;
+    };
+
+    bool compare(double actual, const std::string& op, double value) {
+        if (op == "<") return actual < value;
+        if (op == "<=") return actual <= value;
+        if (op == ">") return actual > value;
+        if (op == ">=") return actual >= value;
+        if (op == "==") return actual == value;
+        return actual != value;
+    }
+
+    bool evaluate(const Node& node, const PetPopulation::ConstPetView& pet, Clock::time_point now) {
+        switch (node.kind) {
+            case Node::Kind::Compare: {
+                auto stats = pet.getStatsAt(now);
+                if (node.field == "level") return compare(static_cast<double>(pet.getEvolutionLevel()), node.op, node.value);
+                if (node.field == "xp") return compare(pet.getXP(), node.op, node.value);
+                // Stats are compared as floats, as the kernels do
+                if (node.field == "hunger") return compare(stats.hunger, node.op, static_cast<float>(node.value));
+                if (node.field == "happiness") return compare(stats.happiness, node.op, static_cast<float>(node.value));
+                if (node.field == "energy") return compare(stats.energy, node.op, static_cast<float>(node.value));
+                auto idle = std::chrono::duration_cast<std::chrono::seconds>(now - pet.getLastInteractionTime()).count();
+                return compare(static_cast<double>(idle), node.op, node.value);
+            }
+            case Node::Kind::Has:
+                return pet.isAchievementUnlocked(node.achievement);
+            case Node::Kind::And:
+                return evaluate(*node.left, pet, now) && evaluate(*node.right, pet, now);
+            case Node::Kind::Or:
+                return evaluate(*node.left, pet, now) || evaluate(*node.right, pet, now);
+            case Node::Kind::Not:
+                return !evaluate(*node.left, pet, now);
+        }
+        return false;
+    }
+
+    std::string render(const Node& node, std::mt19937& random) {
+        auto pick = [&random](std::initializer_list<const char*> spellings) {
+            return std::string(spellings.begin()[random() % spellings.size()]);
+        };
+        auto operand = [&](const Node& child, Node::Kind parent) {
+            // "and" binds tighter than "or", so only an "or" under an "and" or "not" needs parentheses
+            bool parenthesize = child.kind == Node::Kind::Or && parent != Node::Kind::Or;
+            parenthesize |= parent == Node::Kind::Not && child.kind == Node::Kind::And;
+            parenthesize |= random() % 5 == 0;
+            std::string text = render(child, random);
+            return parenthesize ? "(" + text + ")" : text;
+        };
+
+        switch (node.kind) {
+            case Node::Kind::Compare:
+                return node.field + " " + node.op + " " + node.valueText;
+            case Node::Kind::Has: {
+                // Names are one word in predicates, in any case
+                std::string name;
+                for (char c : AchievementSystem::getName(node.achievement)) {
+                    if (c != ' ') {
+                        name += random() % 2 ? static_cast<char>(std::tolower(static_cast<unsigned char>(c))) : c;
+                    }
+                }
+                return "has " + name;
+            }
+            case Node::Kind::And:
+                return operand(*node.left, node.kind) + pick({ " and ", " && " }) + operand(*node.right, node.kind);
+            case Node::Kind::Or:
+                return operand(*node.left, node.kind) + pick({ " or ", " || " }) + operand(*node.right, node.kind);
+            case Node::Kind::Not:
+                return pick({ "not ", "!" }) + operand(*node.left, node.kind);
+        }
+        return {};
+    }
+
+    std::unique_ptr<Node> makeComparison(std::mt19937& random) {
+        static const char* const OPERATORS[] = { "<", "<=", ">", ">=", "==", "!=" };
+        auto node = std::make_unique<Node>();
+        node->kind = Node::Kind::Compare;
+        node->op = OPERATORS[random() % 6];
+        switch (random() % 6) {
+            case 0: {
+                node->field = "level";
+                auto level = static_cast<uint8_t>(random() % 7);
+                node->value = level;
+                node->valueText = random() % 2 ? std::to_string(level) : std::string(PopulationQuery::getLevelName(level));
+                break;
+            }
+            case 1:
+                node->field = "xp";
+                node->value = random() % 30000;
+                node->valueText = std::to_string(static_cast<uint32_t>(node->value));
+                break;
+            case 2:
+            case 3:
+            case 4: {
+                const char* const STATS[] = { "hunger", "happiness", "energy" };
+                node->field = STATS[random() % 3];
+                node->value = static_cast<double>(random() % 1200) / 8.0;
+                node->valueText = std::to_string(node->value);
+                break;
+            }
+            default: {
+                node->field = "idle";
+                static const std::pair<const char*, double> UNITS[] = { { "s", 1 }, { "m", 60 }, { "h", 3600 }, { "d", 86400 }, { "", 3600 } };
+                const auto& [suffix, scale] = UNITS[random() % 5];
+                uint32_t amount = random() % 40;
+                node->value = amount * scale;
+                node->valueText = std::to_string(amount) + suffix;
+                break;
+            }
+        }
+        return node;
+    }
+
+    std::unique_ptr<Node> makePredicate(std::mt19937& random, int depth) {
+        uint32_t choice = depth == 0 ? random() % 4 : random() % 9;
+        if (choice < 3) {
+            return makeComparison(random);
+        }
+        auto node = std::make_unique<Node>();
+        if (choice == 3) {
+            node->kind = Node::Kind::Has;
+            node->achievement = static_cast<AchievementType>(random() % AchievementSystem::getAchievementCount());
+            return node;
+        }
+        node->kind = choice < 6 ? Node::Kind::And : choice < 8 ? Node::Kind::Or : Node::Kind::Not;
+        node->left = makePredicate(random, depth - 1);
+        if (node->kind != Node::Kind::Not) {
+            node->right = makePredicate(random, depth - 1);
+        }
+        return node;
+    }
+
+    void fillPopulation(PetPopulation& population, std::mt19937& random, Clock::time_point now) {
+        // Enough pets for several chunks and a partial last one
+        for (size_t i = 0; i < 3 * QueryEngine::CHUNK_SIZE + 777; ++i) {
+            if (i % 16 == 0) {
+                // Pets with achievements PetPopulation cannot unlock itself
+                PetState petState;
+                petState.initialize("Pet " + std::to_string(i));
+                for (size_t type = 0; type < AchievementSystem::getAchievementCount(); ++type) {
+                    if (random() % 3 == 0) {
+                        petState.unlockAchievement(static_cast<AchievementType>(type));
+                    }
+                }
+                petState.addXP(random() % 30000);
+                population.add(petState);
+                continue;
+            }
+
+            auto last = now - std::chrono::seconds(random() % (86400 * 40));
+            auto view = population[population.add("Pet " + std::to_string(i), last)];
+            view.addXP(random() % 30000);
+            view.decreaseHunger(static_cast<float>(random() % 1000) / 10.0f);
+            view.decreaseHappiness(static_cast<float>(random() % 1000) / 10.0f);
+            view.decreaseEnergy(static_cast<float>(random() % 1000) / 10.0f);
+        }
+    }
+}
+
+int main() {
+    std::mt19937 random(18);
+    // Whole seconds, the resolution of the query's idle times and decay
+    auto now = std::chrono::time_point_cast<std::chrono::seconds>(Clock::now()) + std::chrono::hours(2);
+
+    PetPopulation population;
+    fillPopulation(population, random, now);
+    const PetPopulation& pets = population;
+
+    QueryEngine engine(3);
+    int selective = 0;
+    for (int round = 0; round < 200; ++round) {
+        auto predicate = makePredicate(random, 3);
+        std::string text = render(*predicate, random);
+        std::string error;
+        auto query = PopulationQuery::compile(text, error);
+        if (!query) {
+            check(false, "'" + text + "' compiles: " + error);
+            continue;
+        }
+
+        std::vector<uint32_t> expected;
+        for (size_t i = 0; i < pets.size(); ++i) {
+            if (evaluate(*predicate, pets[i], now)) {
+                expected.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        auto result = engine.run(*query, population, now, true);
+        check(result.scanned == pets.size(), "'" + text + "' scans every pet");
+        check(result.matched == expected.size() && result.indices == expected,
+              "'" + text + "' matches " + std::to_string(result.matched) + " pets, expected " + std::to_string(expected.size()));
+        selective += !expected.empty() && expected.size() < pets.size();
+        if (failures > 20) {
+            break;
+        }
+    }
+
+    check(selective > 100, "most predicates match some pets but not all");
+
+    std::string error;
+    auto everything = PopulationQuery::compile("", error);
+    check(everything && engine.run(*everything, population, now, false).matched == pets.size(),
+          "empty predicate matches every pet");
+    for (const char* invalid : { "xp >", "level == Dragon", "hunger < 5 and", "(xp > 1", "has Nothing", "idle > 3y" }) {
+        check(!PopulationQuery::compile(invalid, error) && !error.empty(), std::string("'") + invalid + "' is rejected");
+    }
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Population query checks passed" << std::endl;
+    return 0;
+}
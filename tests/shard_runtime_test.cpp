@@ -0,0 +1,123 @@
+#include "../include/shard_runtime.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+
+// Tasks posted to a shard must all run, on that shard, and tasks one
+// thread posts to a shard must run in the order it posted them, however
+// many other threads post to the same queue at the same time.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    constexpr size_t SHARD_COUNT = 3;
+    constexpr size_t PRODUCER_COUNT = 6;
+    constexpr uint32_t TASKS_PER_PRODUCER = 30000;
+
+    /**
+     * @brief What one shard saw; only touched by the shard's own tasks
+     */
+    struct ShardLog {
+        std::vector<int64_t> lastSequence = std::vector<int64_t>(PRODUCER_COUNT, -1);
+        uint64_t tasks = 0;
+        bool ordered = true;
+        bool onShard = true;
+    };
+
+    void testOrderingUnderContention() {
+        std::vector<ShardLog> logs(SHARD_COUNT);
+        std::atomic<uint64_t> forwarded{0};
+        {
+            ShardRuntime runtime(SHARD_COUNT);
+            check(runtime.getShardCount() == SHARD_COUNT, "runtime has the requested shards");
+            check(runtime.getCurrentShard() == SHARD_COUNT, "test thread is not a shard");
+
+            std::atomic<bool> go{false};
+            std::vector<std::thread> producers;
+            for (size_t producer = 0; producer < PRODUCER_COUNT; ++producer) {
+                producers.emplace_back([&, producer]() {
+                    while (!go.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    for (uint32_t sequence = 0; sequence < TASKS_PER_PRODUCER; ++sequence) {
+                        size_t shard = runtime.getShardFor(sequence * 7 + producer);
+                        runtime.post(shard, [&, shard, producer, sequence]() {
+                            auto& log = logs[shard];
+                            log.ordered &= log.lastSequence[producer] < static_cast<int64_t>(sequence);
+                            log.lastSequence[producer] = sequence;
+                            log.onShard &= runtime.getCurrentShard() == shard;
+                            ++log.tasks;
+
+                            // Shards post to each other as well
+                            if (sequence % 100 == 0) {
+                                runtime.post((shard + 1) % SHARD_COUNT, [&forwarded]() {
+                                    forwarded.fetch_add(1, std::memory_order_relaxed);
+                                });
+                            }
+                        });
+                    }
+                });
+            }
+            go.store(true, std::memory_order_release);
+            for (auto& producer : producers) {
+                producer.join();
+            }
+
+            // Shards post while they run, so wait for those before the destructor runs what is queued
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+            while (forwarded.load() < PRODUCER_COUNT * TASKS_PER_PRODUCER / 100 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        uint64_t total = 0;
+        bool ordered = true;
+        bool onShard = true;
+        for (const auto& log : logs) {
+            total += log.tasks;
+            ordered &= log.ordered;
+            onShard &= log.onShard;
+        }
+        check(total == PRODUCER_COUNT * TASKS_PER_PRODUCER, "every posted task runs");
+        check(ordered, "each producer's tasks run in the order it posted them");
+        check(onShard, "tasks run on the shard they were posted to");
+        check(forwarded.load() == PRODUCER_COUNT * TASKS_PER_PRODUCER / 100, "tasks posted by shards run");
+    }
+
+    void testSleepingShard() {
+        // A shard that went to sleep must wake for each new task
+        ShardRuntime runtime(2);
+        std::atomic<int> done{0};
+        for (int i = 0; i < 50; ++i) {
+            runtime.post(static_cast<size_t>(i % 2), [&done]() { done.fetch_add(1); });
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (done.load() <= i && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+        check(done.load() == 50, "idle shards wake for new tasks");
+    }
+}
+
+int main() {
+    testOrderingUnderContention();
+    testSleepingShard();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Shard runtime checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include "../include/shared_ring.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+// Records must come out of the ring in order and intact however often
+// they wrap around its end, whether the consumer keeps up or the ring
+// fills, and closing the ring must wake a side that waits on it.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    using namespace std::chrono_literals;
+
+    // Small enough that records wrap every few writes
+    constexpr uint32_t CAPACITY = 256;
+
+    /**
+     * @brief Zeroed memory for a ring, aligned like the ring's control block
+     */
+    struct Region {
+        struct alignas(64) Line {
+            std::byte bytes[64];
+        };
+        std::vector<Line> lines;
+
+        explicit Region(uint32_t capacity) : lines(SharedRing::getRegionSize(capacity) / sizeof(Line) + 1) {
+            SharedRing::initialize(span(), capacity);
+        }
+
+        std::span<std::byte> span() noexcept {
+            return std::as_writable_bytes(std::span(lines));
+        }
+    };
+
+    // Record n holds its number, then bytes derived from it
+    void fillRecord(std::span<std::byte> record, uint32_t n) {
+        std::memcpy(record.data(), &n, sizeof(n));
+        for (size_t i = sizeof(n); i < record.size(); ++i) {
+            record[i] = static_cast<std::byte>(n * 31 + i);
+        }
+    }
+
+    bool checkRecord(std::span<const std::byte> record, uint32_t n, size_t size) {
+        if (record.size() != size) {
+            return false;
+        }
+        uint32_t stored = 0;
+        std::memcpy(&stored, record.data(), sizeof(stored));
+        for (size_t i = sizeof(n); i < record.size(); ++i) {
+            if (record[i] != static_cast<std::byte>(n * 31 + i)) {
+                return false;
+            }
+        }
+        return stored == n;
+    }
+
+    size_t recordSize(uint32_t n, size_t maxSize) {
+        return sizeof(uint32_t) + (n * 7919) % (maxSize - sizeof(uint32_t) + 1);
+    }
+
+    void testWraparound() {
+        Region region(CAPACITY);
+        SharedRing producer;
+        SharedRing consumer;
+        check(producer.attach(region.span()) && consumer.attach(region.span()), "ring attaches");
+        size_t maxSize = producer.getMaxRecordSize();
+        check(producer.beginWrite(maxSize + 1, 0ms).empty(), "record over the maximum is refused");
+
+        // Fill until full, then drain part of it, so both positions cross the end at every offset
+        uint32_t written = 0;
+        uint32_t read = 0;
+        bool intact = true;
+        for (int round = 0; round < 2000; ++round) {
+            for (;;) {
+                size_t size = recordSize(written, maxSize);
+                auto record = producer.beginWrite(maxSize, 0ms);
+                if (record.empty()) {
+                    break;
+                }
+                fillRecord(record.first(size), written++);
+                producer.endWrite(size);
+            }
+            for (int n = round % 3 + 1; n > 0 && read < written; --n) {
+                auto record = consumer.beginRead(0ms);
+                intact &= checkRecord(record, read, recordSize(read, maxSize));
+                consumer.endRead();
+                ++read;
+            }
+        }
+        while (read < written) {
+            auto record = consumer.beginRead(0ms);
+            intact &= checkRecord(record, read, recordSize(read, maxSize));
+            consumer.endRead();
+            ++read;
+        }
+        check(intact, "records wrap around intact and in order");
+        check(written > 10 * CAPACITY / maxSize, "ring wrapped many times");
+        check(consumer.beginRead(0ms).empty(), "drained ring is empty");
+    }
+
+    void testThreads() {
+        Region region(CAPACITY);
+        SharedRing producer;
+        SharedRing consumer;
+        producer.attach(region.span());
+        consumer.attach(region.span());
+        size_t maxSize = producer.getMaxRecordSize();
+        constexpr uint32_t RECORD_COUNT = 100000;
+
+        std::thread writer([&]() {
+            for (uint32_t n = 0; n < RECORD_COUNT; ++n) {
+                size_t size = recordSize(n, maxSize);
+                auto record = producer.beginWrite(size, 10s);
+                if (record.empty()) {
+                    return;
+                }
+                fillRecord(record, n);
+                producer.endWrite(size);
+            }
+        });
+
+        uint32_t received = 0;
+        bool intact = true;
+        while (received < RECORD_COUNT) {
+            auto record = consumer.beginRead(10s);
+            if (record.empty()) {
+                break;
+            }
+            intact &= checkRecord(record, received, recordSize(received, maxSize));
+            consumer.endRead();
+            ++received;
+        }
+        writer.join();
+        check(received == RECORD_COUNT, "every record crosses between threads");
+        check(intact, "records cross between threads intact and in order");
+    }
+
+    void testClose() {
+        Region region(CAPACITY);
+        SharedRing consumer;
+        SharedRing other;
+        consumer.attach(region.span());
+        other.attach(region.span());
+
+        auto start = std::chrono::steady_clock::now();
+        std::thread closer([&]() {
+            std::this_thread::sleep_for(50ms);
+            other.close();
+        });
+        check(consumer.beginRead(30s).empty(), "closed ring returns no record");
+        closer.join();
+        check(std::chrono::steady_clock::now() - start < 10s, "close wakes a waiting reader");
+        check(consumer.isClosed() && consumer.beginWrite(8, 0ms).empty(), "closed ring takes no records");
+
+        // A region that holds no ring does not attach
+        Region garbage(CAPACITY);
+        std::memset(garbage.span().data(), 0xA5, garbage.span().size());
+        SharedRing invalid;
+        check(!invalid.attach(garbage.span()), "region without a ring does not attach");
+    }
+}
+
+int main() {
+    testWraparound();
+    testThreads();
+    testClose();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Shared ring checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,269 @@
+#include "../include/pet_state.h"
+#include "../include/binary_schema.h"
+#include "../include/state_file_format.h"
+#include "../include/state_migrator.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <cstring>
+#include <iterator>
+#include <filesystem>
+
+// Legacy state files must keep loading the way they always have, while
+// migrate's format detection only claims files that parse exactly.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief Builds a state file byte by byte in the legacy sequential layout
+     */
+    struct LegacyFile {
+        std::vector<std::byte> bytes;
+
+        template <BinarySchema::Scalar T>
+        void put(T value) {
+            size_t offset = bytes.size();
+            bytes.resize(offset + sizeof(T));
+            BinarySchema::storeLE(bytes.data() + offset, value);
+        }
+
+        void putString(const std::string& text) {
+            for (char c : text) {
+                bytes.push_back(static_cast<std::byte>(c));
+            }
+        }
+
+        void writeTo(const std::filesystem::path& path) const {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+    };
+
+    LegacyFile makeV1(const std::string& name, uint32_t xp) {
+        LegacyFile file;
+        file.put<uint8_t>(1);
+        file.put(static_cast<uint16_t>(name.size()));
+        file.putString(name);
+        file.put<uint8_t>(static_cast<uint8_t>(EvolutionLevel::Child));
+        file.put(xp);
+        file.put<uint8_t>(50);
+        file.put<uint8_t>(60);
+        file.put<uint8_t>(70);
+        file.put<uint64_t>(1700000000);
+        return file;
+    }
+
+    /**
+     * @brief A version 4 file up to and including the achievement progress
+     * The caller appends the used-command count and entries.
+     */
+    LegacyFile makeV4Prefix(const std::string& name, uint32_t xp) {
+        LegacyFile file;
+        file.put<uint8_t>(4);
+        file.put(static_cast<uint16_t>(name.size()));
+        file.putString(name);
+        file.put<uint8_t>(static_cast<uint8_t>(EvolutionLevel::Child));
+        file.put(xp);
+        file.put(50.0f);
+        file.put(60.0f);
+        file.put(70.0f);
+        file.put<uint64_t>(1700000000);
+        file.put<uint64_t>(1690000000);
+        file.put<uint64_t>(0);
+        file.put<uint64_t>(0);
+        for (size_t i = 0; i < AchievementSystem::getAchievementCount(); ++i) {
+            file.put<uint32_t>(0);
+        }
+        return file;
+    }
+
+    void putCommand(LegacyFile& file, const std::string& command) {
+        file.put(static_cast<uint32_t>(command.size()));
+        file.putString(command);
+    }
+
+    void testLegacyDetection(const std::filesystem::path& directory) {
+        auto path = directory / "v1";
+        makeV1("Rex", 250).writeTo(path);
+
+        uint8_t version = 0;
+        check(PetState::peekFileVersion(path, version) && version == 1, "exact v1 file is detected");
+
+        PetState petState;
+        check(petState.loadFromFile(path), "exact v1 file loads");
+        check(petState.getName() == "Rex" && petState.getXP() == 250, "v1 name and XP survive loading");
+    }
+
+    void testLegacyTrailingBytes(const std::filesystem::path& directory) {
+        auto path = directory / "v1_trailing";
+        auto file = makeV1("Rex", 250);
+        file.put<uint8_t>(0);
+        file.writeTo(path);
+
+        // Loading accepts what older builds accepted ...
+        PetState petState;
+        check(petState.loadFromFile(path), "v1 file with trailing bytes still loads");
+        check(petState.getName() == "Rex" && petState.getXP() == 250, "trailing bytes do not disturb v1 fields");
+
+        // ... but migrate will not claim a file it cannot parse exactly
+        uint8_t version = 0;
+        check(!PetState::peekFileVersion(path, version), "v1 file with trailing bytes is not detected");
+    }
+
+    void testLegacyCommandCountIsClamped(const std::filesystem::path& directory) {
+        auto path = directory / "v4_many_commands";
+        auto file = makeV4Prefix("Rex", 250);
+        file.put<uint32_t>(150);
+        for (int i = 0; i < 100; ++i) {
+            putCommand(file, "feed");
+        }
+        file.writeTo(path);
+
+        PetState petState;
+        check(petState.loadFromFile(path), "v4 file with an over-limit command count loads");
+        check(petState.getName() == "Rex" && petState.getXP() == 250, "clamped command count keeps v4 fields");
+    }
+
+    void testLegacyLongCommandIsSkipped(const std::filesystem::path& directory) {
+        auto path = directory / "v4_long_command";
+        auto file = makeV4Prefix("Rex", 250);
+        file.put<uint32_t>(2);
+        // An implausible length is skipped without consuming its bytes,
+        // so the next entry is read from the bytes that follow it
+        file.put<uint32_t>(60);
+        putCommand(file, "play");
+        file.writeTo(path);
+
+        PetState petState;
+        check(petState.loadFromFile(path), "v4 file with an over-length command loads");
+        check(petState.getName() == "Rex" && petState.getXP() == 250, "skipped command keeps v4 fields");
+    }
+
+    void testNonStateFile(const std::filesystem::path& directory) {
+        auto path = directory / "notes.txt";
+        LegacyFile file;
+        file.putString("\x02 a text file that happens to start with a version byte\n");
+        file.writeTo(path);
+
+        uint8_t version = 0;
+        check(!PetState::peekFileVersion(path, version), "text file is not detected as a state file");
+    }
+
+    void testMigrationRoundTrip(const std::filesystem::path& directory) {
+        auto path = directory / "v4_migrate";
+        auto file = makeV4Prefix("Bella", 1234);
+        file.put<uint32_t>(2);
+        putCommand(file, "feed");
+        putCommand(file, "play");
+        file.writeTo(path);
+
+        uint8_t version = 0;
+        check(PetState::peekFileVersion(path, version) && version == 4, "exact v4 file is detected");
+
+        PetState legacy;
+        if (!legacy.loadFromFile(path)) {
+            check(false, "v4 file loads");
+            return;
+        }
+        legacy.setDurabilityPolicy(DurabilityPolicy::never());
+        check(legacy.saveToFile(path), "migrated file is saved");
+        check(PetState::peekFileVersion(path, version) && version == StateFileFormat::CURRENT_VERSION,
+              "migrated file is detected at the current version");
+
+        PetState migrated;
+        check(migrated.loadFromFile(path), "migrated file loads");
+        check(migrated.getName() == legacy.getName(), "name survives migration");
+        check(migrated.getXP() == legacy.getXP(), "XP survives migration");
+        check(migrated.getEvolutionLevel() == legacy.getEvolutionLevel(), "evolution level survives migration");
+        auto at = legacy.getLastInteractionTime();
+        check(migrated.getStatsAt(at).hunger == legacy.getStatsAt(at).hunger, "hunger survives migration");
+    }
+
+    std::vector<std::byte> readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> chars((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::vector<std::byte> bytes(chars.size());
+        std::memcpy(bytes.data(), chars.data(), chars.size());
+        return bytes;
+    }
+
+    void testMigrator(const std::filesystem::path& directory) {
+        auto root = directory / "tree";
+        std::filesystem::create_directories(root / "nested");
+
+        makeV1("Rex", 250).writeTo(root / "rex");
+        auto v4 = makeV4Prefix("Bella", 1234);
+        v4.put<uint32_t>(1);
+        putCommand(v4, "feed");
+        v4.writeTo(root / "nested" / "bella");
+
+        auto trailing = makeV1("Odd", 1);
+        trailing.put<uint8_t>(0);
+        trailing.writeTo(root / "odd");
+        auto trailingBefore = readFile(root / "odd");
+
+        LegacyFile notes;
+        notes.putString("\x01 not a pet\n");
+        notes.writeTo(root / "notes.txt");
+
+        PetState current;
+        current.initialize("Max");
+        current.setDurabilityPolicy(DurabilityPolicy::never());
+        check(current.saveToFile(root / "nested" / "max"), "current file is saved");
+
+        StateMigrator migrator(2, DurabilityPolicy::never());
+        auto report = migrator.migrate(root);
+        check(report.scanned == 5, "migrate visits every file");
+        check(report.migrated == 2, "migrate rewrites both legacy files");
+        check(report.upToDate == 1, "migrate skips the current file");
+        check(report.ignored == 2, "migrate ignores files it cannot parse exactly");
+        check(report.failed == 0, "migrate has no failures");
+        check(readFile(root / "odd") == trailingBefore, "ignored file is left untouched");
+
+        for (auto [name, file, xp] : { std::tuple{ "Rex", "rex", 250u }, std::tuple{ "Bella", "nested/bella", 1234u } }) {
+            uint8_t version = 0;
+            PetState petState;
+            check(PetState::peekFileVersion(root / file, version) && version == StateFileFormat::CURRENT_VERSION,
+                  std::string(file) + " is at the current version");
+            check(petState.loadFromFile(root / file) && petState.getName() == name && petState.getXP() == xp,
+                  std::string(file) + " keeps its name and XP");
+        }
+
+        // Rerunning after a completed run changes nothing
+        report = migrator.migrate(root);
+        check(report.migrated == 0 && report.upToDate == 3 && report.ignored == 2, "second migrate run is a no-op");
+    }
+}
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "pet_state_format_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    testLegacyDetection(directory);
+    testLegacyTrailingBytes(directory);
+    testLegacyCommandCountIsClamped(directory);
+    testLegacyLongCommandIsSkipped(directory);
+    testNonStateFile(directory);
+    testMigrationRoundTrip(directory);
+    testMigrator(directory);
+
+    std::filesystem::remove_all(directory);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "State file format checks passed" << std::endl;
+    return 0;
+}
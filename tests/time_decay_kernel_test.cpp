@@ -0,0 +1,218 @@
+#include "../include/time_decay.h"
+#include "../include/game_config.h"
+#include <iostream>
+#include <cstring>
+#include <vector>
+#include <chrono>
+#include <iterator>
+
+// Every decay kernel the CPU supports must leave the columns byte-for-byte
+// identical to the portable kernel's output, and the portable kernel must
+// match the scalar decay pets were updated with one at a time.
+
+namespace {
+    /**
+     * @brief Owned copies of the columns a kernel reads and writes
+     */
+    struct ColumnData {
+        std::vector<float> hunger;
+        std::vector<float> happiness;
+        std::vector<float> energy;
+        std::vector<uint8_t> evolutionLevels;
+        std::vector<int64_t> lastInteractionSeconds;
+
+        TimeDecay::Columns columns() {
+            return { hunger, happiness, energy, evolutionLevels, lastInteractionSeconds };
+        }
+    };
+
+    template <typename T>
+    bool sameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+    }
+
+    /**
+     * @brief Pets covering every branch of the kernels
+     *
+     * The count is not a multiple of any vector width, so the scalar tail runs too.
+     */
+    ColumnData makePets(int64_t nowSeconds) {
+        constexpr size_t PET_COUNT = 1031;
+        ColumnData data;
+
+        uint32_t seed = 12345;
+        auto next = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return seed >> 8;
+        };
+
+        for (size_t i = 0; i < PET_COUNT; ++i) {
+            // Stats near zero and near the maximum, and fractional ones in between
+            data.hunger.push_back(static_cast<float>(next() % 6100) / 100.0f);
+            data.happiness.push_back(static_cast<float>(next() % 6100) / 100.0f);
+            data.energy.push_back(static_cast<float>(next() % 6100) / 100.0f);
+
+            // Levels past the end of the max-stat table included
+            data.evolutionLevels.push_back(static_cast<uint8_t>(next() % 10));
+
+            int64_t last;
+            switch (i % 5) {
+                case 0:
+                    last = 0;                                       // Never interacted
+                    break;
+                case 1:
+                    last = nowSeconds - static_cast<int64_t>(next() % 60);  // Below the threshold
+                    break;
+                case 2:
+                    last = nowSeconds - static_cast<int64_t>(next() % (3600 * 24 * 365));  // Up to a year ago
+                    break;
+                case 3:
+                    last = nowSeconds + static_cast<int64_t>(next() % 3600);  // Clock moved backwards
+                    break;
+                default:
+                    last = nowSeconds - static_cast<int64_t>(next() % 600) - 1;
+                    break;
+            }
+            data.lastInteractionSeconds.push_back(last);
+        }
+        return data;
+    }
+
+    /**
+     * @brief The scalar decay TimeManager::applyTimeEffects() applied to one pet at a time
+     *
+     * Transcribed from the original per-pet path: rates widened to double,
+     * amounts narrowed to float, then PetState's decrease/increase clamping.
+     */
+    size_t applyOriginalDecay(ColumnData& data, int64_t nowSeconds) {
+        size_t applied = 0;
+        for (size_t i = 0; i < data.hunger.size(); ++i) {
+            if (data.lastInteractionSeconds[i] == 0) {
+                continue;
+            }
+            double hoursPassed = std::chrono::duration<double, std::ratio<3600, 1>>(
+                std::chrono::seconds(nowSeconds - data.lastInteractionSeconds[i])).count();
+            if (hoursPassed < GameConfig::Time::MIN_TIME_THRESHOLD) {
+                continue;
+            }
+
+            float hungerDecrease = static_cast<float>(GameConfig::getHungerDecreaseRate() * hoursPassed);
+            float happinessDecrease = static_cast<float>(GameConfig::getHappinessDecreaseRate() * hoursPassed);
+            float energyIncrease = static_cast<float>(GameConfig::getEnergyIncreaseRate() * hoursPassed);
+            float maxStat = GameConfig::getMaxStatForEvolutionLevel(data.evolutionLevels[i]);
+
+            data.hunger[i] = (data.hunger[i] > hungerDecrease) ? (data.hunger[i] - hungerDecrease) : 0.0f;
+            data.happiness[i] = (data.happiness[i] > happinessDecrease) ? (data.happiness[i] - happinessDecrease) : 0.0f;
+            data.energy[i] += energyIncrease;
+            if (data.energy[i] > maxStat) {
+                data.energy[i] = maxStat;
+            }
+            data.lastInteractionSeconds[i] = nowSeconds;
+            ++applied;
+        }
+        return applied;
+    }
+
+    /**
+     * @brief A pet with the stats the original decay left it with
+     */
+    struct ReferencePet {
+        float hunger;
+        float happiness;
+        float energy;
+        uint8_t evolutionLevel;
+        int64_t secondsAgo;
+        float expectedHunger;
+        float expectedHappiness;
+        float expectedEnergy;
+        bool applied;
+    };
+
+    // Worked out by hand from the default rates: hunger -5, happiness -3, energy +10 per hour
+    constexpr ReferencePet REFERENCE_PETS[] = {
+        { 50.0f, 40.0f, 10.0f, 0, 7200, 40.0f, 34.0f, 30.0f, true },    // Two hours
+        { 60.0f, 60.0f, 0.0f, 6, 1800, 57.5f, 58.5f, 5.0f, true },     // Half an hour
+        { 7.5f, 2.0f, 75.0f, 3, 10800, 0.0f, 0.0f, 80.0f, true },      // Floors at zero, energy capped at Teen's maximum
+        { 20.0f, 20.0f, 55.0f, 9, 3600, 15.0f, 17.0f, 60.0f, true },   // Unknown level caps at the Egg maximum
+        { 30.0f, 30.0f, 30.0f, 2, 179, 30.0f, 30.0f, 30.0f, false },   // Just under the threshold
+        { 30.0f, 30.0f, 30.0f, 2, 180, 29.75f, 30.0f - 0.15f, 30.5f, true },  // At the threshold
+        { 30.0f, 30.0f, 30.0f, 1, -3600, 30.0f, 30.0f, 30.0f, false }, // Clock moved backwards
+    };
+
+    bool matchesReference(TimeDecay::Kernel kernel, int64_t nowSeconds) {
+        ColumnData data;
+        for (const auto& pet : REFERENCE_PETS) {
+            data.hunger.push_back(pet.hunger);
+            data.happiness.push_back(pet.happiness);
+            data.energy.push_back(pet.energy);
+            data.evolutionLevels.push_back(pet.evolutionLevel);
+            data.lastInteractionSeconds.push_back(nowSeconds - pet.secondsAgo);
+        }
+        TimeDecay::applyTimeEffectsWith(kernel, data.columns(), nowSeconds);
+
+        bool same = true;
+        for (size_t i = 0; i < std::size(REFERENCE_PETS); ++i) {
+            const auto& pet = REFERENCE_PETS[i];
+            same &= data.hunger[i] == pet.expectedHunger && data.happiness[i] == pet.expectedHappiness &&
+                    data.energy[i] == pet.expectedEnergy &&
+                    data.lastInteractionSeconds[i] == (pet.applied ? nowSeconds : nowSeconds - pet.secondsAgo);
+        }
+        return same;
+    }
+}
+
+int main() {
+    constexpr int64_t NOW_SECONDS = 1700000000;
+    int failures = 0;
+
+    ColumnData expected = makePets(NOW_SECONDS);
+    size_t expectedApplied = TimeDecay::applyTimeEffectsWith(TimeDecay::Kernel::Portable, expected.columns(), NOW_SECONDS);
+    if (expectedApplied == 0) {
+        std::cerr << "The portable kernel updated no pets" << std::endl;
+        return 1;
+    }
+
+    // The portable kernel against the original scalar decay
+    ColumnData original = makePets(NOW_SECONDS);
+    size_t originalApplied = applyOriginalDecay(original, NOW_SECONDS);
+    bool sameAsOriginal = originalApplied == expectedApplied &&
+                          sameBytes(original.hunger, expected.hunger) &&
+                          sameBytes(original.happiness, expected.happiness) &&
+                          sameBytes(original.energy, expected.energy) &&
+                          sameBytes(original.lastInteractionSeconds, expected.lastInteractionSeconds);
+    std::cout << "portable: " << (sameAsOriginal ? "matches" : "differs from") << " the scalar decay" << std::endl;
+    if (!sameAsOriginal) {
+        ++failures;
+    }
+
+    if constexpr (GameConfig::CURRENT_PRESET == GameConfig::Preset::Default) {
+        for (auto kernel : { TimeDecay::Kernel::Portable, TimeDecay::Kernel::Sse42, TimeDecay::Kernel::Avx2 }) {
+            if (TimeDecay::isKernelSupported(kernel) && !matchesReference(kernel, NOW_SECONDS)) {
+                std::cerr << TimeDecay::getKernelName(kernel) << ": differs from the reference values" << std::endl;
+                ++failures;
+            }
+        }
+    }
+
+    for (auto kernel : { TimeDecay::Kernel::Sse42, TimeDecay::Kernel::Avx2 }) {
+        if (!TimeDecay::isKernelSupported(kernel)) {
+            std::cout << TimeDecay::getKernelName(kernel) << ": not supported by this CPU, skipped" << std::endl;
+            continue;
+        }
+
+        ColumnData actual = makePets(NOW_SECONDS);
+        size_t applied = TimeDecay::applyTimeEffectsWith(kernel, actual.columns(), NOW_SECONDS);
+
+        bool same = applied == expectedApplied &&
+                    sameBytes(actual.hunger, expected.hunger) &&
+                    sameBytes(actual.happiness, expected.happiness) &&
+                    sameBytes(actual.energy, expected.energy) &&
+                    sameBytes(actual.lastInteractionSeconds, expected.lastInteractionSeconds);
+        std::cout << TimeDecay::getKernelName(kernel) << ": " << (same ? "matches" : "differs from") << " portable" << std::endl;
+        if (!same) {
+            ++failures;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
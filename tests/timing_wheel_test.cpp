@@ -0,0 +1,124 @@
+#include "../include/timing_wheel.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+
+// Timers must fire exactly once, in time order, at or before the time the
+// wheel advances to, whatever level or overflow list they waited in.
+// A plain map of ID to time is the reference.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    constexpr uint32_t TIMER_COUNT = 2000;
+
+    // Spans every level and the overflow list (the four levels cover about 194 days)
+    constexpr int64_t MAX_DELAY = int64_t{400} * 24 * 3600;
+
+    void testRandomTimers() {
+        std::mt19937_64 random(14);
+        std::uniform_int_distribution<int64_t> delayDistribution(0, MAX_DELAY);
+        std::uniform_int_distribution<uint32_t> idDistribution(0, TIMER_COUNT - 1);
+
+        int64_t now = 1'700'000'000;
+        TimingWheel wheel(now);
+        std::map<uint32_t, int64_t> reference;
+
+        for (uint32_t id = 0; id < TIMER_COUNT; ++id) {
+            int64_t when = now + delayDistribution(random);
+            wheel.schedule(id, when);
+            reference[id] = when;
+        }
+
+        // Reschedule and cancel some timers before the first advance
+        for (int i = 0; i < 300; ++i) {
+            uint32_t id = idDistribution(random);
+            if (i % 3 == 0) {
+                check(wheel.cancel(id) == (reference.erase(id) != 0), "cancel reports whether the timer existed");
+            } else {
+                int64_t when = now + delayDistribution(random);
+                wheel.schedule(id, when);
+                reference[id] = when;
+            }
+        }
+        check(wheel.size() == reference.size(), "size counts scheduled timers");
+
+        // Advance in steps of very different sizes until every timer fired
+        std::uniform_int_distribution<int64_t> stepDistribution(0, 3);
+        const int64_t stepSizes[] = { 1, 59, 3600 * 7 + 13, 86400 * 9 + 1 };
+        while (!reference.empty()) {
+            now += stepSizes[stepDistribution(random)];
+
+            std::multimap<int64_t, uint32_t> expected;
+            for (const auto& [id, when] : reference) {
+                if (when <= now) {
+                    expected.emplace(when, id);
+                }
+            }
+
+            int64_t lastFired = INT64_MIN;
+            size_t fired = wheel.advance(now, [&](uint32_t id, int64_t when) {
+                auto it = reference.find(id);
+                check(it != reference.end() && it->second == when, "fired timer was scheduled at that time");
+                check(when <= now, "timer does not fire early");
+                check(when >= lastFired, "timers fire in time order");
+                check(!wheel.isScheduled(id), "timer is removed before its callback");
+                lastFired = when;
+                if (it != reference.end()) {
+                    reference.erase(it);
+                }
+            });
+
+            check(fired == expected.size(), "every due timer fires");
+            for (const auto& [when, id] : expected) {
+                check(reference.count(id) == 0, "due timer " + std::to_string(id) + " fired");
+            }
+            check(wheel.size() == reference.size(), "size drops as timers fire");
+            if (failures > 20) {
+                return;
+            }
+        }
+    }
+
+    void testRescheduleFromCallback() {
+        // A timer that reschedules itself within the advanced span fires again in the same call
+        TimingWheel wheel(0);
+        wheel.schedule(1, 10);
+        std::vector<int64_t> firings;
+        wheel.advance(100, [&](uint32_t id, int64_t when) {
+            firings.push_back(when);
+            if (when + 25 <= 200) {
+                wheel.schedule(id, when + 25);
+            }
+        });
+        check((firings == std::vector<int64_t>{ 10, 35, 60, 85 }), "rescheduled timer fires at each due time");
+        check(wheel.isScheduled(1) && wheel.size() == 1, "timer past the advanced time stays scheduled");
+
+        // Timers at or before the construction time fire on the next advance
+        TimingWheel late(1000);
+        late.schedule(7, 500);
+        size_t fired = late.advance(1000, [](uint32_t, int64_t) {});
+        check(fired == 1, "overdue timer fires on the next advance");
+    }
+}
+
+int main() {
+    testRandomTimers();
+    testRescheduleFromCallback();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Timing wheel checks passed" << std::endl;
+    return 0;
+}
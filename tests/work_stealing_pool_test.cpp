@@ -0,0 +1,133 @@
+#include "../include/work_stealing_pool.h"
+#include "../include/tick_engine.h"
+#include "../include/pet_population.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+
+// parallelFor() must run every task exactly once and return only after all
+// of them finished, however unevenly the work is spread. A parallel tick
+// must leave a population exactly as a single-threaded tick does.
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    void testCompletion() {
+        WorkStealingPool pool(4);
+        check(pool.getThreadCount() == 4, "pool has the requested workers");
+
+        for (size_t taskCount : { size_t{0}, size_t{1}, size_t{3}, size_t{1000}, size_t{65537} }) {
+            for (int round = 0; round < 5; ++round) {
+                auto runs = std::make_unique<std::atomic<uint32_t>[]>(taskCount + 1);
+                std::atomic<size_t> finished{0};
+                std::atomic<bool> badWorker{false};
+
+                pool.parallelFor(taskCount, [&](size_t task, size_t worker) {
+                    if (worker >= pool.getThreadCount()) {
+                        badWorker = true;
+                    }
+                    // Skewed load: the first worker's tasks are slow, so the others must steal them
+                    if (task < taskCount / 8 && task % 64 == 0) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    }
+                    runs[task].fetch_add(1, std::memory_order_relaxed);
+                    finished.fetch_add(1, std::memory_order_release);
+                });
+
+                // parallelFor() returns only after every task finished
+                check(finished.load(std::memory_order_acquire) == taskCount,
+                      "all " + std::to_string(taskCount) + " tasks finished before parallelFor returned");
+                size_t once = 0;
+                for (size_t task = 0; task < taskCount; ++task) {
+                    once += runs[task].load() == 1;
+                }
+                check(once == taskCount, "each of " + std::to_string(taskCount) + " tasks ran exactly once");
+                check(!badWorker, "worker indices are below the thread count");
+            }
+        }
+    }
+
+    void fillPopulation(PetPopulation& population, std::chrono::system_clock::time_point now) {
+        for (size_t i = 0; i < 5000; ++i) {
+            // Interaction times from minutes to weeks ago, and XP at every level
+            auto last = now - std::chrono::minutes(static_cast<int64_t>((i * 7919) % (60 * 24 * 21)));
+            size_t index = population.add("Pet " + std::to_string(i), last);
+            auto view = population[index];
+            view.addXP(static_cast<uint32_t>((i * 104729) % 60000));
+            view.decreaseEnergy(static_cast<float>(i % 90));
+            view.decreaseHunger(static_cast<float>(i % 70));
+        }
+    }
+
+    bool sameLevelStats(const PopulationAggregates::LevelStats& a, const PopulationAggregates::LevelStats& b) {
+        return a.count == b.count && a.xpSum == b.xpSum && a.hungerSum == b.hungerSum &&
+               a.happinessSum == b.happinessSum && a.energySum == b.energySum &&
+               a.hungerWarnings == b.hungerWarnings && a.happinessWarnings == b.happinessWarnings &&
+               a.hungerHistogram == b.hungerHistogram && a.happinessHistogram == b.happinessHistogram &&
+               a.energyHistogram == b.energyHistogram;
+    }
+
+    void testParallelTick() {
+        auto now = std::chrono::system_clock::now();
+        PetPopulation sequential;
+        PetPopulation parallel;
+        fillPopulation(sequential, now);
+        fillPopulation(parallel, now);
+
+        TickEngine single(1);
+        TickEngine many(4, TickEngine::CHUNK_GRANULE);
+        auto expected = single.tick(sequential, now);
+        auto actual = many.tick(parallel, now);
+
+        check(actual.updated == expected.updated, "parallel tick updates the same pets");
+        bool sameEvents = actual.events.size() == expected.events.size();
+        for (size_t i = 0; sameEvents && i < actual.events.size(); ++i) {
+            sameEvents = actual.events[i].petIndex == expected.events[i].petIndex &&
+                         actual.events[i].type == expected.events[i].type &&
+                         actual.events[i].value == expected.events[i].value;
+        }
+        check(sameEvents, "parallel tick reports the same events in pet order");
+
+        bool sameColumns = true;
+        for (size_t i = 0; i < sequential.size(); ++i) {
+            sameColumns &= sequential.getHungerColumn()[i] == parallel.getHungerColumn()[i] &&
+                           sequential.getHappinessColumn()[i] == parallel.getHappinessColumn()[i] &&
+                           sequential.getEnergyColumn()[i] == parallel.getEnergyColumn()[i] &&
+                           sequential.getXPColumn()[i] == parallel.getXPColumn()[i] &&
+                           sequential.getEvolutionLevelColumn()[i] == parallel.getEvolutionLevelColumn()[i] &&
+                           sequential.getLastInteractionColumn()[i] == parallel.getLastInteractionColumn()[i] &&
+                           sequential.getAchievementColumn()[i] == parallel.getAchievementColumn()[i];
+        }
+        check(sameColumns, "parallel tick leaves the same columns");
+
+        for (size_t level = 0; level < PopulationAggregates::LEVEL_COUNT; ++level) {
+            auto evolutionLevel = static_cast<EvolutionLevel>(level);
+            check(sameLevelStats(parallel.getAggregates().getLevelStats(evolutionLevel),
+                                 sequential.getAggregates().getLevelStats(evolutionLevel)),
+                  "parallel tick leaves the same aggregates at level " + std::to_string(level));
+        }
+    }
+}
+
+int main() {
+    testCompletion();
+    testParallelTick();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Work-stealing pool checks passed" << std::endl;
+    return 0;
+}